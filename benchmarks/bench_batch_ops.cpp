@@ -0,0 +1,102 @@
+// Compares the pipelined batch API (get_json_many / set_json_many / get_paths)
+// against the equivalent one-call-per-item loop.
+//
+// Usage: redisjson_bench_batch_ops [num_keys] [iterations]
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/redis_json_client.h"
+#include "redisjson++/common_types.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+
+using json = nlohmann::json;
+
+namespace {
+
+double time_ms(const std::function<void()>& fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const std::string& name, double loop_ms, double batch_ms, size_t ops) {
+    double loop_rate = ops / (loop_ms / 1000.0);
+    double batch_rate = ops / (batch_ms / 1000.0);
+    std::cout << std::left << std::setw(14) << name
+              << " loop: " << std::setw(12) << static_cast<long long>(loop_rate) << " ops/s"
+              << "  batch: " << std::setw(12) << static_cast<long long>(batch_rate) << " ops/s"
+              << "  speedup: " << std::fixed << std::setprecision(1) << (batch_rate / loop_rate) << "x"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t num_keys = argc > 1 ? std::stoul(argv[1]) : 1000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    try {
+        redisjson::RedisJSONClient client(config);
+
+        std::vector<std::string> keys;
+        std::map<std::string, json> documents;
+        for (size_t i = 0; i < num_keys; ++i) {
+            std::string key = "bench:batch:" + std::to_string(i);
+            keys.push_back(key);
+            documents[key] = {
+                {"id", i},
+                {"name", "interface" + std::to_string(i)},
+                {"admin_status", "up"},
+                {"mtu", 9100},
+                {"counters", {{"rx", i * 10}, {"tx", i * 20}}}
+            };
+        }
+        std::vector<std::string> paths = {"id", "name", "admin_status", "mtu", "counters.rx", "counters.tx"};
+        size_t path_ops = paths.size() * 100;
+
+        std::cout << "Keys: " << num_keys << ", iterations: " << iterations << std::endl;
+
+        double set_loop = time_ms([&] {
+            for (const auto& [key, doc] : documents) client.set_json(key, doc);
+        }, iterations);
+        double set_batch = time_ms([&] { client.set_json_many(documents); }, iterations);
+        report("set_json", set_loop, set_batch, num_keys * iterations);
+
+        double get_loop = time_ms([&] {
+            for (const auto& key : keys) client.get_json(key);
+        }, iterations);
+        double get_batch = time_ms([&] { client.get_json_many(keys); }, iterations);
+        report("get_json", get_loop, get_batch, num_keys * iterations);
+
+        double path_loop = time_ms([&] {
+            for (int r = 0; r < 100; ++r)
+                for (const auto& path : paths) client.get_path(keys[0], path);
+        }, iterations);
+        double path_batch = time_ms([&] {
+            for (int r = 0; r < 100; ++r) client.get_paths(keys[0], paths);
+        }, iterations);
+        report("get_path", path_loop, path_batch, path_ops * iterations);
+
+        for (const auto& key : keys) client.del_json(key);
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Measures RedisConnectionManager checkout/return throughput under contention: every
+// thread repeatedly takes a connection from the pool and returns it, without sending a
+// command, so the numbers reflect the pool's own overhead.
+//
+// Usage: redisjson_bench_connection_pool [threads ...] (default: 1 8 64)
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/redis_connection_manager.h"
+#include "redisjson++/common_types.h"
+#include "redisjson++/exceptions.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int OPS_PER_THREAD = 100000;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> thread_counts;
+    for (int i = 1; i < argc; ++i) thread_counts.push_back(std::stoi(argv[i]));
+    if (thread_counts.empty()) thread_counts = {1, 8, 64};
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+    config.connection_pool_size = 16;
+
+    try {
+        redisjson::RedisConnectionManager manager(config);
+        // Fails here, rather than in the worker threads, if Redis is unreachable.
+        manager.return_connection(manager.get_connection());
+
+        for (int thread_count : thread_counts) {
+            std::atomic<bool> failed{false};
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&] {
+                    try {
+                        for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                            auto conn = manager.get_connection();
+                            manager.return_connection(std::move(conn));
+                        }
+                    } catch (const redisjson::RedisJSONException&) {
+                        failed = true;
+                    }
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double ops = static_cast<double>(thread_count) * OPS_PER_THREAD;
+            auto stats = manager.get_stats();
+            std::cout << std::setw(3) << thread_count << " threads: " << std::fixed << std::setprecision(2)
+                      << ops / seconds / 1e6 << " M checkouts/s (pool: " << stats.total_connections << " open, "
+                      << stats.connection_errors << " errors)" << (failed ? " [some checkouts failed]" : "") << std::endl;
+        }
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark aborted: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Compares JSONDiff (JSONModifier::diff) with nlohmann's json::diff on large documents
+// with a few changes: edited members, an element inserted near the start of a large
+// array, and elements removed from and inserted into an array of keyed objects.
+// No Redis server is needed.
+//
+// Usage: redisjson_bench_diff [doc_kb ...] (default: 100 1000)
+
+#include "redisjson++/json_diff.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+using json = nlohmann::json;
+
+namespace {
+
+double time_ms(const std::function<void()>& fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// A document of roughly `target_kb` kilobytes: a keyed port list and a counter history.
+json make_document(size_t target_kb) {
+    json doc = {{"ports", json::array()}, {"history", json::array()}};
+    size_t i = 0;
+    while (doc.dump().size() < target_kb * 1024) {
+        for (size_t batch = 0; batch < 64; ++batch, ++i) {
+            doc["ports"].push_back({
+                {"name", "Ethernet" + std::to_string(i)},
+                {"admin_status", "up"},
+                {"mtu", 9100},
+                {"lanes", {i * 4, i * 4 + 1, i * 4 + 2, i * 4 + 3}},
+                {"counters", {{"rx_bytes", i * 1000}, {"tx_bytes", i * 2000}}}
+            });
+            doc["history"].push_back(i * 7);
+        }
+    }
+    return doc;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes_kb;
+    for (int i = 1; i < argc; ++i) sizes_kb.push_back(std::stoul(argv[i]));
+    if (sizes_kb.empty()) sizes_kb = {100, 1000};
+
+    const int iterations = 10;
+    for (size_t kb : sizes_kb) {
+        json before = make_document(kb);
+        json after = before;
+        json& ports = after["ports"];
+        ports[ports.size() / 2]["mtu"] = 1500;
+        ports.erase(ports.begin() + 5);
+        ports.push_back({{"name", "PortChannel1"}, {"mtu", 9100}});
+        after["history"].insert(after["history"].begin() + 3, -1);
+
+        redisjson::JSONDiff engine;
+        json hashed_patch = engine.diff(before, after);
+        json full_patch = json::diff(before, after);
+        double hashed_ms = time_ms([&] { hashed_patch = engine.diff(before, after); }, iterations);
+        double full_ms = time_ms([&] { full_patch = json::diff(before, after); }, iterations);
+        double identical_ms = time_ms([&] { engine.diff(before, before); }, iterations);
+
+        std::cout << "Document: " << before.dump().size() / 1024 << " KB, " << before["ports"].size() << " ports"
+                  << std::endl;
+        std::cout << std::fixed << std::setprecision(2)
+                  << "  JSONDiff:   " << std::setw(9) << hashed_ms << " ms/diff, " << hashed_patch.size()
+                  << " operations, " << hashed_patch.dump().size() << " bytes\n"
+                  << "  json::diff: " << std::setw(9) << full_ms << " ms/diff, " << full_patch.size()
+                  << " operations, " << full_patch.dump().size() << " bytes\n"
+                  << "  JSONDiff of identical documents: " << identical_ms << " ms" << std::endl;
+        if (before.patch(hashed_patch) != after) {
+            std::cerr << "JSONDiff patch does not reproduce the new document" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
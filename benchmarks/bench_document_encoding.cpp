@@ -0,0 +1,99 @@
+// Compares the JSON and MessagePack document encodings (LegacyClientConfig::document_encoding)
+// on large documents: small path updates, which the server handles as decode/mutate/encode
+// inside a Lua script, and whole-document reads.
+//
+// Usage: redisjson_bench_document_encoding [doc_kb ...] (default: 100 1000)
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/redis_json_client.h"
+#include "redisjson++/common_types.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+
+using json = nlohmann::json;
+
+namespace {
+
+double time_ms(const std::function<void()>& fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// A port table of roughly `target_kb` kilobytes when serialized as JSON.
+json make_document(size_t target_kb) {
+    json doc = {{"ports", json::object()}};
+    size_t i = 0;
+    while (doc.dump().size() < target_kb * 1024) {
+        for (size_t batch = 0; batch < 64; ++batch, ++i) {
+            doc["ports"]["Ethernet" + std::to_string(i)] = {
+                {"admin_status", "up"},
+                {"mtu", 9100},
+                {"speed", 100000},
+                {"alias", "etp" + std::to_string(i)},
+                {"lanes", {i * 4, i * 4 + 1, i * 4 + 2, i * 4 + 3}},
+                {"counters", {{"rx_bytes", i * 1000}, {"tx_bytes", i * 2000}, {"errors", 0}}}
+            };
+        }
+    }
+    return doc;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes_kb;
+    for (int i = 1; i < argc; ++i) sizes_kb.push_back(std::stoul(argv[i]));
+    if (sizes_kb.empty()) sizes_kb = {100, 1000};
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    const int iterations = 50;
+    try {
+        for (size_t kb : sizes_kb) {
+            json doc = make_document(kb);
+            std::cout << "Document: " << doc.dump().size() / 1024 << " KB JSON, "
+                      << json::to_msgpack(doc).size() / 1024 << " KB MessagePack" << std::endl;
+
+            for (auto encoding : {redisjson::DocumentEncoding::JSON, redisjson::DocumentEncoding::MESSAGEPACK}) {
+                config.document_encoding = encoding;
+                redisjson::RedisJSONClient client(config);
+                const std::string key = "bench:encoding";
+                client.set_json(key, doc);
+
+                int counter = 0;
+                double set_path_ms = time_ms([&] {
+                    client.set_path(key, "ports.Ethernet0.mtu", 9000 + (counter++ % 100));
+                }, iterations);
+                double get_path_ms = time_ms([&] { client.get_path(key, "ports.Ethernet0.mtu"); }, iterations);
+                double get_json_ms = time_ms([&] { client.get_json(key); }, iterations);
+                client.del_json(key);
+
+                std::cout << "  " << std::left << std::setw(12)
+                          << (encoding == redisjson::DocumentEncoding::JSON ? "json" : "messagepack")
+                          << std::fixed << std::setprecision(2)
+                          << " set_path: " << std::setw(8) << set_path_ms / iterations << " ms"
+                          << "  get_path: " << std::setw(8) << get_path_ms / iterations << " ms"
+                          << "  get_json: " << std::setw(8) << get_json_ms / iterations << " ms"
+                          << std::endl;
+            }
+        }
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
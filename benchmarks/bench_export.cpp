@@ -0,0 +1,108 @@
+// Measures the throughput of export_json (streamed SCAN pages with pipelined reads,
+// stored bytes copied without parsing) in documents/s and MB/s, against exporting
+// with keys_by_pattern followed by one get_json per key.
+//
+// Usage: redisjson_bench_export [documents] [iterations] (default: 50000 3)
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/redis_json_client.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Discards the output, counting its bytes.
+class CountingBuffer : public std::streambuf {
+public:
+    size_t bytes = 0;
+
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof()) ++bytes;
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        bytes += static_cast<size_t>(count);
+        return count;
+    }
+};
+
+void report(const char* label, size_t documents, size_t bytes, double ms) {
+    std::cout << std::fixed << std::setprecision(1) << label << std::setw(12) << documents * 1000.0 / ms
+              << " docs/s " << std::setw(10) << bytes / (1024.0 * 1024.0) * 1000.0 / ms << " MB/s\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t documents = argc > 1 ? std::stoul(argv[1]) : 50000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    try {
+        redisjson::RedisJSONClient client(config);
+        const std::string pattern = "bench:export:*";
+        std::map<std::string, json> batch;
+        for (size_t i = 0; i < documents; ++i) {
+            batch["bench:export:" + std::to_string(i)] = {
+                {"id", i}, {"name", "device-" + std::to_string(i)},
+                {"ports", {{{"name", "eth0"}, {"mtu", 1500}}, {{"name", "eth1"}, {"mtu", 9000}}}}};
+            if (batch.size() == 1000 || i + 1 == documents) {
+                client.set_json_many(batch);
+                batch.clear();
+            }
+        }
+        std::cout << "Documents: " << documents << std::endl;
+
+        for (redisjson::ExportFormat format : {redisjson::ExportFormat::NDJSON, redisjson::ExportFormat::MESSAGEPACK}) {
+            CountingBuffer buffer;
+            std::ostream output(&buffer);
+            redisjson::ExportOptions options;
+            options.format = format;
+            size_t exported = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                exported += client.export_json(pattern, output, options).documents;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            report(format == redisjson::ExportFormat::NDJSON ? "export_json (NDJSON):      "
+                                                             : "export_json (MessagePack): ",
+                   exported, buffer.bytes, ms);
+        }
+
+        CountingBuffer buffer;
+        std::ostream output(&buffer);
+        size_t exported = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            for (const std::string& key : client.keys_by_pattern(pattern)) {
+                output << json{{"key", key}, {"value", client.get_json(key)}}.dump() << '\n';
+                ++exported;
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        report("keys_by_pattern + get_json: ", exported, buffer.bytes, ms);
+
+        for (const std::string& key : client.keys_by_pattern(pattern)) {
+            client.del_json(key);
+        }
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
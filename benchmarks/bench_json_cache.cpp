@@ -0,0 +1,74 @@
+// Measures JSONCache read throughput under concurrent readers (no Redis needed): every
+// thread reads random keys of a warm cache, with an occasional invalidate + refill.
+// Hits are read both as copies (get) and as shared documents (get_shared).
+//
+// Usage: redisjson_bench_json_cache [threads ...] (default: 1 4 16 32)
+
+#include "redisjson++/json_cache.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr size_t KEYS = 10000;
+constexpr int OPS_PER_THREAD = 200000;
+
+json make_entry(size_t i) {
+    return {{"admin_status", "up"}, {"mtu", 9100}, {"alias", "etp" + std::to_string(i)}, {"lanes", {0, 1, 2, 3}}};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> thread_counts;
+    for (int i = 1; i < argc; ++i) thread_counts.push_back(std::stoi(argv[i]));
+    if (thread_counts.empty()) thread_counts = {1, 4, 16, 32};
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEYS; ++i) keys.push_back("PORT|Ethernet" + std::to_string(i));
+
+    redisjson::JSONCache cache(KEYS * 2, std::chrono::seconds(0), 64 * 1024 * 1024);
+    for (size_t i = 0; i < KEYS; ++i) cache.put(keys[i], make_entry(i));
+    std::cout << "Warm cache: " << cache.get_stats().current_size << " entries, ~"
+              << cache.get_stats().current_bytes / 1024 << " KB" << std::endl;
+
+    for (bool shared : {false, true}) {
+        for (int thread_count : thread_counts) {
+            std::atomic<size_t> hits{0};
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t] {
+                    std::mt19937 rng(t);
+                    std::uniform_int_distribution<size_t> pick(0, KEYS - 1);
+                    size_t local_hits = 0;
+                    for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                        size_t k = pick(rng);
+                        if (i % 100 == 0) {
+                            cache.invalidate(keys[k]);
+                            cache.put(keys[k], make_entry(k));
+                        } else if (shared ? cache.get_shared(keys[k]) != nullptr : cache.get(keys[k]).has_value()) {
+                            ++local_hits;
+                        }
+                    }
+                    hits += local_hits;
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double ops = static_cast<double>(thread_count) * OPS_PER_THREAD;
+            std::cout << (shared ? "get_shared " : "get        ") << std::setw(3) << thread_count << " threads: "
+                      << std::fixed << std::setprecision(2) << ops / seconds / 1e6 << " M ops/s (" << hits.load() << " hits)" << std::endl;
+        }
+    }
+    return 0;
+}
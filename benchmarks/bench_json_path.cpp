@@ -0,0 +1,64 @@
+// Measures JSONPathPlan evaluation over a port array (default 10,000 elements): a filter
+// with a projection, recursive descent, and the same queries with match paths. Runs
+// locally; no Redis server is needed.
+//
+// Usage: redisjson_bench_json_path [ports] [iterations] (default: 10000 200)
+
+#include "redisjson++/json_path_plan.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+
+json make_document(size_t ports) {
+    json doc = {{"device", {{"hostname", "switch-1"}, {"ports", json::array()}}}};
+    json& list = doc["device"]["ports"];
+    for (size_t i = 0; i < ports; ++i) {
+        list.push_back({{"name", "Ethernet" + std::to_string(i)},
+                        {"admin_status", i % 4 == 0 ? "down" : "up"},
+                        {"mtu", i % 3 == 0 ? 1500 : 9100},
+                        {"speed", 100000},
+                        {"counters", {{"rx_bytes", i * 1000}, {"tx_bytes", i * 2000}}}});
+    }
+    return doc;
+}
+
+void run(const json& doc, const std::string& expression, int iterations) {
+    redisjson::JSONPathPlan plan = redisjson::JSONPathPlan::compile(expression);
+    size_t matches = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        matches = plan.select(doc).size();
+    }
+    double select_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        plan.select_paths(doc);
+    }
+    double paths_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(3) << expression << " (" << matches << " matches)\n"
+              << "  select:       " << select_ms / iterations << " ms/query\n"
+              << "  select_paths: " << paths_ms / iterations << " ms/query\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t ports = argc > 1 ? std::stoul(argv[1]) : 10000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 200;
+    json doc = make_document(ports);
+
+    run(doc, "$.device.ports[?(@.admin_status=='up')].mtu", iterations);
+    run(doc, "$..ports[?(@.admin_status=='up' && @.mtu > 1500)].name", iterations);
+    run(doc, "$..rx_bytes", iterations);
+    run(doc, "$.device.ports[-10:]", iterations);
+    return 0;
+}
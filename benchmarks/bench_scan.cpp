@@ -0,0 +1,87 @@
+// Compares reading every document under a key pattern by collecting the keys with
+// keys_by_pattern and then calling get_json_many, with streaming them through
+// scan_keys, which pipelines the document reads with the SCAN calls.
+//
+// Usage: redisjson_bench_scan [documents] [iterations] (default: 50000 5)
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/redis_json_client.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+
+double time_ms(const std::function<void()>& fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t documents = argc > 1 ? std::stoul(argv[1]) : 50000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    try {
+        redisjson::RedisJSONClient client(config);
+        const std::string pattern = "bench:scan:*";
+        std::map<std::string, json> batch;
+        for (size_t i = 0; i < documents; ++i) {
+            batch["bench:scan:" + std::to_string(i)] = {{"id", i}, {"name", "device-" + std::to_string(i)}};
+            if (batch.size() == 1000 || i + 1 == documents) {
+                client.set_json_many(batch);
+                batch.clear();
+            }
+        }
+        std::cout << "Documents: " << documents << std::endl;
+
+        size_t collected = 0;
+        double collect_ms = time_ms([&] {
+            collected = 0;
+            for (const auto& result : client.get_json_many(client.keys_by_pattern(pattern))) {
+                collected += result.ok() ? 1 : 0;
+            }
+        }, iterations);
+        redisjson::ScanOptions options;
+        options.fetch_documents = true;
+        size_t streamed = 0;
+        double stream_ms = time_ms([&] {
+            streamed = 0;
+            client.for_each_key(pattern, [&](const redisjson::ScannedKey& entry) {
+                streamed += entry.error ? 0 : 1;
+                return true;
+            }, options);
+        }, iterations);
+        std::cout << std::fixed << std::setprecision(2)
+                  << "keys_by_pattern + get_json_many: " << std::setw(10) << collect_ms / iterations << " ms ("
+                  << collected << " documents)\n"
+                  << "scan_keys (pipelined reads):     " << std::setw(10) << stream_ms / iterations << " ms ("
+                  << streamed << " documents)\n";
+
+        for (const std::string& key : client.keys_by_pattern(pattern)) {
+            client.del_json(key);
+        }
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
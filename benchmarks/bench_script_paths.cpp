@@ -0,0 +1,84 @@
+// Measures the Redis CPU time per json_path_get call with the path passed as a string
+// (parsed by the script) and pre-tokenised by the client (PathParser::script_path_argument).
+// The server-side time comes from INFO commandstats (usec_per_call of EVALSHA), reset with
+// CONFIG RESETSTAT before each run, so it excludes network and client time.
+//
+// Usage: redisjson_bench_script_paths [calls] (default: 20000)
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/lua_script_manager.h"
+#include "redisjson++/path_parser.h"
+#include "redisjson++/redis_connection_manager.h"
+#include "redisjson++/exceptions.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* BENCH_KEY = "bench:script_paths";
+
+std::string info_commandstats(redisjson::RedisConnectionManager& manager) {
+    redisjson::RedisReplyPtr reply = manager.execute_for_key("", {"INFO", "commandstats"});
+    if (!reply || reply->type != REDIS_REPLY_STRING) {
+        throw redisjson::RedisCommandException("INFO", "Unexpected reply to INFO commandstats");
+    }
+    return std::string(reply->str, reply->len);
+}
+
+// usec_per_call of EVALSHA since the last CONFIG RESETSTAT.
+double evalsha_usec_per_call(redisjson::RedisConnectionManager& manager) {
+    std::string stats = info_commandstats(manager);
+    size_t line = stats.find("cmdstat_evalsha:");
+    size_t field = line == std::string::npos ? line : stats.find("usec_per_call=", line);
+    if (field == std::string::npos) {
+        return 0.0;
+    }
+    return std::stod(stats.substr(field + 14));
+}
+
+double run(redisjson::RedisConnectionManager& manager, redisjson::LuaScriptManager& scripts,
+           const std::string& path_argument, int calls) {
+    manager.execute_for_key("", {"CONFIG", "RESETSTAT"});
+    for (int i = 0; i < calls; ++i) {
+        scripts.execute_script("json_path_get", {BENCH_KEY}, {path_argument});
+    }
+    return evalsha_usec_per_call(manager);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int calls = argc > 1 ? std::stoi(argv[1]) : 20000;
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    try {
+        redisjson::RedisConnectionManager manager(config);
+        redisjson::LuaScriptManager scripts(&manager);
+        // A small document, so that path handling is a visible part of the script's work.
+        manager.execute_for_key(BENCH_KEY, {"SET", BENCH_KEY,
+            R"({"config":{"interfaces":{"Ethernet0":{"vlans":[{"id":10,"tagged":true},{"id":20,"tagged":false}]}}}})"});
+
+        const std::string path = "$.config.interfaces.Ethernet0.vlans[1].tagged";
+        const std::string tokenised = redisjson::PathParser::script_path_argument(path);
+        run(manager, scripts, path, calls / 10); // Warm-up
+
+        double string_usec = run(manager, scripts, path, calls);
+        double tokenised_usec = run(manager, scripts, tokenised, calls);
+        std::cout << std::fixed << std::setprecision(2)
+                  << "json_path_get, " << calls << " calls (Redis CPU per call)\n"
+                  << "  path string:      " << string_usec << " us\n"
+                  << "  tokenised path:   " << tokenised_usec << " us\n";
+        manager.execute_for_key(BENCH_KEY, {"DEL", BENCH_KEY});
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark aborted: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Compares JSONQueryEngine::select resolved through secondary indexes with the same
+// where clause evaluated by scanning the key pattern, over a set of device documents.
+//
+// Usage: redisjson_bench_select [documents] [iterations] (default: 20000 20)
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/redis_json_client.h"
+#include "redisjson++/json_query_engine.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+
+double time_ms(const std::function<void()>& fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t documents = argc > 1 ? std::stoul(argv[1]) : 20000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    try {
+        redisjson::RedisJSONClient client(config);
+        redisjson::JSONQueryEngine queries(client);
+        const std::string pattern = "bench:select:*";
+        const char* cities[] = {"Paris", "Oslo", "Lima", "Pune", "Kyiv"};
+        std::map<std::string, json> batch;
+        for (size_t i = 0; i < documents; ++i) {
+            batch["bench:select:" + std::to_string(i)] = {
+                {"location", {{"city", cities[i % 5]}}},
+                {"ports", {{"count", static_cast<int>(i % 97)}}}};
+            if (batch.size() == 1000 || i + 1 == documents) {
+                client.set_json_many(batch);
+                batch.clear();
+            }
+        }
+        std::cout << "Documents: " << documents << std::endl;
+
+        const std::string clauses[] = {"@.location.city == 'Oslo' && @.ports.count > 95", "@.ports.count == 3"};
+        std::map<std::string, double> scan_ms;
+        for (const std::string& clause : clauses) {
+            scan_ms[clause] = time_ms([&] { queries.select_keys(pattern, clause); }, iterations);
+        }
+        client.create_index({"bench_city", pattern, "location.city", redisjson::IndexType::TAG});
+        client.create_index({"bench_ports", pattern, "ports.count", redisjson::IndexType::NUMERIC});
+        for (const std::string& clause : clauses) {
+            size_t matches = 0;
+            double indexed_ms = time_ms([&] { matches = queries.select_keys(pattern, clause).size(); }, iterations);
+            std::cout << clause << " (" << matches << " matches)\n" << std::fixed << std::setprecision(2)
+                      << "  indexed: " << std::setw(10) << indexed_ms / iterations << " ms\n"
+                      << "  scan:    " << std::setw(10) << scan_ms[clause] / iterations << " ms\n";
+        }
+
+        client.drop_index("bench_city");
+        client.drop_index("bench_ports");
+        for (const std::string& key : client.keys_by_pattern(pattern)) {
+            client.del_json(key);
+        }
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
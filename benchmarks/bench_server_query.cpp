@@ -0,0 +1,117 @@
+// Compares JSONPath queries and aggregations run inside Redis (JSONQueryEngine::query and
+// ::aggregate, the json_query and json_aggregate scripts) with fetching the whole document
+// and evaluating the plan on the client, on a large inventory document: time per query and
+// bytes transferred per query.
+//
+// Usage: redisjson_bench_server_query [doc_kb] [iterations] (default: 2000 50)
+// Connects to REDIS_HOST / REDIS_PORT / REDIS_PASSWORD (default 127.0.0.1:6379).
+
+#include "redisjson++/redis_json_client.h"
+#include "redisjson++/json_query_engine.h"
+#include "redisjson++/json_path_plan.h"
+#include "redisjson++/json_aggregation.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+
+double time_ms(const std::function<void()>& fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// An inventory of ports of roughly `target_kb` kilobytes when serialized as JSON.
+json make_document(size_t target_kb) {
+    json doc = {{"hostname", "switch-1"}, {"ports", json::array()}};
+    size_t i = 0;
+    while (doc.dump().size() < target_kb * 1024) {
+        for (size_t batch = 0; batch < 64; ++batch, ++i) {
+            doc["ports"].push_back({
+                {"name", "Ethernet" + std::to_string(i)},
+                {"admin_status", i % 50 == 0 ? "up" : "down"},
+                {"mtu", 9100},
+                {"alias", "etp" + std::to_string(i)},
+                {"counters", {{"rx_bytes", i * 1000}, {"tx_bytes", i * 2000}, {"errors", 0}}}
+            });
+        }
+    }
+    return doc;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t doc_kb = argc > 1 ? std::stoul(argv[1]) : 2000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 50;
+
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    try {
+        redisjson::RedisJSONClient client(config);
+        redisjson::JSONQueryEngine queries(client);
+        const std::string key = "bench:server_query";
+        json doc = make_document(doc_kb);
+        size_t doc_bytes = doc.dump().size();
+        client.set_json(key, doc);
+        std::cout << "Document: " << doc_bytes / 1024 << " KB, " << doc["ports"].size() << " ports" << std::endl;
+
+        for (const std::string expression : {"$.ports[?(@.admin_status=='up')].name", "$..errors", "$.ports[-5:].mtu"}) {
+            redisjson::JSONPathPlan plan = queries.compile(expression);
+            size_t matches = 0;
+            size_t reply_bytes = 0;
+            double server_ms = time_ms([&] {
+                std::vector<json> result = queries.query(key, expression);
+                matches = result.size();
+                reply_bytes = json(result).dump().size();
+            }, iterations);
+            double client_ms = time_ms([&] { plan.select(client.get_json(key)); }, iterations);
+
+            std::cout << expression << " (" << matches << " matches)\n" << std::fixed << std::setprecision(2)
+                      << "  in Redis:        " << std::setw(8) << server_ms / iterations << " ms, "
+                      << reply_bytes << " bytes\n"
+                      << "  fetch + local:   " << std::setw(8) << client_ms / iterations << " ms, "
+                      << doc_bytes << " bytes\n";
+        }
+
+        for (const std::string operation : {"sum", "percentile:95"}) {
+            const std::string expression = "$.ports[*].counters.rx_bytes";
+            redisjson::JSONPathPlan plan = queries.compile(expression);
+            size_t reply_bytes = 0;
+            double server_ms = time_ms([&] {
+                reply_bytes = queries.aggregate(key, expression, operation).dump().size();
+            }, iterations);
+            double client_ms = time_ms([&] {
+                redisjson::Aggregation aggregation(operation);
+                plan.visit(client.get_json(key), [&](const json& match) { aggregation.add(match); });
+                aggregation.result();
+            }, iterations);
+
+            std::cout << operation << "(" << expression << ")\n" << std::fixed << std::setprecision(2)
+                      << "  in Redis:        " << std::setw(8) << server_ms / iterations << " ms, "
+                      << reply_bytes << " bytes\n"
+                      << "  fetch + local:   " << std::setw(8) << client_ms / iterations << " ms, "
+                      << doc_bytes << " bytes\n";
+        }
+        client.del_json(key);
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
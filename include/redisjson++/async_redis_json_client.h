@@ -0,0 +1,155 @@
+#pragma once
+
+#include "common_types.h"
+#include "exceptions.h"
+#include <nlohmann/json.hpp>
+#include <hiredis/hiredis.h>
+#include <hiredis/async.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <future>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+/**
+ * Non-blocking counterpart of RedisJSONClient (legacy mode only).
+ *
+ * Runs a single hiredis `redisAsyncContext` on a dedicated event-loop thread (poll based).
+ * Commands are written as soon as they are submitted and replies are matched to their
+ * callbacks in order, so one connection carries any number of outstanding requests
+ * without a thread per request.
+ *
+ * Every operation comes in two forms:
+ *  - a callback form, where the callback runs on the event-loop thread and receives
+ *    either the result or the exception the blocking client would have thrown;
+ *  - a future form built on top of it.
+ * Callbacks must not block (they hold up every other reply on the connection) and
+ * must not throw. The event loop uses poll(2), so this class is POSIX only.
+ *
+ * Document and path semantics match RedisJSONClient: path operations run the same
+ * built-in Lua scripts (EVALSHA, falling back to EVAL if the server lost the script),
+ * so get_path likewise returns the matched value wrapped in a one-element array.
+ * The configured DocumentEncoding and DocumentLayout are honoured the same way.
+ */
+class AsyncRedisJSONClient {
+public:
+    using Callback = std::function<void(json result, std::exception_ptr error)>;
+
+    explicit AsyncRedisJSONClient(const LegacyClientConfig& config);
+    // Fails any requests still outstanding with ConnectionException and stops the loop.
+    ~AsyncRedisJSONClient();
+
+    AsyncRedisJSONClient(const AsyncRedisJSONClient&) = delete;
+    AsyncRedisJSONClient& operator=(const AsyncRedisJSONClient&) = delete;
+
+    // Document operations
+    void get_json(const std::string& key, Callback callback);
+    std::future<json> get_json(const std::string& key);
+    void set_json(const std::string& key, const json& document, const SetOptions& opts, Callback callback);
+    std::future<void> set_json(const std::string& key, const json& document, const SetOptions& opts = {});
+    void del_json(const std::string& key, Callback callback);
+    std::future<void> del_json(const std::string& key);
+
+    // Path operations
+    void get_path(const std::string& key, const std::string& path, Callback callback);
+    std::future<json> get_path(const std::string& key, const std::string& path);
+    void set_path(const std::string& key, const std::string& path, const json& value,
+                  const SetOptions& opts, Callback callback);
+    std::future<void> set_path(const std::string& key, const std::string& path, const json& value,
+                               const SetOptions& opts = {});
+
+    // Array operations
+    void append_path(const std::string& key, const std::string& path, const json& value, Callback callback);
+    std::future<void> append_path(const std::string& key, const std::string& path, const json& value);
+    void pop_path(const std::string& key, const std::string& path, int index, Callback callback);
+    std::future<json> pop_path(const std::string& key, const std::string& path, int index = -1);
+    void array_length(const std::string& key, const std::string& path, Callback callback);
+    std::future<size_t> array_length(const std::string& key, const std::string& path);
+
+    // Runs a built-in script (see LuaScriptManager) or one added with register_script.
+    void execute_script(const std::string& name, const std::vector<std::string>& keys,
+                        const std::vector<std::string>& args, Callback callback);
+    std::future<json> execute_script(const std::string& name, const std::vector<std::string>& keys,
+                                     const std::vector<std::string>& args);
+    void register_script(const std::string& name, const std::string& body);
+
+    // Sends an arbitrary command; the reply is converted like a script reply.
+    void command(std::vector<std::string> argv, Callback callback);
+
+    bool is_connected() const { return connected_; }
+    // Requests submitted but not yet answered.
+    size_t pending_requests() const { return pending_count_; }
+
+private:
+    struct Script {
+        std::string name;
+        std::string body;
+        std::string sha;
+    };
+    struct PendingRequest;
+    using ReplyHandler = std::function<void(redisReply* reply)>;
+
+    LegacyClientConfig config_;
+
+    // Loop-thread state: only touched from the event-loop thread.
+    redisAsyncContext* context_ = nullptr;
+    bool want_read_ = false;
+    bool want_write_ = false;
+    std::chrono::steady_clock::time_point timer_deadline_{};
+    bool timer_armed_ = false;
+    std::chrono::steady_clock::time_point next_connect_attempt_{};
+
+    // Cross-thread state.
+    std::thread loop_thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> connected_{false};
+    std::atomic<size_t> pending_count_{0};
+    int wakeup_fds_[2] = {-1, -1};
+    std::mutex tasks_mutex_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex scripts_mutex_;
+    std::unordered_map<std::string, Script> scripts_;
+
+    void run_loop();
+    void post(std::function<void()> task);
+    // Fails `callback` with `error` on the event-loop thread, like every other outcome.
+    void fail(Callback callback, std::exception_ptr error);
+    void connect_if_needed();
+    // Frees the connection (if any), failing its outstanding callbacks.
+    void drop_connection();
+    void send(std::vector<std::string> argv, ReplyHandler handler);
+    void send_script(const Script& script, std::vector<std::string> keys,
+                     std::vector<std::string> args, Callback callback);
+    Script find_script(const std::string& name);
+
+    bool hash_layout() const { return config_.document_layout == DocumentLayout::HASH; }
+    // As in RedisJSONClient: {path, rest...}, or {member, path within the member, rest...}
+    // in the hash layout, where the document root cannot be addressed by a script.
+    std::vector<std::string> script_args(const std::string& path, std::vector<std::string> rest = {}) const;
+    // Runs a built-in path script; an invalid path fails the callback without a request.
+    void execute_path_script(const std::string& name, const std::string& key, const std::string& path,
+                             std::vector<std::string> rest, Callback callback);
+
+    static void on_reply(redisAsyncContext* context, void* reply, void* privdata);
+    static void on_connect(const redisAsyncContext* context, int status);
+    static void on_disconnect(const redisAsyncContext* context, int status);
+    static void ev_add_read(void* privdata);
+    static void ev_del_read(void* privdata);
+    static void ev_add_write(void* privdata);
+    static void ev_del_write(void* privdata);
+    static void ev_cleanup(void* privdata);
+    static void ev_schedule_timer(void* privdata, struct timeval tv);
+};
+
+} // namespace redisjson
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "common_types.h"
+#include "hiredis_RAII.h"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+enum class BulkFormat {
+    AUTO,      // JSON_ARRAY if the input starts with '[', NDJSON otherwise
+    NDJSON,    // One JSON record per line; blank lines are ignored
+    JSON_ARRAY // A single JSON array of records, read element by element
+};
+
+struct BulkLoadProgress {
+    size_t records_read = 0;
+    size_t documents_written = 0;
+    size_t skipped = 0; // Not written because of SetOptions::condition (NX/XX)
+    size_t errors = 0;  // Records that could not be parsed, keyed or written
+    size_t bytes_read = 0;
+    std::chrono::milliseconds elapsed{0};
+
+    double documents_per_second() const {
+        return elapsed.count() > 0 ? documents_written * 1000.0 / elapsed.count() : 0.0;
+    }
+};
+
+struct BulkLoadResult : BulkLoadProgress {
+    // The first BulkLoadOptions::max_error_messages errors, with their record numbers.
+    std::vector<std::string> error_messages;
+};
+
+struct BulkLoadOptions {
+    BulkFormat format = BulkFormat::AUTO;
+    // Each document's key is key_prefix followed by the record's key_field member (a
+    // string or an integer). The document is the record's value_field member if
+    // value_field is set ({"key": ..., "value": {...}}), otherwise the whole record.
+    std::string key_field = "id";
+    std::string key_prefix;
+    std::string value_field;
+    SetOptions set_options;
+    // Worker threads. Each parses a batch of records and writes it as one pipeline, so
+    // up to `threads` batches are in flight at once; at most connection_pool_size of them
+    // get a connection at a time.
+    size_t threads = 4;
+    size_t batch_size = 500;
+    // Batches read ahead of the workers. Bounds the memory used when the input is read
+    // faster than Redis accepts the writes.
+    size_t max_queued_batches = 16;
+    // Called from the loading thread every progress_interval, and once at the end.
+    std::function<void(const BulkLoadProgress&)> progress;
+    std::chrono::milliseconds progress_interval{1000};
+    size_t max_error_messages = 10;
+};
+
+/**
+ * Splits an NDJSON or JSON-array stream into the text of its records, without parsing
+ * them and without holding more than one record in memory.
+ */
+class BulkRecordReader {
+public:
+    BulkRecordReader(std::istream& input, BulkFormat format = BulkFormat::AUTO);
+
+    // The next record, or false at the end of the input.
+    // @throws JsonParsingException if a JSON array is malformed or unterminated
+    bool next(std::string& record);
+    // The detected format once the first record has been read.
+    BulkFormat format() const { return format_; }
+    size_t bytes_read() const { return bytes_read_; }
+
+private:
+    std::istream& input_;
+    BulkFormat format_;
+    size_t bytes_read_ = 0;
+    bool array_started_ = false;
+    bool array_finished_ = false;
+    bool after_element_ = false;
+
+    int read_char();
+    int skip_whitespace();
+};
+
+/**
+ * Loads a stream of JSON records into Redis: the calling thread splits the input into
+ * batches, worker threads parse them, build one write command per document and send
+ * each batch as a pipeline. Failures of single records are counted and loading goes on;
+ * a failure of the connection stops it.
+ */
+class BulkLoader {
+public:
+    // The write command for one document, e.g. {"SET", key, value}.
+    using CommandBuilder = std::function<std::vector<std::string>(const std::string& key, const json& document)>;
+    // Sends a batch of commands and returns their replies in order (as
+    // RedisConnectionManager::execute_pipeline does).
+    using PipelineExecutor = std::function<std::vector<RedisReplyPtr>(const std::vector<std::vector<std::string>>& commands)>;
+
+    BulkLoader(PipelineExecutor executor, CommandBuilder builder, BulkLoadOptions options = {});
+
+    // @throws JsonParsingException for a malformed JSON array, the executor's exceptions
+    //         (ConnectionException, ...) if a batch could not be sent
+    BulkLoadResult load(std::istream& input);
+
+    // The key and document of a record.
+    // @throws JsonParsingException, ArgumentInvalidException if the key or value is missing
+    static std::pair<std::string, json> parse_record(const std::string& text, const BulkLoadOptions& options);
+
+private:
+    PipelineExecutor executor_;
+    CommandBuilder builder_;
+    BulkLoadOptions options_;
+};
+
+} // namespace redisjson
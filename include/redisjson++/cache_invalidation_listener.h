@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common_types.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+namespace redisjson {
+
+class RedisConnection;
+
+/**
+ * Keeps a client-side cache coherent with Redis using CLIENT TRACKING (Redis 6+).
+ *
+ * A background thread holds two connections: a subscriber on `__redis__:invalidate`,
+ * and a control connection on which broadcast tracking is enabled with its
+ * invalidations redirected to the subscriber:
+ *
+ *     CLIENT TRACKING on REDIRECT <subscriber id> BCAST [PREFIX p ...]
+ *
+ * Broadcast mode reports writes to any key under the prefixes, whichever connection
+ * read it, so it works with pooled connections. This only needs RESP2.
+ *
+ * `on_invalidate` runs on the listener thread with the written keys, or with an empty
+ * vector when every entry must be dropped (FLUSHALL/FLUSHDB, or subscription lost or
+ * (re)established, since invalidations may have been missed). Callers should only serve
+ * cached values while is_subscribed() is true. The listener reconnects on its own.
+ */
+class CacheInvalidationListener {
+public:
+    using InvalidateCallback = std::function<void(const std::vector<std::string>& keys)>;
+
+    static constexpr const char* INVALIDATION_CHANNEL = "__redis__:invalidate";
+
+    CacheInvalidationListener(const LegacyClientConfig& config, std::vector<std::string> prefixes,
+                              InvalidateCallback on_invalidate);
+    ~CacheInvalidationListener();
+
+    CacheInvalidationListener(const CacheInvalidationListener&) = delete;
+    CacheInvalidationListener& operator=(const CacheInvalidationListener&) = delete;
+
+    bool is_subscribed() const { return subscribed_; }
+
+    // Waits up to `timeout` for the subscription to be established.
+    bool wait_until_subscribed(std::chrono::milliseconds timeout);
+
+private:
+    LegacyClientConfig config_;
+    std::vector<std::string> prefixes_;
+    InvalidateCallback on_invalidate_;
+
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> subscribed_{false};
+    std::mutex mutex_;
+    std::condition_variable state_changed_;
+
+    void run();
+    bool subscribe(RedisConnection& subscriber, RedisConnection& control);
+    // Reads invalidation messages until either connection fails or the listener stops.
+    void listen(RedisConnection& subscriber, RedisConnection& control);
+    void set_subscribed(bool subscribed);
+};
+
+} // namespace redisjson
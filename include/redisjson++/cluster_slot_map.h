@@ -0,0 +1,62 @@
+#pragma once
+
+#include <hiredis/hiredis.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace redisjson {
+
+// Number of hash slots in a Redis Cluster.
+constexpr uint16_t CLUSTER_SLOT_COUNT = 16384;
+
+// CRC16-CCITT (XMODEM), as used by Redis Cluster.
+uint16_t crc16(const char* data, size_t length);
+
+// The hash slot of `key`. If the key contains a non-empty hash tag ("{...}"), only the
+// tag is hashed, so "{user1}.profile" and "{user1}.settings" share a slot.
+uint16_t key_hash_slot(const std::string& key);
+
+// A MOVED or ASK error reply: the slot is (or, for ASK, is being moved) elsewhere.
+struct ClusterRedirect {
+    bool ask = false; // ASK: retry once on `address` after ASKING; MOVED: the slot moved for good
+    uint16_t slot = 0;
+    std::string address; // "host:port"
+};
+
+// Returns the redirection described by an error reply, or nullopt for any other reply.
+std::optional<ClusterRedirect> parse_cluster_redirect(const redisReply* reply);
+
+// Splits "host:port" (the port follows the last ':', so IPv6 hosts work).
+// @throws std::invalid_argument if there is no port.
+std::pair<std::string, int> split_node_address(const std::string& address);
+
+/**
+ * Thread-safe map from hash slot to the address ("host:port") of the primary serving it.
+ */
+class ClusterSlotMap {
+public:
+    // Replaces the map with the primaries listed in a CLUSTER SLOTS reply. Nodes reported
+    // with an empty host are reachable at `queried_host`, the host the reply came from.
+    // Returns false, leaving the map unchanged, if the reply is not a CLUSTER SLOTS reply.
+    bool update_from_cluster_slots(const redisReply* reply, const std::string& queried_host);
+
+    // Records a MOVED redirection for one slot.
+    void set_slot_owner(uint16_t slot, const std::string& address);
+
+    // Empty if no node is known to serve the slot.
+    std::string node_for_slot(uint16_t slot) const;
+    // Distinct primary addresses, in slot order.
+    std::vector<std::string> nodes() const;
+    bool empty() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::vector<std::string> addresses_;                   // Distinct node addresses
+    std::array<int16_t, CLUSTER_SLOT_COUNT> owners_ = {}; // Index into addresses_ + 1, 0 if unknown
+};
+
+} // namespace redisjson
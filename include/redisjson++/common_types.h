@@ -14,6 +14,37 @@ enum class SetCmdCondition {
     XX    // Set only if key already exists
 };
 
+// How documents are serialized in the Redis string value (legacy mode).
+// JSON is readable with redis-cli and by other clients. MESSAGEPACK is smaller and is
+// decoded/encoded by the Lua scripts with cmsgpack instead of cjson, which is cheaper for
+// large documents. Both sides of a deployment must agree: keys written in one encoding
+// cannot be read in the other.
+// Documents with null members or empty objects or arrays, which cmsgpack would change,
+// are decoded and encoded by a slower Lua codec in the scripts instead.
+enum class DocumentEncoding {
+    JSON,
+    MESSAGEPACK
+};
+
+// How a document is laid out in Redis (legacy mode).
+// STRING stores the whole document in one string value. HASH stores each top-level
+// member of the (object) document in its own field of a Redis hash, the way SWSS tables
+// are laid out: path operations then read and rewrite a single field instead of the
+// whole document, and reading or writing a top-level member is a plain HGET/HSET.
+// In the HASH layout the document root must be an object, an empty object is not
+// stored (the key does not exist), and paths must start with a member name.
+enum class DocumentLayout {
+    STRING,
+    HASH
+};
+
+// Where read-only operations go when LegacyClientConfig::replica_nodes lists replicas.
+enum class ReadPolicy {
+    PRIMARY,        // Every read goes to the primary; the replicas are not used
+    PREFER_REPLICA, // Reads rotate over the healthy replicas, and go to the primary only when none is
+    NEAREST         // Reads go to the healthy server, primary included, with the lowest ping round trip
+};
+
 // Configuration for the Redis client when using direct Redis connection
 struct LegacyClientConfig {
     std::string host = "127.0.0.1";
@@ -29,10 +60,63 @@ struct LegacyClientConfig {
     std::chrono::seconds connection_max_idle_time = std::chrono::seconds(300); // Max time a connection can be idle before being potentially closed
     bool enable_tcp_keepalives = true;
     std::uint16_t tcp_keepalive_time_sec = 60; // Time in seconds for TCP keepalive
+    // Multiplexed mode: when > 0, this many shared connections carry single commands from
+    // all threads, pipelined (see MultiplexedConnection); 2-4 are usually enough for
+    // hundreds of threads. The pool above is still used for transactions and batches.
+    int multiplexed_connections = 0;
+
+    // Redis Cluster: host/port and cluster_seed_nodes ("host:port") are only used to
+    // discover the primaries (CLUSTER SLOTS). Each primary then gets its own pool of
+    // connection_pool_size connections (and multiplexed connections, if enabled), and every
+    // command is sent to the node serving its key's hash slot.
+    bool cluster_mode = false;
+    std::vector<std::string> cluster_seed_nodes;
+
+    // Replica reads (standalone mode): read-only operations (get_json, get_path, the exists,
+    // type, length and key queries, and the read-only scripts) are sent to the primary or to
+    // one of these replicas ("host:port"), as read_policy decides. Each replica gets its own
+    // pool. Scripts run there with EVALSHA_RO (EVALSHA before Redis 7), and a read a replica
+    // cannot serve (down, loading, script missing) is retried on the primary.
+    // Replication is asynchronous: unless replica_write_acks is set, a read right after a
+    // write may not see it.
+    std::vector<std::string> replica_nodes;
+    ReadPolicy read_policy = ReadPolicy::PRIMARY;
+    // Read-your-writes guard: when > 0, each write (or batch of writes) is followed by WAIT
+    // for this many replicas, for at most replica_wait_timeout (0 waits indefinitely). If
+    // fewer acknowledge in time, all reads go to the primary for the next second.
+    int replica_write_acks = 0;
+    std::chrono::milliseconds replica_wait_timeout = std::chrono::milliseconds(50);
 
     // Retry strategy (basic example)
     int max_retries = 3;
     std::chrono::milliseconds retry_backoff_start = std::chrono::milliseconds(100);
+
+    // Storage format and layout of documents (see DocumentEncoding, DocumentLayout)
+    DocumentEncoding document_encoding = DocumentEncoding::JSON;
+    DocumentLayout document_layout = DocumentLayout::STRING;
+
+    // Client-side cache for get_json/get_path (RedisJSONClient, legacy mode). Entries are
+    // evicted when any client writes the key, using Redis 6 CLIENT TRACKING in broadcast
+    // mode on a dedicated connection; while that connection is down nothing is cached.
+    bool enable_client_cache = false;
+    size_t client_cache_max_entries = 10000;
+    size_t client_cache_max_bytes = 64 * 1024 * 1024; // Estimated memory budget (0: entries only)
+    bool client_cache_admission_filter = false; // TinyLFU: keep hot entries over one-off reads
+    std::chrono::seconds client_cache_ttl = std::chrono::seconds(0); // 0: until invalidated or evicted
+    // With a TTL: how long after expiring an entry is still served while one background
+    // read refreshes it (0: expired entries are read again right away).
+    std::chrono::seconds client_cache_stale_while_revalidate = std::chrono::seconds(0);
+    // Only keys starting with one of these prefixes are cached and tracked (all keys if empty).
+    // Broadcast tracking reports every write under the prefixes, so keep them narrow.
+    std::vector<std::string> client_cache_prefixes;
+
+    // Delta writes (string layout): set_json remembers the last version it wrote of up to
+    // this many documents (0: disabled), within delta_write_max_bytes. When one of them is
+    // written again, only the JSON Patch (RFC 6902) from that version is sent, and a script
+    // applies it if the stored value is still that version (SHA1 check); otherwise, or when
+    // the patch is not much smaller than the document, the whole document is written.
+    size_t delta_write_max_entries = 0;
+    size_t delta_write_max_bytes = 64 * 1024 * 1024;
 };
 
 // Configuration for the RedisJSONClient when used with SONiC SWSS
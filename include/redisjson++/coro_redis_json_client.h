@@ -0,0 +1,373 @@
+#pragma once
+
+// C++20 coroutine facade over AsyncRedisJSONClient.
+//
+// The library itself is built as C++17; this header is header-only and only defines
+// anything when the including translation unit is compiled with coroutine support
+// (REDISJSON_HAS_COROUTINES is then set). Nothing here is compiled into the library.
+
+#include "async_redis_json_client.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define REDISJSON_HAS_COROUTINES 1
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace redisjson {
+
+/**
+ * Awaitable for one AsyncRedisJSONClient request.
+ *
+ * The request is submitted when the awaiting coroutine suspends, and the coroutine is
+ * resumed on the client's event-loop thread once the reply arrives. `co_await` yields
+ * the converted result or rethrows the exception the blocking client would have thrown.
+ */
+template <typename T>
+class AsyncResult {
+public:
+    using Starter = std::function<void(AsyncRedisJSONClient::Callback)>;
+
+    explicit AsyncResult(Starter starter) : starter_(std::move(starter)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        // The callback may resume (and so destroy) the coroutine frame holding *this
+        // before the starter returns; keep the starter alive on the stack.
+        Starter starter = std::move(starter_);
+        starter([this, handle](json result, std::exception_ptr error) {
+            result_ = std::move(result);
+            error_ = error;
+            handle.resume();
+        });
+    }
+
+    T await_resume() {
+        if (error_) std::rethrow_exception(error_);
+        if constexpr (std::is_void_v<T>) {
+            return;
+        } else if constexpr (std::is_same_v<T, json>) {
+            return std::move(result_);
+        } else {
+            return result_.template get<T>();
+        }
+    }
+
+private:
+    Starter starter_;
+    json result_;
+    std::exception_ptr error_;
+};
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+// Hands control to the awaiting coroutine when a Task finishes.
+struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        std::coroutine_handle<> next = handle.promise().continuation;
+        return next ? next : std::noop_coroutine();
+    }
+    void await_resume() noexcept {}
+};
+
+template <typename T>
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase<T> {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T result) { value = std::move(result); }
+
+    T take() {
+        if (this->error) std::rethrow_exception(this->error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase<void> {
+    Task<void> get_return_object();
+    void return_void() {}
+
+    void take() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+// Eagerly started, self-destroying coroutine used to drive a Task from sync_wait.
+struct DetachedCoroutine {
+    struct promise_type {
+        DetachedCoroutine get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+/**
+ * Lazily started coroutine returning T. A Task runs when it is first awaited, and
+ * resumes its awaiter directly when it finishes (symmetric transfer).
+ * Move-only; destroying an unfinished Task destroys its frame.
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit Task(handle_type handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().take(); }
+
+    // Awaits completion without consuming the result (used by when_all).
+    auto when_ready() noexcept {
+        struct ReadyAwaiter {
+            handle_type handle;
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            void await_resume() const noexcept {}
+        };
+        return ReadyAwaiter{handle_};
+    }
+
+private:
+    handle_type handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Starts every task at once and resumes the awaiter when the last one finishes.
+template <typename T>
+class WhenAllAwaitable {
+public:
+    explicit WhenAllAwaitable(std::vector<Task<T>>& tasks) : tasks_(tasks) {}
+
+    bool await_ready() const noexcept { return tasks_.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        continuation_ = awaiting;
+        remaining_.store(tasks_.size() + 1);
+        for (auto& task : tasks_) {
+            run(task);
+        }
+        // Tasks that finished synchronously may have completed the whole set already.
+        return remaining_.fetch_sub(1) != 1;
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    std::vector<Task<T>>& tasks_;
+    std::atomic<size_t> remaining_{0};
+    std::coroutine_handle<> continuation_;
+
+    DetachedCoroutine run(Task<T>& task) {
+        co_await task.when_ready();
+        if (remaining_.fetch_sub(1) == 1) {
+            continuation_.resume();
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * Runs all `tasks` concurrently and returns their results in order. Requests issued by
+ * the tasks are all in flight at once, so the total latency is roughly that of the
+ * slowest task rather than the sum. The first failed task's exception is rethrown.
+ */
+template <typename T>
+Task<std::vector<T>> when_all(std::vector<Task<T>> tasks) {
+    co_await detail::WhenAllAwaitable<T>(tasks);
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (auto& task : tasks) {
+        results.push_back(co_await task);
+    }
+    co_return results;
+}
+
+inline Task<void> when_all(std::vector<Task<void>> tasks) {
+    co_await detail::WhenAllAwaitable<void>(tasks);
+    for (auto& task : tasks) {
+        co_await task;
+    }
+}
+
+namespace detail {
+
+template <typename T>
+DetachedCoroutine drive(Task<T>& task, std::promise<T>& done) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+            done.set_value();
+        } else {
+            done.set_value(co_await task);
+        }
+    } catch (...) {
+        done.set_exception(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+/**
+ * Runs `task` to completion and blocks the calling thread until it finishes.
+ * Must not be called from the client's event-loop thread (it would never resume).
+ */
+template <typename T>
+T sync_wait(Task<T> task) {
+    std::promise<T> done;
+    std::future<T> result = done.get_future();
+    detail::drive(task, done);
+    return result.get();
+}
+
+/**
+ * Awaitable versions of the document, path and array operations.
+ *
+ * Thin wrapper around an AsyncRedisJSONClient, which must outlive it. Requests share
+ * the client's single connection, so a handler can keep several operations in flight
+ * (see when_all) without blocking a thread per request:
+ *
+ *     Task<json> load(CoroRedisJSONClient& client) {
+ *         json name = co_await client.get_path_async("user:1", "name");
+ *         co_await client.set_path_async("user:1", "seen", true);
+ *         co_return name;
+ *     }
+ *
+ * After a `co_await` the coroutine continues on the event-loop thread, so the same
+ * rules as for AsyncRedisJSONClient callbacks apply: do not block there.
+ */
+class CoroRedisJSONClient {
+public:
+    explicit CoroRedisJSONClient(AsyncRedisJSONClient& client) : client_(client) {}
+
+    AsyncRedisJSONClient& async_client() { return client_; }
+
+    // Document operations
+    AsyncResult<json> get_json_async(const std::string& key) {
+        return start<json>([this, key](AsyncRedisJSONClient::Callback cb) {
+            client_.get_json(key, std::move(cb));
+        });
+    }
+    AsyncResult<void> set_json_async(const std::string& key, const json& document, const SetOptions& opts = {}) {
+        return start<void>([this, key, document, opts](AsyncRedisJSONClient::Callback cb) {
+            client_.set_json(key, document, opts, std::move(cb));
+        });
+    }
+    AsyncResult<void> del_json_async(const std::string& key) {
+        return start<void>([this, key](AsyncRedisJSONClient::Callback cb) {
+            client_.del_json(key, std::move(cb));
+        });
+    }
+
+    // Path operations
+    AsyncResult<json> get_path_async(const std::string& key, const std::string& path) {
+        return start<json>([this, key, path](AsyncRedisJSONClient::Callback cb) {
+            client_.get_path(key, path, std::move(cb));
+        });
+    }
+    AsyncResult<void> set_path_async(const std::string& key, const std::string& path, const json& value,
+                                     const SetOptions& opts = {}) {
+        return start<void>([this, key, path, value, opts](AsyncRedisJSONClient::Callback cb) {
+            client_.set_path(key, path, value, opts, std::move(cb));
+        });
+    }
+
+    // Array operations
+    AsyncResult<void> append_path_async(const std::string& key, const std::string& path, const json& value) {
+        return start<void>([this, key, path, value](AsyncRedisJSONClient::Callback cb) {
+            client_.append_path(key, path, value, std::move(cb));
+        });
+    }
+    AsyncResult<json> pop_path_async(const std::string& key, const std::string& path, int index = -1) {
+        return start<json>([this, key, path, index](AsyncRedisJSONClient::Callback cb) {
+            client_.pop_path(key, path, index, std::move(cb));
+        });
+    }
+    AsyncResult<size_t> array_length_async(const std::string& key, const std::string& path) {
+        return start<size_t>([this, key, path](AsyncRedisJSONClient::Callback cb) {
+            client_.array_length(key, path, std::move(cb));
+        });
+    }
+
+    // Scripts
+    AsyncResult<json> execute_script_async(const std::string& name, const std::vector<std::string>& keys,
+                                           const std::vector<std::string>& args) {
+        return start<json>([this, name, keys, args](AsyncRedisJSONClient::Callback cb) {
+            client_.execute_script(name, keys, args, std::move(cb));
+        });
+    }
+
+private:
+    AsyncRedisJSONClient& client_;
+
+    template <typename T, typename Fn>
+    static AsyncResult<T> start(Fn&& fn) {
+        return AsyncResult<T>(typename AsyncResult<T>::Starter(std::forward<Fn>(fn)));
+    }
+};
+
+} // namespace redisjson
+
+#endif // __cpp_impl_coroutine
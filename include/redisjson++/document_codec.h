@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common_types.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+// Serializes a document into the Redis string value for the given encoding.
+std::string encode_document(const json& document, DocumentEncoding encoding);
+
+// Parses a Redis string value written with the given encoding.
+// @throws JsonParsingException if the value is not a valid document; context_msg
+//         (e.g. "GET for key 'k'") prefixes the message.
+json decode_document(const std::string& data, DocumentEncoding encoding, const std::string& context_msg);
+
+// Encodes each member of an object as a (field, value) pair for the hash layout (see
+// DocumentLayout), flattened as field1, value1, field2, value2, ... for HSET.
+// @throws ArgumentInvalidException if `object` is not a JSON object.
+std::vector<std::string> encode_document_fields(const json& object, DocumentEncoding encoding);
+
+// Whether the built-in scripts, which decode documents into Lua tables and encode them
+// again, store `document` unchanged in the given encoding. They do not for empty arrays
+// and objects (Lua cannot tell them apart in script arguments), integers beyond 1e14
+// (JSON: cjson keeps 14 significant digits; MessagePack: 2^53) and, in JSON, floating
+// point numbers that need more than 14 significant digits.
+bool scripts_preserve_document(const json& document, DocumentEncoding encoding);
+
+} // namespace redisjson
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+/**
+ * An aggregation over the values a JSONPath matches, in one document or many. The
+ * json_aggregate Lua script computes it inside Redis: it returns either the final result
+ * (a single document, see set_result) or a partial result per batch of keys, which
+ * merge() combines. add() aggregates values on the client, for the cases where the query
+ * is evaluated there.
+ *
+ * Operations: "count" (all matches), "sum", "avg", "min" and "max" (numeric matches
+ * only), "distinct_count" (matches with distinct values; objects and arrays are compared
+ * by their encoding) and "percentile:<0-100>" (numeric matches, linear interpolation
+ * between the closest ranks; "percentile" alone is the median). With no numeric matches,
+ * sum is 0 and the others are null.
+ */
+class Aggregation {
+public:
+    enum class Operation { COUNT, SUM, AVG, MIN, MAX, DISTINCT_COUNT, PERCENTILE };
+
+    // @throws ArgumentInvalidException for an unknown operation or percentile rank.
+    explicit Aggregation(const std::string& operation);
+
+    Operation operation() const { return operation_; }
+    double percentile_rank() const { return percentile_rank_; }
+    // Arguments of the json_aggregate script after the plan.
+    std::vector<std::string> script_arguments(bool partial) const;
+
+    // Adds one matched value.
+    void add(const json& value);
+    // Adds a partial result of the json_aggregate script.
+    // @throws LuaScriptException if it is not a partial result.
+    void merge(const json& partial);
+    // Records the final result computed by the json_aggregate script; result() then
+    // returns it.
+    void set_result(const json& result);
+
+    json result() const;
+
+private:
+    Operation operation_;
+    double percentile_rank_ = 50;
+    size_t count_ = 0;
+    size_t numeric_count_ = 0;
+    double sum_ = 0;
+    std::optional<double> min_, max_;
+    std::set<std::string> distinct_;  // Serialized values
+    std::vector<double> numbers_;     // For PERCENTILE
+    std::optional<json> final_result_;
+
+    void add_number(double value);
+};
+
+} // namespace redisjson
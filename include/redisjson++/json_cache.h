@@ -4,55 +4,172 @@
 #include <string>
 #include <chrono>
 #include <nlohmann/json.hpp>
-#include <unordered_map>
-#include <list>
+#include <memory>
+#include <vector>
+#include <optional>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
 
 namespace redisjson {
 
 using json = nlohmann::json;
 
+// An immutable document (or a value inside one) that can be shared without copying.
+using SharedDocument = std::shared_ptr<const json>;
+
+// Returns a view of the value at `path` inside `document`: it points into the document
+// and keeps the whole document alive, so nothing is copied.
+// @throws PathNotFoundException (and the other JSONModifier::get errors) if the path
+// does not resolve.
+SharedDocument view_at(const SharedDocument& document, const std::string& path);
+
 struct CacheStats {
     size_t hits = 0;
     size_t misses = 0;
     size_t current_size = 0;
     size_t max_size = 0;
+    size_t current_bytes = 0; // Estimated footprint of the cached entries
+    size_t max_bytes = 0;     // 0: no byte budget
+    size_t rejected = 0;      // Entries turned away by the admission filter
+    size_t stale_hits = 0;    // Expired values served by get_or_load while being refreshed
+    size_t coalesced = 0;     // get_or_load misses that waited for another caller's load
 };
 
+/**
+ * Thread-safe LRU cache of JSON values.
+ *
+ * Keys are spread over independently locked shards (16 for caches of 1024 entries or
+ * more, fewer for small caches), so concurrent readers of different keys rarely contend.
+ * Each shard gets an equal part of the entry and byte budgets and evicts its least
+ * recently used entries on its own. A key's path entries live in the key's shard.
+ *
+ * The byte budget counts estimate_size() of each value plus its key. A value larger than
+ * a shard's part of the budget is not cached.
+ *
+ * With the admission filter (TinyLFU) enabled, a new entry that would evict another one
+ * is only cached if its key was accessed more often, recently, than the entry it would
+ * replace. Access counts are kept approximately in a small count-min sketch per shard.
+ * This keeps one-off reads (e.g. a scan over many keys) from flushing hot entries.
+ *
+ * Values are stored as SharedDocument. get() and get_path() return copies; the *_shared
+ * and get_view() variants hand out the stored document itself, which costs a reference
+ * count instead of a deep copy. A document handed out stays valid, and unchanged, after
+ * it is evicted or invalidated (it is no longer counted in the byte budget then).
+ *
+ * get_or_load()/get_path_or_load() read through a loader with single-flight coalescing:
+ * concurrent misses of the same entry wait for one load instead of each reading Redis.
+ * With a stale-while-revalidate window, an entry that expired less than `window` ago is
+ * still returned by them while a background thread reloads it.
+ */
 class JSONCache {
 public:
-    explicit JSONCache(size_t max_size = 1000, std::chrono::seconds default_ttl = std::chrono::seconds(300));
+    explicit JSONCache(size_t max_size = 1000, std::chrono::seconds default_ttl = std::chrono::seconds(300),
+                       size_t max_bytes = 0);
+    ~JSONCache();
+
+    JSONCache(const JSONCache&) = delete;
+    JSONCache& operator=(const JSONCache&) = delete;
 
     void enable_caching(bool enabled);
     bool is_caching_enabled() const;
 
     void set_cache_size(size_t max_size);
+    void set_max_bytes(size_t max_bytes); // 0: no byte budget
     void set_ttl(std::chrono::seconds ttl);
+    void set_admission_filter(bool enabled);
+    // How long after its TTL an entry may still be served by get_or_load while it is
+    // refreshed in the background (0, the default: expired entries are misses).
+    void set_stale_while_revalidate(std::chrono::seconds window);
 
     void put(const std::string& key, const json& value, std::chrono::seconds ttl = std::chrono::seconds(0));
     std::optional<json> get(const std::string& key);
 
+    // Values read at a path of a key's document. They are evicted together with the key.
+    void put_path(const std::string& key, const std::string& path, const json& value);
+    std::optional<json> get_path(const std::string& key, const std::string& path);
+
+    // Zero-copy variants. The getters return nullptr on a miss.
+    void put_shared(const std::string& key, SharedDocument value, std::chrono::seconds ttl = std::chrono::seconds(0));
+    SharedDocument get_shared(const std::string& key);
+    SharedDocument get_path_shared(const std::string& key, const std::string& path);
+    // A view_at() of the cached document of `key`, or nullptr if the document is not cached.
+    // @throws PathNotFoundException if the document is cached but has no value at `path`.
+    SharedDocument get_view(const std::string& key, const std::string& path);
+
+    // Read-through fills race with invalidations: take a token before reading the value
+    // from Redis and store it with fill()/fill_path(). The value is dropped (and false
+    // returned) if `key` was invalidated, or the cache cleared, after the token was taken.
+    using FillToken = std::uint64_t;
+    FillToken fill_token(const std::string& key) const;
+    bool fill(const std::string& key, const json& value, FillToken token);
+    bool fill_path(const std::string& key, const std::string& path, const json& value, FillToken token);
+    bool fill_shared(const std::string& key, SharedDocument value, FillToken token);
+
+    // Returns the cached value, or calls `loader` and caches its result (unless the key
+    // was invalidated meanwhile). Concurrent callers missing the same entry share one
+    // loader call, and get its exception if it throws; a null result is returned but not
+    // cached. Expired entries within the stale-while-revalidate window are returned as
+    // they are and reloaded on a background thread, so `loader` must stay callable after
+    // this returns (capture by value). Invalidating a key detaches loads already running
+    // for it: later callers start a new one and never see a value read before the write.
+    using Loader = std::function<SharedDocument()>;
+    SharedDocument get_or_load(const std::string& key, const Loader& loader);
+    SharedDocument get_path_or_load(const std::string& key, const std::string& path, const Loader& loader);
+
+    // Removes the key's document and every path value cached for it.
     void invalidate(const std::string& key);
     void clear_cache();
 
     CacheStats get_stats() const;
 
+    // Estimated heap footprint of a value in bytes (nlohmann::json nodes, strings,
+    // container storage). Used for the byte budget.
+    static size_t estimate_size(const json& value);
+
 private:
-    struct CacheEntry {
-        json value;
-        std::chrono::time_point<std::chrono::steady_clock> expiry_time;
-        std::list<std::string>::iterator lru_iterator;
-    };
+    struct CacheEntry;
+    struct Shard;
+    struct Flight; // A load in progress
+
+    Shard& _shard_for(const std::string& key) const;
+    // `value_bytes` is estimate_size(*value), computed before taking the shard's lock.
+    void _put_locked(Shard& shard, const std::string& entry_key, const std::string& owner_key, SharedDocument value,
+                     size_t value_bytes, std::chrono::seconds ttl_override);
+    SharedDocument _get_locked(Shard& shard, const std::string& entry_key);
+    FillToken _fill_token_locked(const Shard& shard, const std::string& key) const;
+    SharedDocument _get_or_load(const std::string& entry_key, const std::string& owner_key, const Loader& loader);
+    // Runs `loader` for a flight this caller leads, caches and publishes the result.
+    SharedDocument _run_flight(Shard& shard, const std::string& entry_key, const std::shared_ptr<Flight>& flight,
+                               const Loader& loader);
+    void _schedule_refresh(std::function<void()> task);
+    void _refresh_loop();
+    void _erase(Shard& shard, CacheEntry& entry);
+    void _clear_locked(Shard& shard);
+    // Evicts least recently used entries until the shard is within its budgets.
+    void _enforce_budgets_locked(Shard& shard);
+    size_t _shard_max_entries() const;
+    size_t _shard_max_bytes() const;
 
-    void _evict();
+    std::vector<std::unique_ptr<Shard>> _shards; // Size is a power of two, fixed at construction
 
-    std::unordered_map<std::string, CacheEntry> _cache;
-    std::list<std::string> _lru_list; // For LRU eviction
-    mutable std::mutex _mutex;
+    std::atomic<size_t> _max_size;
+    std::atomic<size_t> _max_bytes;
+    std::atomic<std::chrono::seconds::rep> _default_ttl;
+    std::atomic<bool> _caching_enabled{true};
+    std::atomic<bool> _admission_filter{false};
+    std::atomic<std::chrono::seconds::rep> _stale_window{0};
 
-    size_t _max_size;
-    std::chrono::seconds _default_ttl;
-    bool _caching_enabled = true;
+    // Background refreshes for stale-while-revalidate, on a thread started on first use
+    std::thread _refresh_thread;
+    std::mutex _refresh_mutex;
+    std::condition_variable _refresh_cv;
+    std::deque<std::function<void()>> _refresh_queue;
+    bool _refresh_stopping = false;
 };
 
 } // namespace redisjson
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+struct DiffOptions {
+    // Members that identify the objects of an array, tried in order. If every element in
+    // the changed part of both arrays is an object with a string or number value for one
+    // of them, distinct on each side, elements are matched by that value: an inserted,
+    // removed or changed element only produces operations for that element.
+    std::vector<std::string> identity_fields = {"id", "name"};
+    // Otherwise identical elements are matched: in O(n log n) if no element repeats on
+    // either side, else by longest common subsequence, which takes time and memory in
+    // proportion to the changed part of the arrays (old elements x new elements). Above
+    // this many cells, such arrays are compared position by position.
+    size_t max_lcs_cells = 1 << 20;
+};
+
+/**
+ * Computes the RFC 6902 JSON Patch between two documents. Both documents are first
+ * annotated with a hash of every subtree (Merkle-style, in one pass each), so identical
+ * subtrees are skipped by comparing two hashes instead of walking them, and array
+ * elements are compared by hash. Changed arrays are trimmed of their common prefix and
+ * suffix, and the rest is aligned by identity field (see DiffOptions) or by longest
+ * common subsequence, so an element inserted into a large array is one "add" rather than
+ * a replacement of every element after it.
+ *
+ * Subtrees with the same hash and node count are taken to be equal. Numbers are hashed
+ * so that values equal under json's operator== (e.g. 1 and 1.0) hash alike.
+ */
+class JSONDiff {
+public:
+    explicit JSONDiff(DiffOptions options = {});
+
+    // The patch turning `old_doc` into `new_doc`; an empty array if they are equal.
+    json diff(const json& old_doc, const json& new_doc) const;
+
+    const DiffOptions& options() const { return options_; }
+
+private:
+    DiffOptions options_;
+};
+
+} // namespace redisjson
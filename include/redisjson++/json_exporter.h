@@ -0,0 +1,73 @@
+#pragma once
+
+#include "common_types.h"
+#include "key_scanner.h"
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+enum class ExportFormat {
+    NDJSON,     // One {"key": ..., "value": ...} object per line
+    MESSAGEPACK // A sequence of MessagePack maps {"key": ..., "value": ...}
+};
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::NDJSON;
+    // SCAN page sizing; the documents are always fetched with their page.
+    ScanOptions scan;
+    size_t max_error_messages = 10;
+};
+
+struct ExportResult {
+    size_t documents = 0;
+    size_t errors = 0; // Documents that could not be read or converted
+    size_t bytes_written = 0;
+    std::chrono::milliseconds elapsed{0};
+    std::vector<std::string> error_messages;
+
+    double documents_per_second() const {
+        return elapsed.count() > 0 ? documents * 1000.0 / elapsed.count() : 0.0;
+    }
+    double megabytes_per_second() const {
+        return elapsed.count() > 0 ? bytes_written / (1024.0 * 1024.0) * 1000.0 / elapsed.count() : 0.0;
+    }
+};
+
+/**
+ * Writes export records to a stream. A stored value that is already in the output
+ * format (JSON text for NDJSON, MessagePack for MESSAGEPACK) is copied byte for byte
+ * without being parsed; others are decoded and re-encoded.
+ *
+ * NDJSON exports load back with bulk_load, with key_field "key" and value_field "value".
+ */
+class ExportWriter {
+public:
+    // `stored_encoding`: the encoding of the values passed to write_stored().
+    ExportWriter(std::ostream& output, ExportFormat format, DocumentEncoding stored_encoding);
+
+    // @throws JsonParsingException if the value must be converted and is not a valid
+    //         document, RedisJSONException if the key cannot be written as JSON
+    void write_stored(const std::string& key, const std::string& stored_value);
+    void write_document(const std::string& key, const json& document);
+
+    size_t bytes_written() const { return bytes_written_; }
+
+private:
+    std::ostream& output_;
+    ExportFormat format_;
+    DocumentEncoding stored_encoding_;
+    size_t bytes_written_ = 0;
+    std::string record_;
+
+    void begin_record(const std::string& key);
+    void end_record(const std::string& value);
+};
+
+} // namespace redisjson
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+enum class IndexType {
+    NUMERIC, // Numbers, in a sorted set scored by the value: equality and range lookups
+    TAG      // Strings, numbers and booleans, in one set per value: equality lookups
+};
+
+/**
+ * A secondary index over the value at `path` (a definite path such as "location.city" or
+ * "$.ports[0].speed") in every document whose key matches `key_pattern` (glob-style, as
+ * for SCAN). Documents where the value is missing or of another type are not indexed.
+ */
+struct IndexDefinition {
+    std::string name; // Letters, digits, '_', '-' and '.'
+    std::string key_pattern;
+    std::string path;
+    IndexType type = IndexType::TAG;
+};
+
+/**
+ * The secondary indexes a client maintains. The built-in write scripts keep them up to
+ * date in the same script call as the write, so an index never disagrees with the
+ * documents written through the client (see lua_design.md, "Secondary indexes").
+ *
+ * Redis layout, for an index named "city":
+ *   NUMERIC: a sorted set "redisjson:index:city" of document keys scored by the value.
+ *   TAG: a set "redisjson:index:city:<value>" of document keys per value, plus a hash
+ *        "redisjson:index:city" mapping each document key to its current value.
+ * If the key pattern starts with a hash tag ("{fleet}:device:*"), the index keys carry
+ * it too ("redisjson:index:city:{fleet}"), so that in cluster mode they live in the
+ * same slot as the documents.
+ *
+ * Thread-safe.
+ */
+class IndexRegistry {
+public:
+    // The hash holding every registered definition, by name.
+    static constexpr const char* DEFINITIONS_KEY = "redisjson:indexes";
+    static constexpr const char* KEY_PREFIX = "redisjson:index:";
+
+    // Adds the index, or replaces the one with the same name.
+    // @throws ArgumentInvalidException for an invalid name or key pattern,
+    //         InvalidPathException if the path is not a definite path below the root.
+    void add(const IndexDefinition& definition);
+    bool remove(const std::string& name);
+    std::optional<IndexDefinition> find(const std::string& name) const;
+    std::vector<IndexDefinition> definitions() const;
+    bool empty() const;
+
+    // True if an index covers `key`. The index keys themselves are never covered.
+    bool covers(const std::string& key) const;
+    // Appends the Redis key and the script specification of every index covering `key`
+    // to the KEYS and ARGV of a built-in write script. Returns false if there are none.
+    bool append_script_arguments(const std::string& key, std::vector<std::string>& keys,
+                                 std::vector<std::string>& args) const;
+    // The index over `path_segments` (see path_segments()) for exactly `key_pattern`.
+    std::optional<IndexDefinition> find_for(const std::string& key_pattern, const json& path_segments) const;
+
+    // The Redis key of the index: its sorted set (NUMERIC) or value hash (TAG).
+    static std::string index_key(const IndexDefinition& definition);
+    // The Redis key of the set of documents whose value is `tag` (TAG).
+    static std::string tag_key(const IndexDefinition& definition, const std::string& tag);
+    // The value as a TAG index records it (integral numbers without a fraction, booleans
+    // as "true"/"false"), or nothing for other types.
+    static std::optional<std::string> tag_value(const json& value);
+    // The members and indices of a definite path, e.g. ["ports", 0, "speed"].
+    // @throws InvalidPathException
+    static json path_segments(const std::string& path);
+    // Whether `key` matches the glob-style `pattern` (*, ?, [...] and \ escapes).
+    static bool key_matches(const std::string& pattern, const std::string& key);
+
+    static json to_json(const IndexDefinition& definition);
+    // @throws ArgumentInvalidException
+    static IndexDefinition from_json(const json& definition);
+
+private:
+    struct Entry {
+        IndexDefinition definition;
+        json segments;
+        std::string redis_key;
+        std::string spec; // ["numeric"|"tag", segments], as the scripts expect it
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, Entry> entries_;
+};
+
+} // namespace redisjson
@@ -2,6 +2,7 @@
 
 #include "path_parser.h" // Uses PathElement
 #include "exceptions.h"   // For custom exceptions
+#include "json_diff.h"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -32,6 +33,11 @@ public:
      */
     json get(const json& document, const std::vector<PathParser::PathElement>& path_elements) const;
 
+    /**
+     * Like get(), but returns a reference into `document` instead of a copy.
+     */
+    const json& get_ref(const json& document, const std::vector<PathParser::PathElement>& path_elements) const;
+
     /**
      * Sets the JSON value at the specified path.
      * If intermediate paths do not exist, they will be created (objects for keys, arrays for indices if specified or clear).
@@ -53,8 +59,14 @@ public:
     // Advanced Operations (Stubs for now)
     /**
      * Merges the 'patch' document into the 'document' according to the specified strategy.
+     * SHALLOW and OVERWRITE replace the top-level members present in the patch; DEEP merges
+     * objects recursively, and APPEND also appends arrays to arrays. Other patch values
+     * replace the document's value, and null is stored as null (see RFC 7386 merge_patch
+     * for deleting members). PATCH applies an RFC 6902 patch, as apply_patch() does.
+     * The document is modified in place; the rvalue overload moves values out of the patch.
      */
     void merge(json& document, const json& patch, MergeStrategy strategy = MergeStrategy::DEEP);
+    void merge(json& document, json&& patch, MergeStrategy strategy = MergeStrategy::DEEP);
 
     /**
      * Applies a JSON Patch (RFC 6902) to the document.
@@ -63,8 +75,10 @@ public:
 
     /**
      * Generates a JSON Patch (RFC 6902) representing the difference between old_doc and new_doc.
+     * Computed by JSONDiff, which skips identical subtrees by hash and aligns changed arrays.
      */
     json diff(const json& old_doc, const json& new_doc) const;
+    json diff(const json& old_doc, const json& new_doc, const DiffOptions& options) const;
 
     // Array Operations (Stubs for now)
     void array_append(json& document, const std::vector<PathParser::PathElement>& path_elements,
@@ -92,6 +106,29 @@ public:
     json::value_t get_type(const json& document,
                            const std::vector<PathParser::PathElement>& path_elements) const;
 
+    // Overloads taking a pre-compiled path (PathParser::compile), which is not parsed again.
+    json get(const json& document, const CompiledPath& path) const { return get(document, path.elements()); }
+    const json& get_ref(const json& document, const CompiledPath& path) const { return get_ref(document, path.elements()); }
+    void set(json& document, const CompiledPath& path, const json& value_to_set, bool create_path = true, bool overwrite = true) {
+        set(document, path.elements(), value_to_set, create_path, overwrite);
+    }
+    void del(json& document, const CompiledPath& path) { del(document, path.elements()); }
+    void array_append(json& document, const CompiledPath& path, const json& value_to_append) {
+        array_append(document, path.elements(), value_to_append);
+    }
+    void array_prepend(json& document, const CompiledPath& path, const json& value_to_prepend) {
+        array_prepend(document, path.elements(), value_to_prepend);
+    }
+    json array_pop(json& document, const CompiledPath& path, int index = -1) { return array_pop(document, path.elements(), index); }
+    void array_insert(json& document, const CompiledPath& path, int index, const json& value_to_insert) {
+        array_insert(document, path.elements(), index, value_to_insert);
+    }
+    long long array_trim(json& document, const CompiledPath& path, long long start, long long stop) {
+        return array_trim(document, path.elements(), start, stop);
+    }
+    bool exists(const json& document, const CompiledPath& path) const { return exists(document, path.elements()); }
+    json::value_t get_type(const json& document, const CompiledPath& path) const { return get_type(document, path.elements()); }
+
     /**
      * Gets the size of the element at the path.
      * For objects, number of keys. For arrays, number of elements. For strings, length.
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+// A node matched by a JSONPathPlan: a pointer into the evaluated document (valid as long
+// as the document is neither modified nor destroyed) and its normalized path, e.g.
+// "$.ports[3].mtu" or "$['a.b']", in the syntax PathParser::parse accepts.
+struct JSONPathMatch {
+    std::string path;
+    const json* value;
+};
+
+/**
+ * A JSONPath expression compiled into a plan of node-visit steps, e.g.
+ * "$..ports[?(@.admin_status=='up')].mtu". Compile once and evaluate against any number
+ * of documents, from any number of threads: the plan is immutable and cheap to copy.
+ * Evaluation is a single depth-first pass over the document that copies nothing; matches
+ * are reported as pointers into it, in document order.
+ *
+ * Supported syntax:
+ *   $ (optional), .name, ['name'], ["name"], [index] (negative: from the end),
+ *   .* and [*], [start:end:step], unions such as ['a','b'] or [0,2,-1],
+ *   ..selector (recursive descent), [?(filter)] and [?filter].
+ * Filters test each child of the selected node (array elements, object members):
+ *   @.a.b or $.a (singular paths; alone they test for existence),
+ *   == != < <= > >= against another path or a literal ('text', "text", numbers,
+ *   true, false, null), combined with &&, ||, ! and parentheses.
+ * Comparisons follow RFC 9535: a missing value is only equal to another missing value,
+ * and ordering comparisons only hold between two numbers or two strings.
+ */
+class JSONPathPlan {
+public:
+    // One member or index of a singular path inside a filter (@.a[0], $.b).
+    struct PathSegment {
+        bool is_index = false;
+        std::string name;
+        long long index = 0;
+    };
+
+    struct FilterOperand {
+        enum class Kind { CURRENT, ROOT, LITERAL };
+        Kind kind = Kind::LITERAL;
+        std::vector<PathSegment> path; // For CURRENT and ROOT
+        json literal;                  // For LITERAL
+    };
+
+    struct FilterExpression {
+        enum class Kind { OR, AND, NOT, EXISTS, COMPARE };
+        enum class Comparison { EQ, NE, LT, LE, GT, GE };
+        Kind kind = Kind::EXISTS;
+        Comparison comparison = Comparison::EQ;
+        FilterOperand left, right;               // EXISTS uses left only
+        std::vector<FilterExpression> operands;  // For OR, AND (two or more) and NOT (one)
+    };
+
+    struct Selector {
+        enum class Kind { NAME, INDEX, WILDCARD, SLICE, FILTER };
+        Kind kind = Kind::NAME;
+        std::string name;
+        long long index = 0;
+        bool has_start = false, has_end = false;
+        long long start = 0, end = 0, step = 1;
+        std::shared_ptr<const FilterExpression> filter;
+    };
+
+    // Applies its selectors (more than one for a union) to the current node, or with
+    // `descendant` set, to the current node and every node below it.
+    struct Step {
+        bool descendant = false;
+        std::vector<Selector> selectors;
+    };
+
+    // The root path, "$": it matches the whole document.
+    JSONPathPlan();
+
+    // @throws InvalidPathException
+    static JSONPathPlan compile(const std::string& jsonpath);
+
+    const std::string& expression() const { return data_->expression; }
+    const std::vector<Step>& steps() const { return data_->steps; }
+    // True if the path selects at most one node (names and indices only), so that it is
+    // also a path the rest of the library accepts.
+    bool is_definite() const { return data_->definite; }
+
+    // Calls `visitor` on every match, without collecting them.
+    void visit(const json& document, const std::function<void(const json&)>& visitor) const;
+    std::vector<const json*> select(const json& document) const;
+    std::vector<JSONPathMatch> select_paths(const json& document) const;
+
+    // The plan in the form the json_query Lua script executes (see lua_design.md), so that
+    // a query runs next to the data and only the matches cross the network. Steps before
+    // `first_step` are left out: in the hash layout the first member name selects the
+    // hash field, and the script evaluates the remaining steps against it.
+    json to_script_plan(size_t first_step = 0) const;
+    std::string script_argument(size_t first_step = 0) const { return to_script_plan(first_step).dump(); }
+    // The member name the plan starts with (a single name, not recursive descent), or an
+    // empty string.
+    std::string leading_member() const;
+    // True if a filter refers to the root ($.a); such plans need the whole document.
+    bool filters_use_root() const { return data_->filters_use_root; }
+
+    // Formats a member name or array index as a normalized path segment.
+    static std::string format_segment(const std::string& name);
+    static std::string format_segment(size_t index);
+
+private:
+    struct Data {
+        std::string expression;
+        std::vector<Step> steps;
+        bool definite = true;
+        bool filters_use_root = false;
+    };
+    explicit JSONPathPlan(std::shared_ptr<const Data> data) : data_(std::move(data)) {}
+
+    std::shared_ptr<const Data> data_;
+};
+
+} // namespace redisjson
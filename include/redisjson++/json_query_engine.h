@@ -1,7 +1,14 @@
 #pragma once
 
 #include "common_types.h"
+#include "json_cache.h"      // For SharedDocument
+#include "json_path_plan.h"
+#include <optional>
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <nlohmann/json.hpp>
 
@@ -15,26 +22,68 @@ class JSONQueryEngine {
 public:
     explicit JSONQueryEngine(RedisJSONClient& client);
 
+    static constexpr size_t MAX_CACHED_PLANS = 256;
+
     // JSONPath Support
-    // Executes a JSONPath query against the JSON document stored at the given key.
-    // Returns a vector of JSON values that match the query.
+    // Executes a JSONPath query (see JSONPathPlan for the syntax) against the JSON document
+    // stored at the given key. Returns the matching values, in document order; none if the
+    // key does not exist. The query runs inside Redis where possible, so only the matches
+    // are transferred (see RedisJSONClient::query_json).
+    // @throws InvalidPathException, QueryException
     std::vector<json> query(const std::string& key,
                            const std::string& jsonpath) const;
+    // Like query(), but always evaluated on the client, returning views into the shared
+    // document instead of copies (see RedisJSONClient::get_json_shared): with the
+    // client-side cache enabled, repeated queries of a document copy nothing.
+    std::vector<SharedDocument> query_views(const std::string& key,
+                                            const std::string& jsonpath) const;
+    // The compiled plan for `jsonpath`. The engine keeps the plans of recent queries
+    // (up to MAX_CACHED_PLANS), so each expression is only parsed once.
+    // @throws InvalidPathException
+    JSONPathPlan compile(const std::string& jsonpath) const;
 
-    // SQL-like Queries (Placeholder - Implementation requires significant effort)
-    // Executes an SQL-like query against the JSON document.
-    // This is a complex feature and might require a dedicated parsing and execution engine.
-    std::vector<json> select(const std::string& key,
+    // SQL-like Queries
+    // The documents whose keys match `key_pattern` (glob-style, as for SCAN) and that
+    // satisfy `where_clause`, in key order. The clause is a JSONPath filter expression on
+    // the document, e.g. "@.location.city == 'Paris' && @.ports.count > 4" (see
+    // JSONPathPlan). Comparisons with a literal on a path that has a secondary index for
+    // exactly `key_pattern` (see RedisJSONClient::create_index) are resolved through the
+    // index: == on TAG and NUMERIC indexes, < <= > >= on NUMERIC ones. If the clause
+    // cannot be narrowed down that way (no index, or ||, ! and != around unindexed
+    // terms), every key matching the pattern is scanned. Either way each candidate is
+    // checked against the whole clause.
+    // @throws InvalidPathException, QueryException
+    std::vector<json> select(const std::string& key_pattern,
                             const std::string& where_clause) const;
+    // Like select(), returning the keys of the matching documents.
+    std::vector<std::string> select_keys(const std::string& key_pattern,
+                                         const std::string& where_clause) const;
 
-    // Aggregation (Placeholder - Implementation requires significant effort)
-    // Performs aggregation operations (sum, avg, count, etc.) on values found at a specific path.
+    // Aggregation
+    // Aggregates the values a JSONPath query matches in the document at `key`; see
+    // Aggregation for the operations ("sum", "avg", "percentile:95", ...). The aggregation
+    // runs inside Redis where possible, so only the result is transferred.
+    // @throws InvalidPathException, ArgumentInvalidException, QueryException
     json aggregate(const std::string& key, const std::string& path,
                   const std::string& operation) const;
+    // Like aggregate(), over every document whose key matches `key_pattern` (glob-style, as
+    // for SCAN). Keys are aggregated in Redis in batches of up to `batch_size`, and only a
+    // partial result per batch is transferred.
+    // @throws InvalidPathException, ArgumentInvalidException, QueryException
+    json aggregate_keys(const std::string& key_pattern, const std::string& path,
+                        const std::string& operation, size_t batch_size = 100) const;
 
 private:
     RedisJSONClient& _client;
-    // Helper methods for query execution might be needed here
+
+    std::vector<std::pair<std::string, json>> _select(const std::string& key_pattern,
+                                                      const std::string& where_clause) const;
+    // The keys the index lookups for `filter` narrow the candidates down to, or nothing if
+    // the indexes cannot answer it.
+    std::optional<std::set<std::string>> _index_candidates(const JSONPathPlan::FilterExpression& filter,
+                                                           const std::string& key_pattern) const;
+    mutable std::shared_mutex _plans_mutex;
+    mutable std::unordered_map<std::string, JSONPathPlan> _plans;
 };
 
 } // namespace redisjson
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "redis_connection_manager.h"
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace redisjson {
+
+using json = nlohmann::json;
+
+struct ScanOptions {
+    // COUNT hint of the first SCAN call. Later calls adapt it, between min_count and
+    // max_count, so that each returns about target_batch_size matching keys: sparse
+    // patterns get larger pages (fewer round trips), dense ones smaller (bounded memory).
+    size_t initial_count = 100;
+    size_t min_count = 10;
+    size_t max_count = 10000;
+    size_t target_batch_size = 1000;
+    // Also read the documents. The reads of one page of keys are pipelined with the SCAN
+    // call for the next page, so scanning and fetching overlap in one round trip.
+    bool fetch_documents = false;
+};
+
+// A key found by a KeyScanner, with its document if ScanOptions::fetch_documents is set.
+struct ScannedKey {
+    std::string key;
+    json document;            // Null unless fetched
+    std::exception_ptr error; // Set if the document could not be read or decoded
+};
+
+/**
+ * Iterates over the keys matching a glob-style pattern (as for SCAN) without
+ * materialising them: pages are requested one at a time, each on the same connection,
+ * and only the current page is held in memory. In cluster mode the primaries are
+ * scanned one after another. As with SCAN, a key may be reported more than once, and
+ * keys created or deleted during the scan may or may not be reported; keys deleted
+ * before their document was read are skipped.
+ *
+ * A scanner holds a pooled connection until it is exhausted or destroyed, and must not
+ * outlive the RedisConnectionManager (or RedisJSONClient) it came from. Not thread-safe.
+ */
+class KeyScanner {
+public:
+    // Decodes the reply to the fetch command for `key`. Throws PathNotFoundException if
+    // the key no longer exists.
+    using DocumentDecoder = std::function<json(const std::string& key, redisReply* reply)>;
+
+    // `nodes`: the servers to scan (default: every primary). `fetch_command` and
+    // `decoder` read the documents when options.fetch_documents is set.
+    KeyScanner(RedisConnectionManager& connections, std::string pattern, ScanOptions options = {},
+               std::string fetch_command = "GET", DocumentDecoder decoder = {},
+               std::vector<std::string> nodes = {});
+
+    KeyScanner(KeyScanner&&) = default;
+    KeyScanner& operator=(KeyScanner&&) = default;
+
+    // Replaces `batch` with the next keys found. Returns false, with `batch` empty, once
+    // the scan is complete.
+    // @throws RedisCommandException, ConnectionException
+    bool next_batch(std::vector<ScannedKey>& batch);
+    // The next key, one at a time (batches are still fetched a page at a time).
+    bool next(ScannedKey& entry);
+
+    // The COUNT hint the next SCAN call will use.
+    size_t current_count() const { return count_; }
+    size_t round_trips() const { return round_trips_; }
+
+private:
+    RedisConnectionManager* connections_;
+    std::string pattern_;
+    ScanOptions options_;
+    std::string fetch_command_;
+    DocumentDecoder decoder_;
+    std::vector<std::string> nodes_;
+    size_t node_index_ = 0;
+    RedisConnectionManager::RedisConnectionPtr connection_;
+    std::string cursor_ = "0";
+    bool node_done_ = false;
+    size_t count_;
+    size_t round_trips_ = 0;
+    std::vector<std::string> pending_;   // Found, documents not read yet
+    std::vector<ScannedKey> buffered_;   // For next()
+    size_t buffered_index_ = 0;
+
+    void adapt_count(size_t found);
+    // Disconnects the current connection (its replies may be out of step) and throws.
+    [[noreturn]] void fail(const std::string& message);
+};
+
+} // namespace redisjson
@@ -2,6 +2,7 @@
 
 #include "redis_connection_manager.h" // Needs access to RedisConnection or similar
 #include "exceptions.h"             // For LuaScriptException
+#include "json_index.h"
 #include <nlohmann/json.hpp>
 #include <hiredis/hiredis.h>
 #include <string>
@@ -23,7 +24,11 @@ public:
     // Takes a raw pointer to connection manager, does not own it.
     // Manager must outlive the script manager or be handled carefully.
     // Alternatively, could take a shared_ptr or a factory function for connections.
-    explicit LuaScriptManager(RedisConnectionManager* conn_manager);
+    // `encoding` and `layout` select how the built-in scripts decode, encode and store
+    // documents (see DocumentEncoding and DocumentLayout).
+    explicit LuaScriptManager(RedisConnectionManager* conn_manager,
+                              DocumentEncoding encoding = DocumentEncoding::JSON,
+                              DocumentLayout layout = DocumentLayout::STRING);
     ~LuaScriptManager();
 
     LuaScriptManager(const LuaScriptManager&) = delete;
@@ -78,18 +83,74 @@ public:
      */
     void clear_local_script_cache();
 
+    /**
+     * Returns the SHA1 of a script, loading it on demand if it is a built-in script
+     * that has not been loaded yet. Used by callers that issue EVALSHA themselves,
+     * e.g. when pipelining several script calls on one connection.
+     * @throws LuaScriptException if the script is unknown or cannot be loaded.
+     */
+    std::string get_script_sha(const std::string& name);
+
+    /**
+     * Loads a built-in script again (on every primary in cluster mode), e.g. after an
+     * EVALSHA sent by the caller was answered NOSCRIPT because the server's script cache
+     * was flushed or a failover promoted a server that never had it.
+     * @throws LuaScriptException if `name` is not a built-in script.
+     */
+    void reload_builtin_script(const std::string& name);
+
+    /**
+     * Whether `name` is a built-in script that only reads (json_path_get, json_path_type,
+     * the length, key and index queries, json_query, json_aggregate). execute_script() sends these as reads, so they
+     * may run on a replica (see LegacyClientConfig::replica_nodes).
+     */
+    static bool is_read_only_script(const std::string& name);
+
+    /**
+     * Converts a reply returned by EVALSHA into JSON (see execute_script for the rules).
+     * @throws LuaScriptException if the reply is an error reply.
+     */
+    static json redis_reply_to_json(redisReply* reply);
+
+    /**
+     * Returns the full source of a built-in script (e.g. "json_path_get") for the given
+     * document encoding and layout, i.e. the script body with the matching storage and
+     * codec preludes (and for write scripts, the index prelude), or an empty string if
+     * there is no built-in script with that name.
+     */
+    static std::string get_builtin_script(const std::string& name, DocumentEncoding encoding,
+                                          DocumentLayout layout = DocumentLayout::STRING);
+
+    /**
+     * Returns `value` with every empty array replaced by the placeholder that the built-in
+     * scripts turn back into an empty array when they encode a document. Lua tables cannot
+     * tell an empty array from an empty object, so values written through a script (e.g.
+     * the json_merge_patch argument) are marked this way.
+     */
+    static json mark_empty_arrays(json value);
+
+    /**
+     * Makes execute_script() pass the secondary indexes covering the key of a built-in
+     * write script along with it, so that the script keeps them up to date. The registry
+     * is not owned and must outlive this manager (or be reset to nullptr first).
+     */
+    void set_index_registry(const IndexRegistry* registry) { index_registry_ = registry; }
+
+    DocumentEncoding document_encoding() const { return encoding_; }
+    DocumentLayout document_layout() const { return layout_; }
 
 private:
     RedisConnectionManager* connection_manager_; // Does not own
+    DocumentEncoding encoding_;
+    DocumentLayout layout_;
+    const IndexRegistry* index_registry_ = nullptr; // Does not own
     std::unordered_map<std::string, std::string> script_shas_; // Maps script name to SHA1
     mutable std::mutex cache_mutex_; // Protects script_shas_
 
-    // Helper to convert Redis reply to JSON.
-    // This needs to be robust for various Redis reply types (string, integer, array, nil, error).
-    json redis_reply_to_json(redisReply* reply) const;
-
-    // Helper to get script body by name for on-demand loading
-    const std::string* get_script_body_by_name(const std::string& name) const;
+    // Helper to get script source by name for on-demand loading (empty if unknown)
+    std::string get_script_body_by_name(const std::string& name) const;
+    // redis_reply_to_json() for an EVALSHA reply, reporting NOSCRIPT for script `name`.
+    static json evalsha_reply_to_json(const std::string& name, redisReply* reply);
 
     // Built-in script bodies (can be quite large)
     // These could be static const strings or loaded from files/resources.
@@ -118,6 +179,17 @@ private:
     static const std::string JSON_CLEAR_LUA;
     static const std::string JSON_ARRINDEX_LUA;
     static const std::string JSON_ARRAY_TRIM_LUA;
+    static const std::string JSON_HASH_SET_DOCUMENT_LUA;
+    static const std::string JSON_HASH_MERGE_FIELDS_LUA;
+    static const std::string JSON_SET_DOCUMENT_LUA;
+    static const std::string JSON_DEL_DOCUMENT_LUA;
+    static const std::string JSON_INDEX_DOCUMENT_LUA;
+    static const std::string JSON_DELTA_SET_LUA;
+    static const std::string JSON_PATCH_LUA;
+    static const std::string JSON_MERGE_PATCH_LUA;
+    static const std::string JSON_REPLACE_IF_UNCHANGED_LUA;
+    static const std::string JSON_QUERY_LUA;
+    static const std::string JSON_AGGREGATE_LUA;
     // ... other built-in scripts
 };
 
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "common_types.h"
+#include "hiredis_RAII.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+namespace redisjson {
+
+class RedisConnection;
+
+/**
+ * One Redis connection shared by any number of threads, with implicit pipelining.
+ *
+ * submit() queues a command and returns a future for its reply. A writer thread sends
+ * everything queued since its last write in a single socket write, and a reader thread
+ * hands the replies back in FIFO order, which is the order Redis answers in. Callers
+ * issuing single commands concurrently are therefore pipelined without batching
+ * anything themselves, and a few of these connections can serve many threads.
+ *
+ * Only self-contained commands may be sent: nothing that changes connection state
+ * (MULTI/EXEC, WATCH, SELECT, SUBSCRIBE, CLIENT TRACKING), since other callers share it.
+ *
+ * If the connection fails, every command in flight fails with ConnectionException (it
+ * may or may not have been executed), and so do submissions until it is reestablished.
+ * A reply that takes longer than the configured timeout counts as a failed connection.
+ * The writer thread reconnects on its own.
+ */
+class MultiplexedConnection {
+public:
+    explicit MultiplexedConnection(const LegacyClientConfig& config);
+    ~MultiplexedConnection();
+
+    MultiplexedConnection(const MultiplexedConnection&) = delete;
+    MultiplexedConnection& operator=(const MultiplexedConnection&) = delete;
+
+    // The future holds the reply (possibly an error reply), or a ConnectionException.
+    std::future<RedisReplyPtr> submit(const std::vector<std::string>& argv);
+    // submit() and wait for the reply.
+    // @throws ConnectionException if the connection is down or fails before replying.
+    // @throws TimeoutException if no reply comes within the timeout (see await_reply).
+    RedisReplyPtr execute(const std::vector<std::string>& argv);
+    // Waits for a reply from submit() for at most the configured timeout. On timeout the
+    // connection is failed, and with it every command in flight, since the replies still
+    // due would otherwise be matched with the wrong callers.
+    // @throws TimeoutException on timeout; ConnectionException as execute().
+    RedisReplyPtr await_reply(std::future<RedisReplyPtr> reply);
+
+    bool is_connected() const { return connected_; }
+    // Commands submitted and not answered yet.
+    size_t pending() const;
+
+    // Encodes a command in the Redis protocol (RESP array of bulk strings).
+    static std::string format_command(const std::vector<std::string>& argv);
+
+private:
+    struct Request {
+        std::string command; // Already encoded
+        std::promise<RedisReplyPtr> reply;
+    };
+
+    LegacyClientConfig config_;
+    std::unique_ptr<RedisConnection> connection_; // Only used by the writer/reader threads
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<Request> queued_;                        // Not yet written
+    std::deque<std::promise<RedisReplyPtr>> in_flight_; // Written, awaiting replies in order
+    std::atomic<bool> connected_{false};
+    std::atomic<bool> session_failed_{false};
+    std::atomic<bool> stopping_{false};
+    int session_fd_ = -1; // Socket of the current session, guarded by mutex_
+
+    std::thread writer_;
+
+    void write_loop();
+    // Writes batches until the session fails or the connection stops.
+    void write_batches(int fd);
+    void read_loop();
+    // Ends the current session; shutting its socket down wakes the reader at once.
+    void fail_session();
+    // Fails every queued and in-flight request; called with mutex_ held.
+    void fail_all_locked(const std::string& reason);
+};
+
+} // namespace redisjson
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
+#include <utility>
 #include <nlohmann/json.hpp> // For json type if needed in methods
 
 namespace redisjson {
@@ -9,9 +11,17 @@ namespace redisjson {
 // Forward declare json if preferred over including nlohmann/json.hpp directly
 // using json = nlohmann::json;
 
+class CompiledPath;
+
 class PathParser {
 public:
-    PathParser() = default; // Default constructor
+    static constexpr size_t DEFAULT_COMPILED_PATH_CACHE_SIZE = 1024;
+
+    // `compiled_path_cache_size` bounds the number of paths compile() keeps (0: no caching).
+    explicit PathParser(size_t compiled_path_cache_size = DEFAULT_COMPILED_PATH_CACHE_SIZE);
+    ~PathParser();
+    PathParser(PathParser&&) noexcept;
+    PathParser& operator=(PathParser&&) noexcept;
 
     // Based on requirement.md
     struct PathElement {
@@ -26,8 +36,19 @@ public:
 
     // Declarations
     std::vector<PathElement> parse(const std::string& path) const;
+    // Parses `path` once: later calls with the same string return the same immutable
+    // CompiledPath from a thread-safe cache, without parsing. When the cache is full an
+    // arbitrary entry makes room. Invalid paths are not cached.
+    // @throws InvalidPathException
+    CompiledPath compile(const std::string& path) const;
+    // Number of paths currently cached by compile().
+    size_t compiled_path_count() const;
     bool is_valid_path(const std::string& path) const;
     std::string normalize_path(const std::string& path) const;
+    // For a JSONPath with wildcards, slices, filters or recursive descent (see
+    // JSONPathPlan), the normalized paths of the nodes it matches in `document`; other
+    // paths are returned as parse() reads them, whether or not they exist in the document.
+    // @throws InvalidPathException
     std::vector<std::string> expand_wildcards(const nlohmann::json& document,
                                              const std::string& path) const;
 
@@ -41,12 +62,63 @@ public:
     static bool is_array_path(const std::vector<PathElement>& path_elements_to_target, const nlohmann::json& doc_context);
     static std::string escape_key_if_needed(const std::string& key_name);
     static std::string reconstruct_path(const std::vector<PathElement>& path_elements);
+    // Splits a path into its top-level member and the remaining path, in the syntax the
+    // Lua scripts accept: "ports.Ethernet0.mtu" -> {"ports", "Ethernet0.mtu"},
+    // "$.vlans[2]" -> {"vlans", "[2]"}, "name" -> {"name", ""}. Root paths ("$", "", ".")
+    // yield {"", ""}.
+    // @throws InvalidPathException if the path does not start with a member name.
+    static std::pair<std::string, std::string> split_top_level(const std::string& path_str);
+
+    // Pre-tokenised path arguments for the built-in Lua scripts, so that they resolve the
+    // path with table lookups instead of parsing the string on the Redis main thread.
+    // The encoding is a NUL byte followed by a MessagePack array of the segments: member
+    // names as strings, array indices as integers already shifted to Lua's 1-based indexing
+    // (the scripts' parse_path() unpacks it with cmsgpack). It has no root form, and only
+    // covers KEY and INDEX elements; for other paths this returns an empty string.
+    static std::string encode_script_path(const std::vector<PathElement>& path_elements);
+    // The argument to pass a script for `path_str`: its encoding, or the string itself for
+    // root paths and paths that cannot be encoded (including malformed ones, which the
+    // script then reports as before).
+    static std::string script_path_argument(const std::string& path_str);
 
 
 private:
+    struct CompiledPathCache;
+    std::unique_ptr<CompiledPathCache> compiled_paths_;
+
     // Helper for wildcard expansion, if needed to be distinct from public API
     std::vector<std::string> expand_wildcards(const nlohmann::json& document,
                                              const std::vector<PathElement>& parsed_path) const;
 };
 
+/**
+ * A parsed path (see PathParser::compile). Immutable and cheap to copy: copies share the
+ * parsed elements, so one CompiledPath can be used from any number of threads. Client
+ * and JSONModifier calls that take a CompiledPath never parse the path again.
+ */
+class CompiledPath {
+public:
+    // The root path, "$".
+    CompiledPath();
+
+    const std::string& path() const { return data_->path; }
+    const std::vector<PathParser::PathElement>& elements() const { return data_->elements; }
+    bool is_root() const { return data_->elements.empty(); }
+    // The path argument for the built-in Lua scripts (see PathParser::script_path_argument).
+    const std::string& script_argument() const {
+        return data_->script_argument.empty() ? data_->path : data_->script_argument;
+    }
+
+private:
+    friend class PathParser;
+    struct Data {
+        std::string path;
+        std::vector<PathParser::PathElement> elements;
+        std::string script_argument; // Empty if the path cannot be encoded
+    };
+    explicit CompiledPath(std::shared_ptr<const Data> data) : data_(std::move(data)) {}
+
+    std::shared_ptr<const Data> data_;
+};
+
 } // namespace redisjson
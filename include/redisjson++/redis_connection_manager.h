@@ -2,10 +2,12 @@
 
 #include "common_types.h" // For ClientConfig
 #include "exceptions.h"      // For ConnectionException
+#include "hiredis_RAII.h"   // For RedisReplyPtr
+#include "cluster_slot_map.h"
 #include <hiredis/hiredis.h>
 #include <string>
 #include <vector>
-#include <queue>
+#include <map>
 #include <mutex>
 #include <condition_variable>
 #include <memory>
@@ -13,6 +15,7 @@
 #include <functional> // For std::function
 #include <thread>     // For health check thread
 #include <atomic>     // For health status and control flags
+#include <future>     // For multiplexed command replies
 
 namespace redisjson {
 
@@ -49,7 +52,14 @@ public:
     redisReply* command(const char* format, ...);
     redisReply* command_argv(int argc, const char **argv, const size_t *argvlen);
 
+    // Pipelining: queue commands in the output buffer with append_command_argv(),
+    // then read their replies back in order with get_reply(). The first get_reply()
+    // flushes everything queued so far in a single write.
+    bool append_command_argv(int argc, const char **argv, const size_t *argvlen);
+    redisReply* get_reply();
+
     std::chrono::steady_clock::time_point last_used_time;
+    uint64_t pool_epoch = 0; // The manager's epoch when the connection was checked out
     bool ping(); 
     const std::string& get_last_error() const { return last_error_message_; }
 
@@ -71,6 +81,8 @@ private:
     bool select_database();
 };
 
+class MultiplexedConnection;
+
 class RedisConnectionManager {
 public:
     explicit RedisConnectionManager(const ClientConfig& config);
@@ -93,6 +105,72 @@ public:
     void on_connection_lost(std::function<void(const std::string&)> callback);
     void on_connection_restored(std::function<void(const std::string&)> callback);
 
+    // Multiplexed mode (ClientConfig::multiplexed_connections > 0): single commands from
+    // any thread can be sent over a few shared connections, which pipeline them (see
+    // MultiplexedConnection). The pool stays available for commands that need a
+    // connection of their own.
+    bool is_multiplexed() const { return !multiplexed_.empty(); }
+    // Sends one self-contained command over the least busy shared connection.
+    // @throws ConnectionException if the manager is not in multiplexed mode.
+    // The future is not bounded by the timeout; see MultiplexedConnection::await_reply.
+    std::future<RedisReplyPtr> submit_multiplexed(const std::vector<std::string>& argv);
+
+    // Single commands and pipelines, routed by key. In cluster mode each command goes to
+    // the primary serving the slot of its key (see command_key()), following MOVED and ASK
+    // redirections; a MOVED also refreshes the slot map (at most once a second). Replies
+    // are nullptr for commands whose connection broke before replying.
+    RedisReplyPtr execute_for_key(const std::string& key, const std::vector<std::string>& argv);
+    // Commands for different nodes are pipelined on one connection per node, in parallel.
+    std::vector<RedisReplyPtr> execute_pipeline(const std::vector<std::vector<std::string>>& commands);
+    // The key a command is routed by: KEYS[1] for EVAL/EVALSHA, otherwise its first argument.
+    static std::string command_key(const std::vector<std::string>& argv);
+
+    // Cluster mode (ClientConfig::cluster_mode): the manager keeps a pool per primary.
+    // get_connection() then returns a connection to some primary, for keyless commands.
+    bool is_cluster() const { return config_.cluster_mode; }
+    // Addresses ("host:port") of the primaries; in standalone mode, the configured server.
+    std::vector<std::string> node_addresses();
+    // A connection to one of node_addresses(); in standalone mode, get_connection().
+    RedisConnectionPtr get_connection_for_node(const std::string& address);
+    // Rereads the slot map with CLUSTER SLOTS from a known primary or a seed node.
+    // @throws ConnectionException if none of them answers.
+    void refresh_cluster_slots();
+
+    // Replica reads (ClientConfig::replica_nodes, standalone mode): read-only commands sent
+    // here go to the primary or to a replica, as ClientConfig::read_policy decides; EVALSHA
+    // is sent to replicas as EVALSHA_RO where they support it. Commands a replica cannot
+    // serve are resent to the primary. In cluster mode, or without replicas, these are
+    // execute_for_key() and execute_pipeline(). A pipeline goes to a single server.
+    RedisReplyPtr execute_read(const std::string& key, const std::vector<std::string>& argv);
+    std::vector<RedisReplyPtr> execute_read_pipeline(const std::vector<std::vector<std::string>>& commands);
+    // While one is alive, reads issued by its thread go to the primary. Used for reads that
+    // fill a cache the primary invalidates: a lagging replica could refill it with the
+    // value a write just replaced.
+    class PrimaryReadScope {
+    public:
+        PrimaryReadScope();
+        ~PrimaryReadScope();
+        PrimaryReadScope(const PrimaryReadScope&) = delete;
+        PrimaryReadScope& operator=(const PrimaryReadScope&) = delete;
+
+    private:
+        bool previous_;
+    };
+    // The configured replicas; get_connection_for_node() accepts these addresses too.
+    std::vector<std::string> replica_addresses() const;
+    // Smoothed round trip of the health thread's ping to this manager's server (zero
+    // until measured).
+    std::chrono::microseconds round_trip_time() const { return std::chrono::microseconds(round_trip_us_.load()); }
+
+    // A server a read may go to, as the read policy sees it.
+    struct ReadTarget {
+        bool healthy;
+        std::chrono::microseconds round_trip; // Zero if not measured yet
+    };
+    // Index in `targets` (0 is the primary, then the replicas) of the server a read goes
+    // to. `turn` rotates PREFER_REPLICA reads over the replicas.
+    static size_t select_read_target(ReadPolicy policy, const std::vector<ReadTarget>& targets, size_t turn);
+
 // Made public so RedisConnectionDeleter can be defined outside but still be a nested type if desired
 // Custom deleter for RedisConnection to be used with std::unique_ptr
     struct RedisConnectionDeleter {
@@ -128,13 +206,29 @@ public:
     };
 
 private:
+    // Idle connections are kept in stripes, each a LIFO free list behind its own mutex.
+    // A thread takes connections from, and returns them to, its home stripe (chosen by
+    // thread id), so concurrent callers rarely share a lock and both operations are O(1).
+    // When its home stripe is empty it takes from the other stripes before opening a new
+    // connection. Checkout never pings: idle connections are checked by the health thread.
+    struct PoolStripe {
+        std::mutex mutex;
+        std::vector<RedisConnection*> idle; // Owned by the manager while idle
+    };
+
     ClientConfig config_;
-    // Changed type of pool_
-    std::vector<RedisConnectionManager::RedisConnectionPtr> pool_; 
-    std::queue<RedisConnection*> available_connections_; 
+    std::vector<std::unique_ptr<PoolStripe>> stripes_;
+    // stats_.total_connections counts open connections (idle or checked out) and doubles as
+    // the pool's capacity counter: a slot is reserved before a connection is opened.
+    ConnectionStatsInternal stats_;
+    // pool_mutex_/condition_ are only used by callers waiting for a connection while the
+    // pool is exhausted, and by the health thread's sleep.
     std::mutex pool_mutex_;
     std::condition_variable condition_;
-    ConnectionStatsInternal stats_; 
+    std::atomic<int> waiters_{0};
+    // Bumped by close_all_connections(); connections checked out before are closed when
+    // returned instead of pooled.
+    std::atomic<uint64_t> pool_epoch_{0};
 
     std::atomic<bool> shutting_down_{false};
     std::atomic<bool> primary_healthy_{false}; 
@@ -145,15 +239,57 @@ private:
     std::chrono::seconds max_idle_time_before_ping_ = std::chrono::seconds(60); 
     void health_check_loop();
     bool check_primary_health(); 
-    void maintain_pool_size(std::unique_lock<std::mutex>& lock); 
+    // Pings connections idle for longer than max_idle_time_before_ping_, outside any
+    // stripe lock, and closes the ones that fail.
+    void check_idle_connections();
+    void maintain_pool_size();
 
     std::function<void(const std::string&)> connection_lost_callback_;
     std::function<void(const std::string&)> connection_restored_callback_;
 
+    std::vector<std::unique_ptr<MultiplexedConnection>> multiplexed_;
+    // The connected shared connection with the fewest commands pending (the first one if
+    // none is connected). @throws ConnectionException if not in multiplexed mode.
+    MultiplexedConnection* least_busy_multiplexed() const;
+
+    // Cluster mode: one standalone manager per primary, created on first use and kept
+    // until this manager is destroyed (connections handed out point back to it).
+    ClusterSlotMap slot_map_;
+    mutable std::mutex nodes_mutex_;
+    std::map<std::string, std::unique_ptr<RedisConnectionManager>> node_managers_;
+    std::atomic<int64_t> last_slot_refresh_ms_{0};
+    RedisConnectionManager* node_manager(const std::string& address);
+    RedisConnectionManager* manager_for_key(const std::string& key);
+    std::vector<RedisConnectionManager*> node_managers_snapshot() const;
+    void refresh_slots_after_moved();
+    // Standalone execution on this manager's own connections. With `asking`, the command
+    // is preceded by ASKING on the same (pooled) connection.
+    RedisReplyPtr execute_single(const std::vector<std::string>& argv, bool asking = false);
+    // With `pooled`, the commands share one pooled connection even in multiplexed mode.
+    std::vector<RedisReplyPtr> execute_local_pipeline(const std::vector<std::vector<std::string>>& commands,
+                                                      bool pooled = false);
+
+    // Replica reads: one standalone manager per replica, created with this manager.
+    std::vector<std::unique_ptr<RedisConnectionManager>> replicas_;
+    std::atomic<size_t> read_turn_{0};
+    std::atomic<int64_t> primary_reads_until_ms_{0}; // Set when a WAIT times out
+    std::atomic<int64_t> round_trip_us_{0};
+    std::atomic<bool> read_only_scripts_unsupported_{false}; // On a replica manager: no EVALSHA_RO
+    RedisConnectionManager* read_target();
+    bool waits_for_replicas() const;
+    // Runs writes followed by WAIT on one pooled connection (WAIT covers the writes made
+    // on its own connection).
+    std::vector<RedisReplyPtr> execute_and_wait(const std::vector<std::vector<std::string>>& commands);
+
     void initialize_pool();
-    // Declare new method and adjust/remove old one
-    RedisConnectionManager::RedisConnectionPtr create_new_connection_ptr(const std::string& host, int port);
-    // std::unique_ptr<RedisConnection> create_new_connection(const std::string& host, int port); // Kept for now, to be reviewed
+    // Opens a connection for a reserved slot; returns nullptr (and frees the slot) on failure.
+    std::unique_ptr<RedisConnection> open_connection(std::string& error_detail);
+    size_t home_stripe() const;
+    RedisConnection* take_idle();
+    void put_idle(RedisConnection* conn, size_t stripe);
+    bool try_reserve_slot();
+    void release_slot();
+    void notify_waiter();
 };
 
 } // namespace redisjson
@@ -7,18 +7,29 @@
 #include <string>
 #include <nlohmann/json.hpp>
 #include <optional> // For std::optional
+#include <map>
+#include <exception> // For std::exception_ptr
+#include <functional>
 
 #include <hiredis/hiredis.h> // For redisReply and redisContext
 
 #include "common_types.h"
 #include "exceptions.h"
+#include "hiredis_RAII.h"
 #include "redis_connection_manager.h" // To be replaced
 #include "path_parser.h"
 #include "json_modifier.h"
 #include "lua_script_manager.h" // To be removed or heavily adapted
 // #include "transaction_manager.h" // May be removed if SWSS doesn't support easily
 #include "json_query_engine.h"   // May be adapted or removed
+#include "json_path_plan.h"
+#include "json_aggregation.h"
+#include "json_index.h"
+#include "key_scanner.h"
+#include "bulk_loader.h"
+#include "json_exporter.h"
 #include "json_cache.h"          // May be adapted or removed
+#include "cache_invalidation_listener.h"
 #include "json_schema_validator.h" // May be adapted or removed
 #include "json_event_emitter.h"  // May be adapted or removed
 
@@ -71,6 +82,22 @@ class JSONCache;          // May change
 class JSONSchemaValidator;// May change
 class JSONEventEmitter;   // May change
 
+// Outcome of a single item in a batch operation (get_json_many, set_json_many, get_paths).
+// Items succeed or fail independently: a failed item holds the exception the equivalent
+// single-item call would have thrown, and the other items in the batch are unaffected.
+struct BatchResult {
+    json value;               // The result when ok(); null for failed items
+    std::exception_ptr error; // Set when this item failed
+
+    bool ok() const { return !error; }
+
+    // Returns the value, or rethrows the item's exception if it failed.
+    const json& get() const {
+        if (error) std::rethrow_exception(error);
+        return value;
+    }
+};
+
 class RedisJSONClient {
 public:
     // Constructor for legacy direct Redis connections (existing config)
@@ -84,6 +111,27 @@ public:
     void set_json(const std::string& key, const json& document,
                   const SetOptions& opts = {});
     json get_json(const std::string& key) const;
+    // Like get_json(), but a hit in the client-side cache returns the cached document
+    // itself instead of a copy. Works without the cache too (the document is then owned
+    // by the returned pointer alone).
+    SharedDocument get_json_shared(const std::string& key) const;
+    // The value at `path` (not wrapped in an array, unlike legacy get_path) as a view into
+    // the shared document: reading a few fields of a cached document copies nothing. On
+    // a cache miss the whole document is read, and cached if enabled.
+    SharedDocument get_path_view(const std::string& key, const std::string& path) const;
+    // The values matching a compiled JSONPath query (see JSONPathPlan), in document order;
+    // none if the key does not exist. In legacy mode the plan runs inside Redis (the
+    // json_query script), so only the matches are transferred. It is evaluated on the
+    // client instead in SWSS mode, for keys the client-side cache serves, and in the hash
+    // layout for plans that do not start with a member name or whose filters refer to $.
+    std::vector<json> query_json(const std::string& key, const JSONPathPlan& plan) const;
+    // Adds the values `plan` matches in the documents at `keys` to `aggregation`; missing
+    // keys are skipped. In legacy mode this runs inside Redis (the json_aggregate script):
+    // for a single key the script returns the final result, otherwise keys are sent in
+    // batches of up to `batch_size` (grouped by hash slot in cluster mode) and only partial
+    // results come back. Where query_json evaluates plans on the client, so does this.
+    void aggregate_json(const std::vector<std::string>& keys, const JSONPathPlan& plan,
+                        Aggregation& aggregation, size_t batch_size = 100) const;
     bool exists_json(const std::string& key) const;
     void del_json(const std::string& key);
 
@@ -155,12 +203,34 @@ public:
                        std::optional<long long> start_index = std::nullopt,
                        std::optional<long long> end_index = std::nullopt);
 
+    // Batch Operations
+    // In legacy mode all commands of a batch are pipelined on a single pooled connection,
+    // so the whole batch costs roughly one round trip instead of one per item.
+    // In SWSS mode they fall back to one call per item.
+
+    // Results are in the same order as `keys`. A missing key yields PathNotFoundException.
+    std::vector<BatchResult> get_json_many(const std::vector<std::string>& keys) const;
+    // Writes every document with the same options. Each result's value is true when the
+    // document was written, false when an NX/XX condition prevented the write.
+    std::map<std::string, BatchResult> set_json_many(const std::map<std::string, json>& documents,
+                                                     const SetOptions& opts = {});
+    // Reads several paths of one document. Results are in the same order as `paths`.
+    std::vector<BatchResult> get_paths(const std::string& key, const std::vector<std::string>& paths) const;
+
     // Path Operations (will be client-side get-modify-set, atomicity lost for SWSS)
     json get_path(const std::string& key, const std::string& path) const;
     void set_path(const std::string& key, const std::string& path,
                   const json& value, const SetOptions& opts = {});
     void del_path(const std::string& key, const std::string& path);
     bool exists_path(const std::string& key, const std::string& path) const;
+    // The same, with a path compiled once by compile_path(): calls in a loop then never parse
+    // it again (in legacy mode the scripts also get its cached pre-tokenised form).
+    CompiledPath compile_path(const std::string& path) const;
+    json get_path(const std::string& key, const CompiledPath& path) const;
+    void set_path(const std::string& key, const CompiledPath& path,
+                  const json& value, const SetOptions& opts = {});
+    void del_path(const std::string& key, const CompiledPath& path);
+    bool exists_path(const std::string& key, const CompiledPath& path) const;
 
     // Numeric Operations
     /**
@@ -188,9 +258,13 @@ public:
     long long json_array_trim(const std::string& key, const std::string& path, long long start_index, long long stop_index);
 
 
-    // Merge Operations (client-side or specific command needed)
-    void merge_json(const std::string& key, const json& patch); // Simplified: deep merge by default client-side
-    void patch_json(const std::string& key, const json& patch_operations); // RFC 6902 JSON Patch, client-side
+    // Merge Operations. In legacy mode with the string layout each runs as one script call
+    // (json_merge_patch, json_patch), atomically. Documents the scripts would not store
+    // unchanged (see scripts_preserve_document) are instead patched on the client and
+    // written back only if unchanged in between, still atomically. Otherwise the document is read, patched on the client and written back.
+    void merge_json(const std::string& key, const json& patch); // RFC 7386 JSON Merge Patch
+    // RFC 6902 JSON Patch. @throws PatchFailedException if an operation fails; the document is then unchanged.
+    void patch_json(const std::string& key, const json& patch_operations);
 
     // Atomic Operations (atomicity will be lost with client-side logic for SWSS)
     json non_atomic_get_set(const std::string& key, const std::string& path,
@@ -200,9 +274,68 @@ public:
 
     // Utility Operations
     std::vector<std::string> keys_by_pattern(const std::string& pattern) const;
+    // Streams the keys matching `pattern` instead of collecting them (see KeyScanner), and
+    // with options.fetch_documents their documents too, read in the same round trips as
+    // the scan. The scanner must not outlive this client.
+    // @throws NotImplementedException in SWSS mode
+    KeyScanner scan_keys(const std::string& pattern, const ScanOptions& options = {}) const;
+    // Calls `visitor` for each key scan_keys() finds, until it returns false.
+    void for_each_key(const std::string& pattern, const std::function<bool(const ScannedKey&)>& visitor,
+                      const ScanOptions& options = {}) const;
     json search_by_value(const std::string& key, const json& search_value) const; // Stays client-side
     std::vector<std::string> get_all_paths(const std::string& key) const; // Stays client-side
 
+    // Bulk Import (legacy mode, see BulkLoader)
+    // Writes every record of an NDJSON or JSON-array stream as a document, as set_json
+    // would (encoding, layout and indexes included) with options.set_options, using
+    // options.threads pipelined batches in parallel. Records that fail are counted in the
+    // result. The client-side cache, if enabled, is cleared.
+    // @throws NotImplementedException in SWSS mode, ArgumentInvalidException if the file
+    //         cannot be opened, and BulkLoader::load's exceptions
+    BulkLoadResult bulk_load(std::istream& input, const BulkLoadOptions& options = {});
+    BulkLoadResult bulk_load_file(const std::string& path, const BulkLoadOptions& options = {});
+
+    // Writes every document whose key matches `pattern` to `output`, streaming it page by
+    // page (see scan_keys) through an ExportWriter. Each document is exported as it is when
+    // its page is read: this is not a point-in-time snapshot of the keyspace.
+    // @throws NotImplementedException in SWSS mode, ArgumentInvalidException if the file
+    //         cannot be opened, RedisJSONException if the output fails, and KeyScanner's
+    //         exceptions
+    ExportResult export_json(const std::string& pattern, std::ostream& output, const ExportOptions& options = {}) const;
+    ExportResult export_json_file(const std::string& pattern, const std::string& path,
+                                  const ExportOptions& options = {}) const;
+
+    // Secondary Indexes (legacy mode, see IndexRegistry)
+    // Registers the index with this client and in Redis (IndexRegistry::DEFINITIONS_KEY)
+    // and, with `backfill` set, indexes the documents that already exist. From then on the
+    // writes of this client keep the index up to date, in the same script call as the
+    // write; other clients do so once they have called load_indexes(). In cluster mode the
+    // key pattern must start with a hash tag ("{fleet}:device:*"), so that the index
+    // lives in the documents' slot.
+    // @throws ArgumentInvalidException (also if another index has the name),
+    //         InvalidPathException, NotImplementedException in SWSS mode
+    void create_index(const IndexDefinition& definition, bool backfill = true);
+    // Unregisters the index and deletes its keys. Returns false if there is no such index.
+    bool drop_index(const std::string& name);
+    // Registers the indexes found in Redis (e.g. created by other clients) with this
+    // client; returns how many there are.
+    size_t load_indexes();
+    std::vector<IndexDefinition> list_indexes() const { return _indexes.definitions(); }
+    const IndexRegistry& indexes() const { return _indexes; }
+    // The keys of the documents whose indexed value equals `value`, sorted.
+    // @throws ArgumentInvalidException for an unknown index
+    std::vector<std::string> index_lookup(const std::string& name, const json& value) const;
+    // The keys of the documents whose indexed number lies between `min` and `max` (a
+    // missing bound is unbounded), in ascending order of the value. NUMERIC indexes only.
+    // @throws ArgumentInvalidException for an unknown or TAG index
+    std::vector<std::string> index_range(const std::string& name, std::optional<double> min,
+                                         std::optional<double> max, bool min_exclusive = false,
+                                         bool max_exclusive = false) const;
+
+    // Statistics of the client-side cache (LegacyClientConfig::enable_client_cache);
+    // all zero when it is disabled.
+    CacheStats client_cache_stats() const;
+
     // Access to sub-components (review if these are still relevant/how they adapt)
     // JSONQueryEngine& query_engine();
     // JSONCache& cache();
@@ -218,6 +351,9 @@ private:
 
     std::unique_ptr<swss::DBConnector> _db_connector; // For SWSS mode
 
+    // Secondary indexes; the script manager passes them to the write scripts
+    IndexRegistry _indexes;
+
     // Keep direct Redis connection management for legacy mode
     std::unique_ptr<RedisConnectionManager> _connection_manager; // For legacy mode
     std::unique_ptr<LuaScriptManager> _lua_script_manager; // For legacy mode, might be conditionally compiled/used
@@ -229,7 +365,11 @@ private:
     // Sub-components that might be removed or heavily adapted for SWSS mode
     // std::unique_ptr<TransactionManager> _transaction_manager;
     // std::unique_ptr<JSONQueryEngine> _query_engine;
-    // std::unique_ptr<JSONCache> _json_cache;
+    std::unique_ptr<JSONCache> _json_cache; // Client-side cache, legacy mode only
+    std::unique_ptr<CacheInvalidationListener> _cache_listener; // Keeps _json_cache coherent
+    // Delta writes: {"sha1", "size", "document"} of the last version written per key
+    // (LegacyClientConfig::delta_write_max_entries)
+    std::unique_ptr<JSONCache> _delta_bases;
     // std::unique_ptr<JSONSchemaValidator> _schema_validator;
     // std::unique_ptr<JSONEventEmitter> _event_emitter;
 
@@ -239,10 +379,65 @@ private:
     // Helper to parse json from string reply, throws on error
     json _parse_json_reply(const std::string& reply_str, const std::string& context_msg) const;
 
+    // Legacy-mode reads straight from Redis, bypassing the client-side cache
+    json _fetch_json(const std::string& key) const;
+    json _fetch_path(const std::string& key, const std::string& path_str) const;
+
     // Client-side implementation for path-based modifications
     json _get_document_for_modification(const std::string& key) const;
     void _set_document_after_modification(const std::string& key, const json& document, const SetOptions& opts);
 
+    // Sends all commands on one pooled connection using hiredis pipelining and returns
+    // their replies in order. A null reply means the connection failed before it was read.
+    std::vector<RedisReplyPtr> _execute_pipeline(const std::vector<std::vector<std::string>>& commands) const;
+    // Sends a single command (binary safe) and returns its reply; throws on connection failure.
+    RedisReplyPtr _execute_command(const std::vector<std::string>& argv) const;
+    // As above, for read-only commands: these may be served by a replica
+    // (LegacyClientConfig::replica_nodes).
+    RedisReplyPtr _execute_read_command(const std::vector<std::string>& argv) const;
+    std::vector<RedisReplyPtr> _execute_read_pipeline(const std::vector<std::vector<std::string>>& commands) const;
+    // Pipelined EVALSHA commands answered NOSCRIPT did not run: reloads the built-in
+    // `scripts` they call and resends those commands once, replacing their replies.
+    void _resend_noscript_commands(const std::vector<std::vector<std::string>>& commands,
+                                   std::vector<RedisReplyPtr>& replies,
+                                   const std::vector<std::string>& scripts) const;
+
+    // Hash document layout (LegacyClientConfig::document_layout == DocumentLayout::HASH)
+    bool _is_hash_layout() const;
+    // Arguments for a built-in script acting on `path`: {path, rest...}, or in the hash
+    // layout {member, path within the member, rest...}. In the hash layout the root
+    // cannot be addressed by a script and InvalidPathException is thrown. Paths are passed
+    // pre-tokenised where possible (PathParser::script_path_argument).
+    std::vector<std::string> _script_args(const std::string& path, std::vector<std::string> rest = {}) const;
+    // Builds the document from an HGETALL reply; an empty hash means the key does not exist.
+    json _decode_hash_document(const std::string& key, redisReply* reply) const;
+    // Arguments of the json_hash_set_document script, which replaces a whole document
+    // in the hash layout. Throws ArgumentInvalidException if `document` is not an object.
+    std::vector<std::string> _hash_set_document_args(const json& document, const SetOptions& opts) const;
+    // The command writing a whole document as set_json does, for pipelines: SET, or a
+    // write script in the hash layout and for keys covered by an index.
+    std::vector<std::string> _set_document_command(const std::string& key, const json& document,
+                                                   const SetOptions& opts) const;
+
+    // Delta writes: sends the patch from the remembered version of `key` to the
+    // json_delta_set script. False (nothing written) if there is no usable version, the
+    // patch is not worth it or the stored value has changed since.
+    bool _set_json_delta(const std::string& key, const json& document, const SetOptions& opts);
+    // Remembers `document`, stored as `encoded`, as the version of `key` for delta writes.
+    void _remember_delta_base(const std::string& key, const json& document, const std::string& encoded,
+                              const SetOptions& opts);
+
+    // Reads the stored document of `key` (string layout; `missing_document` if there is
+    // none), applies `modify` and stores the result with json_replace_if_unchanged. Reads
+    // it again if another write came in between.
+    // @throws OperationAbortedException if that keeps happening.
+    void _modify_stored_document(const std::string& key, const json& missing_document,
+                                 const std::function<json(json)>& modify);
+
+    // Client-side cache: true if reads of `key` may be served from and stored in
+    // _json_cache (cache enabled, invalidations subscribed, key under a tracked prefix).
+    bool _cache_usable(const std::string& key) const;
+
     // Helper to check if in legacy mode with Lua support
     void throwIfNotLegacyWithLua(const std::string& operation_name) const;
 
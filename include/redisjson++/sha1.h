@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+namespace redisjson {
+
+// Computes the SHA1 digest of `data` as 40 lowercase hex characters.
+// This matches the digest Redis uses to identify Lua scripts (SCRIPT LOAD / EVALSHA)
+// and the output of redis.sha1hex() inside scripts, so script SHAs can be derived
+// locally without a SCRIPT LOAD round trip.
+std::string sha1_hex(const std::string& data);
+
+} // namespace redisjson
@@ -0,0 +1,694 @@
+#include "redisjson++/async_redis_json_client.h"
+#include "redisjson++/lua_script_manager.h" // For built-in script bodies and reply conversion
+#include "redisjson++/sha1.h"
+#include "redisjson++/document_codec.h"
+#include "redisjson++/path_parser.h"
+
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+namespace redisjson {
+
+struct AsyncRedisJSONClient::PendingRequest {
+    AsyncRedisJSONClient* client;
+    ReplyHandler handler;
+};
+
+namespace {
+
+// Runs `produce` and hands its result (or the exception it threw) to the callback.
+template <typename Produce>
+void deliver(const AsyncRedisJSONClient::Callback& callback, Produce&& produce) {
+    json result;
+    try {
+        result = produce();
+    } catch (...) {
+        callback(json(nullptr), std::current_exception());
+        return;
+    }
+    callback(std::move(result), nullptr);
+}
+
+AsyncRedisJSONClient::Callback json_promise_callback(std::shared_ptr<std::promise<json>> promise) {
+    return [promise](json result, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(result));
+        }
+    };
+}
+
+AsyncRedisJSONClient::Callback void_promise_callback(std::shared_ptr<std::promise<void>> promise) {
+    return [promise](json, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value();
+        }
+    };
+}
+
+void check_reply(redisReply* reply, const std::string& command, const std::string& key) {
+    if (!reply) {
+        throw ConnectionException("No reply for " + command + " on key '" + key + "' (connection lost or not established)");
+    }
+    if (reply->type == REDIS_REPLY_ERROR) {
+        throw RedisCommandException(command, "Key: " + key + ", Error: " + std::string(reply->str, reply->len));
+    }
+}
+
+bool is_root_path(const std::string& path) {
+    return path == "$" || path == ".";
+}
+
+std::string condition_arg(SetCmdCondition condition) {
+    switch (condition) {
+        case SetCmdCondition::NX: return "NX";
+        case SetCmdCondition::XX: return "XX";
+        default: return "NONE";
+    }
+}
+
+// Builds a document stored in the hash layout from an HGETALL reply.
+json decode_hash_document(redisReply* reply, const std::string& key, DocumentEncoding encoding) {
+    check_reply(reply, "HGETALL", key);
+    if (reply->type != REDIS_REPLY_ARRAY) {
+        throw RedisCommandException("HGETALL", "Key: " + key + ", Error: Unexpected reply type " + std::to_string(reply->type));
+    }
+    if (reply->elements == 0) {
+        throw PathNotFoundException(key, "$ (root)");
+    }
+    json document = json::object();
+    for (size_t i = 0; i + 1 < reply->elements; i += 2) {
+        std::string field(reply->element[i]->str, reply->element[i]->len);
+        document[field] = decode_document(std::string(reply->element[i + 1]->str, reply->element[i + 1]->len), encoding,
+                                          "HGETALL for key '" + key + "', field '" + field + "'");
+    }
+    return document;
+}
+
+} // namespace
+
+AsyncRedisJSONClient::AsyncRedisJSONClient(const LegacyClientConfig& config) : config_(config) {
+    if (pipe(wakeup_fds_) != 0) {
+        throw ConnectionException("Failed to create event loop wakeup pipe: " + std::string(strerror(errno)));
+    }
+    for (int fd : wakeup_fds_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    loop_thread_ = std::thread(&AsyncRedisJSONClient::run_loop, this);
+}
+
+AsyncRedisJSONClient::~AsyncRedisJSONClient() {
+    stopping_ = true;
+    post([this] { drop_connection(); });
+    if (loop_thread_.joinable()) {
+        loop_thread_.join();
+    }
+    // Requests submitted while the loop was shutting down never reached a connection.
+    std::deque<std::function<void()>> leftover;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        leftover.swap(tasks_);
+    }
+    for (auto& task : leftover) {
+        task();
+    }
+    close(wakeup_fds_[0]);
+    close(wakeup_fds_[1]);
+}
+
+// --- Event loop ---
+
+void AsyncRedisJSONClient::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    char byte = 1;
+    ssize_t ignored = write(wakeup_fds_[1], &byte, 1); // A full pipe already guarantees a wakeup
+    (void)ignored;
+}
+
+void AsyncRedisJSONClient::fail(Callback callback, std::exception_ptr error) {
+    post([callback = std::move(callback), error] { callback(json(nullptr), error); });
+}
+
+void AsyncRedisJSONClient::run_loop() {
+    connect_if_needed();
+    while (true) {
+        std::deque<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex_);
+            tasks.swap(tasks_);
+        }
+        for (auto& task : tasks) {
+            task();
+        }
+        if (stopping_ && !context_) {
+            break;
+        }
+
+        pollfd fds[2];
+        nfds_t nfds = 1;
+        fds[0] = {wakeup_fds_[0], POLLIN, 0};
+        if (context_) {
+            short events = (want_read_ ? POLLIN : 0) | (want_write_ ? POLLOUT : 0);
+            fds[1] = {context_->c.fd, events, 0};
+            nfds = 2;
+        }
+
+        int timeout_ms = 100; // Upper bound so reconnects are retried without activity
+        auto now = std::chrono::steady_clock::now();
+        if (timer_armed_) {
+            auto until_deadline = std::chrono::duration_cast<std::chrono::milliseconds>(timer_deadline_ - now).count();
+            timeout_ms = static_cast<int>(std::max<long long>(0, std::min<long long>(timeout_ms, until_deadline)));
+        }
+        if (poll(fds, nfds, timeout_ms) < 0) {
+            if (errno != EINTR) {
+                // The connection's state is unknown: drop it, which fails its outstanding
+                // callbacks with ConnectionException, and reconnect after the usual backoff.
+                drop_connection();
+                std::this_thread::sleep_for(config_.retry_backoff_start);
+            }
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char buffer[256];
+            while (read(wakeup_fds_[0], buffer, sizeof(buffer)) > 0) {
+            }
+        }
+        if (context_ && nfds == 2) {
+            if (fds[1].revents & (POLLIN | POLLERR | POLLHUP)) {
+                redisAsyncHandleRead(context_);
+            }
+            if (context_ && (fds[1].revents & POLLOUT)) {
+                redisAsyncHandleWrite(context_);
+            }
+        }
+        if (context_ && timer_armed_ && std::chrono::steady_clock::now() >= timer_deadline_) {
+            timer_armed_ = false;
+            redisAsyncHandleTimeout(context_);
+        }
+        if (!context_) {
+            connect_if_needed();
+        }
+    }
+}
+
+void AsyncRedisJSONClient::drop_connection() {
+    if (context_) {
+        // Outstanding callbacks are invoked with a null reply and fail with ConnectionException.
+        redisAsyncFree(context_);
+        context_ = nullptr;
+        connected_ = false;
+        want_read_ = want_write_ = timer_armed_ = false;
+    }
+}
+
+void AsyncRedisJSONClient::connect_if_needed() {
+    if (context_ || stopping_) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_connect_attempt_) {
+        return;
+    }
+    next_connect_attempt_ = now + config_.retry_backoff_start;
+
+    redisAsyncContext* context = redisAsyncConnect(config_.host.c_str(), config_.port);
+    if (!context) {
+        return;
+    }
+    if (context->err) {
+        redisAsyncFree(context);
+        return;
+    }
+    context->data = this;
+    // Event hooks must be in place before the connect callback, which registers the
+    // first write event used to detect connection completion.
+    context->ev.data = this;
+    context->ev.addRead = &AsyncRedisJSONClient::ev_add_read;
+    context->ev.delRead = &AsyncRedisJSONClient::ev_del_read;
+    context->ev.addWrite = &AsyncRedisJSONClient::ev_add_write;
+    context->ev.delWrite = &AsyncRedisJSONClient::ev_del_write;
+    context->ev.cleanup = &AsyncRedisJSONClient::ev_cleanup;
+    context->ev.scheduleTimer = &AsyncRedisJSONClient::ev_schedule_timer;
+    context_ = context;
+    redisAsyncSetConnectCallback(context, &AsyncRedisJSONClient::on_connect);
+    redisAsyncSetDisconnectCallback(context, &AsyncRedisJSONClient::on_disconnect);
+
+    if (config_.timeout.count() > 0) {
+        struct timeval tv;
+        tv.tv_sec = config_.timeout.count() / 1000;
+        tv.tv_usec = (config_.timeout.count() % 1000) * 1000;
+        redisAsyncSetTimeout(context, tv);
+    }
+
+    // Queued ahead of any user command, so they complete before it is processed.
+    if (!config_.password.empty()) {
+        send({"AUTH", config_.password}, [this](redisReply* reply) {
+            if (reply && reply->type == REDIS_REPLY_ERROR && context_) {
+                redisAsyncDisconnect(context_);
+            }
+        });
+    }
+    if (config_.database != 0) {
+        send({"SELECT", std::to_string(config_.database)}, [this](redisReply* reply) {
+            if (reply && reply->type == REDIS_REPLY_ERROR && context_) {
+                redisAsyncDisconnect(context_);
+            }
+        });
+    }
+}
+
+void AsyncRedisJSONClient::send(std::vector<std::string> argv, ReplyHandler handler) {
+    if (!context_) {
+        handler(nullptr);
+        return;
+    }
+    std::vector<const char*> argv_c;
+    std::vector<size_t> argv_len;
+    argv_c.reserve(argv.size());
+    argv_len.reserve(argv.size());
+    for (const auto& arg : argv) {
+        argv_c.push_back(arg.data());
+        argv_len.push_back(arg.size());
+    }
+
+    auto* request = new PendingRequest{this, std::move(handler)};
+    ++pending_count_;
+    if (redisAsyncCommandArgv(context_, &AsyncRedisJSONClient::on_reply, request,
+                              static_cast<int>(argv_c.size()), argv_c.data(), argv_len.data()) != REDIS_OK) {
+        --pending_count_;
+        ReplyHandler failed = std::move(request->handler);
+        delete request;
+        failed(nullptr);
+    }
+}
+
+void AsyncRedisJSONClient::on_reply(redisAsyncContext*, void* reply, void* privdata) {
+    auto* request = static_cast<PendingRequest*>(privdata);
+    --request->client->pending_count_;
+    try {
+        request->handler(static_cast<redisReply*>(reply));
+    } catch (...) {
+        // Never let an exception unwind through hiredis.
+    }
+    delete request;
+}
+
+void AsyncRedisJSONClient::on_connect(const redisAsyncContext* context, int status) {
+    auto* self = static_cast<AsyncRedisJSONClient*>(context->data);
+    if (status != REDIS_OK) {
+        // hiredis frees the context after this callback returns.
+        self->context_ = nullptr;
+        self->connected_ = false;
+        self->want_read_ = self->want_write_ = self->timer_armed_ = false;
+        return;
+    }
+    self->connected_ = true;
+}
+
+void AsyncRedisJSONClient::on_disconnect(const redisAsyncContext* context, int) {
+    auto* self = static_cast<AsyncRedisJSONClient*>(context->data);
+    self->context_ = nullptr;
+    self->connected_ = false;
+    self->want_read_ = self->want_write_ = self->timer_armed_ = false;
+}
+
+void AsyncRedisJSONClient::ev_add_read(void* privdata) { static_cast<AsyncRedisJSONClient*>(privdata)->want_read_ = true; }
+void AsyncRedisJSONClient::ev_del_read(void* privdata) { static_cast<AsyncRedisJSONClient*>(privdata)->want_read_ = false; }
+void AsyncRedisJSONClient::ev_add_write(void* privdata) { static_cast<AsyncRedisJSONClient*>(privdata)->want_write_ = true; }
+void AsyncRedisJSONClient::ev_del_write(void* privdata) { static_cast<AsyncRedisJSONClient*>(privdata)->want_write_ = false; }
+
+void AsyncRedisJSONClient::ev_cleanup(void* privdata) {
+    auto* self = static_cast<AsyncRedisJSONClient*>(privdata);
+    self->want_read_ = self->want_write_ = self->timer_armed_ = false;
+}
+
+void AsyncRedisJSONClient::ev_schedule_timer(void* privdata, struct timeval tv) {
+    auto* self = static_cast<AsyncRedisJSONClient*>(privdata);
+    self->timer_deadline_ = std::chrono::steady_clock::now() +
+                            std::chrono::seconds(tv.tv_sec) + std::chrono::microseconds(tv.tv_usec);
+    self->timer_armed_ = true;
+}
+
+// --- Scripts ---
+
+void AsyncRedisJSONClient::register_script(const std::string& name, const std::string& body) {
+    if (name.empty() || body.empty()) {
+        throw ArgumentInvalidException("Script name and body cannot be empty.");
+    }
+    std::lock_guard<std::mutex> lock(scripts_mutex_);
+    scripts_[name] = Script{name, body, sha1_hex(body)};
+}
+
+AsyncRedisJSONClient::Script AsyncRedisJSONClient::find_script(const std::string& name) {
+    {
+        std::lock_guard<std::mutex> lock(scripts_mutex_);
+        auto it = scripts_.find(name);
+        if (it != scripts_.end()) {
+            return it->second;
+        }
+    }
+    std::string body = LuaScriptManager::get_builtin_script(name, config_.document_encoding, config_.document_layout);
+    if (body.empty()) {
+        throw LuaScriptException(name, "Script not found: " + name);
+    }
+    Script script{name, body, sha1_hex(body)};
+    std::lock_guard<std::mutex> lock(scripts_mutex_);
+    scripts_.emplace(name, script);
+    return script;
+}
+
+void AsyncRedisJSONClient::send_script(const Script& script, std::vector<std::string> keys,
+                                       std::vector<std::string> args, Callback callback) {
+    std::vector<std::string> argv = {"EVALSHA", script.sha, std::to_string(keys.size())};
+    argv.insert(argv.end(), keys.begin(), keys.end());
+    argv.insert(argv.end(), args.begin(), args.end());
+
+    auto finish = [name = script.name, callback](redisReply* reply) {
+        deliver(callback, [&]() -> json {
+            if (!reply) {
+                throw ConnectionException("No reply for script '" + name + "' (connection lost or not established)");
+            }
+            if (reply->type == REDIS_REPLY_ERROR) {
+                throw LuaScriptException(name, std::string(reply->str, reply->len));
+            }
+            return LuaScriptManager::redis_reply_to_json(reply);
+        });
+    };
+
+    send(argv, [this, argv, body = script.body, finish](redisReply* reply) {
+        if (reply && reply->type == REDIS_REPLY_ERROR && strncmp(reply->str, "NOSCRIPT", 8) == 0) {
+            // The server does not know the script (first use or SCRIPT FLUSH): EVAL caches it.
+            std::vector<std::string> eval_argv = argv;
+            eval_argv[0] = "EVAL";
+            eval_argv[1] = body;
+            send(std::move(eval_argv), finish);
+            return;
+        }
+        finish(reply);
+    });
+}
+
+void AsyncRedisJSONClient::execute_script(const std::string& name, const std::vector<std::string>& keys,
+                                          const std::vector<std::string>& args, Callback callback) {
+    Script script;
+    try {
+        script = find_script(name);
+    } catch (...) {
+        fail(std::move(callback), std::current_exception());
+        return;
+    }
+    post([this, script = std::move(script), keys, args, callback = std::move(callback)]() mutable {
+        send_script(script, std::move(keys), std::move(args), std::move(callback));
+    });
+}
+
+std::future<json> AsyncRedisJSONClient::execute_script(const std::string& name, const std::vector<std::string>& keys,
+                                                       const std::vector<std::string>& args) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    execute_script(name, keys, args, json_promise_callback(promise));
+    return future;
+}
+
+std::vector<std::string> AsyncRedisJSONClient::script_args(const std::string& path, std::vector<std::string> rest) const {
+    std::vector<std::string> args;
+    args.reserve(rest.size() + 2);
+    if (hash_layout()) {
+        auto [member, sub_path] = PathParser::split_top_level(path);
+        if (member.empty()) {
+            throw InvalidPathException("Path '" + path + "' addresses the document root, which is not supported here in the hash layout");
+        }
+        args.push_back(std::move(member));
+        args.push_back(sub_path.empty() ? "$" : PathParser::script_path_argument(sub_path));
+    } else {
+        args.push_back(PathParser::script_path_argument(path));
+    }
+    args.insert(args.end(), std::make_move_iterator(rest.begin()), std::make_move_iterator(rest.end()));
+    return args;
+}
+
+void AsyncRedisJSONClient::execute_path_script(const std::string& name, const std::string& key, const std::string& path,
+                                               std::vector<std::string> rest, Callback callback) {
+    std::vector<std::string> args;
+    try {
+        args = script_args(path, std::move(rest));
+    } catch (...) {
+        fail(std::move(callback), std::current_exception());
+        return;
+    }
+    execute_script(name, {key}, args, std::move(callback));
+}
+
+void AsyncRedisJSONClient::command(std::vector<std::string> argv, Callback callback) {
+    post([this, argv = std::move(argv), callback = std::move(callback)]() mutable {
+        std::string command_name = argv.empty() ? "" : argv[0];
+        send(std::move(argv), [command_name, callback](redisReply* reply) {
+            deliver(callback, [&]() -> json {
+                if (!reply) {
+                    throw ConnectionException("No reply for " + command_name + " (connection lost or not established)");
+                }
+                if (reply->type == REDIS_REPLY_ERROR) {
+                    throw RedisCommandException(command_name, std::string(reply->str, reply->len));
+                }
+                return LuaScriptManager::redis_reply_to_json(reply);
+            });
+        });
+    });
+}
+
+// --- Document Operations ---
+
+void AsyncRedisJSONClient::get_json(const std::string& key, Callback callback) {
+    if (hash_layout()) {
+        post([this, key, callback = std::move(callback)] {
+            send({"HGETALL", key}, [key, callback, encoding = config_.document_encoding](redisReply* reply) {
+                deliver(callback, [&]() -> json { return decode_hash_document(reply, key, encoding); });
+            });
+        });
+        return;
+    }
+    post([this, key, callback = std::move(callback)] {
+        send({"GET", key}, [key, callback, encoding = config_.document_encoding](redisReply* reply) {
+            deliver(callback, [&]() -> json {
+                check_reply(reply, "GET", key);
+                if (reply->type == REDIS_REPLY_NIL) {
+                    throw PathNotFoundException(key, "$ (root)");
+                }
+                if (reply->type != REDIS_REPLY_STRING) {
+                    throw RedisCommandException("GET", "Key: " + key + ", Error: Unexpected reply type " + std::to_string(reply->type));
+                }
+                return decode_document(std::string(reply->str, reply->len), encoding, "GET for key '" + key + "'");
+            });
+        });
+    });
+}
+
+std::future<json> AsyncRedisJSONClient::get_json(const std::string& key) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    get_json(key, json_promise_callback(promise));
+    return future;
+}
+
+void AsyncRedisJSONClient::set_json(const std::string& key, const json& document, const SetOptions& opts, Callback callback) {
+    if (hash_layout()) {
+        // The leading empty argument is the (unused) member consumed by the storage prelude.
+        std::vector<std::string> args = {"", condition_arg(opts.condition), std::to_string(opts.ttl.count())};
+        try {
+            std::vector<std::string> fields = encode_document_fields(document, config_.document_encoding);
+            args.insert(args.end(), std::make_move_iterator(fields.begin()), std::make_move_iterator(fields.end()));
+        } catch (...) {
+            fail(std::move(callback), std::current_exception());
+            return;
+        }
+        execute_script("json_hash_set_document", {key}, args, [callback](json, std::exception_ptr error) {
+            callback(json(nullptr), error); // 0 means an NX/XX condition was not met
+        });
+        return;
+    }
+    std::vector<std::string> argv = {"SET", key};
+    try {
+        argv.push_back(encode_document(document, config_.document_encoding));
+    } catch (...) {
+        fail(std::move(callback), std::current_exception());
+        return;
+    }
+    if (opts.ttl.count() > 0) {
+        argv.push_back("EX");
+        argv.push_back(std::to_string(opts.ttl.count()));
+    }
+    if (opts.condition == SetCmdCondition::NX) {
+        argv.push_back("NX");
+    } else if (opts.condition == SetCmdCondition::XX) {
+        argv.push_back("XX");
+    }
+    post([this, key, argv = std::move(argv), callback = std::move(callback)]() mutable {
+        send(std::move(argv), [key, callback](redisReply* reply) {
+            deliver(callback, [&]() -> json {
+                check_reply(reply, "SET", key);
+                return json(nullptr); // NIL means an NX/XX condition was not met, as in RedisJSONClient
+            });
+        });
+    });
+}
+
+std::future<void> AsyncRedisJSONClient::set_json(const std::string& key, const json& document, const SetOptions& opts) {
+    auto promise = std::make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    set_json(key, document, opts, void_promise_callback(promise));
+    return future;
+}
+
+void AsyncRedisJSONClient::del_json(const std::string& key, Callback callback) {
+    post([this, key, callback = std::move(callback)] {
+        send({"DEL", key}, [key, callback](redisReply* reply) {
+            deliver(callback, [&]() -> json {
+                check_reply(reply, "DEL", key);
+                return json(nullptr);
+            });
+        });
+    });
+}
+
+std::future<void> AsyncRedisJSONClient::del_json(const std::string& key) {
+    auto promise = std::make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    del_json(key, void_promise_callback(promise));
+    return future;
+}
+
+// --- Path Operations ---
+
+void AsyncRedisJSONClient::get_path(const std::string& key, const std::string& path, Callback callback) {
+    if (is_root_path(path)) {
+        get_json(key, std::move(callback));
+        return;
+    }
+    if (hash_layout()) {
+        std::pair<std::string, std::string> parts;
+        try {
+            parts = PathParser::split_top_level(path);
+        } catch (...) {
+            fail(std::move(callback), std::current_exception());
+            return;
+        }
+        if (parts.second.empty()) {
+            // A top-level member is one hash field; wrap it like the script result.
+            post([this, key, path, field = parts.first, callback = std::move(callback)] {
+                send({"HGET", key, field}, [key, path, callback, encoding = config_.document_encoding](redisReply* reply) {
+                    deliver(callback, [&]() -> json {
+                        check_reply(reply, "HGET", key);
+                        if (reply->type == REDIS_REPLY_NIL) {
+                            throw PathNotFoundException(key, path);
+                        }
+                        if (reply->type != REDIS_REPLY_STRING) {
+                            throw RedisCommandException("HGET", "Key: " + key + ", Error: Unexpected reply type " + std::to_string(reply->type));
+                        }
+                        return json::array({decode_document(std::string(reply->str, reply->len), encoding,
+                                                            "HGET for key '" + key + "', path '" + path + "'")});
+                    });
+                });
+            });
+            return;
+        }
+    }
+    execute_path_script("json_path_get", key, path, {}, [key, path, callback](json result, std::exception_ptr error) {
+        if (!error && result.is_array() && result.empty()) {
+            error = std::make_exception_ptr(PathNotFoundException(key, path));
+        }
+        callback(std::move(result), error);
+    });
+}
+
+std::future<json> AsyncRedisJSONClient::get_path(const std::string& key, const std::string& path) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    get_path(key, path, json_promise_callback(promise));
+    return future;
+}
+
+void AsyncRedisJSONClient::set_path(const std::string& key, const std::string& path, const json& value,
+                                    const SetOptions& opts, Callback callback) {
+    if (is_root_path(path)) {
+        set_json(key, value, opts, std::move(callback));
+        return;
+    }
+    execute_path_script("json_path_set", key, path,
+                        {value.dump(), condition_arg(opts.condition), std::to_string(opts.ttl.count()), opts.create_path ? "true" : "false"},
+                        std::move(callback));
+}
+
+std::future<void> AsyncRedisJSONClient::set_path(const std::string& key, const std::string& path, const json& value,
+                                                 const SetOptions& opts) {
+    auto promise = std::make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    set_path(key, path, value, opts, void_promise_callback(promise));
+    return future;
+}
+
+// --- Array Operations ---
+
+void AsyncRedisJSONClient::append_path(const std::string& key, const std::string& path, const json& value, Callback callback) {
+    execute_path_script("json_array_append", key, path, {value.dump()}, std::move(callback));
+}
+
+std::future<void> AsyncRedisJSONClient::append_path(const std::string& key, const std::string& path, const json& value) {
+    auto promise = std::make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    append_path(key, path, value, void_promise_callback(promise));
+    return future;
+}
+
+void AsyncRedisJSONClient::pop_path(const std::string& key, const std::string& path, int index, Callback callback) {
+    execute_path_script("json_array_pop", key, path, {std::to_string(index)},
+                        [key, path, callback](json result, std::exception_ptr error) {
+        if (!error && result.is_null()) {
+            error = std::make_exception_ptr(PathNotFoundException(key, path));
+        }
+        callback(std::move(result), error);
+    });
+}
+
+std::future<json> AsyncRedisJSONClient::pop_path(const std::string& key, const std::string& path, int index) {
+    auto promise = std::make_shared<std::promise<json>>();
+    auto future = promise->get_future();
+    pop_path(key, path, index, json_promise_callback(promise));
+    return future;
+}
+
+void AsyncRedisJSONClient::array_length(const std::string& key, const std::string& path, Callback callback) {
+    execute_path_script("json_array_length", key, path, {}, [key, path, callback](json result, std::exception_ptr error) {
+        if (!error && result.is_null()) {
+            error = std::make_exception_ptr(PathNotFoundException(key, path));
+        } else if (!error && (!result.is_number_integer() || result.get<long long>() < 0)) {
+            error = std::make_exception_ptr(RedisCommandException("LUA_json_array_length", "Unexpected result: " + result.dump()));
+        }
+        callback(std::move(result), error);
+    });
+}
+
+std::future<size_t> AsyncRedisJSONClient::array_length(const std::string& key, const std::string& path) {
+    auto promise = std::make_shared<std::promise<size_t>>();
+    auto future = promise->get_future();
+    array_length(key, path, [promise](json result, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(result.get<size_t>());
+        }
+    });
+    return future;
+}
+
+} // namespace redisjson
@@ -0,0 +1,334 @@
+#include "redisjson++/bulk_loader.h"
+#include "redisjson++/exceptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace redisjson {
+
+namespace {
+
+constexpr int END_OF_INPUT = std::char_traits<char>::eof();
+
+bool is_space(int c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+struct RecordBatch {
+    size_t first_record = 1; // 1-based, for error messages
+    std::vector<std::string> records;
+};
+
+} // namespace
+
+BulkRecordReader::BulkRecordReader(std::istream& input, BulkFormat format)
+    : input_(input), format_(format) {}
+
+int BulkRecordReader::read_char() {
+    int c = input_.rdbuf()->sbumpc();
+    if (c != END_OF_INPUT) ++bytes_read_;
+    return c;
+}
+
+int BulkRecordReader::skip_whitespace() {
+    int c = read_char();
+    while (is_space(c)) c = read_char();
+    return c;
+}
+
+bool BulkRecordReader::next(std::string& record) {
+    record.clear();
+    if (format_ == BulkFormat::AUTO) {
+        std::streambuf* buffer = input_.rdbuf();
+        int c = buffer->sgetc();
+        while (is_space(c)) {
+            buffer->sbumpc();
+            ++bytes_read_;
+            c = buffer->sgetc();
+        }
+        format_ = c == '[' ? BulkFormat::JSON_ARRAY : BulkFormat::NDJSON;
+    }
+
+    if (format_ == BulkFormat::NDJSON) {
+        std::string line;
+        while (std::getline(input_, line)) {
+            bytes_read_ += line.size() + 1;
+            if (std::any_of(line.begin(), line.end(), [](char c) { return !is_space(static_cast<unsigned char>(c)); })) {
+                record = std::move(line);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (array_finished_) {
+        return false;
+    }
+    int c = skip_whitespace();
+    if (!array_started_) {
+        if (c != '[') {
+            throw JsonParsingException("Bulk input must be a JSON array");
+        }
+        array_started_ = true;
+        c = skip_whitespace();
+    }
+    if (c == ']') {
+        array_finished_ = true;
+        return false;
+    }
+    if (after_element_) {
+        if (c != ',') {
+            throw JsonParsingException("Expected ',' or ']' after element at byte " + std::to_string(bytes_read_));
+        }
+        c = skip_whitespace();
+    }
+    if (c == END_OF_INPUT) {
+        throw JsonParsingException("Unterminated JSON array");
+    }
+
+    // One element: a container up to its matching bracket, a string up to its closing
+    // quote, or a scalar up to the next separator.
+    after_element_ = true;
+    int depth = 0;
+    bool in_string = false;
+    bool escaped = false;
+    bool scalar = c != '{' && c != '[' && c != '"';
+    while (true) {
+        record.push_back(static_cast<char>(c));
+        if (in_string) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                in_string = false;
+            }
+        } else if (c == '"') {
+            in_string = true;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+        if (scalar) {
+            int next_char = input_.rdbuf()->sgetc();
+            if (next_char == ',' || next_char == ']' || is_space(next_char) || next_char == END_OF_INPUT) {
+                return true;
+            }
+        } else if (!in_string && depth == 0) {
+            return true;
+        }
+        c = read_char();
+        if (c == END_OF_INPUT) {
+            throw JsonParsingException("Unterminated JSON array");
+        }
+    }
+}
+
+BulkLoader::BulkLoader(PipelineExecutor executor, CommandBuilder builder, BulkLoadOptions options)
+    : executor_(std::move(executor)), builder_(std::move(builder)), options_(std::move(options)) {
+    if (options_.key_field.empty()) {
+        throw ArgumentInvalidException("BulkLoadOptions::key_field must not be empty");
+    }
+}
+
+std::pair<std::string, json> BulkLoader::parse_record(const std::string& text, const BulkLoadOptions& options) {
+    json record;
+    try {
+        record = json::parse(text);
+    } catch (const json::parse_error& e) {
+        throw JsonParsingException(e.what());
+    }
+    if (!record.is_object()) {
+        throw ArgumentInvalidException("Record is not a JSON object");
+    }
+    auto key_it = record.find(options.key_field);
+    if (key_it == record.end()) {
+        throw ArgumentInvalidException("Record has no '" + options.key_field + "' member");
+    }
+    std::string key;
+    if (key_it->is_string()) {
+        key = options.key_prefix + key_it->get<std::string>();
+    } else if (key_it->is_number_integer()) {
+        key = options.key_prefix + key_it->dump();
+    } else {
+        throw ArgumentInvalidException("Record member '" + options.key_field + "' must be a string or an integer");
+    }
+    if (options.value_field.empty()) {
+        return {std::move(key), std::move(record)};
+    }
+    auto value_it = record.find(options.value_field);
+    if (value_it == record.end()) {
+        throw ArgumentInvalidException("Record has no '" + options.value_field + "' member");
+    }
+    return {std::move(key), std::move(*value_it)};
+}
+
+BulkLoadResult BulkLoader::load(std::istream& input) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t batch_size = std::max<size_t>(options_.batch_size, 1);
+    const size_t max_queued = std::max<size_t>(options_.max_queued_batches, 1);
+    const size_t thread_count = std::max<size_t>(options_.threads, 1);
+    const auto interval = std::max(options_.progress_interval, std::chrono::milliseconds(10));
+
+    BulkRecordReader reader(input, options_.format);
+    std::mutex mutex;
+    std::condition_variable queue_changed;
+    std::deque<RecordBatch> queue;
+    bool reading_done = false;
+    size_t active_workers = thread_count;
+    std::exception_ptr failure;
+    std::vector<std::string> error_messages;
+    std::atomic<size_t> written{0}, skipped{0}, errors{0};
+    size_t records_read = 0;
+
+    auto record_error = [&](size_t record, const std::string& message) {
+        ++errors;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error_messages.size() < options_.max_error_messages) {
+            error_messages.push_back("Record " + std::to_string(record) + ": " + message);
+        }
+    };
+
+    auto work = [&]() {
+        while (true) {
+            RecordBatch batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queue_changed.wait(lock, [&] { return !queue.empty() || reading_done || failure; });
+                if (failure || queue.empty()) break;
+                batch = std::move(queue.front());
+                queue.pop_front();
+            }
+            queue_changed.notify_all();
+
+            std::vector<std::vector<std::string>> commands;
+            std::vector<size_t> record_numbers;
+            commands.reserve(batch.records.size());
+            record_numbers.reserve(batch.records.size());
+            for (size_t i = 0; i < batch.records.size(); ++i) {
+                try {
+                    auto [key, document] = parse_record(batch.records[i], options_);
+                    commands.push_back(builder_(key, document));
+                    record_numbers.push_back(batch.first_record + i);
+                } catch (const std::exception& e) {
+                    record_error(batch.first_record + i, e.what());
+                }
+            }
+            if (commands.empty()) continue;
+
+            std::vector<RedisReplyPtr> replies;
+            try {
+                replies = executor_(commands);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure) failure = std::current_exception();
+                break;
+            }
+            for (size_t i = 0; i < commands.size(); ++i) {
+                redisReply* reply = i < replies.size() ? replies[i].get() : nullptr;
+                if (!reply) {
+                    record_error(record_numbers[i], "No reply or connection error");
+                } else if (reply->type == REDIS_REPLY_ERROR) {
+                    record_error(record_numbers[i], std::string(reply->str, reply->len));
+                } else if (reply->type == REDIS_REPLY_NIL || (reply->type == REDIS_REPLY_INTEGER && reply->integer == 0)) {
+                    ++skipped; // NX/XX condition not met
+                } else {
+                    ++written;
+                }
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --active_workers;
+        }
+        queue_changed.notify_all();
+    };
+
+    auto snapshot = [&]() {
+        BulkLoadProgress progress;
+        progress.records_read = records_read;
+        progress.documents_written = written;
+        progress.skipped = skipped;
+        progress.errors = errors;
+        progress.bytes_read = reader.bytes_read();
+        progress.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        return progress;
+    };
+    auto last_report = start;
+    auto report_if_due = [&]() {
+        auto now = std::chrono::steady_clock::now();
+        if (options_.progress && now - last_report >= interval) {
+            last_report = now;
+            options_.progress(snapshot());
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.emplace_back(work);
+    }
+
+    try {
+        RecordBatch batch;
+        batch.records.reserve(batch_size);
+        std::string record;
+        bool stopped = false;
+        while (!stopped && reader.next(record)) {
+            ++records_read;
+            batch.records.push_back(std::move(record));
+            if (batch.records.size() == batch_size) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    queue_changed.wait(lock, [&] { return queue.size() < max_queued || failure; });
+                    stopped = static_cast<bool>(failure);
+                    queue.push_back(std::move(batch));
+                }
+                queue_changed.notify_all();
+                batch = RecordBatch{records_read + 1, {}};
+                batch.records.reserve(batch_size);
+            }
+            report_if_due();
+        }
+        if (!batch.records.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(batch));
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failure) failure = std::current_exception();
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        reading_done = true;
+        queue_changed.notify_all();
+        while (active_workers > 0) {
+            queue_changed.wait_for(lock, interval);
+            lock.unlock();
+            report_if_due();
+            lock.lock();
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    BulkLoadResult result;
+    static_cast<BulkLoadProgress&>(result) = snapshot();
+    result.error_messages = std::move(error_messages);
+    if (options_.progress) {
+        options_.progress(result);
+    }
+    return result;
+}
+
+} // namespace redisjson
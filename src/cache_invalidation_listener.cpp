@@ -0,0 +1,150 @@
+#include "redisjson++/cache_invalidation_listener.h"
+#include "redisjson++/redis_connection_manager.h" // For RedisConnection
+#include "redisjson++/hiredis_RAII.h"
+
+#include <poll.h>
+#include <cstring>
+
+namespace redisjson {
+
+namespace {
+
+// How often the listener thread wakes up to check for shutdown while idle.
+constexpr int POLL_INTERVAL_MS = 200;
+constexpr std::chrono::seconds RECONNECT_DELAY = std::chrono::seconds(1);
+
+RedisReplyPtr run_command(RedisConnection& conn, const std::vector<std::string>& argv) {
+    std::vector<const char*> args;
+    std::vector<size_t> lengths;
+    for (const auto& arg : argv) {
+        args.push_back(arg.data());
+        lengths.push_back(arg.size());
+    }
+    return RedisReplyPtr(conn.command_argv(static_cast<int>(args.size()), args.data(), lengths.data()));
+}
+
+bool is_invalidation_message(const redisReply* reply) {
+    return reply->type == REDIS_REPLY_ARRAY && reply->elements == 3 &&
+           reply->element[0]->type == REDIS_REPLY_STRING &&
+           std::string(reply->element[0]->str, reply->element[0]->len) == "message";
+}
+
+} // namespace
+
+CacheInvalidationListener::CacheInvalidationListener(const LegacyClientConfig& config, std::vector<std::string> prefixes,
+                                                     InvalidateCallback on_invalidate)
+    : config_(config), prefixes_(std::move(prefixes)), on_invalidate_(std::move(on_invalidate)) {
+    thread_ = std::thread(&CacheInvalidationListener::run, this);
+}
+
+CacheInvalidationListener::~CacheInvalidationListener() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    state_changed_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool CacheInvalidationListener::wait_until_subscribed(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return state_changed_.wait_for(lock, timeout, [this] { return subscribed_.load() || stopping_.load(); }) &&
+           subscribed_;
+}
+
+void CacheInvalidationListener::set_subscribed(bool subscribed) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subscribed_ = subscribed;
+    }
+    state_changed_.notify_all();
+    // Invalidations may have been missed while unsubscribed, so either way the
+    // cache has to start over.
+    on_invalidate_({});
+}
+
+void CacheInvalidationListener::run() {
+    while (!stopping_) {
+        RedisConnection subscriber(config_.host, config_.port, config_.password, config_.database, config_.timeout);
+        RedisConnection control(config_.host, config_.port, config_.password, config_.database, config_.timeout);
+        if (subscribe(subscriber, control)) {
+            set_subscribed(true);
+            listen(subscriber, control);
+            set_subscribed(false);
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        state_changed_.wait_for(lock, RECONNECT_DELAY, [this] { return stopping_.load(); });
+    }
+}
+
+bool CacheInvalidationListener::subscribe(RedisConnection& subscriber, RedisConnection& control) {
+    if (!subscriber.connect() || !control.connect()) {
+        return false;
+    }
+    RedisReplyPtr id_reply = run_command(subscriber, {"CLIENT", "ID"});
+    if (!id_reply || id_reply->type != REDIS_REPLY_INTEGER) {
+        return false;
+    }
+    RedisReplyPtr subscribe_reply = run_command(subscriber, {"SUBSCRIBE", INVALIDATION_CHANNEL});
+    if (!subscribe_reply || subscribe_reply->type != REDIS_REPLY_ARRAY) {
+        return false;
+    }
+    std::vector<std::string> tracking = {"CLIENT", "TRACKING", "on", "REDIRECT", std::to_string(id_reply->integer), "BCAST"};
+    for (const auto& prefix : prefixes_) {
+        tracking.push_back("PREFIX");
+        tracking.push_back(prefix);
+    }
+    RedisReplyPtr tracking_reply = run_command(control, tracking);
+    return tracking_reply && tracking_reply->type == REDIS_REPLY_STATUS;
+}
+
+void CacheInvalidationListener::listen(RedisConnection& subscriber, RedisConnection& control) {
+    redisContext* sub_context = subscriber.get_context();
+    // Tracking is tied to the control connection: if it closes, invalidations stop, so it
+    // is watched too. It never receives anything otherwise.
+    pollfd fds[2] = {{sub_context->fd, POLLIN, 0}, {control.get_context()->fd, POLLIN, 0}};
+
+    while (!stopping_) {
+        int ready = poll(fds, 2, POLL_INTERVAL_MS);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (ready == 0) continue;
+        if (fds[1].revents != 0) {
+            return; // Control connection closed or errored
+        }
+        if ((fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 && (fds[0].revents & POLLIN) == 0) {
+            return;
+        }
+        if (redisBufferRead(sub_context) != REDIS_OK) {
+            return;
+        }
+        while (true) {
+            void* raw_reply = nullptr;
+            if (redisGetReplyFromReader(sub_context, &raw_reply) != REDIS_OK) {
+                return;
+            }
+            if (!raw_reply) break;
+            RedisReplyPtr reply(static_cast<redisReply*>(raw_reply));
+            if (!is_invalidation_message(reply.get())) continue;
+
+            const redisReply* payload = reply->element[2];
+            std::vector<std::string> keys;
+            if (payload->type == REDIS_REPLY_ARRAY) {
+                keys.reserve(payload->elements);
+                for (size_t i = 0; i < payload->elements; ++i) {
+                    keys.emplace_back(payload->element[i]->str, payload->element[i]->len);
+                }
+            } else if (payload->type == REDIS_REPLY_STRING) {
+                keys.emplace_back(payload->str, payload->len);
+            }
+            // A nil payload (FLUSHALL/FLUSHDB) leaves `keys` empty: drop everything.
+            on_invalidate_(keys);
+        }
+    }
+}
+
+} // namespace redisjson
@@ -0,0 +1,148 @@
+#include "redisjson++/cluster_slot_map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace redisjson {
+
+uint16_t crc16(const char* data, size_t length) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= static_cast<uint16_t>(static_cast<unsigned char>(data[i])) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t key_hash_slot(const std::string& key) {
+    size_t open = key.find('{');
+    if (open != std::string::npos) {
+        size_t close = key.find('}', open + 1);
+        if (close != std::string::npos && close > open + 1) {
+            return crc16(key.data() + open + 1, close - open - 1) % CLUSTER_SLOT_COUNT;
+        }
+    }
+    return crc16(key.data(), key.size()) % CLUSTER_SLOT_COUNT;
+}
+
+std::optional<ClusterRedirect> parse_cluster_redirect(const redisReply* reply) {
+    if (!reply || reply->type != REDIS_REPLY_ERROR || !reply->str) {
+        return std::nullopt;
+    }
+    // "MOVED 3999 127.0.0.1:6381" or "ASK 3999 127.0.0.1:6381"
+    std::string message(reply->str, reply->len);
+    ClusterRedirect redirect;
+    size_t prefix_length;
+    if (message.compare(0, 6, "MOVED ") == 0) {
+        prefix_length = 6;
+    } else if (message.compare(0, 4, "ASK ") == 0) {
+        redirect.ask = true;
+        prefix_length = 4;
+    } else {
+        return std::nullopt;
+    }
+    size_t space = message.find(' ', prefix_length);
+    if (space == std::string::npos || space + 1 >= message.size()) {
+        return std::nullopt;
+    }
+    try {
+        unsigned long slot = std::stoul(message.substr(prefix_length, space - prefix_length));
+        if (slot >= CLUSTER_SLOT_COUNT) return std::nullopt;
+        redirect.slot = static_cast<uint16_t>(slot);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    redirect.address = message.substr(space + 1);
+    return redirect;
+}
+
+std::pair<std::string, int> split_node_address(const std::string& address) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size()) {
+        throw std::invalid_argument("Cluster node address '" + address + "' has no port");
+    }
+    std::string host = address.substr(0, colon);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    return {host, std::stoi(address.substr(colon + 1))};
+}
+
+bool ClusterSlotMap::update_from_cluster_slots(const redisReply* reply, const std::string& queried_host) {
+    if (!reply || reply->type != REDIS_REPLY_ARRAY) {
+        return false;
+    }
+    // Each element: [start slot, end slot, [host, port, id, ...] (primary), replicas...]
+    std::vector<std::string> addresses;
+    std::array<int16_t, CLUSTER_SLOT_COUNT> owners = {};
+    for (size_t i = 0; i < reply->elements; ++i) {
+        const redisReply* range = reply->element[i];
+        if (range->type != REDIS_REPLY_ARRAY || range->elements < 3 || range->element[0]->type != REDIS_REPLY_INTEGER ||
+            range->element[1]->type != REDIS_REPLY_INTEGER || range->element[2]->type != REDIS_REPLY_ARRAY ||
+            range->element[2]->elements < 2) {
+            return false;
+        }
+        const redisReply* primary = range->element[2];
+        std::string host = primary->element[0]->str ? std::string(primary->element[0]->str, primary->element[0]->len) : "";
+        if (host.empty() || host == "?") host = queried_host;
+        if (primary->element[1]->type != REDIS_REPLY_INTEGER) return false;
+        std::string address = host + ":" + std::to_string(primary->element[1]->integer);
+
+        auto it = std::find(addresses.begin(), addresses.end(), address);
+        if (it == addresses.end()) {
+            addresses.push_back(address);
+            it = addresses.end() - 1;
+        }
+        auto index = static_cast<int16_t>(it - addresses.begin() + 1);
+        long long first = std::max(0LL, range->element[0]->integer);
+        long long last = std::min<long long>(CLUSTER_SLOT_COUNT - 1, range->element[1]->integer);
+        for (long long slot = first; slot <= last; ++slot) {
+            owners[static_cast<size_t>(slot)] = index;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    addresses_ = std::move(addresses);
+    owners_ = owners;
+    return true;
+}
+
+void ClusterSlotMap::set_slot_owner(uint16_t slot, const std::string& address) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = std::find(addresses_.begin(), addresses_.end(), address);
+    if (it == addresses_.end()) {
+        addresses_.push_back(address);
+        it = addresses_.end() - 1;
+    }
+    owners_[slot % CLUSTER_SLOT_COUNT] = static_cast<int16_t>(it - addresses_.begin() + 1);
+}
+
+std::string ClusterSlotMap::node_for_slot(uint16_t slot) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    int16_t owner = owners_[slot % CLUSTER_SLOT_COUNT];
+    return owner > 0 ? addresses_[static_cast<size_t>(owner - 1)] : std::string();
+}
+
+std::vector<std::string> ClusterSlotMap::nodes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    // Addresses a MOVED made obsolete are left in addresses_; only report current owners.
+    std::vector<bool> serving(addresses_.size(), false);
+    std::vector<std::string> result;
+    for (int16_t owner : owners_) {
+        if (owner > 0 && !serving[static_cast<size_t>(owner - 1)]) {
+            serving[static_cast<size_t>(owner - 1)] = true;
+            result.push_back(addresses_[static_cast<size_t>(owner - 1)]);
+        }
+    }
+    return result;
+}
+
+bool ClusterSlotMap::empty() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return addresses_.empty();
+}
+
+} // namespace redisjson
@@ -0,0 +1,78 @@
+#include "redisjson++/document_codec.h"
+#include "redisjson++/exceptions.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace redisjson {
+
+std::string encode_document(const json& document, DocumentEncoding encoding) {
+    if (encoding == DocumentEncoding::MESSAGEPACK) {
+        std::vector<std::uint8_t> bytes = json::to_msgpack(document);
+        return std::string(bytes.begin(), bytes.end());
+    }
+    return document.dump();
+}
+
+json decode_document(const std::string& data, DocumentEncoding encoding, const std::string& context_msg) {
+    if (encoding == DocumentEncoding::MESSAGEPACK) {
+        try {
+            return json::from_msgpack(data);
+        } catch (const json::exception& e) {
+            throw JsonParsingException(context_msg + ": invalid MessagePack document: " + e.what());
+        }
+    }
+    try {
+        return json::parse(data);
+    } catch (const json::parse_error& e) {
+        throw JsonParsingException(context_msg + ": " + e.what() + ". Received: " + data);
+    }
+}
+
+std::vector<std::string> encode_document_fields(const json& object, DocumentEncoding encoding) {
+    if (!object.is_object()) {
+        throw ArgumentInvalidException("Documents stored in the hash layout must be JSON objects.");
+    }
+    std::vector<std::string> fields;
+    fields.reserve(2 * object.size());
+    for (auto it = object.begin(); it != object.end(); ++it) {
+        fields.push_back(it.key());
+        fields.push_back(encode_document(it.value(), encoding));
+    }
+    return fields;
+}
+
+bool scripts_preserve_document(const json& document, DocumentEncoding encoding) {
+    const bool msgpack = encoding == DocumentEncoding::MESSAGEPACK;
+    switch (document.type()) {
+        case json::value_t::object:
+        case json::value_t::array:
+            if (document.empty()) return false;
+            for (const auto& child : document) {
+                if (!scripts_preserve_document(child, encoding)) return false;
+            }
+            return true;
+        case json::value_t::number_integer:
+        case json::value_t::number_unsigned: {
+            double value = std::fabs(document.get<double>());
+            return msgpack ? value <= 9007199254740992.0 : value < 1e14;
+        }
+        case json::value_t::number_float: {
+            if (msgpack) return true;
+            double value = document.get<double>();
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.14g", value);
+            return std::strtod(buffer, nullptr) == value;
+        }
+        case json::value_t::binary:
+        case json::value_t::discarded:
+            return false;
+        default:
+            return true;
+    }
+}
+
+} // namespace redisjson
@@ -0,0 +1,146 @@
+#include "redisjson++/json_aggregation.h"
+#include "redisjson++/exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+
+namespace redisjson {
+
+namespace {
+
+const std::map<std::string, Aggregation::Operation> OPERATIONS = {
+    {"count", Aggregation::Operation::COUNT},
+    {"sum", Aggregation::Operation::SUM},
+    {"avg", Aggregation::Operation::AVG},
+    {"min", Aggregation::Operation::MIN},
+    {"max", Aggregation::Operation::MAX},
+    {"distinct_count", Aggregation::Operation::DISTINCT_COUNT},
+    {"percentile", Aggregation::Operation::PERCENTILE},
+};
+
+// Integral values as integers, as the script reports them.
+json number_value(double value) {
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        return static_cast<long long>(value);
+    }
+    return value;
+}
+
+json optional_number(const std::optional<double>& value) {
+    return value ? number_value(*value) : json(nullptr);
+}
+
+} // namespace
+
+Aggregation::Aggregation(const std::string& operation) {
+    size_t colon = operation.find(':');
+    auto it = OPERATIONS.find(operation.substr(0, colon));
+    if (it == OPERATIONS.end() || (colon != std::string::npos && it->second != Operation::PERCENTILE)) {
+        throw ArgumentInvalidException("Unknown aggregation '" + operation +
+                                       "' (expected count, sum, avg, min, max, distinct_count or percentile[:0-100])");
+    }
+    operation_ = it->second;
+    if (colon != std::string::npos) {
+        try {
+            size_t parsed = 0;
+            percentile_rank_ = std::stod(operation.substr(colon + 1), &parsed);
+            if (parsed != operation.size() - colon - 1) throw std::invalid_argument("trailing characters");
+        } catch (const std::exception&) {
+            percentile_rank_ = -1;
+        }
+        if (!(percentile_rank_ >= 0 && percentile_rank_ <= 100)) {
+            throw ArgumentInvalidException("Percentile rank in '" + operation + "' must be between 0 and 100");
+        }
+    }
+}
+
+std::vector<std::string> Aggregation::script_arguments(bool partial) const {
+    std::string name;
+    for (const auto& entry : OPERATIONS) {
+        if (entry.second == operation_) name = entry.first;
+    }
+    std::ostringstream rank;
+    rank.precision(17);
+    rank << percentile_rank_;
+    return {name, rank.str(), partial ? "partial" : "final"};
+}
+
+void Aggregation::add_number(double value) {
+    ++numeric_count_;
+    sum_ += value;
+    if (!min_ || value < *min_) min_ = value;
+    if (!max_ || value > *max_) max_ = value;
+    if (operation_ == Operation::PERCENTILE) numbers_.push_back(value);
+}
+
+void Aggregation::add(const json& value) {
+    ++count_;
+    if (value.is_number()) {
+        add_number(value.get<double>());
+    }
+    if (operation_ == Operation::DISTINCT_COUNT) {
+        distinct_.insert(value.dump());
+    }
+}
+
+void Aggregation::merge(const json& partial) {
+    if (!partial.is_object() || !partial.contains("count") || !partial.contains("values")) {
+        throw LuaScriptException("json_aggregate", "Unexpected partial result: " + partial.dump());
+    }
+    count_ += partial["count"].get<size_t>();
+    size_t numeric = partial.value("numeric", size_t(0));
+    if (numeric > 0) {
+        numeric_count_ += numeric;
+        sum_ += partial["sum"].get<double>();
+        double min = partial["min"].get<double>();
+        double max = partial["max"].get<double>();
+        if (!min_ || min < *min_) min_ = min;
+        if (!max_ || max > *max_) max_ = max;
+    }
+    const json& values = partial["values"];
+    if (operation_ == Operation::DISTINCT_COUNT) {
+        for (const auto& value : values) distinct_.insert(value.dump());
+    } else if (operation_ == Operation::PERCENTILE) {
+        for (const auto& value : values) numbers_.push_back(value.get<double>());
+    }
+}
+
+void Aggregation::set_result(const json& result) {
+    final_result_ = (operation_ == Operation::AVG && result.is_number()) ? json(result.get<double>()) : result;
+}
+
+json Aggregation::result() const {
+    if (final_result_) {
+        return *final_result_;
+    }
+    switch (operation_) {
+        case Operation::COUNT:
+            return count_;
+        case Operation::SUM:
+            return number_value(sum_);
+        case Operation::AVG:
+            return numeric_count_ > 0 ? json(sum_ / static_cast<double>(numeric_count_)) : json(nullptr);
+        case Operation::MIN:
+            return optional_number(min_);
+        case Operation::MAX:
+            return optional_number(max_);
+        case Operation::DISTINCT_COUNT:
+            return distinct_.size();
+        case Operation::PERCENTILE: {
+            if (numbers_.empty()) return nullptr;
+            std::vector<double> sorted = numbers_;
+            std::sort(sorted.begin(), sorted.end());
+            double position = percentile_rank_ / 100 * static_cast<double>(sorted.size() - 1);
+            size_t lower = static_cast<size_t>(std::floor(position));
+            double fraction = position - static_cast<double>(lower);
+            double value = sorted[lower];
+            if (fraction > 0) value += (sorted[lower + 1] - value) * fraction;
+            return number_value(value);
+        }
+    }
+    return nullptr;
+}
+
+} // namespace redisjson
@@ -1,144 +1,691 @@
 #include "redisjson++/json_cache.h"
-#include <stdexcept> // For std::out_of_range with unordered_map::at
+#include "redisjson++/json_modifier.h"
+#include "redisjson++/path_parser.h"
+#include <algorithm> // For std::min
+#include <array>
+#include <functional> // For std::hash
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace redisjson {
 
-JSONCache::JSONCache(size_t max_size, std::chrono::seconds default_ttl)
-    : _max_size(max_size), _default_ttl(default_ttl), _caching_enabled(true) {
+namespace {
+
+constexpr size_t MAX_SHARDS = 16;
+constexpr size_t MIN_ENTRIES_PER_SHARD = 64;
+// Invalidation generations per shard, striped by key hash so that a write to one key
+// rarely drops concurrent fills of others.
+constexpr size_t GENERATION_STRIPES = 16;
+// Bookkeeping per entry beyond its key and value: hash node, LRU links, expiry.
+constexpr size_t ENTRY_OVERHEAD = 96;
+// Allocation per object member beyond the member name and value (std::map node).
+constexpr size_t OBJECT_MEMBER_OVERHEAD = 32;
+
+std::string path_entry_key(const std::string& key, const std::string& path) {
+    std::string entry_key = key;
+    entry_key.push_back('\0');
+    entry_key += path;
+    return entry_key;
+}
+
+size_t hash_key(const std::string& key) {
+    return std::hash<std::string>{}(key);
+}
+
+// Caches of fewer than 1024 entries use fewer shards so that each one keeps enough
+// entries for LRU to be meaningful.
+size_t shard_count_for(size_t max_size) {
+    size_t count = 1;
+    while (count < MAX_SHARDS && count * 2 * MIN_ENTRIES_PER_SHARD <= max_size) {
+        count *= 2;
+    }
+    return count;
+}
+
+// Approximate access counts for TinyLFU admission: a count-min sketch of 4-bit
+// counters (stored in bytes) over four rows. All counters are halved every
+// 10 x width increments so that old popularity fades.
+class FrequencySketch {
+public:
+    void resize(size_t capacity) {
+        size_t width = 16;
+        while (width < capacity && width < (size_t{1} << 20)) {
+            width *= 2;
+        }
+        if (width == width_) return;
+        width_ = width;
+        counters_.assign(width_ * ROWS, 0);
+        additions_ = 0;
+    }
+
+    void increment(size_t hash) {
+        if (width_ == 0) return;
+        for (size_t row = 0; row < ROWS; ++row) {
+            std::uint8_t& counter = counters_[row * width_ + index(hash, row)];
+            if (counter < MAX_COUNT) ++counter;
+        }
+        if (++additions_ >= width_ * 10) {
+            for (auto& counter : counters_) counter >>= 1;
+            additions_ /= 2;
+        }
+    }
+
+    std::uint8_t estimate(size_t hash) const {
+        if (width_ == 0) return 0;
+        std::uint8_t frequency = MAX_COUNT;
+        for (size_t row = 0; row < ROWS; ++row) {
+            frequency = std::min(frequency, counters_[row * width_ + index(hash, row)]);
+        }
+        return frequency;
+    }
+
+private:
+    static constexpr size_t ROWS = 4;
+    static constexpr std::uint8_t MAX_COUNT = 15;
+
+    size_t index(size_t hash, size_t row) const {
+        static constexpr std::array<std::uint64_t, ROWS> SEEDS = {
+            0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+        std::uint64_t mixed = (static_cast<std::uint64_t>(hash) + SEEDS[row]) * SEEDS[(row + 1) % ROWS];
+        return static_cast<size_t>(mixed >> 32) & (width_ - 1);
+    }
+
+    std::vector<std::uint8_t> counters_;
+    size_t width_ = 0;
+    size_t additions_ = 0;
+};
+
+} // namespace
+
+SharedDocument view_at(const SharedDocument& document, const std::string& path) {
+    static const PathParser parser;
+    static const JSONModifier modifier;
+    // Aliasing constructor: points at the value, shares ownership of the document.
+    return SharedDocument(document, &modifier.get_ref(*document, parser.compile(path).elements()));
+}
+
+struct JSONCache::CacheEntry {
+    SharedDocument value;
+    const std::string* key = nullptr; // Key of this entry's node in Shard::entries
+    std::string owner_key;            // Document key of a path entry; empty for documents
+    bool is_path = false;
+    size_t bytes = 0;
+    std::chrono::time_point<std::chrono::steady_clock> expiry_time;
+    // Intrusive LRU list, so keys are not stored a second time
+    CacheEntry* newer = nullptr;
+    CacheEntry* older = nullptr;
+};
+
+struct JSONCache::Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, CacheEntry> entries;
+    std::unordered_map<std::string, std::unordered_set<CacheEntry*>> paths_by_key;
+    CacheEntry* newest = nullptr;
+    CacheEntry* oldest = nullptr;
+    size_t bytes = 0;
+
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t rejected = 0;
+    size_t stale_hits = 0;
+    size_t coalesced = 0;
+    std::uint64_t clear_generation = 0;
+    std::array<std::uint64_t, GENERATION_STRIPES> key_generations{};
+    FrequencySketch sketch;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights; // By entry key
+
+    void unlink(CacheEntry& entry) {
+        (entry.newer ? entry.newer->older : newest) = entry.older;
+        (entry.older ? entry.older->newer : oldest) = entry.newer;
+        entry.newer = entry.older = nullptr;
+    }
+
+    void push_newest(CacheEntry& entry) {
+        entry.older = newest;
+        entry.newer = nullptr;
+        if (newest) newest->newer = &entry;
+        newest = &entry;
+        if (!oldest) oldest = &entry;
+    }
+};
+
+struct JSONCache::Flight {
+    std::string owner_key; // Document key of the entry being loaded
+    bool is_path = false;
+    FillToken token = 0;   // Taken when the load started
+    std::promise<SharedDocument> promise;
+    std::shared_future<SharedDocument> result = promise.get_future().share();
+};
+
+JSONCache::JSONCache(size_t max_size, std::chrono::seconds default_ttl, size_t max_bytes)
+    : _max_size(max_size), _max_bytes(max_bytes), _default_ttl(default_ttl.count()) {
     if (max_size == 0) {
         _caching_enabled = false; // Or throw, depending on desired behavior for 0 max_size
     }
+    size_t shard_count = shard_count_for(max_size);
+    _shards.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        _shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+JSONCache::~JSONCache() {
+    {
+        std::lock_guard<std::mutex> lock(_refresh_mutex);
+        _refresh_stopping = true;
+    }
+    _refresh_cv.notify_all();
+    if (_refresh_thread.joinable()) {
+        _refresh_thread.join();
+    }
 }
 
 void JSONCache::enable_caching(bool enabled) {
-    std::lock_guard<std::mutex> lock(_mutex);
     _caching_enabled = enabled;
-    if (!_caching_enabled) {
-        _cache.clear();
-        _lru_list.clear();
+    if (!enabled) {
+        for (auto& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            _clear_locked(*shard);
+        }
     }
 }
 
 bool JSONCache::is_caching_enabled() const {
-    std::lock_guard<std::mutex> lock(_mutex);
     return _caching_enabled;
 }
 
 void JSONCache::set_cache_size(size_t max_size) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    // The number of shards stays as chosen at construction; only their budgets change.
+    _max_size = max_size;
     if (max_size == 0) {
         _caching_enabled = false; // Or throw
-        _cache.clear();
-        _lru_list.clear();
     }
-    _max_size = max_size;
-    while (_cache.size() > _max_size && _max_size > 0) {
-        _evict();
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if (max_size == 0) {
+            _clear_locked(*shard);
+            continue;
+        }
+        if (_admission_filter) {
+            shard->sketch.resize(_shard_max_entries());
+        }
+        _enforce_budgets_locked(*shard);
+    }
+}
+
+void JSONCache::set_max_bytes(size_t max_bytes) {
+    _max_bytes = max_bytes;
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        _enforce_budgets_locked(*shard);
     }
 }
 
 void JSONCache::set_ttl(std::chrono::seconds ttl) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _default_ttl = ttl;
+    _default_ttl = ttl.count();
+}
+
+void JSONCache::set_stale_while_revalidate(std::chrono::seconds window) {
+    _stale_window = window.count();
+}
+
+void JSONCache::set_admission_filter(bool enabled) {
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if (enabled) {
+            shard->sketch.resize(_shard_max_entries());
+        }
+    }
+    _admission_filter = enabled;
 }
 
 void JSONCache::put(const std::string& key, const json& value, std::chrono::seconds ttl_override) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    put_shared(key, std::make_shared<const json>(value), ttl_override);
+}
+
+std::optional<json> JSONCache::get(const std::string& key) {
+    if (SharedDocument value = get_shared(key)) {
+        return *value;
+    }
+    return std::nullopt;
+}
+
+void JSONCache::put_path(const std::string& key, const std::string& path, const json& value) {
+    auto shared = std::make_shared<const json>(value);
+    size_t value_bytes = estimate_size(*shared);
+    Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    _put_locked(shard, path_entry_key(key, path), key, std::move(shared), value_bytes, std::chrono::seconds(0));
+}
+
+std::optional<json> JSONCache::get_path(const std::string& key, const std::string& path) {
+    if (SharedDocument value = get_path_shared(key, path)) {
+        return *value;
+    }
+    return std::nullopt;
+}
+
+void JSONCache::put_shared(const std::string& key, SharedDocument value, std::chrono::seconds ttl_override) {
+    if (!value) {
+        return;
+    }
+    size_t value_bytes = estimate_size(*value);
+    Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    _put_locked(shard, key, std::string(), std::move(value), value_bytes, ttl_override);
+}
+
+SharedDocument JSONCache::get_shared(const std::string& key) {
+    Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return _get_locked(shard, key);
+}
+
+SharedDocument JSONCache::get_path_shared(const std::string& key, const std::string& path) {
+    Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return _get_locked(shard, path_entry_key(key, path));
+}
+
+SharedDocument JSONCache::get_view(const std::string& key, const std::string& path) {
+    SharedDocument document = get_shared(key);
+    if (!document) {
+        return nullptr;
+    }
+    return view_at(document, path); // Outside the lock: the document is immutable
+}
+
+JSONCache::FillToken JSONCache::fill_token(const std::string& key) const {
+    const Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return _fill_token_locked(shard, key);
+}
+
+bool JSONCache::fill(const std::string& key, const json& value, FillToken token) {
+    return fill_shared(key, std::make_shared<const json>(value), token);
+}
+
+bool JSONCache::fill_path(const std::string& key, const std::string& path, const json& value, FillToken token) {
+    auto shared = std::make_shared<const json>(value);
+    size_t value_bytes = estimate_size(*shared);
+    Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (_fill_token_locked(shard, key) != token) {
+        return false;
+    }
+    _put_locked(shard, path_entry_key(key, path), key, std::move(shared), value_bytes, std::chrono::seconds(0));
+    return true;
+}
+
+bool JSONCache::fill_shared(const std::string& key, SharedDocument value, FillToken token) {
+    if (!value) {
+        return false;
+    }
+    size_t value_bytes = estimate_size(*value);
+    Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (_fill_token_locked(shard, key) != token) {
+        return false; // Invalidated while the value was being read
+    }
+    _put_locked(shard, key, std::string(), std::move(value), value_bytes, std::chrono::seconds(0));
+    return true;
+}
+
+SharedDocument JSONCache::get_or_load(const std::string& key, const Loader& loader) {
+    return _get_or_load(key, std::string(), loader);
+}
+
+SharedDocument JSONCache::get_path_or_load(const std::string& key, const std::string& path, const Loader& loader) {
+    return _get_or_load(path_entry_key(key, path), key, loader);
+}
+
+void JSONCache::invalidate(const std::string& key) {
+    Shard& shard = _shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ++shard.key_generations[(hash_key(key) >> 16) % GENERATION_STRIPES];
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        _erase(shard, it->second);
+    }
+    auto paths_it = shard.paths_by_key.find(key);
+    if (paths_it != shard.paths_by_key.end()) {
+        std::unordered_set<CacheEntry*> path_entries = std::move(paths_it->second);
+        shard.paths_by_key.erase(paths_it);
+        for (CacheEntry* entry : path_entries) {
+            entry->is_path = false; // Already detached from paths_by_key
+            _erase(shard, *entry);
+        }
+    }
+    // Loads already running may have read the old value: they still answer their
+    // waiters but are not joined by later callers (and their fill token is stale).
+    for (auto flight_it = shard.flights.begin(); flight_it != shard.flights.end();) {
+        if (flight_it->second->owner_key == key) {
+            flight_it = shard.flights.erase(flight_it);
+        } else {
+            ++flight_it;
+        }
+    }
+}
+
+void JSONCache::clear_cache() {
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        _clear_locked(*shard);
+    }
+}
+
+CacheStats JSONCache::get_stats() const {
+    CacheStats stats;
+    for (const auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.hits += shard->hits;
+        stats.misses += shard->misses;
+        stats.rejected += shard->rejected;
+        stats.stale_hits += shard->stale_hits;
+        stats.coalesced += shard->coalesced;
+        stats.current_size += shard->entries.size();
+        stats.current_bytes += shard->bytes;
+    }
+    stats.max_size = _max_size;
+    stats.max_bytes = _max_bytes;
+    return stats;
+}
+
+size_t JSONCache::estimate_size(const json& value) {
+    size_t size = sizeof(json);
+    switch (value.type()) {
+        case json::value_t::string:
+            size += sizeof(json::string_t) + value.get_ref<const json::string_t&>().capacity();
+            break;
+        case json::value_t::object:
+            size += sizeof(json::object_t);
+            for (const auto& member : value.get_ref<const json::object_t&>()) {
+                size += OBJECT_MEMBER_OVERHEAD + sizeof(std::string) + member.first.capacity() +
+                        estimate_size(member.second);
+            }
+            break;
+        case json::value_t::array: {
+            const auto& elements = value.get_ref<const json::array_t&>();
+            size += sizeof(json::array_t) + (elements.capacity() - elements.size()) * sizeof(json);
+            for (const auto& element : elements) {
+                size += estimate_size(element);
+            }
+            break;
+        }
+        case json::value_t::binary:
+            size += sizeof(json::binary_t) + value.get_binary().capacity();
+            break;
+        default:
+            break; // Scalars are stored inline
+    }
+    return size;
+}
+
+JSONCache::Shard& JSONCache::_shard_for(const std::string& key) const {
+    return *_shards[hash_key(key) & (_shards.size() - 1)];
+}
+
+void JSONCache::_put_locked(Shard& shard, const std::string& entry_key, const std::string& owner_key,
+                            SharedDocument value, size_t value_bytes, std::chrono::seconds ttl_override) {
+    // Assumes the shard's mutex is already held
     if (!_caching_enabled || _max_size == 0) {
         return;
     }
 
-    if (_cache.size() >= _max_size) {
-        _evict();
+    size_t bytes = value_bytes + entry_key.size() + owner_key.size() + ENTRY_OVERHEAD;
+    size_t max_bytes = _shard_max_bytes();
+    auto it = shard.entries.find(entry_key);
+    if (max_bytes > 0 && bytes > max_bytes) {
+        if (it != shard.entries.end()) _erase(shard, it->second); // Drop the previous value
+        return;
     }
 
-    auto it = _cache.find(key);
-    if (it != _cache.end()) {
+    if (it == shard.entries.end()) {
+        bool needs_eviction = shard.entries.size() >= _shard_max_entries() ||
+                              (max_bytes > 0 && shard.bytes + bytes > max_bytes);
+        if (_admission_filter && needs_eviction && shard.oldest &&
+            shard.sketch.estimate(hash_key(entry_key)) <= shard.sketch.estimate(hash_key(*shard.oldest->key))) {
+            ++shard.rejected;
+            return;
+        }
+        it = shard.entries.try_emplace(entry_key).first;
+        CacheEntry& entry = it->second;
+        entry.key = &it->first;
+        if (!owner_key.empty()) {
+            entry.owner_key = owner_key;
+            entry.is_path = true;
+            shard.paths_by_key[owner_key].insert(&entry);
+        }
+    } else {
         // Key exists, update it and move to front of LRU
-        _lru_list.erase(it->second.lru_iterator);
+        shard.unlink(it->second);
+        shard.bytes -= it->second.bytes;
     }
 
-    _lru_list.push_front(key);
-
-    CacheEntry entry;
-    entry.value = value;
-    auto effective_ttl = (ttl_override.count() > 0) ? ttl_override : _default_ttl;
+    CacheEntry& entry = it->second;
+    entry.value = std::move(value);
+    entry.bytes = bytes;
+    auto effective_ttl = (ttl_override.count() > 0) ? ttl_override : std::chrono::seconds(_default_ttl.load());
     if (effective_ttl.count() > 0) {
         entry.expiry_time = std::chrono::steady_clock::now() + effective_ttl;
     } else {
         // No expiry (or very long expiry)
         entry.expiry_time = std::chrono::time_point<std::chrono::steady_clock>::max();
     }
-    entry.lru_iterator = _lru_list.begin();
+    shard.push_newest(entry);
+    shard.bytes += bytes;
 
-    _cache[key] = entry;
+    _enforce_budgets_locked(shard);
 }
 
-std::optional<json> JSONCache::get(const std::string& key) {
-    std::lock_guard<std::mutex> lock(_mutex);
+SharedDocument JSONCache::_get_locked(Shard& shard, const std::string& entry_key) {
+    // Assumes the shard's mutex is already held
     if (!_caching_enabled) {
-        return std::nullopt;
+        return nullptr;
+    }
+    if (_admission_filter) {
+        shard.sketch.increment(hash_key(entry_key));
     }
 
-    auto it = _cache.find(key);
-    if (it == _cache.end()) {
+    auto it = shard.entries.find(entry_key);
+    if (it == shard.entries.end()) {
         // Cache miss
-        return std::nullopt;
+        ++shard.misses;
+        return nullptr;
     }
 
     CacheEntry& entry = it->second;
 
-    if (std::chrono::steady_clock::now() > entry.expiry_time) {
-        // Cache entry expired
-        _lru_list.erase(entry.lru_iterator);
-        _cache.erase(it);
-        return std::nullopt;
+    auto now = std::chrono::steady_clock::now();
+    if (now > entry.expiry_time) {
+        // Cache entry expired. Within the stale-while-revalidate window it is kept for get_or_load.
+        if (now - entry.expiry_time > std::chrono::seconds(_stale_window.load())) {
+            _erase(shard, entry);
+        }
+        ++shard.misses;
+        return nullptr;
     }
 
     // Cache hit: move to front of LRU list
-    _lru_list.erase(entry.lru_iterator);
-    _lru_list.push_front(key);
-    entry.lru_iterator = _lru_list.begin();
+    shard.unlink(entry);
+    shard.push_newest(entry);
 
+    ++shard.hits;
     return entry.value;
 }
 
-void JSONCache::invalidate(const std::string& key) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    auto it = _cache.find(key);
-    if (it != _cache.end()) {
-        _lru_list.erase(it->second.lru_iterator);
-        _cache.erase(it);
-    }
+JSONCache::FillToken JSONCache::_fill_token_locked(const Shard& shard, const std::string& key) const {
+    // Both counters only grow, so their sum changes whenever either does.
+    return shard.clear_generation + shard.key_generations[(hash_key(key) >> 16) % GENERATION_STRIPES];
 }
 
-void JSONCache::clear_cache() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    _cache.clear();
-    _lru_list.clear();
+SharedDocument JSONCache::_get_or_load(const std::string& entry_key, const std::string& owner_key,
+                                       const Loader& loader) {
+    if (!_caching_enabled) {
+        return loader();
+    }
+    const std::string& document_key = owner_key.empty() ? entry_key : owner_key;
+    Shard& shard = _shard_for(document_key);
+    std::shared_ptr<Flight> flight;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (_admission_filter) {
+            shard.sketch.increment(hash_key(entry_key));
+        }
+        auto now = std::chrono::steady_clock::now();
+        auto it = shard.entries.find(entry_key);
+        if (it != shard.entries.end()) {
+            CacheEntry& entry = it->second;
+            bool fresh = now <= entry.expiry_time;
+            if (fresh || now - entry.expiry_time <= std::chrono::seconds(_stale_window.load())) {
+                shard.unlink(entry);
+                shard.push_newest(entry);
+                if (fresh) {
+                    ++shard.hits;
+                    return entry.value;
+                }
+                // Stale: serve it, and reload it in the background unless that is underway.
+                ++shard.stale_hits;
+                if (shard.flights.find(entry_key) == shard.flights.end()) {
+                    auto refresh = std::make_shared<Flight>();
+                    refresh->owner_key = document_key;
+                    refresh->is_path = !owner_key.empty();
+                    refresh->token = _fill_token_locked(shard, document_key);
+                    shard.flights.emplace(entry_key, refresh);
+                    _schedule_refresh([this, &shard, entry_key, refresh, loader] {
+                        try {
+                            _run_flight(shard, entry_key, refresh, loader);
+                        } catch (...) {
+                            // The stale value keeps being served until it leaves the window.
+                        }
+                    });
+                }
+                return entry.value;
+            }
+            _erase(shard, entry);
+        }
+        ++shard.misses;
+        auto flight_it = shard.flights.find(entry_key);
+        if (flight_it != shard.flights.end()) {
+            flight = flight_it->second;
+            ++shard.coalesced;
+        } else {
+            flight = std::make_shared<Flight>();
+            flight->owner_key = document_key;
+            flight->is_path = !owner_key.empty();
+            flight->token = _fill_token_locked(shard, document_key);
+            shard.flights.emplace(entry_key, flight);
+            leader = true;
+        }
+    }
+    if (!leader) {
+        return flight->result.get(); // Rethrows the leader's exception
+    }
+    return _run_flight(shard, entry_key, flight, loader);
 }
 
-CacheStats JSONCache::get_stats() const {
-    std::lock_guard<std::mutex> lock(_mutex);
-    CacheStats stats;
-    // Actual hits/misses would need to be tracked in get() and put()
-    // For this stub, we'll just report size.
-    // stats.hits = _hits; // Need to add _hits and _misses counters
-    // stats.misses = _misses;
-    stats.current_size = _cache.size();
-    stats.max_size = _max_size;
-    return stats;
+SharedDocument JSONCache::_run_flight(Shard& shard, const std::string& entry_key, const std::shared_ptr<Flight>& flight,
+                                      const Loader& loader) {
+    auto end_flight_locked = [&] {
+        auto it = shard.flights.find(entry_key);
+        if (it != shard.flights.end() && it->second == flight) {
+            shard.flights.erase(it);
+        }
+    };
+    SharedDocument value;
+    try {
+        value = loader();
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            end_flight_locked();
+        }
+        flight->promise.set_exception(std::current_exception());
+        throw;
+    }
+    size_t value_bytes = value ? estimate_size(*value) : 0;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (value && _fill_token_locked(shard, flight->owner_key) == flight->token) {
+            _put_locked(shard, entry_key, flight->is_path ? flight->owner_key : std::string(), value, value_bytes,
+                        std::chrono::seconds(0));
+        }
+        end_flight_locked();
+    }
+    flight->promise.set_value(value);
+    return value;
 }
 
-void JSONCache::_evict() {
-    // Assumes _mutex is already held
-    if (_lru_list.empty()) {
+void JSONCache::_schedule_refresh(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(_refresh_mutex);
+    if (_refresh_stopping) {
         return;
     }
-    // Evict least recently used item (back of the list)
-    const std::string& lru_key = _lru_list.back();
-    _cache.erase(lru_key);
-    _lru_list.pop_back();
+    if (!_refresh_thread.joinable()) {
+        _refresh_thread = std::thread(&JSONCache::_refresh_loop, this);
+    }
+    _refresh_queue.push_back(std::move(task));
+    _refresh_cv.notify_one();
+}
+
+void JSONCache::_refresh_loop() {
+    std::unique_lock<std::mutex> lock(_refresh_mutex);
+    while (true) {
+        _refresh_cv.wait(lock, [this] { return _refresh_stopping || !_refresh_queue.empty(); });
+        if (_refresh_stopping) {
+            return; // Queued refreshes are dropped; their entries simply expire
+        }
+        std::function<void()> task = std::move(_refresh_queue.front());
+        _refresh_queue.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+void JSONCache::_erase(Shard& shard, CacheEntry& entry) {
+    // Assumes the shard's mutex is already held
+    if (entry.is_path) {
+        auto paths_it = shard.paths_by_key.find(entry.owner_key);
+        if (paths_it != shard.paths_by_key.end()) {
+            paths_it->second.erase(&entry);
+            if (paths_it->second.empty()) {
+                shard.paths_by_key.erase(paths_it);
+            }
+        }
+    }
+    shard.unlink(entry);
+    shard.bytes -= entry.bytes;
+    shard.entries.erase(shard.entries.find(*entry.key));
+}
+
+void JSONCache::_clear_locked(Shard& shard) {
+    shard.entries.clear();
+    shard.paths_by_key.clear();
+    shard.flights.clear(); // Running loads finish for their waiters only
+    shard.newest = shard.oldest = nullptr;
+    shard.bytes = 0;
+    ++shard.clear_generation;
+}
+
+void JSONCache::_enforce_budgets_locked(Shard& shard) {
+    size_t max_entries = _shard_max_entries();
+    size_t max_bytes = _shard_max_bytes();
+    while (shard.oldest && (shard.entries.size() > max_entries || (max_bytes > 0 && shard.bytes > max_bytes))) {
+        // Evict least recently used item
+        _erase(shard, *shard.oldest);
+    }
+}
+
+size_t JSONCache::_shard_max_entries() const {
+    return (_max_size + _shards.size() - 1) / _shards.size();
+}
+
+size_t JSONCache::_shard_max_bytes() const {
+    return (_max_bytes + _shards.size() - 1) / _shards.size();
 }
 
 } // namespace redisjson
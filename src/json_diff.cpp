@@ -0,0 +1,430 @@
+#include "redisjson++/json_diff.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace redisjson {
+
+namespace {
+
+constexpr size_t NO_MATCH = std::numeric_limits<size_t>::max();
+
+enum HashTag : uint64_t { NULL_TAG = 1, FALSE_TAG, TRUE_TAG, INTEGER_TAG, LARGE_UNSIGNED_TAG, FLOAT_TAG,
+                          STRING_TAG, BINARY_TAG, ARRAY_TAG, OBJECT_TAG };
+
+// splitmix64 finalizer
+uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Order-sensitive: combine(combine(s, a), b) != combine(combine(s, b), a).
+uint64_t combine(uint64_t seed, uint64_t value) {
+    return mix(seed ^ mix(value));
+}
+
+uint64_t hash_string(const std::string& value) {
+    return combine(STRING_TAG, std::hash<std::string>{}(value));
+}
+
+// Integers, and floats with an integral value, hash by value, as operator== compares them.
+uint64_t hash_number(const json& value) {
+    if (value.is_number_integer() && !value.is_number_unsigned()) {
+        return combine(INTEGER_TAG, static_cast<uint64_t>(value.get<int64_t>()));
+    }
+    if (value.is_number_unsigned()) {
+        uint64_t number = value.get<uint64_t>();
+        return number <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())
+            ? combine(INTEGER_TAG, number) : combine(LARGE_UNSIGNED_TAG, number);
+    }
+    double number = value.get<double>();
+    if (number == std::trunc(number) && number >= -9.2233720368547758e18 && number < 9.2233720368547758e18) {
+        return combine(INTEGER_TAG, static_cast<uint64_t>(static_cast<int64_t>(number)));
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    return combine(FLOAT_TAG, bits);
+}
+
+// Hash of a value that is neither an object nor an array.
+uint64_t hash_scalar(const json& value) {
+    switch (value.type()) {
+        case json::value_t::null:
+            return mix(NULL_TAG);
+        case json::value_t::boolean:
+            return mix(value.get<bool>() ? TRUE_TAG : FALSE_TAG);
+        case json::value_t::number_integer:
+        case json::value_t::number_unsigned:
+        case json::value_t::number_float:
+            return hash_number(value);
+        case json::value_t::string:
+            return hash_string(value.get_ref<const std::string&>());
+        case json::value_t::binary: {
+            const auto& binary = value.get_binary();
+            uint64_t hash = combine(BINARY_TAG, binary.has_subtype() ? binary.subtype() + 1 : 0);
+            return combine(hash, std::hash<std::string>{}(std::string(binary.begin(), binary.end())));
+        }
+        default:
+            return 0;
+    }
+}
+
+void append_token(std::string& path, const std::string& token) {
+    path.push_back('/');
+    for (char c : token) {
+        if (c == '~') {
+            path += "~0";
+        } else if (c == '/') {
+            path += "~1";
+        } else {
+            path.push_back(c);
+        }
+    }
+}
+
+void append_index(std::string& path, size_t index) {
+    path.push_back('/');
+    path += std::to_string(index);
+}
+
+// The subtree hashes of a document, in pre-order: a node's first child follows it, and its
+// next sibling comes `size` nodes later.
+class HashedTree {
+public:
+    explicit HashedTree(const json& root) { build(root); }
+
+    uint64_t hash(size_t node) const { return nodes_[node].hash; }
+    size_t size(size_t node) const { return nodes_[node].size; }
+    size_t next_sibling(size_t node) const { return node + nodes_[node].size; }
+
+    // The nodes of the `count` children of `node`.
+    std::vector<size_t> children(size_t node, size_t count) const {
+        std::vector<size_t> result;
+        result.reserve(count);
+        for (size_t child = node + 1; result.size() < count; child = next_sibling(child)) {
+            result.push_back(child);
+        }
+        return result;
+    }
+
+private:
+    struct Node {
+        uint64_t hash;
+        size_t size; // Nodes in the subtree, including this one
+    };
+    std::vector<Node> nodes_;
+
+    void build(const json& value) {
+        size_t node = nodes_.size();
+        nodes_.push_back({0, 1});
+        uint64_t hash;
+        if (value.is_object()) {
+            hash = combine(OBJECT_TAG, value.size());
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                size_t child = nodes_.size();
+                build(it.value());
+                hash = combine(combine(hash, hash_string(it.key())), nodes_[child].hash);
+            }
+        } else if (value.is_array()) {
+            hash = combine(ARRAY_TAG, value.size());
+            for (const json& element : value) {
+                size_t child = nodes_.size();
+                build(element);
+                hash = combine(hash, nodes_[child].hash);
+            }
+        } else {
+            hash = hash_scalar(value);
+        }
+        nodes_[node] = {hash, nodes_.size() - node};
+    }
+};
+
+class DiffBuilder {
+public:
+    DiffBuilder(const DiffOptions& options, const json& old_doc, const json& new_doc)
+        : options_(options), old_doc_(old_doc), new_doc_(new_doc), old_tree_(old_doc), new_tree_(new_doc) {}
+
+    json build() {
+        std::string path;
+        diff_value(old_doc_, 0, new_doc_, 0, path);
+        return std::move(patch_);
+    }
+
+private:
+    const DiffOptions& options_;
+    const json& old_doc_;
+    const json& new_doc_;
+    HashedTree old_tree_;
+    HashedTree new_tree_;
+    json patch_ = json::array();
+
+    bool same(size_t old_node, size_t new_node) const {
+        return old_tree_.hash(old_node) == new_tree_.hash(new_node) &&
+               old_tree_.size(old_node) == new_tree_.size(new_node);
+    }
+
+    void emit(const char* op, const std::string& path, const json* value = nullptr) {
+        json operation = {{"op", op}, {"path", path}};
+        if (value) {
+            operation["value"] = *value;
+        }
+        patch_.push_back(std::move(operation));
+    }
+
+    void diff_value(const json& from, size_t from_node, const json& to, size_t to_node, std::string& path) {
+        if (same(from_node, to_node)) {
+            return;
+        }
+        if (from.is_object() && to.is_object()) {
+            diff_object(from, from_node, to, to_node, path);
+        } else if (from.is_array() && to.is_array()) {
+            diff_array(from, from_node, to, to_node, path);
+        } else {
+            emit("replace", path, &to);
+        }
+    }
+
+    // Members are visited in key order on both sides, as json objects keep them sorted.
+    void diff_object(const json& from, size_t from_node, const json& to, size_t to_node, std::string& path) {
+        const size_t base = path.size();
+        auto from_it = from.begin();
+        auto to_it = to.begin();
+        size_t from_child = from_node + 1;
+        size_t to_child = to_node + 1;
+        while (from_it != from.end() || to_it != to.end()) {
+            int order = from_it == from.end() ? 1 : to_it == to.end() ? -1 : from_it.key().compare(to_it.key());
+            if (order < 0) {
+                append_token(path, from_it.key());
+                emit("remove", path);
+                ++from_it;
+                from_child = old_tree_.next_sibling(from_child);
+            } else if (order > 0) {
+                append_token(path, to_it.key());
+                emit("add", path, &to_it.value());
+                ++to_it;
+                to_child = new_tree_.next_sibling(to_child);
+            } else {
+                append_token(path, to_it.key());
+                diff_value(from_it.value(), from_child, to_it.value(), to_child, path);
+                ++from_it;
+                ++to_it;
+                from_child = old_tree_.next_sibling(from_child);
+                to_child = new_tree_.next_sibling(to_child);
+            }
+            path.resize(base);
+        }
+    }
+
+    void diff_array(const json& from, size_t from_node, const json& to, size_t to_node, std::string& path) {
+        const std::vector<size_t> from_nodes = old_tree_.children(from_node, from.size());
+        const std::vector<size_t> to_nodes = new_tree_.children(to_node, to.size());
+        const size_t from_size = from.size();
+        const size_t to_size = to.size();
+
+        size_t prefix = 0;
+        while (prefix < from_size && prefix < to_size && same(from_nodes[prefix], to_nodes[prefix])) {
+            ++prefix;
+        }
+        size_t suffix = 0;
+        while (suffix < from_size - prefix && suffix < to_size - prefix &&
+               same(from_nodes[from_size - 1 - suffix], to_nodes[to_size - 1 - suffix])) {
+            ++suffix;
+        }
+        const size_t from_end = from_size - suffix;
+        const size_t to_end = to_size - suffix;
+
+        // Matched (old, new) element pairs of the changed part, increasing on both sides.
+        std::vector<std::pair<size_t, size_t>> matches;
+        bool keyed = match_by_identity(from, to, prefix, from_end, to_end, matches);
+        if (!keyed) {
+            match_by_value(from_nodes, to_nodes, prefix, from_end, to_end, matches);
+        }
+
+        // The array being patched holds to[0, index) followed by from[i, from_size).
+        const size_t base = path.size();
+        size_t index = prefix;
+        size_t i = prefix;
+        size_t j = prefix;
+        auto element_path = [&](size_t position) -> std::string& {
+            path.resize(base);
+            append_index(path, position);
+            return path;
+        };
+        // Unmatched elements before old position `from_stop` and new position `to_stop`.
+        // Without identity fields, they are paired up by position and diffed.
+        auto close_gap = [&](size_t from_stop, size_t to_stop) {
+            if (!keyed) {
+                for (; i < from_stop && j < to_stop; ++i, ++j, ++index) {
+                    diff_value(from[i], from_nodes[i], to[j], to_nodes[j], element_path(index));
+                }
+            }
+            for (; i < from_stop; ++i) {
+                emit("remove", element_path(index));
+            }
+            for (; j < to_stop; ++j, ++index) {
+                emit("add", element_path(index), &to[j]);
+            }
+        };
+        for (const auto& [from_match, to_match] : matches) {
+            close_gap(from_match, to_match);
+            diff_value(from[i], from_nodes[i], to[j], to_nodes[j], element_path(index));
+            ++i;
+            ++j;
+            ++index;
+        }
+        close_gap(from_end, to_end);
+        path.resize(base);
+    }
+
+    // The value identifying `element` by `field`, if it has one that can.
+    static std::optional<uint64_t> identity(const json& element, const std::string& field) {
+        if (!element.is_object()) {
+            return std::nullopt;
+        }
+        auto it = element.find(field);
+        if (it == element.end() || !(it->is_string() || it->is_number())) {
+            return std::nullopt;
+        }
+        return hash_scalar(*it);
+    }
+
+    // Matches the elements of from[first, from_end) and to[first, to_end) by the first
+    // identity field they all have, keeping the longest run of matches in the same order
+    // on both sides. Returns false if no field identifies them.
+    bool match_by_identity(const json& from, const json& to, size_t first, size_t from_end, size_t to_end,
+                           std::vector<std::pair<size_t, size_t>>& matches) const {
+        if (first == from_end || first == to_end) {
+            return false;
+        }
+        for (const std::string& field : options_.identity_fields) {
+            std::unordered_map<uint64_t, size_t> from_positions;
+            bool identified = true;
+            for (size_t i = first; i < from_end && identified; ++i) {
+                std::optional<uint64_t> key = identity(from[i], field);
+                identified = key && from_positions.emplace(*key, i).second;
+            }
+            // Candidate pairs in new-array order; longest_increasing() keeps those in old order too.
+            std::vector<std::pair<size_t, size_t>> candidates;
+            std::unordered_set<uint64_t> to_keys;
+            for (size_t j = first; j < to_end && identified; ++j) {
+                std::optional<uint64_t> key = identity(to[j], field);
+                identified = key && to_keys.insert(*key).second;
+                if (identified) {
+                    auto match = from_positions.find(*key);
+                    if (match != from_positions.end()) {
+                        candidates.emplace_back(match->second, j);
+                    }
+                }
+            }
+            if (identified) {
+                matches = longest_increasing(candidates);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The longest subsequence of `candidates` (increasing second members) whose first
+    // members increase too, in O(n log n).
+    static std::vector<std::pair<size_t, size_t>> longest_increasing(
+            const std::vector<std::pair<size_t, size_t>>& candidates) {
+        std::vector<size_t> tails; // tails[k]: the candidate ending the best run of length k + 1
+        std::vector<size_t> previous(candidates.size(), NO_MATCH);
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            auto position = std::lower_bound(tails.begin(), tails.end(), candidates[c].first,
+                                             [&](size_t tail, size_t value) { return candidates[tail].first < value; });
+            if (position != tails.begin()) {
+                previous[c] = *(position - 1);
+            }
+            if (position == tails.end()) {
+                tails.push_back(c);
+            } else {
+                *position = c;
+            }
+        }
+        std::vector<std::pair<size_t, size_t>> result;
+        for (size_t c = tails.empty() ? NO_MATCH : tails.back(); c != NO_MATCH; c = previous[c]) {
+            result.push_back(candidates[c]);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    // Matches the identical elements of from[first, from_end) and to[first, to_end): by
+    // their hashes in O(n log n) if no element repeats on either side, otherwise by longest
+    // common subsequence, unless that is too large to compute.
+    void match_by_value(const std::vector<size_t>& from_nodes, const std::vector<size_t>& to_nodes, size_t first,
+                        size_t from_end, size_t to_end, std::vector<std::pair<size_t, size_t>>& matches) const {
+        const size_t rows = from_end - first;
+        const size_t columns = to_end - first;
+        if (rows == 0 || columns == 0) {
+            return;
+        }
+        std::unordered_map<uint64_t, size_t> from_positions;
+        bool distinct = true;
+        for (size_t i = first; i < from_end && distinct; ++i) {
+            distinct = from_positions.emplace(old_tree_.hash(from_nodes[i]), i).second;
+        }
+        std::vector<std::pair<size_t, size_t>> candidates;
+        std::unordered_set<uint64_t> to_hashes;
+        for (size_t j = first; j < to_end && distinct; ++j) {
+            uint64_t hash = new_tree_.hash(to_nodes[j]);
+            distinct = to_hashes.insert(hash).second;
+            auto match = from_positions.find(hash);
+            if (distinct && match != from_positions.end() && same(from_nodes[match->second], to_nodes[j])) {
+                candidates.emplace_back(match->second, j);
+            }
+        }
+        if (distinct) {
+            matches = longest_increasing(candidates);
+            return;
+        }
+        if (rows * columns > options_.max_lcs_cells) {
+            return;
+        }
+        // length[r][c]: the LCS of from[first + r, from_end) and to[first + c, to_end)
+        const size_t width = columns + 1;
+        std::vector<uint32_t> length((rows + 1) * width, 0);
+        for (size_t r = rows; r-- > 0;) {
+            for (size_t c = columns; c-- > 0;) {
+                length[r * width + c] = same(from_nodes[first + r], to_nodes[first + c])
+                    ? length[(r + 1) * width + c + 1] + 1
+                    : std::max(length[(r + 1) * width + c], length[r * width + c + 1]);
+            }
+        }
+        size_t r = 0;
+        size_t c = 0;
+        while (r < rows && c < columns) {
+            if (same(from_nodes[first + r], to_nodes[first + c]) &&
+                length[r * width + c] == length[(r + 1) * width + c + 1] + 1) {
+                matches.emplace_back(first + r, first + c);
+                ++r;
+                ++c;
+            } else if (length[(r + 1) * width + c] >= length[r * width + c + 1]) {
+                ++r;
+            } else {
+                ++c;
+            }
+        }
+    }
+};
+
+} // namespace
+
+JSONDiff::JSONDiff(DiffOptions options) : options_(std::move(options)) {}
+
+json JSONDiff::diff(const json& old_doc, const json& new_doc) const {
+    return DiffBuilder(options_, old_doc, new_doc).build();
+}
+
+} // namespace redisjson
@@ -0,0 +1,86 @@
+#include "redisjson++/json_exporter.h"
+#include "redisjson++/document_codec.h"
+#include "redisjson++/exceptions.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace redisjson {
+
+namespace {
+
+// A MessagePack str header (fixstr, str8, str16 or str32) followed by the bytes.
+void append_msgpack_string(std::string& out, const std::string& value) {
+    size_t size = value.size();
+    if (size < 32) {
+        out.push_back(static_cast<char>(0xa0 | size));
+    } else if (size <= 0xff) {
+        out.push_back(static_cast<char>(0xd9));
+        out.push_back(static_cast<char>(size));
+    } else if (size <= 0xffff) {
+        out.push_back(static_cast<char>(0xda));
+        out.push_back(static_cast<char>(size >> 8));
+        out.push_back(static_cast<char>(size));
+    } else {
+        out.push_back(static_cast<char>(0xdb));
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>(static_cast<uint32_t>(size) >> shift));
+        }
+    }
+    out += value;
+}
+
+} // namespace
+
+ExportWriter::ExportWriter(std::ostream& output, ExportFormat format, DocumentEncoding stored_encoding)
+    : output_(output), format_(format), stored_encoding_(stored_encoding) {}
+
+void ExportWriter::begin_record(const std::string& key) {
+    record_.clear();
+    if (format_ == ExportFormat::NDJSON) {
+        try {
+            record_ = "{\"key\":" + json(key).dump() + ",\"value\":";
+        } catch (const json::exception& e) {
+            throw RedisJSONException("Key cannot be exported as JSON: " + std::string(e.what()));
+        }
+    } else {
+        record_.push_back(static_cast<char>(0x82)); // fixmap of 2
+        append_msgpack_string(record_, "key");
+        append_msgpack_string(record_, key);
+        append_msgpack_string(record_, "value");
+    }
+}
+
+void ExportWriter::end_record(const std::string& value) {
+    if (format_ == ExportFormat::NDJSON) {
+        output_.write(record_.data(), static_cast<std::streamsize>(record_.size()));
+        output_.write(value.data(), static_cast<std::streamsize>(value.size()));
+        output_.write("}\n", 2);
+        bytes_written_ += record_.size() + value.size() + 2;
+    } else {
+        output_.write(record_.data(), static_cast<std::streamsize>(record_.size()));
+        output_.write(value.data(), static_cast<std::streamsize>(value.size()));
+        bytes_written_ += record_.size() + value.size();
+    }
+}
+
+void ExportWriter::write_stored(const std::string& key, const std::string& stored_value) {
+    bool raw = format_ == ExportFormat::NDJSON
+        // Multi-line JSON (not written by this library) would break the one-record-per-line format.
+        ? stored_encoding_ == DocumentEncoding::JSON && std::memchr(stored_value.data(), '\n', stored_value.size()) == nullptr
+        : stored_encoding_ == DocumentEncoding::MESSAGEPACK;
+    if (!raw) {
+        write_document(key, decode_document(stored_value, stored_encoding_, "Export of key '" + key + "'"));
+        return;
+    }
+    begin_record(key);
+    end_record(stored_value);
+}
+
+void ExportWriter::write_document(const std::string& key, const json& document) {
+    begin_record(key);
+    end_record(encode_document(document, format_ == ExportFormat::NDJSON ? DocumentEncoding::JSON
+                                                                         : DocumentEncoding::MESSAGEPACK));
+}
+
+} // namespace redisjson
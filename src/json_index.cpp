@@ -0,0 +1,239 @@
+#include "redisjson++/json_index.h"
+#include "redisjson++/json_path_plan.h"
+#include "redisjson++/exceptions.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+
+namespace redisjson {
+
+namespace {
+
+const char* type_name(IndexType type) {
+    return type == IndexType::NUMERIC ? "numeric" : "tag";
+}
+
+bool valid_name(const std::string& name) {
+    if (name.empty()) return false;
+    for (char c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-' && c != '.') return false;
+    }
+    return true;
+}
+
+// The hash tag a key pattern starts with ("{fleet}:device:*" -> "fleet"), if it is literal.
+std::string leading_hash_tag(const std::string& pattern) {
+    if (pattern.empty() || pattern[0] != '{') return "";
+    size_t close = pattern.find('}');
+    if (close == std::string::npos || close == 1) return "";
+    std::string tag = pattern.substr(1, close - 1);
+    return tag.find_first_of("*?[\\") == std::string::npos ? tag : "";
+}
+
+// Redis's stringmatchlen(): * ? [abc] [^a-z] and \ escapes.
+bool glob_match(const char* pattern, const char* pattern_end, const char* str, const char* str_end) {
+    while (pattern < pattern_end) {
+        switch (*pattern) {
+            case '*':
+                while (pattern + 1 < pattern_end && pattern[1] == '*') ++pattern;
+                if (pattern + 1 == pattern_end) return true;
+                for (const char* s = str; s <= str_end; ++s) {
+                    if (glob_match(pattern + 1, pattern_end, s, str_end)) return true;
+                }
+                return false;
+            case '?':
+                if (str == str_end) return false;
+                ++str;
+                break;
+            case '[': {
+                if (str == str_end) return false;
+                ++pattern;
+                bool negate = pattern < pattern_end && *pattern == '^';
+                if (negate) ++pattern;
+                bool matched = false;
+                while (pattern < pattern_end && *pattern != ']') {
+                    if (*pattern == '\\' && pattern + 1 < pattern_end) {
+                        ++pattern;
+                        matched = matched || *pattern == *str;
+                    } else if (pattern + 2 < pattern_end && pattern[1] == '-' && pattern[2] != ']') {
+                        char low = std::min(pattern[0], pattern[2]);
+                        char high = std::max(pattern[0], pattern[2]);
+                        matched = matched || (*str >= low && *str <= high);
+                        pattern += 2;
+                    } else {
+                        matched = matched || *pattern == *str;
+                    }
+                    ++pattern;
+                }
+                if (matched == negate) return false;
+                ++str;
+                break;
+            }
+            case '\\':
+                if (pattern + 1 < pattern_end) ++pattern;
+                // fall through
+            default:
+                if (str == str_end || *pattern != *str) return false;
+                ++str;
+                break;
+        }
+        ++pattern;
+    }
+    return str == str_end;
+}
+
+} // namespace
+
+void IndexRegistry::add(const IndexDefinition& definition) {
+    if (!valid_name(definition.name)) {
+        throw ArgumentInvalidException("Index name '" + definition.name + "' must be non-empty and contain only letters, digits, '_', '-' and '.'");
+    }
+    if (definition.key_pattern.empty()) {
+        throw ArgumentInvalidException("Index '" + definition.name + "' needs a key pattern");
+    }
+    Entry entry{definition, path_segments(definition.path), index_key(definition), ""};
+    entry.spec = json::array({type_name(definition.type), entry.segments}).dump();
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    entries_[definition.name] = std::move(entry);
+}
+
+bool IndexRegistry::remove(const std::string& name) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return entries_.erase(name) > 0;
+}
+
+std::optional<IndexDefinition> IndexRegistry::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    if (it == entries_.end()) return std::nullopt;
+    return it->second.definition;
+}
+
+std::vector<IndexDefinition> IndexRegistry::definitions() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<IndexDefinition> result;
+    result.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        result.push_back(entry.second.definition);
+    }
+    return result;
+}
+
+bool IndexRegistry::empty() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_.empty();
+}
+
+bool IndexRegistry::covers(const std::string& key) const {
+    std::vector<std::string> keys, args;
+    return append_script_arguments(key, keys, args);
+}
+
+bool IndexRegistry::append_script_arguments(const std::string& key, std::vector<std::string>& keys,
+                                            std::vector<std::string>& args) const {
+    if (key.compare(0, std::char_traits<char>::length(KEY_PREFIX), KEY_PREFIX) == 0 || key == DEFINITIONS_KEY) {
+        return false;
+    }
+    bool covered = false;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        if (key_matches(entry.second.definition.key_pattern, key)) {
+            keys.push_back(entry.second.redis_key);
+            args.push_back(entry.second.spec);
+            covered = true;
+        }
+    }
+    return covered;
+}
+
+std::optional<IndexDefinition> IndexRegistry::find_for(const std::string& key_pattern, const json& path_segments) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        if (entry.second.definition.key_pattern == key_pattern && entry.second.segments == path_segments) {
+            return entry.second.definition;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string IndexRegistry::index_key(const IndexDefinition& definition) {
+    std::string key = KEY_PREFIX + definition.name;
+    std::string hash_tag = leading_hash_tag(definition.key_pattern);
+    if (!hash_tag.empty()) {
+        key += ":{" + hash_tag + "}";
+    }
+    return key;
+}
+
+std::string IndexRegistry::tag_key(const IndexDefinition& definition, const std::string& tag) {
+    return index_key(definition) + ":" + tag;
+}
+
+std::optional<std::string> IndexRegistry::tag_value(const json& value) {
+    if (value.is_string()) {
+        return value.get<std::string>();
+    }
+    if (value.is_boolean()) {
+        return value.get<bool>() ? "true" : "false";
+    }
+    if (value.is_number()) {
+        // Formatted as the scripts format Lua numbers.
+        double number = value.get<double>();
+        char buffer[32];
+        if (number == std::floor(number) && std::fabs(number) < 1e15) {
+            std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(number));
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+        }
+        return std::string(buffer);
+    }
+    return std::nullopt;
+}
+
+json IndexRegistry::path_segments(const std::string& path) {
+    JSONPathPlan plan = JSONPathPlan::compile(path);
+    if (!plan.is_definite() || plan.steps().empty()) {
+        throw InvalidPathException("Index path '" + path + "' must name a single value below the root");
+    }
+    json segments = json::array();
+    for (const auto& step : plan.steps()) {
+        const JSONPathPlan::Selector& selector = step.selectors.front();
+        if (selector.kind == JSONPathPlan::Selector::Kind::NAME) {
+            segments.push_back(selector.name);
+        } else {
+            segments.push_back(selector.index);
+        }
+    }
+    return segments;
+}
+
+bool IndexRegistry::key_matches(const std::string& pattern, const std::string& key) {
+    return glob_match(pattern.data(), pattern.data() + pattern.size(), key.data(), key.data() + key.size());
+}
+
+json IndexRegistry::to_json(const IndexDefinition& definition) {
+    return {{"name", definition.name}, {"key_pattern", definition.key_pattern},
+            {"path", definition.path}, {"type", type_name(definition.type)}};
+}
+
+IndexDefinition IndexRegistry::from_json(const json& definition) {
+    try {
+        IndexDefinition result;
+        result.name = definition.at("name").get<std::string>();
+        result.key_pattern = definition.at("key_pattern").get<std::string>();
+        result.path = definition.at("path").get<std::string>();
+        std::string type = definition.at("type").get<std::string>();
+        if (type != "numeric" && type != "tag") {
+            throw ArgumentInvalidException("Unknown index type '" + type + "'");
+        }
+        result.type = type == "numeric" ? IndexType::NUMERIC : IndexType::TAG;
+        return result;
+    } catch (const json::exception& e) {
+        throw ArgumentInvalidException("Invalid index definition " + definition.dump() + ": " + e.what());
+    }
+}
+
+} // namespace redisjson
@@ -1,5 +1,6 @@
 #include "redisjson++/json_modifier.h"
 #include <algorithm> // For std::find_if if used with filters
+#include <type_traits>
 #include <variant>   // Added for std::variant related functions like std::holds_alternative, std::get
 
 namespace redisjson {
@@ -29,6 +30,34 @@ static std::string reconstruct_path_string(const std::vector<PathParser::PathEle
     return p_str;
 }
 
+// Merges `patch` into `target` in place: objects member by member, recursively (only at
+// the top level with `recursive` false), arrays by appending with `append_arrays`; any
+// other patch value replaces the target value. Values taken from an rvalue patch are
+// moved rather than copied.
+template <typename Patch>
+static void merge_into(json& target, Patch&& patch, bool recursive, bool append_arrays) {
+    using Member = std::conditional_t<std::is_lvalue_reference<Patch>::value, const json&, json&&>;
+    if (target.is_object() && patch.is_object()) {
+        for (auto it = patch.begin(); it != patch.end(); ++it) {
+            auto existing = target.find(it.key());
+            if (existing == target.end()) {
+                target.emplace(it.key(), static_cast<Member>(*it));
+            } else if (recursive) {
+                merge_into(*existing, static_cast<Member>(*it), true, append_arrays);
+            } else {
+                *existing = static_cast<Member>(*it);
+            }
+        }
+    } else if (append_arrays && target.is_array() && patch.is_array()) {
+        target.get_ref<json::array_t&>().reserve(target.size() + patch.size());
+        for (auto it = patch.begin(); it != patch.end(); ++it) {
+            target.push_back(static_cast<Member>(*it));
+        }
+    } else {
+        target = std::forward<Patch>(patch);
+    }
+}
+
 long long JSONModifier::array_trim(json& document, const std::vector<PathParser::PathElement>& path_elements,
                                    long long start, long long stop) {
     json* target_array_ptr = navigate_to_element(document, path_elements, false /* create_missing_paths */);
@@ -291,6 +320,13 @@ json JSONModifier::get(const json& document, const std::vector<PathParser::PathE
     return *target_element; // navigate_to_element_const throws if not found
 }
 
+const json& JSONModifier::get_ref(const json& document, const std::vector<PathParser::PathElement>& path_elements) const {
+    if (path_elements.empty()) {
+        return document;
+    }
+    return *navigate_to_element_const(document, path_elements);
+}
+
 void JSONModifier::set(json& document, const std::vector<PathParser::PathElement>& path_elements,
                        const json& value_to_set, bool create_path, bool overwrite) {
     if (path_elements.empty()) {
@@ -454,20 +490,35 @@ size_t JSONModifier::get_size(const json& document,
 
 // --- Stubs for Advanced and Array Operations ---
 void JSONModifier::merge(json& document, const json& patch, MergeStrategy strategy) {
-    if (strategy == MergeStrategy::PATCH && patch.is_array()) {
-         document = document.patch(patch);
-         return;
-    }
-    if (strategy == MergeStrategy::OVERWRITE) {
-        if (document.is_object() && patch.is_object()) {
-            document.update(patch); // nlohmann's update is overwrite for objects
-        } else { // If types differ or not both objects, or one isn't object, wholesale replace
-            document = patch;
-        }
-        return;
+    switch (strategy) {
+        case MergeStrategy::PATCH:
+            apply_patch(document, patch);
+            return;
+        case MergeStrategy::SHALLOW:
+        case MergeStrategy::OVERWRITE:
+            merge_into(document, patch, false, false);
+            return;
+        case MergeStrategy::DEEP:
+        case MergeStrategy::APPEND:
+            merge_into(document, patch, true, strategy == MergeStrategy::APPEND);
+            return;
+    }
+}
+
+void JSONModifier::merge(json& document, json&& patch, MergeStrategy strategy) {
+    switch (strategy) {
+        case MergeStrategy::PATCH:
+            apply_patch(document, patch);
+            return;
+        case MergeStrategy::SHALLOW:
+        case MergeStrategy::OVERWRITE:
+            merge_into(document, std::move(patch), false, false);
+            return;
+        case MergeStrategy::DEEP:
+        case MergeStrategy::APPEND:
+            merge_into(document, std::move(patch), true, strategy == MergeStrategy::APPEND);
+            return;
     }
-    // TODO: Implement DEEP, SHALLOW (distinct from OVERWRITE if patch is not object), APPEND
-    throw std::runtime_error("Merge strategy not fully implemented yet.");
 }
 
 void JSONModifier::apply_patch(json& document, const json& patch_operations) {
@@ -482,7 +533,11 @@ void JSONModifier::apply_patch(json& document, const json& patch_operations) {
 }
 
 json JSONModifier::diff(const json& old_doc, const json& new_doc) const {
-    return json::diff(old_doc, new_doc);
+    return JSONDiff().diff(old_doc, new_doc);
+}
+
+json JSONModifier::diff(const json& old_doc, const json& new_doc, const DiffOptions& options) const {
+    return JSONDiff(options).diff(old_doc, new_doc);
 }
 
 void JSONModifier::array_append(json& document, const std::vector<PathParser::PathElement>& path_elements,
@@ -0,0 +1,688 @@
+#include "redisjson++/json_path_plan.h"
+#include "redisjson++/exceptions.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+
+namespace redisjson {
+
+namespace {
+
+using Step = JSONPathPlan::Step;
+using Selector = JSONPathPlan::Selector;
+using FilterExpression = JSONPathPlan::FilterExpression;
+using FilterOperand = JSONPathPlan::FilterOperand;
+using PathSegment = JSONPathPlan::PathSegment;
+
+bool is_name_char(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return std::isalnum(u) || c == '_' || c == '-' || u >= 0x80;
+}
+
+// Recursive-descent parser for the expression syntax described in json_path_plan.h.
+class PlanParser {
+public:
+    explicit PlanParser(const std::string& text) : text_(text) {}
+
+    std::vector<Step> parse_path() {
+        std::vector<Step> steps;
+        skip_spaces();
+        if (at_end() || (peek() == '.' && pos_ + 1 == text_.size())) {
+            return steps; // "" and "." are the root, as elsewhere in the library
+        }
+        if (peek() == '$') {
+            ++pos_;
+        } else if (peek() != '.' && peek() != '[') {
+            steps.push_back(name_step(false)); // "ports[*]" is "$.ports[*]"
+        }
+        while (true) {
+            skip_spaces();
+            if (at_end()) break;
+            if (text_.compare(pos_, 2, "..") == 0) {
+                pos_ += 2;
+                if (!at_end() && peek() == '[') {
+                    steps.push_back(bracket_step(true));
+                } else {
+                    steps.push_back(dot_step(true));
+                }
+            } else if (peek() == '.') {
+                ++pos_;
+                steps.push_back(dot_step(false));
+            } else if (peek() == '[') {
+                steps.push_back(bracket_step(false));
+            } else {
+                fail("unexpected '" + std::string(1, peek()) + "'");
+            }
+        }
+        return steps;
+    }
+
+private:
+    const std::string& text_;
+    size_t pos_ = 0;
+
+    bool at_end() const { return pos_ >= text_.size(); }
+    char peek() const { return text_[pos_]; }
+    void skip_spaces() {
+        while (!at_end() && std::isspace(static_cast<unsigned char>(peek()))) ++pos_;
+    }
+    bool consume(const char* token) {
+        skip_spaces();
+        size_t length = std::char_traits<char>::length(token);
+        if (text_.compare(pos_, length, token) == 0) {
+            pos_ += length;
+            return true;
+        }
+        return false;
+    }
+    void expect(char c) {
+        skip_spaces();
+        if (at_end() || peek() != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        ++pos_;
+    }
+    [[noreturn]] void fail(const std::string& reason) const {
+        throw InvalidPathException("JSONPath '" + text_ + "' at offset " + std::to_string(pos_) + ": " + reason);
+    }
+
+    Step name_step(bool descendant) {
+        size_t end = text_.find_first_of(".[", pos_);
+        std::string name = text_.substr(pos_, end == std::string::npos ? std::string::npos : end - pos_);
+        if (name.empty()) fail("empty member name");
+        if (name.find(']') != std::string::npos) fail("']' without '['");
+        pos_ += name.size();
+        Step step;
+        step.descendant = descendant;
+        step.selectors.emplace_back();
+        step.selectors.back().kind = Selector::Kind::NAME;
+        step.selectors.back().name = std::move(name);
+        return step;
+    }
+
+    Step dot_step(bool descendant) {
+        if (!at_end() && peek() == '*') {
+            ++pos_;
+            Step step;
+            step.descendant = descendant;
+            step.selectors.emplace_back();
+            step.selectors.back().kind = Selector::Kind::WILDCARD;
+            return step;
+        }
+        return name_step(descendant);
+    }
+
+    Step bracket_step(bool descendant) {
+        expect('[');
+        Step step;
+        step.descendant = descendant;
+        while (true) {
+            step.selectors.push_back(selector());
+            skip_spaces();
+            if (consume(",")) continue;
+            expect(']');
+            break;
+        }
+        return step;
+    }
+
+    Selector selector() {
+        skip_spaces();
+        if (at_end()) fail("unterminated '['");
+        Selector selector;
+        char c = peek();
+        if (c == '*') {
+            ++pos_;
+            selector.kind = Selector::Kind::WILDCARD;
+        } else if (c == '\'' || c == '"') {
+            selector.kind = Selector::Kind::NAME;
+            selector.name = quoted();
+        } else if (c == '?') {
+            ++pos_;
+            selector.kind = Selector::Kind::FILTER;
+            selector.filter = std::make_shared<const FilterExpression>(filter_or());
+        } else {
+            long long value = 0;
+            bool has_value = integer(value);
+            skip_spaces();
+            if (!at_end() && peek() == ':') {
+                selector.kind = Selector::Kind::SLICE;
+                selector.has_start = has_value;
+                selector.start = value;
+                ++pos_;
+                skip_spaces();
+                selector.has_end = integer(selector.end);
+                skip_spaces();
+                if (!at_end() && peek() == ':') {
+                    ++pos_;
+                    skip_spaces();
+                    if (!integer(selector.step)) selector.step = 1;
+                }
+            } else if (has_value) {
+                selector.kind = Selector::Kind::INDEX;
+                selector.index = value;
+            } else {
+                fail("expected a selector");
+            }
+        }
+        return selector;
+    }
+
+    bool integer(long long& value) {
+        size_t start = pos_;
+        if (!at_end() && peek() == '-') ++pos_;
+        size_t digits = pos_;
+        while (!at_end() && std::isdigit(static_cast<unsigned char>(peek()))) ++pos_;
+        if (pos_ == digits) {
+            pos_ = start;
+            return false;
+        }
+        errno = 0;
+        value = std::strtoll(text_.c_str() + start, nullptr, 10);
+        if (errno == ERANGE) fail("integer out of range");
+        return true;
+    }
+
+    std::string quoted() {
+        char quote = peek();
+        ++pos_;
+        std::string value;
+        while (!at_end() && peek() != quote) {
+            if (peek() == '\\' && pos_ + 1 < text_.size()) ++pos_;
+            value += text_[pos_++];
+        }
+        if (at_end()) fail("unterminated string");
+        ++pos_;
+        return value;
+    }
+
+    FilterExpression combine(FilterExpression::Kind kind, FilterExpression first,
+                             FilterExpression (PlanParser::*next)(), const char* token) {
+        if (!consume(token)) return first;
+        FilterExpression combined;
+        combined.kind = kind;
+        combined.operands.push_back(std::move(first));
+        do {
+            combined.operands.push_back((this->*next)());
+        } while (consume(token));
+        return combined;
+    }
+
+    FilterExpression filter_or() {
+        return combine(FilterExpression::Kind::OR, filter_and(), &PlanParser::filter_and, "||");
+    }
+
+    FilterExpression filter_and() {
+        return combine(FilterExpression::Kind::AND, filter_unary(), &PlanParser::filter_unary, "&&");
+    }
+
+    FilterExpression filter_unary() {
+        skip_spaces();
+        if (!at_end() && peek() == '!' && text_.compare(pos_, 2, "!=") != 0) {
+            ++pos_;
+            FilterExpression negation;
+            negation.kind = FilterExpression::Kind::NOT;
+            negation.operands.push_back(filter_unary());
+            return negation;
+        }
+        if (!at_end() && peek() == '(') {
+            ++pos_;
+            FilterExpression inner = filter_or();
+            expect(')');
+            return inner;
+        }
+        FilterExpression test;
+        test.left = operand();
+        static const std::pair<const char*, FilterExpression::Comparison> comparisons[] = {
+            {"==", FilterExpression::Comparison::EQ}, {"!=", FilterExpression::Comparison::NE},
+            {"<=", FilterExpression::Comparison::LE}, {">=", FilterExpression::Comparison::GE},
+            {"<", FilterExpression::Comparison::LT},  {">", FilterExpression::Comparison::GT}};
+        for (const auto& comparison : comparisons) {
+            if (consume(comparison.first)) {
+                test.kind = FilterExpression::Kind::COMPARE;
+                test.comparison = comparison.second;
+                test.right = operand();
+                return test;
+            }
+        }
+        if (test.left.kind == FilterOperand::Kind::LITERAL) {
+            fail("a literal is not a test");
+        }
+        test.kind = FilterExpression::Kind::EXISTS;
+        return test;
+    }
+
+    FilterOperand operand() {
+        skip_spaces();
+        if (at_end()) fail("expected an operand");
+        FilterOperand result;
+        char c = peek();
+        if (c == '@' || c == '$') {
+            ++pos_;
+            result.kind = c == '@' ? FilterOperand::Kind::CURRENT : FilterOperand::Kind::ROOT;
+            result.path = singular_path();
+        } else if (c == '\'' || c == '"') {
+            result.literal = quoted();
+        } else if (text_.compare(pos_, 4, "true") == 0) {
+            pos_ += 4;
+            result.literal = true;
+        } else if (text_.compare(pos_, 5, "false") == 0) {
+            pos_ += 5;
+            result.literal = false;
+        } else if (text_.compare(pos_, 4, "null") == 0) {
+            pos_ += 4;
+            result.literal = nullptr;
+        } else {
+            result.literal = number();
+        }
+        return result;
+    }
+
+    std::vector<PathSegment> singular_path() {
+        std::vector<PathSegment> path;
+        while (!at_end()) {
+            PathSegment segment;
+            if (peek() == '.') {
+                ++pos_;
+                size_t start = pos_;
+                while (!at_end() && is_name_char(peek())) ++pos_;
+                if (pos_ == start) fail("empty member name");
+                segment.name = text_.substr(start, pos_ - start);
+            } else if (peek() == '[') {
+                ++pos_;
+                skip_spaces();
+                if (!at_end() && (peek() == '\'' || peek() == '"')) {
+                    segment.name = quoted();
+                } else if (integer(segment.index)) {
+                    segment.is_index = true;
+                } else {
+                    fail("filter paths only take member names and indices");
+                }
+                expect(']');
+            } else {
+                break;
+            }
+            path.push_back(std::move(segment));
+        }
+        return path;
+    }
+
+    json number() {
+        size_t start = pos_;
+        bool is_float = false;
+        if (!at_end() && (peek() == '-' || peek() == '+')) ++pos_;
+        while (!at_end()) {
+            char c = peek();
+            if (c == '.' || c == 'e' || c == 'E') {
+                is_float = true;
+            } else if (!std::isdigit(static_cast<unsigned char>(c)) &&
+                       !((c == '-' || c == '+') && (text_[pos_ - 1] == 'e' || text_[pos_ - 1] == 'E'))) {
+                break;
+            }
+            ++pos_;
+        }
+        std::string token = text_.substr(start, pos_ - start);
+        if (token.empty() || token == "-" || token == "+") fail("expected an operand");
+        char* end = nullptr;
+        if (is_float) {
+            double value = std::strtod(token.c_str(), &end);
+            if (*end != '\0') fail("invalid number '" + token + "'");
+            return value;
+        }
+        long long value = std::strtoll(token.c_str(), &end, 10);
+        if (*end != '\0') fail("invalid number '" + token + "'");
+        return value;
+    }
+};
+
+bool uses_root(const FilterExpression& expression) {
+    if (expression.left.kind == FilterOperand::Kind::ROOT || expression.right.kind == FilterOperand::Kind::ROOT) {
+        return true;
+    }
+    for (const auto& operand : expression.operands) {
+        if (uses_root(operand)) return true;
+    }
+    return false;
+}
+
+bool plan_uses_root(const std::vector<Step>& steps) {
+    for (const auto& step : steps) {
+        for (const auto& selector : step.selectors) {
+            if (selector.filter && uses_root(*selector.filter)) return true;
+        }
+    }
+    return false;
+}
+
+bool is_definite_path(const std::vector<Step>& steps) {
+    for (const auto& step : steps) {
+        if (step.descendant || step.selectors.size() != 1 ||
+            (step.selectors[0].kind != Selector::Kind::NAME && step.selectors[0].kind != Selector::Kind::INDEX)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Position of the visited node below the root; names point into the plan or the document.
+struct TrailSegment {
+    const std::string* name;
+    size_t index;
+};
+
+// Walks the document depth-first, one plan step per level, calling emit(node, trail) on
+// every match. The trail is only maintained when `track_paths` is set.
+template <typename Emit>
+class Evaluator {
+public:
+    Evaluator(const std::vector<Step>& steps, const json& root, bool track_paths, Emit& emit)
+        : steps_(steps), root_(root), track_paths_(track_paths), emit_(emit) {}
+
+    void run(size_t step_index, const json& node) {
+        if (step_index == steps_.size()) {
+            emit_(node, trail_);
+        } else if (steps_[step_index].descendant) {
+            descend(step_index, node);
+        } else {
+            apply(step_index, node);
+        }
+    }
+
+private:
+    const std::vector<Step>& steps_;
+    const json& root_;
+    const bool track_paths_;
+    Emit& emit_;
+    std::vector<TrailSegment> trail_;
+
+    void enter(size_t step_index, const json& child, const std::string* name, size_t index) {
+        if (track_paths_) trail_.push_back({name, index});
+        run(step_index, child);
+        if (track_paths_) trail_.pop_back();
+    }
+
+    // Applies the step to `node` and to every node below it.
+    void descend(size_t step_index, const json& node) {
+        apply(step_index, node);
+        if (node.is_object()) {
+            for (auto it = node.begin(); it != node.end(); ++it) {
+                if (track_paths_) trail_.push_back({&it.key(), 0});
+                descend(step_index, it.value());
+                if (track_paths_) trail_.pop_back();
+            }
+        } else if (node.is_array()) {
+            for (size_t i = 0; i < node.size(); ++i) {
+                if (track_paths_) trail_.push_back({nullptr, i});
+                descend(step_index, node[i]);
+                if (track_paths_) trail_.pop_back();
+            }
+        }
+    }
+
+    void apply(size_t step_index, const json& node) {
+        size_t next = step_index + 1;
+        for (const Selector& selector : steps_[step_index].selectors) {
+            switch (selector.kind) {
+                case Selector::Kind::NAME:
+                    if (node.is_object()) {
+                        auto it = node.find(selector.name);
+                        if (it != node.end()) enter(next, *it, &selector.name, 0);
+                    }
+                    break;
+                case Selector::Kind::INDEX:
+                    if (node.is_array()) {
+                        long long size = static_cast<long long>(node.size());
+                        long long index = selector.index < 0 ? selector.index + size : selector.index;
+                        if (index >= 0 && index < size) {
+                            enter(next, node[static_cast<size_t>(index)], nullptr, static_cast<size_t>(index));
+                        }
+                    }
+                    break;
+                case Selector::Kind::WILDCARD:
+                case Selector::Kind::FILTER:
+                    if (node.is_object()) {
+                        for (auto it = node.begin(); it != node.end(); ++it) {
+                            if (!selector.filter || test(*selector.filter, it.value())) {
+                                enter(next, it.value(), &it.key(), 0);
+                            }
+                        }
+                    } else if (node.is_array()) {
+                        for (size_t i = 0; i < node.size(); ++i) {
+                            if (!selector.filter || test(*selector.filter, node[i])) {
+                                enter(next, node[i], nullptr, i);
+                            }
+                        }
+                    }
+                    break;
+                case Selector::Kind::SLICE:
+                    if (node.is_array()) slice(next, node, selector);
+                    break;
+            }
+        }
+    }
+
+    void slice(size_t next, const json& node, const Selector& selector) {
+        long long step = selector.step;
+        if (step == 0) return;
+        long long size = static_cast<long long>(node.size());
+        auto bound = [&](bool given, long long value, long long missing) {
+            if (!given) return missing;
+            if (value < 0) value += size;
+            return step > 0 ? std::min(std::max(value, 0LL), size) : std::min(std::max(value, -1LL), size - 1);
+        };
+        long long start = bound(selector.has_start, selector.start, step > 0 ? 0 : size - 1);
+        long long end = bound(selector.has_end, selector.end, step > 0 ? size : -1);
+        for (long long i = start; step > 0 ? i < end : i > end; i += step) {
+            enter(next, node[static_cast<size_t>(i)], nullptr, static_cast<size_t>(i));
+        }
+    }
+
+    const json* resolve(const FilterOperand& operand, const json& current) const {
+        if (operand.kind == FilterOperand::Kind::LITERAL) {
+            return &operand.literal;
+        }
+        const json* node = operand.kind == FilterOperand::Kind::CURRENT ? &current : &root_;
+        for (const PathSegment& segment : operand.path) {
+            if (segment.is_index) {
+                if (!node->is_array()) return nullptr;
+                long long size = static_cast<long long>(node->size());
+                long long index = segment.index < 0 ? segment.index + size : segment.index;
+                if (index < 0 || index >= size) return nullptr;
+                node = &(*node)[static_cast<size_t>(index)];
+            } else {
+                if (!node->is_object()) return nullptr;
+                auto it = node->find(segment.name);
+                if (it == node->end()) return nullptr;
+                node = &*it;
+            }
+        }
+        return node;
+    }
+
+    static bool less(const json* left, const json* right) {
+        if (!left || !right) return false;
+        bool comparable = (left->is_number() && right->is_number()) || (left->is_string() && right->is_string());
+        return comparable && *left < *right;
+    }
+
+    static bool equal(const json* left, const json* right) {
+        if (!left || !right) return !left && !right;
+        return *left == *right;
+    }
+
+    bool test(const FilterExpression& expression, const json& current) const {
+        switch (expression.kind) {
+            case FilterExpression::Kind::OR:
+                for (const auto& operand : expression.operands) {
+                    if (test(operand, current)) return true;
+                }
+                return false;
+            case FilterExpression::Kind::AND:
+                for (const auto& operand : expression.operands) {
+                    if (!test(operand, current)) return false;
+                }
+                return true;
+            case FilterExpression::Kind::NOT:
+                return !test(expression.operands.front(), current);
+            case FilterExpression::Kind::EXISTS:
+                return resolve(expression.left, current) != nullptr;
+            case FilterExpression::Kind::COMPARE: {
+                const json* left = resolve(expression.left, current);
+                const json* right = resolve(expression.right, current);
+                switch (expression.comparison) {
+                    case FilterExpression::Comparison::EQ: return equal(left, right);
+                    case FilterExpression::Comparison::NE: return !equal(left, right);
+                    case FilterExpression::Comparison::LT: return less(left, right);
+                    case FilterExpression::Comparison::LE: return less(left, right) || equal(left, right);
+                    case FilterExpression::Comparison::GT: return less(right, left);
+                    case FilterExpression::Comparison::GE: return less(right, left) || equal(left, right);
+                }
+            }
+        }
+        return false;
+    }
+};
+
+template <typename Emit>
+void evaluate(const std::vector<Step>& steps, const json& document, bool track_paths, Emit emit) {
+    Evaluator<Emit> evaluator(steps, document, track_paths, emit);
+    evaluator.run(0, document);
+}
+
+} // namespace
+
+JSONPathPlan::JSONPathPlan() {
+    static const std::shared_ptr<const Data> root = std::make_shared<const Data>(Data{"$", {}, true, false});
+    data_ = root;
+}
+
+JSONPathPlan JSONPathPlan::compile(const std::string& jsonpath) {
+    auto data = std::make_shared<Data>();
+    data->expression = jsonpath;
+    data->steps = PlanParser(jsonpath).parse_path();
+    data->definite = is_definite_path(data->steps);
+    data->filters_use_root = plan_uses_root(data->steps);
+    return JSONPathPlan(std::move(data));
+}
+
+void JSONPathPlan::visit(const json& document, const std::function<void(const json&)>& visitor) const {
+    evaluate(data_->steps, document, false,
+             [&visitor](const json& node, const std::vector<TrailSegment>&) { visitor(node); });
+}
+
+std::vector<const json*> JSONPathPlan::select(const json& document) const {
+    std::vector<const json*> matches;
+    evaluate(data_->steps, document, false,
+             [&matches](const json& node, const std::vector<TrailSegment>&) { matches.push_back(&node); });
+    return matches;
+}
+
+std::vector<JSONPathMatch> JSONPathPlan::select_paths(const json& document) const {
+    std::vector<JSONPathMatch> matches;
+    evaluate(data_->steps, document, true, [&matches](const json& node, const std::vector<TrailSegment>& trail) {
+        std::string path = "$";
+        for (const auto& segment : trail) {
+            path += segment.name ? format_segment(*segment.name) : format_segment(segment.index);
+        }
+        matches.push_back({std::move(path), &node});
+    });
+    return matches;
+}
+
+namespace {
+
+json operand_to_script(const FilterOperand& operand) {
+    if (operand.kind == FilterOperand::Kind::LITERAL) {
+        return json::array({"lit", operand.literal});
+    }
+    json encoded = json::array({operand.kind == FilterOperand::Kind::CURRENT ? "@" : "$"});
+    for (const PathSegment& segment : operand.path) {
+        if (segment.is_index) {
+            encoded.push_back(segment.index);
+        } else {
+            encoded.push_back(segment.name);
+        }
+    }
+    return encoded;
+}
+
+json filter_to_script(const FilterExpression& expression) {
+    static const char* const COMPARISONS[] = {"==", "!=", "<", "<=", ">", ">="};
+    switch (expression.kind) {
+        case FilterExpression::Kind::EXISTS:
+            return json::array({"exists", operand_to_script(expression.left)});
+        case FilterExpression::Kind::COMPARE:
+            return json::array({"cmp", COMPARISONS[static_cast<int>(expression.comparison)],
+                                operand_to_script(expression.left), operand_to_script(expression.right)});
+        default: {
+            json encoded = json::array({expression.kind == FilterExpression::Kind::OR    ? "or"
+                                        : expression.kind == FilterExpression::Kind::AND ? "and"
+                                                                                         : "not"});
+            for (const auto& operand : expression.operands) {
+                encoded.push_back(filter_to_script(operand));
+            }
+            return encoded;
+        }
+    }
+}
+
+json selector_to_script(const Selector& selector) {
+    switch (selector.kind) {
+        case Selector::Kind::NAME:
+            return json::array({"n", selector.name});
+        case Selector::Kind::INDEX:
+            return json::array({"i", selector.index});
+        case Selector::Kind::WILDCARD:
+            return json::array({"*"});
+        case Selector::Kind::SLICE:
+            return json::array({"s", selector.has_start, selector.start, selector.has_end, selector.end, selector.step});
+        case Selector::Kind::FILTER:
+            return json::array({"f", filter_to_script(*selector.filter)});
+    }
+    return json::array();
+}
+
+} // namespace
+
+json JSONPathPlan::to_script_plan(size_t first_step) const {
+    // [[descendant, [selector, ...]], ...]; see the json_query script for the selector forms.
+    json plan = json::array();
+    for (size_t i = first_step; i < data_->steps.size(); ++i) {
+        json selectors = json::array();
+        for (const Selector& selector : data_->steps[i].selectors) {
+            selectors.push_back(selector_to_script(selector));
+        }
+        plan.push_back(json::array({data_->steps[i].descendant, std::move(selectors)}));
+    }
+    return plan;
+}
+
+std::string JSONPathPlan::leading_member() const {
+    if (data_->steps.empty()) return "";
+    const Step& first = data_->steps.front();
+    if (first.descendant || first.selectors.size() != 1 || first.selectors[0].kind != Selector::Kind::NAME) {
+        return "";
+    }
+    return first.selectors[0].name;
+}
+
+std::string JSONPathPlan::format_segment(const std::string& name) {
+    bool plain = !name.empty();
+    for (char c : name) {
+        if (!is_name_char(c)) {
+            plain = false;
+            break;
+        }
+    }
+    if (plain) return "." + name;
+    char quote = name.find('\'') == std::string::npos ? '\'' : '"';
+    return "[" + std::string(1, quote) + name + quote + "]";
+}
+
+std::string JSONPathPlan::format_segment(size_t index) {
+    return "[" + std::to_string(index) + "]";
+}
+
+} // namespace redisjson
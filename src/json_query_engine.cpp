@@ -1,7 +1,9 @@
 #include "redisjson++/json_query_engine.h"
 #include "redisjson++/redis_json_client.h" // Required for RedisJSONClient definition
 #include "redisjson++/exceptions.h"
-#include "redisjson++/path_parser.h" // May be needed for path validation or expansion
+#include <algorithm>
+#include <iterator>
+#include <mutex>
 
 namespace redisjson {
 
@@ -9,76 +11,216 @@ namespace redisjson {
 JSONQueryEngine::JSONQueryEngine(RedisJSONClient& client) : _client(client) {}
 
 // JSONPath Support
-std::vector<json> JSONQueryEngine::query(const std::string& key, const std::string& jsonpath) const {
-    // This is a complex operation.
-    // 1. Validate the JSONPath.
-    // 2. Fetch the entire JSON document from Redis using _client.get_json(key).
-    // 3. If the document exists, use a JSONPath library (like a C++ port of Stefan Goessner's or similar)
-    //    to evaluate the path against the nlohmann::json object.
-    //    nlohmann::json itself has some JSON Pointer support, but full JSONPath is more extensive.
-    //    For true JSONPath, an external library or custom implementation would be needed.
-    //    Example (conceptual, assuming a jsonpath evaluation function):
-    //    json doc = _client.get_json(key);
-    //    if (doc.is_null()) {
-    //        return {}; // Or throw PathNotFoundException if appropriate
-    //    }
-    //    try {
-    //        return jsonpath_evaluator::eval(doc, jsonpath);
-    //    } catch (const std::exception& e) {
-    //        throw QueryException("JSONPath evaluation failed: " + std::string(e.what()));
-    //    }
+JSONPathPlan JSONQueryEngine::compile(const std::string& jsonpath) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(_plans_mutex);
+        auto it = _plans.find(jsonpath);
+        if (it != _plans.end()) {
+            return it->second;
+        }
+    }
+    JSONPathPlan plan = JSONPathPlan::compile(jsonpath);
+    std::unique_lock<std::shared_mutex> lock(_plans_mutex);
+    if (_plans.size() >= MAX_CACHED_PLANS && _plans.find(jsonpath) == _plans.end()) {
+        _plans.erase(_plans.begin());
+    }
+    return _plans.emplace(jsonpath, std::move(plan)).first->second;
+}
 
-    // Placeholder implementation:
-    // For now, let's assume the 'jsonpath' is a simple path that PathParser can handle for a 'GET'
-    // This is NOT full JSONPath support.
+std::vector<SharedDocument> JSONQueryEngine::query_views(const std::string& key, const std::string& jsonpath) const {
+    JSONPathPlan plan = compile(jsonpath);
+    SharedDocument document;
     try {
-        json result = _client.get_path(key, jsonpath);
-        if (result.is_null()) {
-            return {};
-        }
-        // If get_path returns a single value, and query expects a list of matches,
-        // wrap it in a vector. If it could return multiple (e.g. wildcard), it should already be an array.
-        // For simplicity, we'll assume get_path is sufficient for a simplified "query".
-        if (result.is_array()) {
-            std::vector<json> results_vec;
-            for(const auto& item : result) {
-                results_vec.push_back(item);
-            }
-            return results_vec;
-        } else {
-             return {result};
-        }
+        document = _client.get_json_shared(key);
+    } catch (const PathNotFoundException&) {
+        return {};
+    } catch (const RedisJSONException& e) {
+        throw QueryException("Query failed for key '" + key + "' path '" + jsonpath + "': " + e.what());
+    }
+    std::vector<SharedDocument> views;
+    plan.visit(*document, [&](const json& match) {
+        // Aliasing constructor: points at the match, shares ownership of the document.
+        views.emplace_back(document, &match);
+    });
+    return views;
+}
+
+std::vector<json> JSONQueryEngine::query(const std::string& key, const std::string& jsonpath) const {
+    JSONPathPlan plan = compile(jsonpath);
+    try {
+        return _client.query_json(key, plan);
     } catch (const PathNotFoundException&) {
         return {};
     } catch (const RedisJSONException& e) {
         throw QueryException("Query failed for key '" + key + "' path '" + jsonpath + "': " + e.what());
     }
-    // To be fully implemented with a proper JSONPath library.
-    throw NotImplementedException("Full JSONPath query support is not yet implemented.");
 }
 
 // SQL-like Queries
-std::vector<json> JSONQueryEngine::select(const std::string& key, const std::string& where_clause) const {
-    // This requires a sophisticated SQL parsing and execution engine that operates on JSON.
-    // It would involve:
-    // 1. Parsing the `where_clause`.
-    // 2. Translating it into operations on the JSON structure.
-    // 3. Fetching the document and filtering it.
-    // This is a major feature.
-    throw NotImplementedException("SQL-like select queries are not yet implemented.");
-    return {}; // Should be unreachable, but satisfies compiler warning
+std::vector<json> JSONQueryEngine::select(const std::string& key_pattern, const std::string& where_clause) const {
+    std::vector<json> documents;
+    for (auto& match : _select(key_pattern, where_clause)) {
+        documents.push_back(std::move(match.second));
+    }
+    return documents;
+}
+
+std::vector<std::string> JSONQueryEngine::select_keys(const std::string& key_pattern, const std::string& where_clause) const {
+    std::vector<std::string> keys;
+    for (auto& match : _select(key_pattern, where_clause)) {
+        keys.push_back(std::move(match.first));
+    }
+    return keys;
+}
+
+std::vector<std::pair<std::string, json>> JSONQueryEngine::_select(const std::string& key_pattern,
+                                                                   const std::string& where_clause) const {
+    // The clause filters the children of the root: evaluated against [document], it
+    // matches if the document satisfies it.
+    JSONPathPlan plan = compile("$[?(" + where_clause + ")]");
+    if (plan.filters_use_root()) {
+        throw InvalidPathException("Where clause '" + where_clause + "' must refer to the document as @, not $");
+    }
+    const JSONPathPlan::FilterExpression& filter = *plan.steps().front().selectors.front().filter;
+    std::vector<std::pair<std::string, json>> matches;
+    try {
+        std::vector<std::string> keys;
+        if (std::optional<std::set<std::string>> candidates = _index_candidates(filter, key_pattern)) {
+            keys.assign(candidates->begin(), candidates->end());
+        } else {
+            keys = _client.keys_by_pattern(key_pattern);
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        }
+        std::vector<BatchResult> documents = _client.get_json_many(keys);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            json document;
+            try {
+                document = documents[i].get();
+            } catch (const PathNotFoundException&) {
+                continue; // Deleted since
+            }
+            json wrapped = json::array({std::move(document)});
+            if (!plan.select(wrapped).empty()) {
+                matches.emplace_back(keys[i], std::move(wrapped[0]));
+            }
+        }
+    } catch (const RedisJSONException& e) {
+        throw QueryException("Select failed for keys '" + key_pattern + "' where '" + where_clause + "': " + e.what());
+    }
+    return matches;
+}
+
+std::optional<std::set<std::string>> JSONQueryEngine::_index_candidates(const JSONPathPlan::FilterExpression& filter,
+                                                                       const std::string& key_pattern) const {
+    using Filter = JSONPathPlan::FilterExpression;
+    using Operand = JSONPathPlan::FilterOperand;
+    switch (filter.kind) {
+        case Filter::Kind::AND: {
+            std::optional<std::set<std::string>> result;
+            for (const auto& operand : filter.operands) {
+                std::optional<std::set<std::string>> keys = _index_candidates(operand, key_pattern);
+                if (!keys) continue;
+                if (!result) {
+                    result = std::move(keys);
+                    continue;
+                }
+                std::set<std::string> both;
+                std::set_intersection(result->begin(), result->end(), keys->begin(), keys->end(),
+                                      std::inserter(both, both.end()));
+                result = std::move(both);
+            }
+            return result;
+        }
+        case Filter::Kind::OR: {
+            std::set<std::string> result;
+            for (const auto& operand : filter.operands) {
+                std::optional<std::set<std::string>> keys = _index_candidates(operand, key_pattern);
+                if (!keys) return std::nullopt;
+                result.insert(keys->begin(), keys->end());
+            }
+            return result;
+        }
+        case Filter::Kind::COMPARE:
+            break;
+        default:
+            return std::nullopt;
+    }
+
+    // A path on the document compared with a literal, in either order.
+    const Operand* path = &filter.left;
+    const Operand* literal = &filter.right;
+    Filter::Comparison comparison = filter.comparison;
+    if (path->kind == Operand::Kind::LITERAL) {
+        std::swap(path, literal);
+        switch (comparison) {
+            case Filter::Comparison::LT: comparison = Filter::Comparison::GT; break;
+            case Filter::Comparison::LE: comparison = Filter::Comparison::GE; break;
+            case Filter::Comparison::GT: comparison = Filter::Comparison::LT; break;
+            case Filter::Comparison::GE: comparison = Filter::Comparison::LE; break;
+            default: break;
+        }
+    }
+    if (path->kind != Operand::Kind::CURRENT || literal->kind != Operand::Kind::LITERAL || path->path.empty() ||
+        comparison == Filter::Comparison::NE) {
+        return std::nullopt;
+    }
+    json segments = json::array();
+    for (const auto& segment : path->path) {
+        if (segment.is_index) {
+            segments.push_back(segment.index);
+        } else {
+            segments.push_back(segment.name);
+        }
+    }
+    std::optional<IndexDefinition> index = _client.indexes().find_for(key_pattern, segments);
+    if (!index) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> keys;
+    const json& value = literal->literal;
+    if (comparison == Filter::Comparison::EQ) {
+        if (index->type == IndexType::NUMERIC ? !value.is_number() : !IndexRegistry::tag_value(value)) {
+            return std::nullopt; // Documents with a value of another type are not in the index
+        }
+        keys = _client.index_lookup(index->name, value);
+    } else if (index->type == IndexType::NUMERIC && value.is_number()) {
+        double bound = value.get<double>();
+        bool exclusive = comparison == Filter::Comparison::LT || comparison == Filter::Comparison::GT;
+        if (comparison == Filter::Comparison::LT || comparison == Filter::Comparison::LE) {
+            keys = _client.index_range(index->name, std::nullopt, bound, false, exclusive);
+        } else {
+            keys = _client.index_range(index->name, bound, std::nullopt, exclusive, false);
+        }
+    } else {
+        return std::nullopt;
+    }
+    return std::set<std::string>(keys.begin(), keys.end());
 }
 
 // Aggregation
 json JSONQueryEngine::aggregate(const std::string& key, const std::string& path, const std::string& operation) const {
-    // This would involve:
-    // 1. Fetching the data at `path` (which might be an array or a collection of values via wildcards).
-    // 2. Performing the aggregation (`sum`, `avg`, `count`, `min`, `max`, etc.).
-    //    - `count`: trivial if path points to an array (return its size) or number of matches.
-    //    - `sum`, `avg`, `min`, `max`: require numerical data.
-    // Lua scripts could be very beneficial here for performance.
-    throw NotImplementedException("JSON aggregation is not yet implemented.");
-    return json(nullptr); // Should be unreachable, but satisfies compiler warning
+    Aggregation aggregation(operation);
+    JSONPathPlan plan = compile(path);
+    try {
+        _client.aggregate_json({key}, plan, aggregation);
+    } catch (const RedisJSONException& e) {
+        throw QueryException("Aggregation '" + operation + "' failed for key '" + key + "' path '" + path + "': " + e.what());
+    }
+    return aggregation.result();
+}
+
+json JSONQueryEngine::aggregate_keys(const std::string& key_pattern, const std::string& path,
+                                     const std::string& operation, size_t batch_size) const {
+    Aggregation aggregation(operation);
+    JSONPathPlan plan = compile(path);
+    try {
+        _client.aggregate_json(_client.keys_by_pattern(key_pattern), plan, aggregation, batch_size);
+    } catch (const RedisJSONException& e) {
+        throw QueryException("Aggregation '" + operation + "' failed for keys '" + key_pattern + "' path '" + path + "': " + e.what());
+    }
+    return aggregation.result();
 }
 
 } // namespace redisjson
@@ -0,0 +1,149 @@
+#include "redisjson++/key_scanner.h"
+#include "redisjson++/exceptions.h"
+#include "redisjson++/hiredis_RAII.h"
+
+#include <algorithm>
+
+namespace redisjson {
+
+KeyScanner::KeyScanner(RedisConnectionManager& connections, std::string pattern, ScanOptions options,
+                       std::string fetch_command, DocumentDecoder decoder, std::vector<std::string> nodes)
+    : connections_(&connections),
+      pattern_(std::move(pattern)),
+      options_(options),
+      fetch_command_(std::move(fetch_command)),
+      decoder_(std::move(decoder)),
+      nodes_(nodes.empty() ? connections.node_addresses() : std::move(nodes)),
+      count_(std::clamp(options.initial_count, std::max<size_t>(options.min_count, 1),
+                        std::max(options.max_count, std::max<size_t>(options.min_count, 1)))) {
+    if (options_.fetch_documents && !decoder_) {
+        throw ArgumentInvalidException("KeyScanner needs a document decoder to fetch documents");
+    }
+}
+
+bool KeyScanner::next(ScannedKey& entry) {
+    while (buffered_index_ >= buffered_.size()) {
+        buffered_index_ = 0;
+        if (!next_batch(buffered_)) {
+            return false;
+        }
+    }
+    entry = std::move(buffered_[buffered_index_++]);
+    return true;
+}
+
+bool KeyScanner::next_batch(std::vector<ScannedKey>& batch) {
+    batch.clear();
+    while (true) {
+        if (!connection_) {
+            if (node_index_ >= nodes_.size()) {
+                return false;
+            }
+            connection_ = connections_->get_connection_for_node(nodes_[node_index_]);
+            cursor_ = "0";
+            node_done_ = false;
+        }
+        if (node_done_ && pending_.empty()) {
+            connections_->return_connection(std::move(connection_));
+            ++node_index_;
+            continue;
+        }
+
+        // The next SCAN page, and the reads of the previous page's documents.
+        std::vector<std::vector<std::string>> commands;
+        if (!node_done_) {
+            commands.push_back({"SCAN", cursor_, "MATCH", pattern_, "COUNT", std::to_string(count_)});
+        }
+        for (const std::string& key : pending_) {
+            commands.push_back({fetch_command_, key});
+        }
+        std::vector<const char*> argv;
+        std::vector<size_t> argvlen;
+        for (const auto& command : commands) {
+            argv.clear();
+            argvlen.clear();
+            for (const auto& arg : command) {
+                argv.push_back(arg.data());
+                argvlen.push_back(arg.size());
+            }
+            if (!connection_->append_command_argv(static_cast<int>(argv.size()), argv.data(), argvlen.data())) {
+                fail("Pattern: " + pattern_ + ", Error: could not send command");
+            }
+        }
+        ++round_trips_;
+
+        std::vector<std::string> found;
+        if (!node_done_) {
+            RedisReplyPtr reply(connection_->get_reply());
+            if (!reply) {
+                fail("Pattern: " + pattern_ + ", No reply");
+            }
+            if (reply->type == REDIS_REPLY_ERROR) {
+                fail("Pattern: " + pattern_ + ", Error: " + std::string(reply->str, reply->len));
+            }
+            if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 2) {
+                fail("Pattern: " + pattern_ + ", Unexpected reply structure");
+            }
+            redisReply* cursor_reply = reply->element[0];
+            cursor_ = std::string(cursor_reply->str, cursor_reply->len);
+            node_done_ = cursor_ == "0";
+            redisReply* keys_reply = reply->element[1];
+            found.reserve(keys_reply->elements);
+            for (size_t i = 0; i < keys_reply->elements; ++i) {
+                if (keys_reply->element[i]->type == REDIS_REPLY_STRING) {
+                    found.emplace_back(keys_reply->element[i]->str, keys_reply->element[i]->len);
+                }
+            }
+            adapt_count(found.size());
+        }
+        for (std::string& key : pending_) {
+            RedisReplyPtr reply(connection_->get_reply());
+            if (!reply) {
+                fail("Pattern: " + pattern_ + ", No reply to " + fetch_command_ + " " + key);
+            }
+            ScannedKey entry{std::move(key), nullptr, nullptr};
+            try {
+                entry.document = decoder_(entry.key, reply.get());
+            } catch (const PathNotFoundException&) {
+                continue; // Deleted since it was found
+            } catch (...) {
+                entry.error = std::current_exception();
+            }
+            batch.push_back(std::move(entry));
+        }
+        pending_.clear();
+
+        if (options_.fetch_documents) {
+            pending_ = std::move(found);
+        } else {
+            for (std::string& key : found) {
+                batch.push_back({std::move(key), nullptr, nullptr});
+            }
+        }
+        if (!batch.empty()) {
+            return true;
+        }
+    }
+}
+
+void KeyScanner::adapt_count(size_t found) {
+    size_t min_count = std::max<size_t>(options_.min_count, 1);
+    size_t max_count = std::max(options_.max_count, min_count);
+    if (found < options_.target_batch_size / 2) {
+        count_ = std::min(count_ * 2, max_count);
+    } else if (found > options_.target_batch_size * 2) {
+        count_ = std::max(count_ / 2, min_count);
+    }
+}
+
+void KeyScanner::fail(const std::string& message) {
+    if (connection_) {
+        connection_->disconnect();
+        connections_->return_connection(std::move(connection_));
+    }
+    pending_.clear();
+    node_index_ = nodes_.size();
+    throw RedisCommandException("SCAN", message);
+}
+
+} // namespace redisjson
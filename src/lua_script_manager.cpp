@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <algorithm> // For std::all_of
+#include <set>
 #include <cstring>   // For strncmp
 #include <iostream>  // For std::cout, std::cerr (logging)
 #include <thread>    // For std::this_thread::get_id (logging)
@@ -15,8 +16,13 @@ namespace redisjson {
 
 // Helper function to parse a JSON path string (e.g., "obj.arr[0].field")
 // Returns a table of path segments. Numeric indices are converted to numbers (1-based for Lua).
+// Paths pre-tokenised by the client (PathParser::encode_script_path: a NUL byte, then a
+// MessagePack array of the segments) are unpacked as they are, without parsing.
 const std::string LUA_HELPER_PARSE_PATH_FUNC = R"lua(
 local function parse_path(path_str)
+    if path_str ~= nil and string.byte(path_str, 1) == 0 then
+        return cmsgpack.unpack(string.sub(path_str, 2))
+    end
     local segments = {}
     if path_str == nil or path_str == '$' or path_str == '' then
         return segments -- Root path
@@ -254,6 +260,356 @@ end
 )lua";
 
 
+// Document storage. Every built-in script reads, writes and deletes the stored document
+// through load_doc/store_doc/delete_doc; one of these preludes is prepended when the
+// script is loaded, according to the client's DocumentLayout. In the hash layout the
+// client passes the top-level member (hash field) as an extra first argument, which the
+// prelude removes from ARGV so that the script body sees the same arguments in both
+// layouts, with paths relative to that member. DOC_FIELD is nil in the string layout.
+const std::string LUA_STRING_STORAGE_PRELUDE = R"lua(
+local DOC_FIELD = nil
+local function load_doc(key) return redis.call('GET', key) end
+local function store_doc(key, data) return redis.call('SET', key, data) end
+local function delete_doc(key) return redis.call('DEL', key) end
+)lua";
+
+const std::string LUA_HASH_STORAGE_PRELUDE = R"lua(
+local DOC_FIELD = table.remove(ARGV, 1)
+local function load_doc(key) return redis.call('HGET', key, DOC_FIELD) end
+local function store_doc(key, data) return redis.call('HSET', key, DOC_FIELD, data) end
+local function delete_doc(key) return redis.call('HDEL', key, DOC_FIELD) end
+)lua";
+
+// Document codecs. Every built-in script reads and writes the stored document through
+// decode_doc/encode_doc; one of these preludes is prepended when the script is loaded,
+// according to the client's DocumentEncoding. Script arguments and replies stay JSON.
+// encode_doc(doc, true) also turns EMPTY_ARRAY_SENTINEL values back into empty arrays.
+// decoding_preserves(data) tells whether encode_doc(decode_doc(data)) stores the same
+// values (see scripts_preserve_document); it may answer false for documents that are.
+const std::string LUA_JSON_CODEC_PRELUDE = LUA_EMPTY_ARRAY_SENTINEL_DEF + R"lua(
+local function decode_doc(data)
+    return cjson.decode(data)
+end
+local function encode_doc(doc, restore_empty_arrays)
+    local data, err = cjson.encode(doc)
+    if data and restore_empty_arrays then
+        data = string.gsub(data, '"' .. EMPTY_ARRAY_SENTINEL .. '"', '[]')
+    end
+    return data, err
+end
+-- Empty arrays come back as objects, and numbers keep 14 significant digits. Brackets and
+-- digits inside strings count too.
+local function decoding_preserves(data)
+    if string.find(data, '%[%s*%]') then return false end
+    for number in string.gmatch(data, '[%d%.]+') do
+        local digits = string.gsub((string.gsub(number, '%.', '')), '^0+', '')
+        if #digits > 14 then return false end
+    end
+    return true
+end
+)lua";
+
+const std::string LUA_MSGPACK_CODEC_PRELUDE = LUA_EMPTY_ARRAY_SENTINEL_DEF + R"lua(
+-- cmsgpack drops nil members and decodes empty maps and empty arrays alike, so documents
+-- holding those bytes (or bytes that look like them) are decoded here instead: nil becomes
+-- cjson.null, as with the JSON codec, and arrays are tagged like empty_array() results.
+local MSGPACK_ARRAY_MT = { __array = true }
+local msgpack_decode_value
+local function msgpack_decode_string(data, pos, length)
+    if pos + length - 1 > #data then error('truncated MessagePack document') end
+    return string.sub(data, pos, pos + length - 1), pos + length
+end
+local function msgpack_decode_array(data, pos, count)
+    local array = setmetatable({}, MSGPACK_ARRAY_MT)
+    for i = 1, count do
+        array[i], pos = msgpack_decode_value(data, pos)
+    end
+    return array, pos
+end
+local function msgpack_decode_map(data, pos, count)
+    local map, member = {}, nil
+    for _ = 1, count do
+        member, pos = msgpack_decode_value(data, pos)
+        map[member], pos = msgpack_decode_value(data, pos)
+    end
+    return map, pos
+end
+-- Formats of the numbers and of the lengths that follow a type byte.
+local MSGPACK_NUMBERS = { [0xca] = '>f', [0xcb] = '>d', [0xcc] = '>B', [0xcd] = '>H', [0xce] = '>I4',
+                          [0xd0] = '>b', [0xd1] = '>h', [0xd2] = '>i4' }
+local MSGPACK_STRINGS = { [0xc4] = '>B', [0xc5] = '>H', [0xc6] = '>I4', [0xd9] = '>B', [0xda] = '>H', [0xdb] = '>I4' }
+local MSGPACK_ARRAYS = { [0xdc] = '>H', [0xdd] = '>I4' }
+local MSGPACK_MAPS = { [0xde] = '>H', [0xdf] = '>I4' }
+msgpack_decode_value = function(data, pos)
+    local byte = string.byte(data, pos)
+    if not byte then error('truncated MessagePack document') end
+    pos = pos + 1
+    if byte < 0x80 then return byte, pos end
+    if byte >= 0xe0 then return byte - 256, pos end
+    if byte < 0x90 then return msgpack_decode_map(data, pos, byte - 0x80) end
+    if byte < 0xa0 then return msgpack_decode_array(data, pos, byte - 0x90) end
+    if byte < 0xc0 then return msgpack_decode_string(data, pos, byte - 0xa0) end
+    if byte == 0xc0 then return cjson.null, pos end
+    if byte == 0xc2 then return false, pos end
+    if byte == 0xc3 then return true, pos end
+    if byte == 0xcf or byte == 0xd3 then -- 64-bit integers, as two 32-bit halves
+        local high, low
+        high, pos = struct.unpack(byte == 0xcf and '>I4' or '>i4', data, pos)
+        low, pos = struct.unpack('>I4', data, pos)
+        return high * 4294967296 + low, pos
+    end
+    local format = MSGPACK_NUMBERS[byte]
+    if format then return struct.unpack(format, data, pos) end
+    local length
+    format = MSGPACK_STRINGS[byte]
+    if format then
+        length, pos = struct.unpack(format, data, pos)
+        return msgpack_decode_string(data, pos, length)
+    end
+    format = MSGPACK_ARRAYS[byte]
+    if format then
+        length, pos = struct.unpack(format, data, pos)
+        return msgpack_decode_array(data, pos, length)
+    end
+    format = MSGPACK_MAPS[byte]
+    if format then
+        length, pos = struct.unpack(format, data, pos)
+        return msgpack_decode_map(data, pos, length)
+    end
+    error(string.format('unsupported MessagePack type 0x%02x', byte))
+end
+local function msgpack_decode(data)
+    local doc, pos = msgpack_decode_value(data, 1)
+    if pos <= #data then error('trailing bytes after MessagePack document') end
+    return doc
+end
+-- Tags the (non-empty) arrays cmsgpack decoded, so that one a script empties is still
+-- encoded as an array.
+local function msgpack_tag_arrays(value)
+    if type(value) == 'table' then
+        if rawget(value, 1) ~= nil then setmetatable(value, MSGPACK_ARRAY_MT) end
+        for _, v in pairs(value) do msgpack_tag_arrays(v) end
+    end
+    return value
+end
+local function decode_doc(data)
+    if string.find(data, '[\128\144\192]') then
+        local ok, doc = pcall(msgpack_decode, data)
+        if not ok then return nil, doc end
+        return doc
+    end
+    local ok, doc = pcall(cmsgpack.unpack, data)
+    if not ok then return nil, doc end
+    return msgpack_tag_arrays(doc)
+end
+
+-- cmsgpack packs cjson.null as nil but every empty table as an array, so documents with
+-- empty maps (untagged empty tables) or sentinels to restore are encoded here instead.
+local function cmsgpack_can_encode(value, restore_empty_arrays)
+    if type(value) ~= 'table' then
+        return not (restore_empty_arrays and value == EMPTY_ARRAY_SENTINEL)
+    end
+    if next(value) == nil then
+        local mt = getmetatable(value)
+        return mt ~= nil and mt.__array == true
+    end
+    for _, v in pairs(value) do
+        if not cmsgpack_can_encode(v, restore_empty_arrays) then return false end
+    end
+    return true
+end
+local function msgpack_encode_header(buffer, length, fixed, fixed_limit, code16, code32)
+    if length < fixed_limit then
+        buffer[#buffer + 1] = string.char(fixed + length)
+    elseif length < 65536 then
+        buffer[#buffer + 1] = code16 .. struct.pack('>H', length)
+    else
+        buffer[#buffer + 1] = code32 .. struct.pack('>I4', length)
+    end
+end
+local function msgpack_encode_number(buffer, value)
+    if value ~= math.floor(value) or value >= 18446744073709551616 or value < -9223372036854775808 then
+        buffer[#buffer + 1] = '\203' .. struct.pack('>d', value) -- Also NaN and infinities
+    elseif value >= 0 then
+        if value < 128 then buffer[#buffer + 1] = string.char(value)
+        elseif value < 256 then buffer[#buffer + 1] = '\204' .. string.char(value)
+        elseif value < 65536 then buffer[#buffer + 1] = '\205' .. struct.pack('>H', value)
+        elseif value < 4294967296 then buffer[#buffer + 1] = '\206' .. struct.pack('>I4', value)
+        else
+            local high = math.floor(value / 4294967296)
+            buffer[#buffer + 1] = '\207' .. struct.pack('>I4', high) .. struct.pack('>I4', value - high * 4294967296)
+        end
+    else
+        if value >= -32 then buffer[#buffer + 1] = string.char(value + 256)
+        elseif value >= -128 then buffer[#buffer + 1] = '\208' .. struct.pack('>b', value)
+        elseif value >= -32768 then buffer[#buffer + 1] = '\209' .. struct.pack('>h', value)
+        elseif value >= -2147483648 then buffer[#buffer + 1] = '\210' .. struct.pack('>i4', value)
+        else
+            local high = math.floor(value / 4294967296)
+            buffer[#buffer + 1] = '\211' .. struct.pack('>i4', high) .. struct.pack('>I4', value - high * 4294967296)
+        end
+    end
+end
+local function msgpack_encode_value(buffer, value, restore_empty_arrays)
+    local kind = type(value)
+    if value == cjson.null or kind == 'nil' then
+        buffer[#buffer + 1] = '\192'
+    elseif kind == 'boolean' then
+        buffer[#buffer + 1] = value and '\195' or '\194'
+    elseif kind == 'number' then
+        msgpack_encode_number(buffer, value)
+    elseif kind == 'string' then
+        if restore_empty_arrays and value == EMPTY_ARRAY_SENTINEL then
+            buffer[#buffer + 1] = '\144'
+        elseif #value >= 32 and #value < 256 then
+            buffer[#buffer + 1] = '\217' .. string.char(#value) .. value
+        else
+            msgpack_encode_header(buffer, #value, 0xa0, 32, '\218', '\219')
+            buffer[#buffer + 1] = value
+        end
+    elseif kind == 'table' then
+        local count = 0
+        for _ in pairs(value) do count = count + 1 end
+        local mt = getmetatable(value)
+        if (mt and mt.__array == true) or (count > 0 and #value == count) then
+            msgpack_encode_header(buffer, #value, 0x90, 16, '\220', '\221')
+            for i = 1, #value do msgpack_encode_value(buffer, value[i], restore_empty_arrays) end
+        else
+            msgpack_encode_header(buffer, count, 0x80, 16, '\222', '\223')
+            for k, v in pairs(value) do
+                msgpack_encode_value(buffer, tostring(k), false)
+                msgpack_encode_value(buffer, v, restore_empty_arrays)
+            end
+        end
+    else
+        error('cannot encode a ' .. kind .. ' as MessagePack')
+    end
+end
+local function encode_doc(doc, restore_empty_arrays)
+    if cmsgpack_can_encode(doc, restore_empty_arrays) then
+        local ok, data = pcall(cmsgpack.pack, doc)
+        if not ok then return nil, data end
+        return data
+    end
+    local buffer = {}
+    local ok, err = pcall(msgpack_encode_value, buffer, doc, restore_empty_arrays)
+    if not ok then return nil, err end
+    return table.concat(buffer)
+end
+-- 64-bit integers may lose precision and binary values come back as strings. Their type
+-- bytes inside other values count too.
+local function decoding_preserves(data)
+    return not string.find(data, '[\196-\198\207\211]')
+end
+)lua";
+
+// Secondary indexes (see IndexRegistry). Prepended to the built-in write scripts, after
+// the storage and codec preludes. The client appends the Redis key of each index covering
+// KEYS[1] to KEYS and its specification, ["numeric"|"tag", [member or index, ...]], to
+// ARGV; both are removed here, so the script body sees its usual arguments. While there
+// are indexes, store_doc and delete_doc update them along with the document. In the hash
+// layout a write only affects the indexes whose path starts with DOC_FIELD.
+const std::string LUA_INDEX_PRELUDE = R"lua(
+local INDEXES = {}
+for i = #KEYS, 2, -1 do
+    local spec = cjson.decode(table.remove(ARGV))
+    table.insert(INDEXES, 1, {key = KEYS[i], numeric = spec[1] == 'numeric', path = spec[2]})
+    KEYS[i] = nil
+end
+
+local function index_lookup(node, path, first)
+    for i = first, #path do
+        if type(node) ~= 'table' then return nil end
+        local segment = path[i]
+        if type(segment) == 'number' then
+            if segment < 0 then segment = #node + segment end
+            node = node[segment + 1]
+        else
+            node = node[segment]
+        end
+    end
+    return node
+end
+
+-- Formatted as IndexRegistry::tag_value formats it.
+local function index_tag(value)
+    local t = type(value)
+    if t == 'string' then return value end
+    if t == 'boolean' then return tostring(value) end
+    if t == 'number' then
+        if value == math.floor(value) and math.abs(value) < 1e15 then return string.format('%d', value) end
+        return string.format('%.17g', value)
+    end
+    return nil
+end
+
+local function update_index(index, key, value)
+    if index.numeric then
+        if type(value) == 'number' then
+            redis.call('ZADD', index.key, value, key)
+        else
+            redis.call('ZREM', index.key, key)
+        end
+        return
+    end
+    local tag = index_tag(value)
+    local old = redis.call('HGET', index.key, key)
+    if old == tag then return end
+    if old then redis.call('SREM', index.key .. ':' .. old, key) end
+    if tag then
+        redis.call('SADD', index.key .. ':' .. tag, key)
+        redis.call('HSET', index.key, key, tag)
+    else
+        redis.call('HDEL', index.key, key)
+    end
+end
+
+-- Updates the indexes for the new version of the document at `key` (nil: deleted). With
+-- `field` set (hash layout), `doc` is the value of that member only.
+local function index_document(key, doc, field)
+    for _, index in ipairs(INDEXES) do
+        if field == nil then
+            update_index(index, key, doc and index_lookup(doc, index.path, 1))
+        elseif index.path[1] == field then
+            update_index(index, key, doc and index_lookup(doc, index.path, 2))
+        end
+    end
+end
+
+-- The document as far as the indexes need it: all of it in the string layout, an object
+-- of the indexed members in the hash layout. nil if there is no document.
+local function load_indexed_document(key)
+    if DOC_FIELD == nil then
+        local data = load_doc(key)
+        if not data then return nil end
+        return decode_doc(data)
+    end
+    local doc = {}
+    for _, index in ipairs(INDEXES) do
+        local member = index.path[1]
+        if doc[member] == nil then
+            local data = redis.call('HGET', key, member)
+            if data then doc[member] = decode_doc(data) end
+        end
+    end
+    return doc
+end
+
+if #INDEXES > 0 then
+    local store_unindexed, delete_unindexed = store_doc, delete_doc
+    store_doc = function(key, data)
+        local result = store_unindexed(key, data)
+        index_document(key, decode_doc(data), DOC_FIELD)
+        return result
+    end
+    delete_doc = function(key)
+        local result = delete_unindexed(key)
+        index_document(key, nil, DOC_FIELD)
+        return result
+    end
+end
+)lua";
+
 const std::string LUA_COMMON_HELPERS = LUA_HELPER_PARSE_PATH_FUNC +
                                    LUA_HELPER_GET_VALUE_AT_PATH_FUNC +
                                    LUA_HELPER_SET_VALUE_AT_PATH_FUNC +
@@ -264,9 +620,9 @@ const std::string LUA_COMMON_HELPERS = LUA_HELPER_PARSE_PATH_FUNC +
 const std::string LuaScriptManager::JSON_PATH_GET_LUA = LUA_COMMON_HELPERS + R"lua(
     local key = KEYS[1]
     local path_str = ARGV[1]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then return nil end
-    local current_doc, err = cjson.decode(current_json_str)
+    local current_doc, err = decode_doc(current_json_str)
     if not current_doc then return redis.error_reply('ERR_DECODE Key ' .. key .. ': ' .. (err or 'unknown error')) end
     if path_str == '$' or path_str == '' then return cjson.encode(current_doc) end
     local path_segments = parse_path(path_str)
@@ -288,13 +644,13 @@ const std::string LuaScriptManager::JSON_PATH_SET_LUA = LUA_COMMON_HELPERS + R"l
     local create_path_str = ARGV[5]
     local create_path_flag = (create_path_str == "true")
 
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     local current_doc
     local path_exists = false
 
     if current_json_str then
         local err
-        current_doc, err = cjson.decode(current_json_str)
+        current_doc, err = decode_doc(current_json_str)
         if not current_doc then return redis.error_reply('ERR_DECODE Existing JSON: ' .. (err or 'unknown error')) end
         if path_str == '$' or path_str == '' then path_exists = true else
             local temp_path_segments = parse_path(path_str)
@@ -314,7 +670,7 @@ const std::string LuaScriptManager::JSON_PATH_SET_LUA = LUA_COMMON_HELPERS + R"l
     if not new_value and new_value_json_str ~= 'null' then return redis.error_reply('ERR_DECODE_ARG New value: '.. (err_val or 'unknown error')) end
 
     if path_str == '$' or path_str == '' then
-        if type(new_value) ~= 'table' and new_value_json_str ~= 'null' then return redis.error_reply('ERR_ROOT_TYPE Root must be object/array/null') end
+        if type(new_value) ~= 'table' and new_value_json_str ~= 'null' and not DOC_FIELD then return redis.error_reply('ERR_ROOT_TYPE Root must be object/array/null') end
         current_doc = new_value
     else
         local path_segments = parse_path(path_str)
@@ -323,9 +679,9 @@ const std::string LuaScriptManager::JSON_PATH_SET_LUA = LUA_COMMON_HELPERS + R"l
         if not success then return redis.error_reply('ERR_SET_PATH ' .. err_set) end
     end
 
-    local new_doc_json_str, err_enc = cjson.encode(current_doc)
+    local new_doc_json_str, err_enc = encode_doc(current_doc)
     if not new_doc_json_str then return redis.error_reply('ERR_ENCODE Document: ' .. (err_enc or 'unknown')) end
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
 
     local ttl = tonumber(ttl_str)
     if ttl and ttl > 0 then redis.call('EXPIRE', key, ttl) end
@@ -335,12 +691,12 @@ const std::string LuaScriptManager::JSON_PATH_SET_LUA = LUA_COMMON_HELPERS + R"l
 const std::string LuaScriptManager::JSON_PATH_DEL_LUA = LUA_COMMON_HELPERS + R"lua(
     local key = KEYS[1]
     local path_str = ARGV[1]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then return 0 end
-    local current_doc, err = cjson.decode(current_json_str)
+    local current_doc, err = decode_doc(current_json_str)
     if not current_doc then return redis.error_reply('ERR_DECODE JSON: ' .. (err or 'unknown error')) end
 
-    if path_str == '$' or path_str == '' then return redis.call('DEL', key) end
+    if path_str == '$' or path_str == '' then return delete_doc(key) end
 
     local path_segments = parse_path(path_str)
     if path_segments == nil then return redis.error_reply('ERR_PATH Invalid path string: ' .. path_str) end
@@ -348,18 +704,18 @@ const std::string LuaScriptManager::JSON_PATH_DEL_LUA = LUA_COMMON_HELPERS + R"l
     if not success then return redis.error_reply('ERR_DEL_PATH ' .. msg) end
     if msg ~= 'OK' then return 0 end
 
-    local new_doc_json_str, err_enc = cjson.encode(current_doc)
+    local new_doc_json_str, err_enc = encode_doc(current_doc)
     if not new_doc_json_str then return redis.error_reply('ERR_ENCODE Deleted doc: ' .. (err_enc or 'unknown')) end
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
     return 1
 )lua";
 
 const std::string LuaScriptManager::JSON_PATH_TYPE_LUA = LUA_COMMON_HELPERS + R"lua(
     local key = KEYS[1]
     local path_str = ARGV[1]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then return nil end
-    local current_doc, err = cjson.decode(current_json_str)
+    local current_doc, err = decode_doc(current_json_str)
     if not current_doc then return redis.error_reply('ERR_DECODE JSON: ' .. (err or 'unknown error')) end
 
     local value_at_path
@@ -388,9 +744,9 @@ const std::string LuaScriptManager::JSON_ARRAY_APPEND_LUA = LUA_COMMON_HELPERS +
     local key = KEYS[1]
     local path_str = ARGV[1]
     local value_json_str = ARGV[2]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then return redis.error_reply('ERR_NOKEY Key not found') end
-    local doc, err = cjson.decode(current_json_str)
+    local doc, err = decode_doc(current_json_str)
     if not doc then return redis.error_reply('ERR_DECODE Invalid JSON: ' .. (err or 'unknown')) end
     local value_to_append, err_val = cjson.decode(value_json_str)
     if not value_to_append and value_json_str ~= 'null' then return redis.error_reply('ERR_DECODE_ARG Value: ' .. (err_val or 'unknown')) end
@@ -406,9 +762,9 @@ const std::string LuaScriptManager::JSON_ARRAY_APPEND_LUA = LUA_COMMON_HELPERS +
     if type(target_array_ref) ~= 'table' then return redis.error_reply('ERR_NOT_ARRAY Path points to a non-array type') end
     table.insert(target_array_ref, value_to_append)
 
-    local new_doc_json_str, err_enc = cjson.encode(doc)
+    local new_doc_json_str, err_enc = encode_doc(doc)
     if not new_doc_json_str then return redis.error_reply('ERR_ENCODE Document: ' .. (err_enc or 'unknown')) end
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
     return #target_array_ref
 )lua";
 
@@ -416,9 +772,9 @@ const std::string LuaScriptManager::JSON_ARRAY_PREPEND_LUA = LUA_COMMON_HELPERS
     local key = KEYS[1]
     local path_str = ARGV[1]
     local value_json_str = ARGV[2]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then return redis.error_reply('ERR_NOKEY Key not found') end
-    local doc, err = cjson.decode(current_json_str)
+    local doc, err = decode_doc(current_json_str)
     if not doc then return redis.error_reply('ERR_DECODE Invalid JSON: ' .. (err or 'unknown')) end
     local value_to_prepend, err_val = cjson.decode(value_json_str)
     if not value_to_prepend and value_json_str ~= 'null' then return redis.error_reply('ERR_DECODE_ARG Value: ' .. (err_val or 'unknown')) end
@@ -434,9 +790,9 @@ const std::string LuaScriptManager::JSON_ARRAY_PREPEND_LUA = LUA_COMMON_HELPERS
     if type(target_array_ref) ~= 'table' then return redis.error_reply('ERR_NOT_ARRAY Path points to a non-array type') end
     table.insert(target_array_ref, 1, value_to_prepend)
 
-    local new_doc_json_str, err_enc = cjson.encode(doc)
+    local new_doc_json_str, err_enc = encode_doc(doc)
     if not new_doc_json_str then return redis.error_reply('ERR_ENCODE Document: ' .. (err_enc or 'unknown')) end
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
     return #target_array_ref
 )lua";
 
@@ -444,9 +800,9 @@ const std::string LuaScriptManager::JSON_ARRAY_POP_LUA = LUA_COMMON_HELPERS + R"
     local key = KEYS[1]
     local path_str = ARGV[1]
     local index_str = ARGV[2]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then return nil end
-    local doc, err = cjson.decode(current_json_str)
+    local doc, err = decode_doc(current_json_str)
     if not doc then return redis.error_reply('ERR_DECODE Invalid JSON: ' .. (err or 'unknown')) end
 
     local target_array_ref = doc
@@ -470,18 +826,18 @@ const std::string LuaScriptManager::JSON_ARRAY_POP_LUA = LUA_COMMON_HELPERS + R"
     if index < 1 or index > len or len == 0 then return nil end
 
     local popped_value = table.remove(target_array_ref, index)
-    local new_doc_json_str, err_enc = cjson.encode(doc)
+    local new_doc_json_str, err_enc = encode_doc(doc)
     if not new_doc_json_str then return redis.error_reply('ERR_ENCODE Document: ' .. (err_enc or 'unknown')) end
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
     return cjson.encode(popped_value)
 )lua";
 
 const std::string LuaScriptManager::JSON_ARRAY_LENGTH_LUA = LUA_COMMON_HELPERS + R"lua(
     local key = KEYS[1]
     local path_str = ARGV[1]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then return nil end
-    local doc, err = cjson.decode(current_json_str)
+    local doc, err = decode_doc(current_json_str)
     if not doc then return redis.error_reply('ERR_DECODE Invalid JSON: ' .. (err or 'unknown')) end
 
     local target_array_ref = doc
@@ -498,13 +854,13 @@ const std::string LuaScriptManager::ATOMIC_JSON_GET_SET_PATH_LUA = LUA_COMMON_HE
     local key = KEYS[1]
     local path_str = ARGV[1]
     local new_value_json_str = ARGV[2]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     local current_doc
     local old_value_encoded = cjson.encode(nil)
 
     if not current_json_str then current_doc = {} else
         local err_dec_curr
-        current_doc, err_dec_curr = cjson.decode(current_json_str)
+        current_doc, err_dec_curr = decode_doc(current_json_str)
         if not current_doc then return redis.error_reply('ERR_DECODE Existing JSON: ' .. (err_dec_curr or 'unknown')) end
         if path_str == '$' or path_str == '' then old_value_encoded = cjson.encode(current_doc) else
             local path_segments_old = parse_path(path_str)
@@ -518,7 +874,7 @@ const std::string LuaScriptManager::ATOMIC_JSON_GET_SET_PATH_LUA = LUA_COMMON_HE
     if not new_value and new_value_json_str ~= 'null' then return redis.error_reply('ERR_DECODE_ARG New value: ' .. (err_val or 'unknown')) end
 
     if path_str == '$' or path_str == '' then
-         if type(new_value) ~= 'table' and new_value_json_str ~= 'null' then return redis.error_reply('ERR_ROOT_TYPE Root must be object/array/null') end
+         if type(new_value) ~= 'table' and new_value_json_str ~= 'null' and not DOC_FIELD then return redis.error_reply('ERR_ROOT_TYPE Root must be object/array/null') end
         current_doc = new_value
     else
         local path_segments_set = parse_path(path_str)
@@ -527,9 +883,9 @@ const std::string LuaScriptManager::ATOMIC_JSON_GET_SET_PATH_LUA = LUA_COMMON_HE
         if not success then return redis.error_reply('ERR_SET_PATH ' .. err_set) end
     end
 
-    local final_doc_str, err_enc = cjson.encode(current_doc)
+    local final_doc_str, err_enc = encode_doc(current_doc)
     if not final_doc_str then return redis.error_reply('ERR_ENCODE Final doc: ' .. (err_enc or 'unknown')) end
-    redis.call('SET', key, final_doc_str)
+    store_doc(key, final_doc_str)
     return old_value_encoded
 )lua";
 
@@ -538,7 +894,7 @@ const std::string LuaScriptManager::ATOMIC_JSON_COMPARE_SET_PATH_LUA = LUA_COMMO
     local path_str = ARGV[1]
     local expected_value_json_str = ARGV[2]
     local new_value_json_str = ARGV[3]
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     local current_doc
     local actual_value_at_path
 
@@ -547,7 +903,7 @@ const std::string LuaScriptManager::ATOMIC_JSON_COMPARE_SET_PATH_LUA = LUA_COMMO
         current_doc = {}
     else
         local err_dec_curr
-        current_doc, err_dec_curr = cjson.decode(current_json_str)
+        current_doc, err_dec_curr = decode_doc(current_json_str)
         if not current_doc then return redis.error_reply('ERR_DECODE Existing JSON: ' .. (err_dec_curr or 'unknown')) end
         if path_str == '$' or path_str == '' then actual_value_at_path = current_doc else
             local path_segments_get = parse_path(path_str)
@@ -563,7 +919,7 @@ const std::string LuaScriptManager::ATOMIC_JSON_COMPARE_SET_PATH_LUA = LUA_COMMO
         if not new_value and new_value_json_str ~= 'null' then return redis.error_reply('ERR_DECODE_ARG New value CAS: ' .. (err_val or 'unknown')) end
 
         if path_str == '$' or path_str == '' then
-            if type(new_value) ~= 'table' and new_value_json_str ~= 'null' then return redis.error_reply('ERR_ROOT_TYPE Root CAS: object/array/null') end
+            if type(new_value) ~= 'table' and new_value_json_str ~= 'null' and not DOC_FIELD then return redis.error_reply('ERR_ROOT_TYPE Root CAS: object/array/null') end
             current_doc = new_value
         else
             local path_segments_set = parse_path(path_str)
@@ -571,9 +927,9 @@ const std::string LuaScriptManager::ATOMIC_JSON_COMPARE_SET_PATH_LUA = LUA_COMMO
             local success, err_set = set_value_at_path(current_doc, path_segments_set, new_value, true)
             if not success then return redis.error_reply('ERR_SET_PATH CAS: ' .. err_set) end
         end
-        local final_doc_str, err_enc = cjson.encode(current_doc)
+        local final_doc_str, err_enc = encode_doc(current_doc)
         if not final_doc_str then return redis.error_reply('ERR_ENCODE Final doc CAS: ' .. (err_enc or 'unknown')) end
-        redis.call('SET', key, final_doc_str)
+        store_doc(key, final_doc_str)
         return 1
     else
         return 0
@@ -632,7 +988,7 @@ const std::string LuaScriptManager::JSON_SPARSE_MERGE_LUA = R"lua(
         return redis.error_reply('ERR_ARG_TYPE Changes argument must be a JSON object, not an array (final check)')
     end
 
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     local current_doc
 
     if not current_json_str then
@@ -640,7 +996,7 @@ const std::string LuaScriptManager::JSON_SPARSE_MERGE_LUA = R"lua(
         current_doc = changes_doc
     else
         local err_current
-        current_doc, err_current = cjson.decode(current_json_str)
+        current_doc, err_current = decode_doc(current_json_str)
         if not current_doc then
             return redis.error_reply('ERR_DECODE_EXISTING Invalid JSON in existing key ' .. key .. ': ' .. (err_current or 'unknown error'))
         end
@@ -676,12 +1032,12 @@ const std::string LuaScriptManager::JSON_SPARSE_MERGE_LUA = R"lua(
         end
     end
 
-    local new_doc_json_str, err_encode = cjson.encode(current_doc)
+    local new_doc_json_str, err_encode = encode_doc(current_doc)
     if not new_doc_json_str then
         return redis.error_reply('ERR_ENCODE Failed to encode merged document: ' .. (err_encode or 'unknown error'))
     end
 
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
     return 1 -- Success
 )lua";
 
@@ -694,13 +1050,13 @@ local key = KEYS[1]
 local path_str = ARGV[1]
 
 -- Get the JSON string from Redis
-local current_json_str = redis.call('GET', key)
+local current_json_str = load_doc(key)
 if not current_json_str then
     return nil -- Key not found
 end
 
 -- Decode the JSON string
-local current_doc, err_decode = cjson.decode(current_json_str)
+local current_doc, err_decode = decode_doc(current_json_str)
 if not current_doc then
     return redis.error_reply('ERR_DECODE Failed to decode JSON for key ' .. key .. ': ' .. (err_decode or 'unknown error'))
 end
@@ -769,16 +1125,17 @@ const std::string LuaScriptManager::JSON_NUMINCRBY_LUA = LUA_COMMON_HELPERS + R"
     local path_str = ARGV[1]
     local increment_by_str = ARGV[2]
 
-    if path_str == '$' or path_str == '' then
+    -- A document field (hash layout) may itself be the number to increment.
+    if (path_str == '$' or path_str == '') and not DOC_FIELD then
         return redis.error_reply('ERR_PATH path cannot be root for NUMINCRBY')
     end
 
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then
         return redis.error_reply('ERR_NOKEY key ' .. key .. ' does not exist')
     end
 
-    local current_doc, err_decode = cjson.decode(current_json_str)
+    local current_doc, err_decode = decode_doc(current_json_str)
     if not current_doc then
         return redis.error_reply('ERR_DECODE Failed to decode JSON for key ' .. key .. ': ' .. (err_decode or 'unknown error'))
     end
@@ -787,7 +1144,7 @@ const std::string LuaScriptManager::JSON_NUMINCRBY_LUA = LUA_COMMON_HELPERS + R"
     if path_segments == nil or (type(path_segments) == 'table' and path_segments.err) then
          return redis.error_reply('ERR_PATH Invalid path string: ' .. path_str .. (path_segments.err or ''))
     end
-    if #path_segments == 0 then -- Should be caught by root check above, but as safeguard
+    if #path_segments == 0 and not DOC_FIELD then -- Should be caught by root check above, but as safeguard
         return redis.error_reply('ERR_PATH path cannot be root for NUMINCRBY (safeguard)')
     end
 
@@ -813,17 +1170,21 @@ const std::string LuaScriptManager::JSON_NUMINCRBY_LUA = LUA_COMMON_HELPERS + R"
         return redis.error_reply('ERR_OVERFLOW numeric overflow or invalid result after increment')
     end
 
-    local success, err_set = set_value_at_path(current_doc, path_segments, new_value, false) -- create_path is false
-    if not success then
-        return redis.error_reply('ERR_SET_PATH Failed to set new numeric value: ' .. (err_set or 'unknown error'))
+    if #path_segments == 0 then
+        current_doc = new_value
+    else
+        local success, err_set = set_value_at_path(current_doc, path_segments, new_value, false) -- create_path is false
+        if not success then
+            return redis.error_reply('ERR_SET_PATH Failed to set new numeric value: ' .. (err_set or 'unknown error'))
+        end
     end
 
-    local new_doc_json_str, err_encode = cjson.encode(current_doc)
+    local new_doc_json_str, err_encode = encode_doc(current_doc)
     if not new_doc_json_str then
         return redis.error_reply('ERR_ENCODE Failed to encode document after NUMINCRBY: ' .. (err_encode or 'unknown error'))
     end
 
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
 
     return cjson.encode(new_value) -- Return the new value, JSON encoded
 )lua";
@@ -837,13 +1198,13 @@ local key = KEYS[1]
 local path_str = ARGV[1]
 
 -- Get the JSON string from Redis
-local current_json_str = redis.call('GET', key)
+local current_json_str = load_doc(key)
 if not current_json_str then
     return nil -- Key not found, return nil (RedisJSON behavior for JSON.OBJLEN on non-existent key)
 end
 
 -- Decode the JSON string
-local current_doc, err_decode = cjson.decode(current_json_str)
+local current_doc, err_decode = decode_doc(current_json_str)
 if not current_doc then
     return redis.error_reply('ERR_DECODE Failed to decode JSON for key ' .. key .. ': ' .. (err_decode or 'unknown error'))
 end
@@ -923,12 +1284,12 @@ const std::string LuaScriptManager::JSON_ARRAY_INSERT_LUA = LUA_COMMON_HELPERS +
         return redis.error_reply('ERR_ARG_COUNT Not enough arguments for JSON.ARRINSERT')
     end
 
-    local current_json_str = redis.call('GET', key)
+    local current_json_str = load_doc(key)
     if not current_json_str then
         return redis.error_reply('ERR_NOKEY Key ' .. key .. ' does not exist')
     end
 
-    local doc, err_decode = cjson.decode(current_json_str)
+    local doc, err_decode = decode_doc(current_json_str)
     if not doc then
         return redis.error_reply('ERR_DECODE Failed to decode JSON for key ' .. key .. ': ' .. (err_decode or 'unknown error'))
     end
@@ -1046,12 +1407,12 @@ const std::string LuaScriptManager::JSON_ARRAY_INSERT_LUA = LUA_COMMON_HELPERS +
         insert_idx = insert_idx + 1
     end
 
-    local new_doc_json_str, err_encode = cjson.encode(doc)
+    local new_doc_json_str, err_encode = encode_doc(doc)
     if not new_doc_json_str then
         return redis.error_reply('ERR_ENCODE Failed to encode document after array insert: ' .. (err_encode or 'unknown error'))
     end
 
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
 
     return #target_array_ref
 )lua";
@@ -1071,13 +1432,13 @@ local start_index_str = ARGV[3]
 local end_index_str = ARGV[4]
 
 -- Get the JSON string from Redis
-local current_json_str = redis.call('GET', key)
+local current_json_str = load_doc(key)
 if not current_json_str then
     return redis.error_reply('ERR_NOKEY Key ' .. key .. ' does not exist')
 end
 
 -- Decode the JSON string
-local current_doc, err_decode = cjson.decode(current_json_str)
+local current_doc, err_decode = decode_doc(current_json_str)
 if not current_doc then
     return redis.error_reply('ERR_DECODE Failed to decode JSON for key ' .. key .. ': ' .. (err_decode or 'unknown error'))
 end
@@ -1294,14 +1655,14 @@ local key = KEYS[1]
 local path_str = ARGV[1]
 if path_str == nil then path_str = '$' end
 
-local current_json_str = redis.call('GET', key)
+local current_json_str = load_doc(key)
 
 if not current_json_str then
     if path_str == '$' or path_str == '' then return 0; end
     return redis.error_reply('ERR document not found')
 end
 
-local current_doc, err_decode = cjson.decode(current_json_str)
+local current_doc, err_decode = decode_doc(current_json_str)
 if not current_doc then
     return redis.error_reply('ERR_DECODE Failed to decode JSON for key ' .. key .. ': ' .. (err_decode or 'unknown error'))
 end
@@ -1401,15 +1762,13 @@ if doc_modified_overall then
         current_doc = replace_empty_arrays_with_sentinel_recursive(current_doc)
     end
 
-    local new_doc_json_str, err_encode = cjson.encode(current_doc)
+    -- encode_doc turns the sentinels back into empty arrays
+    local new_doc_json_str, err_encode = encode_doc(current_doc, true)
     if not new_doc_json_str then
         return redis.error_reply('ERR_ENCODE Failed to encode document after CLEAR: ' .. (err_encode or 'unknown error'))
     end
 
-    -- Replace sentinel string with actual empty array JSON '[]' AFTER encoding
-    new_doc_json_str = string.gsub(new_doc_json_str, '"' .. EMPTY_ARRAY_SENTINEL .. '"', '[]')
-
-    redis.call('SET', key, new_doc_json_str)
+    store_doc(key, new_doc_json_str)
 end
 
 return cleared_count
@@ -1428,13 +1787,13 @@ local start_index_str = ARGV[2]
 local stop_index_str = ARGV[3]
 
 -- Get the JSON string from Redis
-local current_json_str = redis.call('GET', key)
+local current_json_str = load_doc(key)
 if not current_json_str then
     return redis.error_reply('ERR_NOKEY Key ' .. key .. ' does not exist')
 end
 
 -- Decode the JSON string
-local current_doc, err_decode = cjson.decode(current_json_str)
+local current_doc, err_decode = decode_doc(current_json_str)
 if not current_doc then
     return redis.error_reply('ERR_DECODE Failed to decode JSON for key ' .. key .. ': ' .. (err_decode or 'unknown error'))
 end
@@ -1559,15 +1918,13 @@ if type(current_doc) == 'table' then -- Only if current_doc is a table (not alre
     current_doc = replace_empty_arrays_with_sentinel_recursive(current_doc)
 end
 
-local new_doc_json_str, err_encode = cjson.encode(current_doc)
+-- encode_doc turns the sentinels back into empty arrays
+local new_doc_json_str, err_encode = encode_doc(current_doc, true)
 if not new_doc_json_str then
     return redis.error_reply('ERR_ENCODE Failed to encode document after array trim: ' .. (err_encode or 'unknown error'))
 end
 
--- Replace sentinel string with actual empty array JSON '[]' AFTER encoding
-new_doc_json_str = string.gsub(new_doc_json_str, '"' .. EMPTY_ARRAY_SENTINEL .. '"', '[]')
-
-redis.call('SET', key, new_doc_json_str)
+store_doc(key, new_doc_json_str)
 
 -- Get the length of the array *at the path* after modification.
 local final_array_at_path_value -- Can be table, sentinel, or nil
@@ -1628,8 +1985,601 @@ end
 return final_length
 )lua";
 
-LuaScriptManager::LuaScriptManager(RedisConnectionManager* conn_manager)
-    : connection_manager_(conn_manager) {
+// Evaluates a compiled JSONPath (JSONPathPlan::to_script_plan) against a decoded document
+// and returns the matches in document order (object members in key order, as on the
+// client). The plan is [[descendant, [selector, ...]], ...] where a selector is
+// ["n", name], ["i", index], ["*"], ["s", has_start, start, has_end, end, step] or
+// ["f", filter]; a filter is ["or"|"and", filter...], ["not", filter], ["exists", operand]
+// or ["cmp", op, operand, operand]; an operand is ["@"|"$", segment...] (names, or 0-based
+// indices) or ["lit", value].
+const std::string LUA_HELPER_EVALUATE_PLAN_FUNC = R"lua(
+-- 'array' or 'object' for tables (an empty table has no children either way), else nil
+local function table_kind(t)
+    if type(t) ~= 'table' then return nil end
+    local n = 0
+    for k in pairs(t) do
+        if type(k) ~= 'number' then return 'object' end
+        n = n + 1
+    end
+    if n == #t then return 'array' end
+    return 'object'
+end
+
+local function sorted_keys(t)
+    local keys = {}
+    for k in pairs(t) do keys[#keys + 1] = k end
+    table.sort(keys, function(a, b) return tostring(a) < tostring(b) end)
+    return keys
+end
+
+local function deep_equal(a, b)
+    if type(a) ~= type(b) then return false end
+    if type(a) ~= 'table' then return a == b end
+    for k, v in pairs(a) do
+        if not deep_equal(v, b[k]) then return false end
+    end
+    for k in pairs(b) do
+        if a[k] == nil then return false end
+    end
+    return true
+end
+
+local function evaluate_plan(steps, root)
+    -- The value an operand refers to, and whether it exists
+    local function resolve(operand, current)
+        if operand[1] == 'lit' then return operand[2], true end
+        local node = operand[1] == '@' and current or root
+        for i = 2, #operand do
+            if type(node) ~= 'table' then return nil, false end
+            local segment = operand[i]
+            if type(segment) == 'number' then
+                if segment < 0 then segment = segment + #node end
+                node = node[segment + 1]
+            else
+                node = node[segment]
+            end
+            if node == nil then return nil, false end
+        end
+        return node, true
+    end
+
+    local function less(a, found_a, b, found_b)
+        if not found_a or not found_b then return false end
+        local ta, tb = type(a), type(b)
+        return ta == tb and (ta == 'number' or ta == 'string') and a < b
+    end
+
+    local function equal(a, found_a, b, found_b)
+        if not found_a or not found_b then return not found_a and not found_b end
+        return deep_equal(a, b)
+    end
+
+    local function test(filter, current)
+        local kind = filter[1]
+        if kind == 'or' then
+            for i = 2, #filter do if test(filter[i], current) then return true end end
+            return false
+        elseif kind == 'and' then
+            for i = 2, #filter do if not test(filter[i], current) then return false end end
+            return true
+        elseif kind == 'not' then
+            return not test(filter[2], current)
+        elseif kind == 'exists' then
+            local _, found = resolve(filter[2], current)
+            return found
+        end
+        local a, found_a = resolve(filter[3], current)
+        local b, found_b = resolve(filter[4], current)
+        local op = filter[2]
+        if op == '==' then return equal(a, found_a, b, found_b)
+        elseif op == '!=' then return not equal(a, found_a, b, found_b)
+        elseif op == '<' then return less(a, found_a, b, found_b)
+        elseif op == '<=' then return less(a, found_a, b, found_b) or equal(a, found_a, b, found_b)
+        elseif op == '>' then return less(b, found_b, a, found_a)
+        elseif op == '>=' then return less(b, found_b, a, found_a) or equal(a, found_a, b, found_b)
+        end
+        return false
+    end
+
+    local matches = {}
+    local run, apply
+
+    local function descend(step_index, node)
+        apply(step_index, node)
+        local kind = table_kind(node)
+        if kind == 'array' then
+            for i = 1, #node do descend(step_index, node[i]) end
+        elseif kind == 'object' then
+            for _, k in ipairs(sorted_keys(node)) do descend(step_index, node[k]) end
+        end
+    end
+
+    run = function(step_index, node)
+        local step = steps[step_index]
+        if not step then
+            matches[#matches + 1] = node
+        elseif step[1] then
+            descend(step_index, node)
+        else
+            apply(step_index, node)
+        end
+    end
+
+    local function each_child(node, kind, filter, step_index)
+        if kind == 'array' then
+            for i = 1, #node do
+                if not filter or test(filter, node[i]) then run(step_index, node[i]) end
+            end
+        elseif kind == 'object' then
+            for _, k in ipairs(sorted_keys(node)) do
+                if not filter or test(filter, node[k]) then run(step_index, node[k]) end
+            end
+        end
+    end
+
+    apply = function(step_index, node)
+        local kind = table_kind(node)
+        if not kind then return end
+        local next_step = step_index + 1
+        for _, selector in ipairs(steps[step_index][2]) do
+            local s = selector[1]
+            if s == 'n' then
+                if kind == 'object' and node[selector[2]] ~= nil then run(next_step, node[selector[2]]) end
+            elseif s == 'i' then
+                if kind == 'array' then
+                    local index = selector[2]
+                    if index < 0 then index = index + #node end
+                    if index >= 0 and index < #node then run(next_step, node[index + 1]) end
+                end
+            elseif s == '*' then
+                each_child(node, kind, nil, next_step)
+            elseif s == 'f' then
+                each_child(node, kind, selector[2], next_step)
+            elseif s == 's' and kind == 'array' then
+                local size, step = #node, selector[6]
+                if step ~= 0 then
+                    local function bound(given, value, missing)
+                        if not given then return missing end
+                        if value < 0 then value = value + size end
+                        if step > 0 then return math.min(math.max(value, 0), size) end
+                        return math.min(math.max(value, -1), size - 1)
+                    end
+                    local first = bound(selector[2], selector[3], step > 0 and 0 or size - 1)
+                    local last = bound(selector[4], selector[5], step > 0 and size or -1)
+                    local i = first
+                    while (step > 0 and i < last) or (step < 0 and i > last) do
+                        run(next_step, node[i + 1])
+                        i = i + step
+                    end
+                end
+            end
+        end
+    end
+
+    run(1, root)
+    return matches
+end
+)lua";
+
+// Returns the matches of a compiled JSONPath (see LUA_HELPER_EVALUATE_PLAN_FUNC) as a JSON
+// array, so that a query runs next to the data and only the matches cross the network.
+// KEYS[1] - The key where the JSON document is stored
+// ARGV[1] - The plan (JSONPathPlan::to_script_plan)
+// Returns nil if the key does not exist.
+const std::string LuaScriptManager::JSON_QUERY_LUA = LUA_HELPER_EVALUATE_PLAN_FUNC + R"lua(
+local key = KEYS[1]
+local ok, steps = pcall(cjson.decode, ARGV[1])
+if not ok or type(steps) ~= 'table' then return redis.error_reply('ERR_PATH Invalid query plan') end
+local data = load_doc(key)
+if not data then return nil end
+local root, err = decode_doc(data)
+if root == nil then return redis.error_reply('ERR_DECODE Key ' .. key .. ': ' .. (err or 'unknown error')) end
+
+local encoded = {}
+for i, value in ipairs(evaluate_plan(steps, root)) do encoded[i] = cjson.encode(value) end
+return '[' .. table.concat(encoded, ',') .. ']'
+)lua";
+
+// Aggregates the values a compiled JSONPath matches in one or more documents, so that only
+// the result crosses the network (see Aggregation for the operations).
+// KEYS    - The documents; missing keys are skipped. In cluster mode they share a hash slot.
+// ARGV[1] - The plan (JSONPathPlan::to_script_plan)
+// ARGV[2] - count, sum, avg, min, max, distinct_count or percentile
+// ARGV[3] - The percentile rank (0-100)
+// ARGV[4] - 'final' returns {"result": value}; 'partial' returns {"count", "numeric", "sum",
+//           "min", "max", "values"} for the client to combine with other batches, where
+//           values holds the distinct values (distinct_count) or the numbers (percentile).
+const std::string LuaScriptManager::JSON_AGGREGATE_LUA = LUA_HELPER_EVALUATE_PLAN_FUNC + R"lua(
+local ok, steps = pcall(cjson.decode, ARGV[1])
+if not ok or type(steps) ~= 'table' then return redis.error_reply('ERR_PATH Invalid query plan') end
+local operation = ARGV[2]
+local rank = tonumber(ARGV[3]) or 50
+local partial = ARGV[4] == 'partial'
+
+local count, numeric, sum, min, max = 0, 0, 0, nil, nil
+local distinct, distinct_count = {}, 0
+local numbers = {}
+for _, key in ipairs(KEYS) do
+    local data = load_doc(key)
+    if data then
+        local doc, err = decode_doc(data)
+        if doc == nil then return redis.error_reply('ERR_DECODE Key ' .. key .. ': ' .. (err or 'unknown error')) end
+        for _, value in ipairs(evaluate_plan(steps, doc)) do
+            count = count + 1
+            if type(value) == 'number' then
+                numeric = numeric + 1
+                sum = sum + value
+                if min == nil or value < min then min = value end
+                if max == nil or value > max then max = value end
+                if operation == 'percentile' then numbers[#numbers + 1] = value end
+            end
+            if operation == 'distinct_count' then
+                local encoded = cjson.encode(value)
+                if not distinct[encoded] then
+                    distinct[encoded] = true
+                    distinct_count = distinct_count + 1
+                end
+            end
+        end
+    end
+end
+
+-- Integral values as integers, others with full precision
+local function number(x)
+    if x == nil then return 'null' end
+    if x == math.floor(x) and math.abs(x) < 1e15 then return string.format('%d', x) end
+    return string.format('%.17g', x)
+end
+
+if partial then
+    local values = {}
+    if operation == 'distinct_count' then
+        for encoded in pairs(distinct) do values[#values + 1] = encoded end
+    else
+        for i, x in ipairs(numbers) do values[i] = number(x) end
+    end
+    return '{"count":' .. count .. ',"numeric":' .. numeric .. ',"sum":' .. number(sum) ..
+           ',"min":' .. number(min) .. ',"max":' .. number(max) .. ',"values":[' .. table.concat(values, ',') .. ']}'
+end
+
+local result = 'null'
+if operation == 'count' then
+    result = count
+elseif operation == 'sum' then
+    result = number(sum)
+elseif operation == 'avg' then
+    if numeric > 0 then result = string.format('%.17g', sum / numeric) end
+elseif operation == 'min' then
+    result = number(min)
+elseif operation == 'max' then
+    result = number(max)
+elseif operation == 'distinct_count' then
+    result = distinct_count
+elseif operation == 'percentile' then
+    if #numbers > 0 then
+        table.sort(numbers)
+        local position = rank / 100 * (#numbers - 1)
+        local lower = math.floor(position)
+        local fraction = position - lower
+        local value = numbers[lower + 1]
+        if fraction > 0 then value = value + (numbers[lower + 2] - value) * fraction end
+        result = number(value)
+    end
+else
+    return redis.error_reply('ERR_ARGUMENT Unknown aggregation ' .. tostring(operation))
+end
+return '{"result":' .. result .. '}'
+)lua";
+
+// Replaces a whole document stored in the hash layout (one field per top-level member).
+// ARGV (after DOC_FIELD, which is unused here): condition (NX/XX/NONE), ttl, then
+// field/value pairs with values already encoded by the client.
+const std::string LuaScriptManager::JSON_HASH_SET_DOCUMENT_LUA = R"lua(
+local key = KEYS[1]
+local condition = ARGV[1]
+local ttl = tonumber(ARGV[2])
+local exists = redis.call('EXISTS', key) == 1
+if condition == 'NX' and exists then return 0 end
+if condition == 'XX' and not exists then return 0 end
+redis.call('DEL', key)
+-- HSET in chunks: unpack() of very many arguments would overflow the Lua C stack.
+local i = 3
+while i <= #ARGV do
+    local last = math.min(i + 199, #ARGV)
+    redis.call('HSET', key, unpack(ARGV, i, last))
+    i = last + 1
+end
+if ttl and ttl > 0 and i > 3 then redis.call('EXPIRE', key, ttl) end
+if #INDEXES > 0 then index_document(key, load_indexed_document(key), nil) end
+return 1
+)lua";
+
+// Shallow-merges top-level members into a document stored in the hash layout when indexes
+// cover the key; otherwise the client sends a plain HSET. ARGV (after the unused
+// DOC_FIELD): field/value pairs with values already encoded by the client.
+const std::string LuaScriptManager::JSON_HASH_MERGE_FIELDS_LUA = R"lua(
+local key = KEYS[1]
+local i = 1
+while i <= #ARGV do
+    local last = math.min(i + 199, #ARGV)
+    redis.call('HSET', key, unpack(ARGV, i, last))
+    i = last + 1
+end
+index_document(key, load_indexed_document(key), nil)
+return 1
+)lua";
+
+// Replaces a whole document in the string layout when indexes cover the key; otherwise
+// the client sends a plain SET. ARGV: condition (NX/XX/NONE), ttl, the encoded document.
+const std::string LuaScriptManager::JSON_SET_DOCUMENT_LUA = R"lua(
+local key = KEYS[1]
+local condition = ARGV[1]
+local ttl = tonumber(ARGV[2])
+local exists = redis.call('EXISTS', key) == 1
+if condition == 'NX' and exists then return 0 end
+if condition == 'XX' and not exists then return 0 end
+store_doc(key, ARGV[3])
+if ttl and ttl > 0 then redis.call('EXPIRE', key, ttl) end
+return 1
+)lua";
+
+// Deletes a whole document (either layout) and its index entries. Returns the number of
+// keys deleted.
+const std::string LuaScriptManager::JSON_DEL_DOCUMENT_LUA = R"lua(
+local key = KEYS[1]
+local deleted = redis.call('DEL', key)
+index_document(key, nil, nil)
+return deleted
+)lua";
+
+// Brings the indexes passed along with KEYS[1] up to date with its current document, e.g.
+// when an index is created over existing documents. Returns the number of indexes.
+const std::string LuaScriptManager::JSON_INDEX_DOCUMENT_LUA = R"lua(
+local key = KEYS[1]
+index_document(key, load_indexed_document(key), nil)
+return #INDEXES
+)lua";
+
+// Applies an RFC 6902 JSON Patch (add, remove, replace, move, copy, test) to a decoded
+// document. Arrays are told from objects by their first element, so an empty table is
+// taken for an array only when addressed with an array index or '-'.
+// apply_patch(doc, ops) returns the patched document, or nil and an error message.
+const std::string LUA_HELPER_APPLY_PATCH_FUNC = R"lua(
+local function pointer_segments(pointer)
+    if pointer == '' then return {} end
+    if type(pointer) ~= 'string' or string.sub(pointer, 1, 1) ~= '/' then return nil end
+    local segments = {}
+    for raw in string.gmatch(string.sub(pointer, 2) .. '/', '([^/]*)/') do
+        segments[#segments + 1] = (raw:gsub('~1', '/'):gsub('~0', '~'))
+    end
+    return segments
+end
+
+local function patch_is_array(node, segment)
+    if rawget(node, 1) ~= nil then return true end
+    if next(node) ~= nil then return false end
+    return segment == '-' or string.match(segment, '^%d+$') ~= nil
+end
+
+-- 1-based index of an array segment ('0' or digits without a leading zero), or nil
+local function patch_index(segment)
+    if segment == '0' or string.match(segment, '^[1-9]%d*$') then return tonumber(segment) + 1 end
+    return nil
+end
+
+local function patch_child(node, segment)
+    if type(node) ~= 'table' then return nil end
+    if patch_is_array(node, segment) then
+        local index = patch_index(segment)
+        return index and node[index]
+    end
+    return node[segment]
+end
+
+local function patch_parent(doc, segments)
+    local node = doc
+    for i = 1, #segments - 1 do
+        node = patch_child(node, segments[i])
+        if node == nil then return nil end
+    end
+    if type(node) ~= 'table' then return nil end
+    return node
+end
+
+local function patch_get(doc, segments)
+    if #segments == 0 then return doc end
+    local parent = patch_parent(doc, segments)
+    return parent and patch_child(parent, segments[#segments])
+end
+
+local function patch_copy(value)
+    if type(value) ~= 'table' then return value end
+    local copy = {}
+    for k, v in pairs(value) do copy[k] = patch_copy(v) end
+    return setmetatable(copy, getmetatable(value))
+end
+
+local function patch_equal(a, b)
+    if type(a) ~= 'table' or type(b) ~= 'table' then return a == b end
+    for k, v in pairs(a) do
+        if not patch_equal(v, b[k]) then return false end
+    end
+    for k in pairs(b) do
+        if a[k] == nil then return false end
+    end
+    return true
+end
+
+local function patch_add(doc, segments, value)
+    if #segments == 0 then return value end
+    local parent = patch_parent(doc, segments)
+    if not parent then return nil, 'path not found' end
+    local last = segments[#segments]
+    if patch_is_array(parent, last) then
+        local index = last == '-' and #parent + 1 or patch_index(last)
+        if not index or index > #parent + 1 then return nil, 'array index out of bounds' end
+        table.insert(parent, index, value)
+    else
+        parent[last] = value
+    end
+    return doc
+end
+
+local function patch_remove(doc, segments)
+    if #segments == 0 then return nil, 'cannot remove the root' end
+    local parent = patch_parent(doc, segments)
+    if not parent then return nil, 'path not found' end
+    local last = segments[#segments]
+    if patch_is_array(parent, last) then
+        local index = patch_index(last)
+        if not index or parent[index] == nil then return nil, 'path not found' end
+        return doc, table.remove(parent, index)
+    end
+    local value = parent[last]
+    if value == nil then return nil, 'path not found' end
+    parent[last] = nil
+    return doc, value
+end
+
+local function apply_patch(doc, ops)
+    if type(ops) ~= 'table' then return nil, 'the patch must be an array of operations' end
+    for i, op in ipairs(ops) do
+        local path = type(op) == 'table' and pointer_segments(op.path)
+        if not path then return nil, 'operation ' .. i .. ': invalid path' end
+        local name = op.op
+        local err, value
+        if (name == 'add' or name == 'replace' or name == 'test') and op.value == nil then
+            return nil, 'operation ' .. i .. ': missing value'
+        end
+        if name == 'add' then
+            doc, err = patch_add(doc, path, op.value)
+        elseif name == 'remove' then
+            doc, err = patch_remove(doc, path)
+        elseif name == 'replace' then
+            if patch_get(doc, path) == nil then return nil, 'operation ' .. i .. ': path not found' end
+            if #path > 0 then doc = patch_remove(doc, path) end
+            doc, err = patch_add(doc, path, op.value)
+        elseif name == 'move' or name == 'copy' then
+            local from = pointer_segments(op.from)
+            if not from then return nil, 'operation ' .. i .. ': invalid from' end
+            if name == 'move' then
+                if #from < #path and op.path:sub(1, #op.from + 1) == op.from .. '/' then
+                    return nil, 'operation ' .. i .. ': cannot move a value into itself'
+                end
+                doc, value = patch_remove(doc, from)
+                if doc == nil then return nil, 'operation ' .. i .. ': ' .. value end
+            else
+                value = patch_get(doc, from)
+                if value == nil then return nil, 'operation ' .. i .. ': from not found' end
+                value = patch_copy(value)
+            end
+            doc, err = patch_add(doc, path, value)
+        elseif name == 'test' then
+            if not patch_equal(patch_get(doc, path), op.value) then
+                return nil, 'operation ' .. i .. ': test failed for ' .. op.path
+            end
+        else
+            return nil, 'operation ' .. i .. ': unknown op ' .. tostring(name)
+        end
+        if doc == nil then return nil, 'operation ' .. i .. ': ' .. err end
+    end
+    return doc
+end
+)lua";
+
+// Delta write (string layout): applies a JSON Patch to the stored document, provided it is
+// still the version the client diffed against. ARGV: the SHA1 of that version's stored
+// value, the patch, ttl. Returns 0 if the stored value differs (or is missing), otherwise
+// [SHA1 of the new stored value, its length] as JSON, for the client's next delta.
+const std::string LuaScriptManager::JSON_DELTA_SET_LUA = LUA_HELPER_APPLY_PATCH_FUNC + R"lua(
+local key = KEYS[1]
+local data = load_doc(key)
+if not data or redis.sha1hex(data) ~= ARGV[1] then return 0 end
+local doc, err = decode_doc(data)
+if doc == nil then return redis.error_reply('ERR_DECODE Key ' .. key .. ': ' .. (err or 'unknown error')) end
+doc, err = apply_patch(doc, cjson.decode(ARGV[2]))
+if doc == nil then return redis.error_reply('ERR_PATCH ' .. err) end
+local new_data, err_enc = encode_doc(doc)
+if not new_data then return redis.error_reply('ERR_ENCODE Document: ' .. (err_enc or 'unknown')) end
+store_doc(key, new_data)
+local ttl = tonumber(ARGV[3])
+if ttl and ttl > 0 then redis.call('EXPIRE', key, ttl) end
+return cjson.encode({redis.sha1hex(new_data), #new_data})
+)lua";
+
+// RFC 6902 JSON Patch applied to a whole document (string layout) in one call. ARGV: the
+// patch. A missing key is patched as a null document, so only an operation on the root
+// can create it. Returns 1; if an operation fails (including a failed "test"), returns an
+// ERR_PATCH error and the document is left unchanged. Returns 0, without patching, if the
+// stored document would not survive decoding (decoding_preserves); the client then
+// patches it itself and stores it with json_replace_if_unchanged.
+const std::string LuaScriptManager::JSON_PATCH_LUA = LUA_HELPER_APPLY_PATCH_FUNC + R"lua(
+local key = KEYS[1]
+local data = load_doc(key)
+if data and not decoding_preserves(data) then return 0 end
+local doc, err = cjson.null, nil
+if data then
+    doc, err = decode_doc(data)
+    if doc == nil then return redis.error_reply('ERR_DECODE Key ' .. key .. ': ' .. (err or 'unknown error')) end
+end
+local ok, ops = pcall(cjson.decode, ARGV[1])
+if not ok then return redis.error_reply('ERR_PATCH Invalid patch: ' .. tostring(ops)) end
+doc, err = apply_patch(doc, ops)
+if doc == nil then return redis.error_reply('ERR_PATCH ' .. err) end
+local new_data, err_enc = encode_doc(doc, true)
+if not new_data then return redis.error_reply('ERR_ENCODE Document: ' .. (err_enc or 'unknown')) end
+store_doc(key, new_data)
+return 1
+)lua";
+
+// RFC 7386 JSON Merge Patch applied to a whole document (string layout) in one call.
+// ARGV: the patch, which must be an object (any other patch simply replaces the document,
+// which the client does with a plain write). A missing key is merged into an empty
+// object. Returns 1, or 0 as JSON_PATCH_LUA does.
+const std::string LuaScriptManager::JSON_MERGE_PATCH_LUA = R"lua(
+local function merge_patch(target, patch)
+    if type(patch) ~= 'table' or rawget(patch, 1) ~= nil then return patch end
+    if type(target) ~= 'table' or rawget(target, 1) ~= nil then target = {} end
+    for k, v in pairs(patch) do
+        if v == cjson.null then
+            target[k] = nil
+        else
+            target[k] = merge_patch(target[k], v)
+        end
+    end
+    return target
+end
+
+local key = KEYS[1]
+local data = load_doc(key)
+if data and not decoding_preserves(data) then return 0 end
+local doc, err = {}, nil
+if data then
+    doc, err = decode_doc(data)
+    if doc == nil then return redis.error_reply('ERR_DECODE Key ' .. key .. ': ' .. (err or 'unknown error')) end
+end
+local ok, patch = pcall(cjson.decode, ARGV[1])
+if not ok or type(patch) ~= 'table' then return redis.error_reply('ERR_ARGUMENT The merge patch must be an object') end
+local new_data, err_enc = encode_doc(merge_patch(doc, patch), true)
+if not new_data then return redis.error_reply('ERR_ENCODE Document: ' .. (err_enc or 'unknown')) end
+store_doc(key, new_data)
+return 1
+)lua";
+
+// Stores a document (string layout) the client read and modified, provided the stored
+// value is still the one it read. ARGV: the SHA1 of that value ("" if the key was
+// missing), the encoded new document. Returns 1, or 0 if the stored value has changed.
+const std::string LuaScriptManager::JSON_REPLACE_IF_UNCHANGED_LUA = R"lua(
+local key = KEYS[1]
+local data = load_doc(key)
+if (data and redis.sha1hex(data) or '') ~= ARGV[1] then return 0 end
+store_doc(key, ARGV[2])
+return 1
+)lua";
+
+LuaScriptManager::LuaScriptManager(RedisConnectionManager* conn_manager, DocumentEncoding encoding,
+                                   DocumentLayout layout)
+    : connection_manager_(conn_manager), encoding_(encoding), layout_(layout) {
     if (!conn_manager) {
         throw std::invalid_argument("RedisConnectionManager cannot be null for LuaScriptManager.");
     }
@@ -1643,39 +2593,51 @@ void LuaScriptManager::load_script(const std::string& name, const std::string& s
     if (name.empty() || script_body.empty()) {
         throw std::invalid_argument("Script name and body cannot be empty.");
     }
-    RedisConnectionManager::RedisConnectionPtr conn_guard = connection_manager_->get_connection();
-    RedisConnection* conn = conn_guard.get();
-    if (!conn || !conn->is_connected()) {
-        throw ConnectionException("Failed to get valid Redis connection for SCRIPT LOAD.");
-    }
-    RedisReplyPtr reply(static_cast<redisReply*>(conn->command("SCRIPT LOAD %s", script_body.c_str())));
-
-    std::string error_context_for_throw;
-    if (conn && conn->get_context()) {
-        error_context_for_throw = " (hiredis context error: " + std::string(conn->get_context()->errstr ? conn->get_context()->errstr : "unknown") +
-                                  ", code: " + std::to_string(conn->get_context()->err) + ")";
-    } else if (conn) {
-        error_context_for_throw = " (hiredis context is null, connection might be bad)";
-    } else {
-        error_context_for_throw = " (RedisConnection object is null)";
-    }
-
-    if (!reply) {
-        throw RedisCommandException("SCRIPT LOAD", "No reply from Redis for script '" + name + "'" + error_context_for_throw);
-    }
+    // In cluster mode every primary needs the script; the SHA1 is the same on all of them.
     std::string sha1_hash;
-    if (reply->type == REDIS_REPLY_STRING) {
-        sha1_hash = std::string(reply->str, reply->len);
-    } else if (reply->type == REDIS_REPLY_ERROR) {
-        std::string err_msg = (reply->str ? std::string(reply->str, reply->len) : "Unknown Redis error");
-        throw RedisCommandException("SCRIPT LOAD", "Error for script '" + name + "': " + err_msg);
-    } else {
-        throw RedisCommandException("SCRIPT LOAD", "Unexpected reply type for script '" + name + "': " + std::to_string(reply->type));
+    for (const std::string& node : connection_manager_->node_addresses()) {
+        RedisConnectionManager::RedisConnectionPtr conn_guard = connection_manager_->get_connection_for_node(node);
+        RedisConnection* conn = conn_guard.get();
+        if (!conn || !conn->is_connected()) {
+            throw ConnectionException("Failed to get valid Redis connection for SCRIPT LOAD.");
+        }
+        RedisReplyPtr reply(static_cast<redisReply*>(conn->command("SCRIPT LOAD %s", script_body.c_str())));
+
+        std::string error_context_for_throw;
+        if (conn && conn->get_context()) {
+            error_context_for_throw = " (hiredis context error: " + std::string(conn->get_context()->errstr ? conn->get_context()->errstr : "unknown") +
+                                      ", code: " + std::to_string(conn->get_context()->err) + ")";
+        } else if (conn) {
+            error_context_for_throw = " (hiredis context is null, connection might be bad)";
+        } else {
+            error_context_for_throw = " (RedisConnection object is null)";
+        }
+
+        if (!reply) {
+            throw RedisCommandException("SCRIPT LOAD", "No reply from Redis for script '" + name + "'" + error_context_for_throw);
+        }
+        if (reply->type == REDIS_REPLY_STRING) {
+            sha1_hash = std::string(reply->str, reply->len);
+        } else if (reply->type == REDIS_REPLY_ERROR) {
+            std::string err_msg = (reply->str ? std::string(reply->str, reply->len) : "Unknown Redis error");
+            throw RedisCommandException("SCRIPT LOAD", "Error for script '" + name + "': " + err_msg);
+        } else {
+            throw RedisCommandException("SCRIPT LOAD", "Unexpected reply type for script '" + name + "': " + std::to_string(reply->type));
+        }
     }
 
     if (sha1_hash.empty()) {
          throw RedisCommandException("SCRIPT LOAD", "Failed to load script '" + name + "', SHA1 hash is empty.");
     }
+    // Replicas get the script too, for reads routed there. A replica that cannot load it
+    // answers NOSCRIPT, and those reads are resent to the primary, so this is best effort.
+    for (const std::string& replica : connection_manager_->replica_addresses()) {
+        try {
+            RedisConnectionManager::RedisConnectionPtr conn = connection_manager_->get_connection_for_node(replica);
+            RedisReplyPtr reply(static_cast<redisReply*>(conn->command("SCRIPT LOAD %s", script_body.c_str())));
+        } catch (const RedisJSONException&) {
+        }
+    }
     {
         std::lock_guard<std::mutex> lock(cache_mutex_);
         script_shas_[name] = sha1_hash;
@@ -1701,19 +2663,39 @@ const std::map<std::string, const std::string*> LuaScriptManager::SCRIPT_DEFINIT
     {"json_array_insert", &LuaScriptManager::JSON_ARRAY_INSERT_LUA},
     {"json_clear", &LuaScriptManager::JSON_CLEAR_LUA},
     {"json_arrindex", &LuaScriptManager::JSON_ARRINDEX_LUA},
-    {"json_array_trim", &LuaScriptManager::JSON_ARRAY_TRIM_LUA}
+    {"json_array_trim", &LuaScriptManager::JSON_ARRAY_TRIM_LUA},
+    {"json_hash_set_document", &LuaScriptManager::JSON_HASH_SET_DOCUMENT_LUA},
+    {"json_hash_merge_fields", &LuaScriptManager::JSON_HASH_MERGE_FIELDS_LUA},
+    {"json_set_document", &LuaScriptManager::JSON_SET_DOCUMENT_LUA},
+    {"json_del_document", &LuaScriptManager::JSON_DEL_DOCUMENT_LUA},
+    {"json_index_document", &LuaScriptManager::JSON_INDEX_DOCUMENT_LUA},
+    {"json_delta_set", &LuaScriptManager::JSON_DELTA_SET_LUA},
+    {"json_patch", &LuaScriptManager::JSON_PATCH_LUA},
+    {"json_merge_patch", &LuaScriptManager::JSON_MERGE_PATCH_LUA},
+    {"json_replace_if_unchanged", &LuaScriptManager::JSON_REPLACE_IF_UNCHANGED_LUA},
+    {"json_query", &LuaScriptManager::JSON_QUERY_LUA},
+    {"json_aggregate", &LuaScriptManager::JSON_AGGREGATE_LUA}
 };
 
 // Moved get_script_body_by_name and redis_reply_to_json here
-const std::string* LuaScriptManager::get_script_body_by_name(const std::string& name) const {
+std::string LuaScriptManager::get_script_body_by_name(const std::string& name) const {
+    return get_builtin_script(name, encoding_, layout_);
+}
+
+std::string LuaScriptManager::get_builtin_script(const std::string& name, DocumentEncoding encoding,
+                                                 DocumentLayout layout) {
     auto it = SCRIPT_DEFINITIONS.find(name);
-    if (it != SCRIPT_DEFINITIONS.end()) {
-        return it->second;
+    if (it == SCRIPT_DEFINITIONS.end()) {
+        return std::string();
     }
-    return nullptr;
+    const std::string& storage = (layout == DocumentLayout::HASH) ? LUA_HASH_STORAGE_PRELUDE
+                                                                  : LUA_STRING_STORAGE_PRELUDE;
+    const std::string& codec = (encoding == DocumentEncoding::MESSAGEPACK) ? LUA_MSGPACK_CODEC_PRELUDE
+                                                                          : LUA_JSON_CODEC_PRELUDE;
+    return storage + codec + (is_read_only_script(name) ? std::string() : LUA_INDEX_PRELUDE) + *it->second;
 }
 
-json LuaScriptManager::redis_reply_to_json(redisReply* reply) const {
+json LuaScriptManager::redis_reply_to_json(redisReply* reply) {
     if (!reply) return json(nullptr);
 
     switch (reply->type) {
@@ -1770,11 +2752,8 @@ json LuaScriptManager::redis_reply_to_json(redisReply* reply) const {
     }
 }
 
-json LuaScriptManager::execute_script(const std::string& name,
-                                    const std::vector<std::string>& keys,
-                                    const std::vector<std::string>& args) {
+std::string LuaScriptManager::get_script_sha(const std::string& name) {
     std::string sha1_hash;
-    bool attempted_on_demand_load = false;
 
     for (int attempt = 0; attempt < 2; ++attempt) {
         std::unique_lock<std::mutex> lock(cache_mutex_);
@@ -1787,14 +2766,13 @@ json LuaScriptManager::execute_script(const std::string& name,
             throw LuaScriptException(name, "Script SHA not found in cache even after on-demand load attempt for: " + name);
         }
         lock.unlock();
-        attempted_on_demand_load = true;
-        const std::string* script_body_ptr = get_script_body_by_name(name);
+        std::string script_body = get_script_body_by_name(name);
 
-        if (!script_body_ptr) {
+        if (script_body.empty()) {
             throw LuaScriptException(name, "Script body not found for on-demand loading of script: " + name);
         }
         try {
-            load_script(name, *script_body_ptr);
+            load_script(name, script_body);
         } catch (const RedisJSONException& e) {
             throw LuaScriptException(name, "Failed to load script '" + name + "' on demand: " + std::string(e.what()));
         }
@@ -1803,42 +2781,81 @@ json LuaScriptManager::execute_script(const std::string& name,
     if (sha1_hash.empty()) {
         throw LuaScriptException(name, "Failed to obtain SHA1 for script: " + name + " after load attempts.");
     }
+    return sha1_hash;
+}
 
-    RedisConnectionManager::RedisConnectionPtr conn_guard = connection_manager_->get_connection();
-    RedisConnection* conn = conn_guard.get();
-     if (!conn || !conn->is_connected()) {
-        throw ConnectionException("Failed to get valid Redis connection for EVALSHA.");
+void LuaScriptManager::reload_builtin_script(const std::string& name) {
+    std::string script_body = get_script_body_by_name(name);
+    if (script_body.empty()) {
+        throw LuaScriptException(name, "Not a built-in script: " + name);
     }
+    load_script(name, script_body);
+}
 
-    std::vector<const char*> argv_c;
-    std::vector<size_t> argv_len;
-    argv_c.push_back("EVALSHA");
-    argv_len.push_back(strlen("EVALSHA"));
-    argv_c.push_back(sha1_hash.c_str());
-    argv_len.push_back(sha1_hash.length());
-    std::string num_keys_str = std::to_string(keys.size());
-    argv_c.push_back(num_keys_str.c_str());
-    argv_len.push_back(num_keys_str.length());
-    for (const auto& key : keys) {
-        argv_c.push_back(key.c_str());
-        argv_len.push_back(key.length());
+json LuaScriptManager::execute_script(const std::string& name,
+                                    const std::vector<std::string>& keys,
+                                    const std::vector<std::string>& args) {
+    std::string sha1_hash = get_script_sha(name);
+
+    std::vector<std::string> index_keys, index_args;
+    if (index_registry_ && keys.size() == 1 && SCRIPT_DEFINITIONS.count(name) && !is_read_only_script(name)) {
+        index_registry_->append_script_arguments(keys.front(), index_keys, index_args);
     }
-    for (const auto& arg : args) {
-        argv_c.push_back(arg.c_str());
-        argv_len.push_back(arg.length());
+    std::vector<std::string> argv = {"EVALSHA", sha1_hash, std::to_string(keys.size() + index_keys.size())};
+    argv.insert(argv.end(), keys.begin(), keys.end());
+    argv.insert(argv.end(), index_keys.begin(), index_keys.end());
+    argv.insert(argv.end(), args.begin(), args.end());
+    argv.insert(argv.end(), index_args.begin(), index_args.end());
+    // Routed to the node serving KEYS[1] in cluster mode; reads may go to a replica.
+    const std::string routing_key = keys.empty() ? std::string() : keys.front();
+    RedisReplyPtr reply = is_read_only_script(name) ? connection_manager_->execute_read(routing_key, argv)
+                                                    : connection_manager_->execute_for_key(routing_key, argv);
+    if (!reply) {
+        throw RedisCommandException("EVALSHA", "No reply from Redis (connection error) for script " + name);
     }
 
-    RedisReplyPtr reply(static_cast<redisReply*>(conn->command_argv(argv_c.size(), argv_c.data(), argv_len.data())));
+    if (reply->type == REDIS_REPLY_ERROR && strncmp(reply->str, "NOSCRIPT", 8) == 0) {
+        // A server whose script cache was flushed, or a primary that joined (or failed
+        // over) after the scripts were loaded: load the built-in script there and retry once.
+        std::string script_body = get_script_body_by_name(name);
+        if (!script_body.empty()) {
+            RedisReplyPtr load_reply = connection_manager_->execute_for_key(routing_key, {"SCRIPT", "LOAD", script_body});
+            if (load_reply && load_reply->type == REDIS_REPLY_STRING) {
+                reply = connection_manager_->execute_for_key(routing_key, argv);
+                if (!reply) {
+                    throw RedisCommandException("EVALSHA", "No reply from Redis (connection error) for script " + name);
+                }
+            }
+        }
+    }
+    return evalsha_reply_to_json(name, reply.get());
+}
 
-    if (!reply) {
-         throw RedisCommandException("EVALSHA", "No reply from Redis (connection error: " + (conn->get_context() ? std::string(conn->get_context()->errstr) : "unknown") + ") for script " + name);
+bool LuaScriptManager::is_read_only_script(const std::string& name) {
+    static const std::set<std::string> READ_ONLY_SCRIPTS = {
+        "json_path_get", "json_path_type", "json_array_length", "json_object_keys", "json_object_length", "json_arrindex",
+        "json_query", "json_aggregate"};
+    return READ_ONLY_SCRIPTS.count(name) > 0;
+}
+
+json LuaScriptManager::mark_empty_arrays(json value) {
+    if (value.is_array() && value.empty()) {
+        return "__EMPTY_ARRAY_SENTINEL_PLACEHOLDER__"; // EMPTY_ARRAY_SENTINEL in LUA_EMPTY_ARRAY_SENTINEL_DEF
+    }
+    if (value.is_structured()) {
+        for (json& element : value) {
+            element = mark_empty_arrays(std::move(element));
+        }
     }
+    return value;
+}
 
+json LuaScriptManager::evalsha_reply_to_json(const std::string& name, redisReply* reply) {
     if (reply->type == REDIS_REPLY_ERROR && strncmp(reply->str, "NOSCRIPT", 8) == 0) {
         std::string noscript_error_msg = std::string(reply->str, reply->len);
         throw LuaScriptException(name, "Script not found on server (NOSCRIPT): " + noscript_error_msg + ". Consider reloading scripts if SCRIPT FLUSH occurred.");
     }
-    return redis_reply_to_json(reply.get());
+    return redis_reply_to_json(reply);
 }
 
 void LuaScriptManager::preload_builtin_scripts() {
@@ -1846,9 +2863,8 @@ void LuaScriptManager::preload_builtin_scripts() {
     int fail_count = 0;
     for (const auto& pair : SCRIPT_DEFINITIONS) {
         const std::string& script_name = pair.first;
-        const std::string* script_body = pair.second;
         try {
-            load_script(script_name, *script_body);
+            load_script(script_name, get_script_body_by_name(script_name));
             success_count++;
         } catch (const RedisJSONException& e) {
             fail_count++;
@@ -0,0 +1,222 @@
+#include "redisjson++/multiplexed_connection.h"
+#include "redisjson++/redis_connection_manager.h" // For RedisConnection
+#include "redisjson++/exceptions.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <cerrno>
+
+namespace redisjson {
+
+namespace {
+
+// How often the reader thread wakes up to check for shutdown while idle; fail_session()
+// also wakes it by shutting the socket down.
+constexpr int POLL_INTERVAL_MS = 200;
+constexpr std::chrono::seconds RECONNECT_DELAY = std::chrono::seconds(1);
+
+// Writes all of `data`, retrying partial writes. The socket is blocking, with the
+// configured timeout as send timeout.
+bool send_all(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+MultiplexedConnection::MultiplexedConnection(const LegacyClientConfig& config)
+    : config_(config),
+      connection_(std::make_unique<RedisConnection>(config.host, config.port, config.password, config.database, config.timeout)) {
+    // Connect once up front, so commands submitted right after construction are not
+    // rejected while the writer thread starts.
+    connected_ = connection_->connect();
+    writer_ = std::thread(&MultiplexedConnection::write_loop, this);
+}
+
+MultiplexedConnection::~MultiplexedConnection() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+std::string MultiplexedConnection::format_command(const std::vector<std::string>& argv) {
+    std::string command = "*" + std::to_string(argv.size()) + "\r\n";
+    for (const auto& arg : argv) {
+        command += "$" + std::to_string(arg.size()) + "\r\n";
+        command += arg;
+        command += "\r\n";
+    }
+    return command;
+}
+
+std::future<RedisReplyPtr> MultiplexedConnection::submit(const std::vector<std::string>& argv) {
+    Request request{format_command(argv), {}};
+    std::future<RedisReplyPtr> reply = request.reply.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || !connected_) {
+            request.reply.set_exception(std::make_exception_ptr(ConnectionException(
+                "Multiplexed connection to " + config_.host + ":" + std::to_string(config_.port) + " is down")));
+            return reply;
+        }
+        queued_.push_back(std::move(request));
+    }
+    work_available_.notify_one();
+    return reply;
+}
+
+RedisReplyPtr MultiplexedConnection::execute(const std::vector<std::string>& argv) {
+    return await_reply(submit(argv));
+}
+
+RedisReplyPtr MultiplexedConnection::await_reply(std::future<RedisReplyPtr> reply) {
+    if (reply.wait_for(config_.timeout) != std::future_status::ready) {
+        fail_session();
+        throw TimeoutException("No reply from " + config_.host + ":" + std::to_string(config_.port) +
+                               " within " + std::to_string(config_.timeout.count()) + " ms");
+    }
+    return reply.get();
+}
+
+size_t MultiplexedConnection::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queued_.size() + in_flight_.size();
+}
+
+void MultiplexedConnection::write_loop() {
+    while (!stopping_) {
+        if (!connected_) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_available_.wait_for(lock, RECONNECT_DELAY, [this] { return stopping_.load(); });
+            }
+            if (stopping_) break;
+            connection_ = std::make_unique<RedisConnection>(config_.host, config_.port, config_.password,
+                                                            config_.database, config_.timeout);
+            connected_ = connection_->connect();
+            continue;
+        }
+
+        session_failed_ = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            session_fd_ = connection_->get_context()->fd;
+        }
+        std::thread reader(&MultiplexedConnection::read_loop, this);
+        write_batches(connection_->get_context()->fd);
+        fail_session();
+        reader.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            session_fd_ = -1;
+            connected_ = false;
+            fail_all_locked(stopping_ ? "Multiplexed connection is shutting down"
+                                      : "Multiplexed connection to " + config_.host + ":" +
+                                            std::to_string(config_.port) + " failed");
+        }
+        connection_->disconnect();
+    }
+}
+
+void MultiplexedConnection::write_batches(int fd) {
+    std::string batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] {
+                return stopping_.load() || session_failed_.load() || !queued_.empty();
+            });
+            if (stopping_ || session_failed_) return;
+            // Requests move to in_flight_ before their bytes are sent, so the reader always
+            // finds the waiter for a reply.
+            batch.clear();
+            for (auto& request : queued_) {
+                batch += request.command;
+                in_flight_.push_back(std::move(request.reply));
+            }
+            queued_.clear();
+        }
+        if (!send_all(fd, batch)) return;
+    }
+}
+
+void MultiplexedConnection::read_loop() {
+    redisContext* context = connection_->get_context();
+    pollfd fds[1] = {{context->fd, POLLIN, 0}};
+
+    while (!stopping_ && !session_failed_) {
+        int ready = poll(fds, 1, POLL_INTERVAL_MS);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (ready == 0) continue;
+        if ((fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 && (fds[0].revents & POLLIN) == 0) {
+            break;
+        }
+        if (redisBufferRead(context) != REDIS_OK) {
+            break;
+        }
+        bool protocol_error = false;
+        while (true) {
+            void* raw_reply = nullptr;
+            if (redisGetReplyFromReader(context, &raw_reply) != REDIS_OK) {
+                protocol_error = true;
+                break;
+            }
+            if (!raw_reply) break;
+            RedisReplyPtr reply(static_cast<redisReply*>(raw_reply));
+            std::promise<RedisReplyPtr> waiter;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (in_flight_.empty()) {
+                    protocol_error = true; // A reply nobody asked for: the stream is out of sync
+                    break;
+                }
+                waiter = std::move(in_flight_.front());
+                in_flight_.pop_front();
+            }
+            waiter.set_value(std::move(reply));
+        }
+        if (protocol_error) break;
+    }
+    fail_session();
+}
+
+void MultiplexedConnection::fail_session() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        session_failed_ = true;
+        if (session_fd_ >= 0) {
+            ::shutdown(session_fd_, SHUT_RDWR);
+        }
+    }
+    work_available_.notify_all();
+}
+
+void MultiplexedConnection::fail_all_locked(const std::string& reason) {
+    auto error = std::make_exception_ptr(ConnectionException(reason));
+    for (auto& waiter : in_flight_) {
+        waiter.set_exception(error);
+    }
+    in_flight_.clear();
+    for (auto& request : queued_) {
+        request.reply.set_exception(error);
+    }
+    queued_.clear();
+}
+
+} // namespace redisjson
@@ -1,10 +1,14 @@
 #include "redisjson++/path_parser.h"
 #include "redisjson++/exceptions.h" // For InvalidPathException
+#include "redisjson++/json_path_plan.h"
 #include <nlohmann/json.hpp> // Added for json type
 #include <iostream> // For temporary debugging
 #include <algorithm>
 #include <stdexcept> // For std::invalid_argument, std::out_of_range
 #include <optional> // Required for PathElement slice members
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace redisjson {
 
@@ -30,6 +34,57 @@ static bool elements_before_require_dot(const PathParser::PathElement& prev_el)
 }
 
 
+struct PathParser::CompiledPathCache {
+    explicit CompiledPathCache(size_t capacity) : capacity(capacity) {}
+    const size_t capacity;
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, CompiledPath> paths;
+};
+
+PathParser::PathParser(size_t compiled_path_cache_size)
+    : compiled_paths_(std::make_unique<CompiledPathCache>(compiled_path_cache_size)) {}
+
+PathParser::~PathParser() = default;
+PathParser::PathParser(PathParser&&) noexcept = default;
+PathParser& PathParser::operator=(PathParser&&) noexcept = default;
+
+CompiledPath::CompiledPath() {
+    static const std::shared_ptr<const Data> root = std::make_shared<const Data>(Data{"$", {}, ""});
+    data_ = root;
+}
+
+CompiledPath PathParser::compile(const std::string& path) const {
+    if (compiled_paths_ && compiled_paths_->capacity > 0) {
+        std::shared_lock<std::shared_mutex> lock(compiled_paths_->mutex);
+        auto it = compiled_paths_->paths.find(path);
+        if (it != compiled_paths_->paths.end()) {
+            return it->second;
+        }
+    }
+    auto data = std::make_shared<CompiledPath::Data>();
+    data->path = path;
+    data->elements = parse(path);
+    data->script_argument = encode_script_path(data->elements);
+    CompiledPath compiled(std::move(data));
+    if (!compiled_paths_ || compiled_paths_->capacity == 0) {
+        return compiled;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(compiled_paths_->mutex);
+    auto& paths = compiled_paths_->paths;
+    if (paths.size() >= compiled_paths_->capacity && paths.find(path) == paths.end()) {
+        paths.erase(paths.begin());
+    }
+    // If another thread compiled the same path meanwhile, its copy is kept and returned.
+    return paths.emplace(path, std::move(compiled)).first->second;
+}
+
+size_t PathParser::compiled_path_count() const {
+    if (!compiled_paths_) return 0;
+    std::shared_lock<std::shared_mutex> lock(compiled_paths_->mutex);
+    return compiled_paths_->paths.size();
+}
+
 // Very simplified initial parser. It will only handle basic dot notation and simple array indexing.
 // e.g., "key1.key2", "array[0].key"
 // Does not yet support root '$', wildcards, slices, filters, recursive descent, or complex bracket notations.
@@ -54,7 +109,12 @@ std::vector<PathParser::PathElement> PathParser::parse(const std::string& path_s
         // PathParser::is_root_path can encapsulate this.
         return elements;
     }
-
+    // "$.a.b" and "$[0]" are "a.b" and "[0]" relative to the root.
+    if (path_str.compare(0, 2, "$.") == 0) {
+        path_str.erase(0, 2);
+    } else if (path_str.compare(0, 2, "$[") == 0) {
+        path_str.erase(0, 1);
+    }
 
     std::string current_segment;
     for (size_t i = 0; i < path_str.length(); ++i) {
@@ -219,14 +279,22 @@ std::vector<std::string> PathParser::expand_wildcards(const json& document,
         if (reconstructed_path.empty() && !parsed_path.empty()) return {};
         return {reconstructed_path};
     }
-    throw std::runtime_error("Wildcard expansion is not yet implemented.");
+    return expand_wildcards(document, reconstruct_path(parsed_path));
 }
 
 std::vector<std::string> PathParser::expand_wildcards(const json& document,
                                                       const std::string& path_str) const {
     if (path_str.empty()) return {""};
-    auto parsed = parse(path_str);
-    return expand_wildcards(document, parsed);
+    JSONPathPlan plan = JSONPathPlan::compile(path_str);
+    if (plan.is_definite()) {
+        auto parsed = parse(path_str);
+        return expand_wildcards(document, parsed);
+    }
+    std::vector<std::string> paths;
+    for (auto& match : plan.select_paths(document)) {
+        paths.push_back(std::move(match.path));
+    }
+    return paths;
 }
 
 
@@ -235,6 +303,60 @@ bool PathParser::is_root_path(const std::string& path_str) {
     return trim(path_str) == "$";
 }
 
+std::pair<std::string, std::string> PathParser::split_top_level(const std::string& path_str_in) {
+    std::string path = trim(path_str_in);
+    if (path.empty() || path == "$" || path == ".") {
+        return {"", ""};
+    }
+    if (path.compare(0, 2, "$.") == 0) {
+        path = path.substr(2);
+    }
+    size_t end = path.find_first_of(".[");
+    if (end == 0 || path[0] == '$') {
+        throw InvalidPathException("Path '" + path_str_in + "' does not start with a member name");
+    }
+    if (end == std::string::npos) {
+        return {path, ""};
+    }
+    std::string rest = (path[end] == '.') ? path.substr(end + 1) : path.substr(end);
+    if (rest.empty()) {
+        throw InvalidPathException("Path '" + path_str_in + "' ends with a dot");
+    }
+    return {path.substr(0, end), rest};
+}
+
+std::string PathParser::encode_script_path(const std::vector<PathElement>& path_elements) {
+    if (path_elements.empty()) {
+        return "";
+    }
+    json segments = json::array();
+    for (const auto& element : path_elements) {
+        if (element.type == PathElement::Type::KEY) {
+            segments.push_back(element.key_name);
+        } else if (element.type == PathElement::Type::INDEX) {
+            segments.push_back(static_cast<int64_t>(element.index) + 1);
+        } else {
+            return "";
+        }
+    }
+    std::vector<std::uint8_t> packed = json::to_msgpack(segments);
+    std::string encoded(1, '\0');
+    encoded.append(packed.begin(), packed.end());
+    return encoded;
+}
+
+std::string PathParser::script_path_argument(const std::string& path_str) {
+    if (path_str.empty() || path_str == "$" || path_str == ".") {
+        return path_str;
+    }
+    static const PathParser shared_parser;
+    try {
+        return shared_parser.compile(path_str).script_argument();
+    } catch (const InvalidPathException&) {
+        return path_str;
+    }
+}
+
 // This is a heuristic. A path like "a.b" doesn't strictly define 'b' as an array
 // until an operation like "a.b[0]" or "a.b.append(...)" is attempted.
 // This function primarily checks if the *final* element of a path is an INDEX type,
@@ -293,7 +415,7 @@ std::string PathParser::reconstruct_path(const std::vector<PathElement>& path_el
         const auto& el = path_elements[i];
         switch (el.type) {
             case PathElement::Type::KEY:
-                if (!first_key && (p_str.empty() || p_str.back() != ']')) { // Avoid leading dot if first element, or dot after bracket
+                if (!first_key && (p_str.empty() || (p_str.back() != ']' && p_str.back() != '.'))) { // Avoid leading dot if first element, or dot after bracket or ".."
                     p_str += ".";
                 }
                 p_str += el.key_name; // Simplified: assumes key_name is safe or PathParser::escape_key_if_needed was used
@@ -303,10 +425,22 @@ std::string PathParser::reconstruct_path(const std::vector<PathElement>& path_el
                 p_str += "[" + std::to_string(el.index) + "]";
                 first_key = false; // After an index, next key doesn't need a dot if it's a quoted key in brackets
                 break;
-            // TODO: Add other types (SLICE, WILDCARD, etc.)
-            default:
-                // This should ideally not happen if path_elements is valid
-                p_str += ".<ERROR_UNKNOWN_PATH_ELEMENT>";
+            case PathElement::Type::WILDCARD:
+                p_str += "[*]";
+                first_key = false;
+                break;
+            case PathElement::Type::SLICE: // start/end of -1 mean "not given"
+                p_str += "[" + (el.start < 0 ? std::string() : std::to_string(el.start)) + ":" +
+                         (el.end < 0 ? std::string() : std::to_string(el.end)) + "]";
+                first_key = false;
+                break;
+            case PathElement::Type::FILTER:
+                p_str += "[?(" + el.filter_expression + ")]";
+                first_key = false;
+                break;
+            case PathElement::Type::RECURSIVE: // Applies to the element that follows
+                p_str += "..";
+                first_key = false;
                 break;
         }
     }
@@ -1,10 +1,13 @@
 #include "redisjson++/redis_connection_manager.h"
+#include "redisjson++/multiplexed_connection.h"
 #include <stdexcept> // For runtime_error
 #include <vector>    // For command_argv
 #include <cstdarg>   // For va_list, va_start, va_end
 #include <cstring>   // For strcmp
-#include <algorithm> // For std::find_if
+#include <algorithm> // For std::min, std::partition
 #include <iostream>  // For std::cout (logging)
+#include <cstdint>   // For SIZE_MAX
+#include <tuple>     // For std::tie
 // <thread> is included via redis_connection_manager.h for std::this_thread::get_id
 
 namespace redisjson {
@@ -264,9 +267,90 @@ redisReply* RedisConnection::command_argv(int argc, const char **argv, const siz
     return reply;
 }
 
+bool RedisConnection::append_command_argv(int argc, const char **argv, const size_t *argvlen) {
+    if (!is_connected()) {
+        return false;
+    }
+    if (redisAppendCommandArgv(context_, argc, argv, argvlen) != REDIS_OK) {
+        last_error_message_ = "redisAppendCommandArgv failed: " + std::string(context_->errstr);
+        connected_ = false;
+        return false;
+    }
+    return true;
+}
+
+redisReply* RedisConnection::get_reply() {
+    if (!is_connected()) {
+        return nullptr;
+    }
+    void* reply_ptr = nullptr;
+    if (redisGetReply(context_, &reply_ptr) != REDIS_OK || reply_ptr == nullptr) {
+        last_error_message_ = "redisGetReply failed: " + std::string(context_->errstr);
+        connected_ = false;
+        return nullptr;
+    }
+    last_used_time = std::chrono::steady_clock::now();
+    return static_cast<redisReply*>(reply_ptr);
+}
+
 // --- RedisConnectionManager Implementation ---
+namespace {
+constexpr size_t MAX_POOL_STRIPES = 16;
+// Upper bound on commands written before their replies are drained, so that very
+// large batches don't buffer every request (and every reply) in memory at once.
+constexpr size_t PIPELINE_CHUNK_SIZE = 512;
+constexpr int MAX_CLUSTER_REDIRECTS = 5;
+constexpr int64_t MIN_SLOT_REFRESH_INTERVAL_MS = 1000;
+// How long reads stay on the primary after a write that too few replicas acknowledged.
+constexpr int64_t PRIMARY_READS_AFTER_UNACKNOWLEDGED_WRITE_MS = 1000;
+
+int64_t steady_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+thread_local bool primary_reads_only = false; // See RedisConnectionManager::PrimaryReadScope
+
+bool is_error_with_prefix(const redisReply* reply, const char* prefix) {
+    size_t length = strlen(prefix);
+    return reply && reply->type == REDIS_REPLY_ERROR && reply->str && reply->len >= length &&
+           strncmp(reply->str, prefix, length) == 0;
+}
+
+// Whether a replica's reply is final, or the command should be resent to the primary:
+// no reply (connection lost), a script the replica has not loaded, a replica still
+// loading its dataset or cut off from its primary (replica-serve-stale-data no).
+bool replica_served(const redisReply* reply) {
+    return reply && !is_error_with_prefix(reply, "NOSCRIPT") && !is_error_with_prefix(reply, "LOADING") &&
+           !is_error_with_prefix(reply, "MASTERDOWN") && !is_error_with_prefix(reply, "READONLY");
+}
+}
+
 RedisConnectionManager::RedisConnectionManager(const ClientConfig& config) : config_(config) {
+    size_t stripe_count = std::min(MAX_POOL_STRIPES, static_cast<size_t>(std::max(config_.connection_pool_size, 1)));
+    for (size_t i = 0; i < stripe_count; ++i) {
+        stripes_.push_back(std::make_unique<PoolStripe>());
+    }
+    if (config_.cluster_mode) {
+        // The pools live in the per-node managers. An unreachable cluster is not an error
+        // yet: the slot map is read again when the first command needs it.
+        try {
+            refresh_cluster_slots();
+        } catch (const ConnectionException&) {
+        }
+        return;
+    }
+    for (const std::string& address : config_.replica_nodes) {
+        ClientConfig replica_config = config_;
+        std::tie(replica_config.host, replica_config.port) = split_node_address(address);
+        replica_config.replica_nodes.clear();
+        replica_config.read_policy = ReadPolicy::PRIMARY;
+        replica_config.replica_write_acks = 0;
+        replicas_.push_back(std::make_unique<RedisConnectionManager>(replica_config));
+    }
     initialize_pool();
+    for (int i = 0; i < config_.multiplexed_connections; ++i) {
+        multiplexed_.push_back(std::make_unique<MultiplexedConnection>(config_));
+    }
     if (config_.connection_pool_size > 0 && health_check_interval_.count() > 0) {
         run_health_checker_ = true;
         health_check_thread_ = std::thread(&RedisConnectionManager::health_check_loop, this);
@@ -277,336 +361,657 @@ RedisConnectionManager::~RedisConnectionManager() {
     shutting_down_ = true;
     if (run_health_checker_) {
         run_health_checker_ = false;
-        condition_.notify_all();
-        if (health_check_thread_.joinable()) {
-            health_check_thread_.join();
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
         }
+        condition_.notify_all();
+    }
+    if (health_check_thread_.joinable()) {
+        health_check_thread_.join();
     }
     close_all_connections();
 }
 
-// Changed to create_new_connection_ptr and return RedisConnectionPtr
-RedisConnectionManager::RedisConnectionPtr RedisConnectionManager::create_new_connection_ptr(const std::string& host, int port) {
-    auto conn_raw = new RedisConnection(host, port, config_.password, config_.database, config_.timeout);
-    conn_raw->connect(); // Attempt to connect
-    return RedisConnectionPtr(conn_raw, RedisConnectionDeleter(this));
+size_t RedisConnectionManager::home_stripe() const {
+    return std::hash<std::thread::id>{}(std::this_thread::get_id()) % stripes_.size();
 }
 
-void RedisConnectionManager::initialize_pool() {
-    // std::cout << "LOG: RedisConnectionManager::initialize_pool() - Entry. Pool size: " << config_.connection_pool_size << std::endl;
-    std::lock_guard<std::mutex> lock(pool_mutex_);
-    for (int i = 0; i < config_.connection_pool_size; ++i) {
-        // std::cout << "LOG: RedisConnectionManager::initialize_pool() - Attempting to create initial connection " << (i + 1) << "/" << config_.connection_pool_size << std::endl;
-        RedisConnection* conn_raw = new RedisConnection(config_.host, config_.port, config_.password, config_.database, config_.timeout);
-        bool connected_successfully = false;
+RedisConnection* RedisConnectionManager::take_idle() {
+    size_t home = home_stripe();
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        PoolStripe& stripe = *stripes_[(home + i) % stripes_.size()];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        if (!stripe.idle.empty()) {
+            RedisConnection* conn = stripe.idle.back();
+            stripe.idle.pop_back();
+            stats_.idle_connections--;
+            return conn;
+        }
+    }
+    return nullptr;
+}
 
-        if (conn_raw) {
-            // std::cout << "LOG: RedisConnectionManager::initialize_pool() - Connection " << (i+1) << " allocated. Calling connect()." << std::endl;
-            connected_successfully = conn_raw->connect();
-        } else {
-            // std::cout << "LOG: RedisConnectionManager::initialize_pool() - Connection " << (i+1) << " FAILED TO ALLOCATE (new returned null)." << std::endl;
+void RedisConnectionManager::put_idle(RedisConnection* conn, size_t stripe_index) {
+    PoolStripe& stripe = *stripes_[stripe_index];
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.idle.push_back(conn);
+        stats_.idle_connections++;
+    }
+    notify_waiter();
+}
+
+bool RedisConnectionManager::try_reserve_slot() {
+    uint32_t total = stats_.total_connections.load();
+    while (static_cast<int64_t>(total) < config_.connection_pool_size) {
+        if (stats_.total_connections.compare_exchange_weak(total, total + 1)) {
+            return true;
         }
+    }
+    return false;
+}
 
-        if (connected_successfully) {
-            // std::cout << "LOG: RedisConnectionManager::initialize_pool() - Connection " << (i+1) << " connected successfully." << std::endl;
-            RedisConnectionManager::RedisConnectionPtr conn(conn_raw, RedisConnectionDeleter(this));
-            available_connections_.push(conn.get());
-            pool_.push_back(std::move(conn));
-            stats_.idle_connections++;
-            stats_.total_connections++;
-            if (pool_.size() == 1 && i == 0) primary_healthy_ = true;
-        } else {
-            // std::cout << "LOG: RedisConnectionManager::initialize_pool() - Connection " << (i+1) << " FAILED to connect. Last error: " << (conn_raw ? conn_raw->get_last_error() : "N/A (allocation failed)") << std::endl;
-            stats_.connection_errors++;
-            if (conn_raw) {
-                delete conn_raw;
-            }
-            if (i == 0) primary_healthy_ = false;
+void RedisConnectionManager::release_slot() {
+    if (stats_.total_connections > 0) {
+        stats_.total_connections--;
+    }
+    notify_waiter();
+}
+
+void RedisConnectionManager::notify_waiter() {
+    // Waiters re-check their predicate under pool_mutex_, so taking it here (only when
+    // someone is waiting) guarantees the wakeup is not lost.
+    if (waiters_.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
         }
+        condition_.notify_one();
     }
-    // std::cout << "LOG: RedisConnectionManager::initialize_pool() - Exit. Total connections in pool: " << pool_.size()
-    //           << ", Available: " << available_connections_.size()
-    //           << ", Stats(total/active/idle/errors): "
-    //           << stats_.total_connections.load() << "/" << stats_.active_connections.load() << "/"
-    //           << stats_.idle_connections.load() << "/" << stats_.connection_errors.load() << std::endl;
 }
 
-RedisConnectionManager::RedisConnectionPtr RedisConnectionManager::get_connection() {
-    // std::cout << "LOG: RedisConnectionManager::get_connection() - Entry. Thread ID: " << std::this_thread::get_id() << std::endl;
-    std::unique_lock<std::mutex> lock(pool_mutex_);
-    // std::cout << "LOG: RedisConnectionManager::get_connection() - Acquired pool_mutex_. Thread ID: " << std::this_thread::get_id() << std::endl;
+std::unique_ptr<RedisConnection> RedisConnectionManager::open_connection(std::string& error_detail) {
+    auto conn = std::make_unique<RedisConnection>(config_.host, config_.port, config_.password, config_.database, config_.timeout);
+    if (!conn->connect()) {
+        error_detail = conn->get_last_error();
+        stats_.connection_errors++;
+        release_slot();
+        return nullptr;
+    }
+    return conn;
+}
 
+void RedisConnectionManager::initialize_pool() {
+    for (int i = 0; i < config_.connection_pool_size; ++i) {
+        if (!try_reserve_slot()) break;
+        std::string error_detail;
+        std::unique_ptr<RedisConnection> conn = open_connection(error_detail);
+        if (conn) {
+            put_idle(conn.release(), static_cast<size_t>(i) % stripes_.size());
+            if (i == 0) primary_healthy_ = true;
+        } else if (i == 0) {
+            primary_healthy_ = false;
+        }
+    }
+}
 
+RedisConnectionManager::RedisConnectionPtr RedisConnectionManager::get_connection() {
+    if (config_.cluster_mode) {
+        return manager_for_key(std::string())->get_connection();
+    }
     while (true) {
         if (shutting_down_) {
-            // std::cout << "LOG: RedisConnectionManager::get_connection() - Shutting down. Throwing ConnectionException. Thread ID: " << std::this_thread::get_id() << std::endl;
             throw ConnectionException("Connection manager is shutting down.");
         }
 
-        // std::cout << "LOG: RedisConnectionManager::get_connection() - Before condition_variable.wait. Predicate: (shutting_down_ || !available_connections_.empty() || ((stats_.active_connections + pool_.size()) < config_.connection_pool_size)). Values: available_empty="
-        //           << available_connections_.empty() << ", active=" << stats_.active_connections.load()
-        //           << ", pool_v_sz=" << pool_.size() << ", config_pool_sz=" << config_.connection_pool_size
-        //           << ". Thread ID: " << std::this_thread::get_id() << std::endl;
+        if (RedisConnection* conn = take_idle()) {
+            if (conn->is_connected()) {
+                stats_.active_connections++;
+                conn->pool_epoch = pool_epoch_.load();
+                return RedisConnectionPtr(conn, RedisConnectionDeleter(this));
+            }
+            // Dropped since it was pooled; the health thread would have caught it later.
+            stats_.connection_errors++;
+            delete conn;
+            release_slot();
+            continue;
+        }
+
+        if (try_reserve_slot()) {
+            std::string error_detail;
+            std::unique_ptr<RedisConnection> conn = open_connection(error_detail);
+            if (!conn) {
+                throw ConnectionException("Failed to create new connection to " + config_.host + ":" +
+                                          std::to_string(config_.port) + ". Detail: " + error_detail);
+            }
+            if (shutting_down_) {
+                release_slot();
+                throw ConnectionException("Connection manager is shutting down during new connection creation.");
+            }
+            stats_.active_connections++;
+            conn->pool_epoch = pool_epoch_.load();
+            return RedisConnectionPtr(conn.release(), RedisConnectionDeleter(this));
+        }
 
+        // Pool exhausted: wait until a connection is returned or a slot is freed.
+        std::unique_lock<std::mutex> lock(pool_mutex_);
+        waiters_++;
         condition_.wait(lock, [this] {
-            // This predicate is logged before the wait by the caller
-            return shutting_down_ ||
-                   !available_connections_.empty() ||
-                   ((stats_.active_connections + pool_.size()) < static_cast<size_t>(this->config_.connection_pool_size));
+            return shutting_down_.load() || stats_.idle_connections.load() > 0 ||
+                   static_cast<int64_t>(stats_.total_connections.load()) < config_.connection_pool_size;
         });
+        waiters_--;
+    }
+}
 
-        // std::cout << "LOG: RedisConnectionManager::get_connection() - Woke up from condition_variable.wait. Thread ID: " << std::this_thread::get_id() << std::endl;
+void RedisConnectionManager::return_connection(RedisConnectionManager::RedisConnectionPtr conn_param_owner) {
+    if (!conn_param_owner) {
+        return;
+    }
+    // In cluster mode connections come from (and go back to) the per-node managers.
+    RedisConnectionManager* owner = conn_param_owner.get_deleter().manager_ptr_;
+    if (owner && owner != this) {
+        owner->return_connection(std::move(conn_param_owner));
+        return;
+    }
+    // The pool keeps raw pointers; release so the deleter does not call back in here.
+    std::unique_ptr<RedisConnection> conn(conn_param_owner.release());
 
-        if (shutting_down_) {
-            // std::cout << "LOG: RedisConnectionManager::get_connection() - Shutting down (checked after wait). Throwing ConnectionException. Thread ID: " << std::this_thread::get_id() << std::endl;
-            throw ConnectionException("Connection manager is shutting down while waiting for a connection.");
-        }
+    if (stats_.active_connections > 0) {
+        stats_.active_connections--;
+    }
+
+    // Connections checked out before close_all_connections() are closed, not pooled.
+    if (shutting_down_ || conn->pool_epoch != pool_epoch_.load()) {
+        conn->disconnect();
+        release_slot();
+        return;
+    }
 
-        RedisConnectionManager::RedisConnectionPtr conn_to_return;
+    if (conn->is_connected()) {
+        conn->last_used_time = std::chrono::steady_clock::now();
+        put_idle(conn.release(), home_stripe());
+    } else {
+        stats_.connection_errors++;
+        conn.reset();
+        release_slot();
+    }
+}
 
-        if (!available_connections_.empty()) {
-            // std::cout << "LOG: RedisConnectionManager::get_connection() - Path: Taking from available_connections_ (size=" << available_connections_.size() << "). Thread ID: " << std::this_thread::get_id() << std::endl;
-            RedisConnection* raw_conn = available_connections_.front();
-            available_connections_.pop();
-            stats_.idle_connections--;
+void RedisConnectionManager::close_all_connections() {
+    for (RedisConnectionManager* node : node_managers_snapshot()) {
+        node->close_all_connections();
+    }
+    std::vector<RedisConnection*> connections_to_destroy;
+    for (auto& stripe : stripes_) {
+        std::lock_guard<std::mutex> lock(stripe->mutex);
+        connections_to_destroy.insert(connections_to_destroy.end(), stripe->idle.begin(), stripe->idle.end());
+        stripe->idle.clear();
+    }
+    {
+        // Checked-out connections keep their slots until they are returned (and closed).
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        pool_epoch_++;
+        uint32_t closed = static_cast<uint32_t>(connections_to_destroy.size());
+        stats_.total_connections -= closed;
+        stats_.idle_connections -= closed;
+    }
+    condition_.notify_all();
 
-            auto it = std::find_if(pool_.begin(), pool_.end(),
-                                   [&](const RedisConnectionManager::RedisConnectionPtr& p) { return p.get() == raw_conn; });
+    for (RedisConnection* conn : connections_to_destroy) {
+        delete conn;
+    }
+}
 
-            if (it != pool_.end()) {
-                conn_to_return = std::move(*it);
-                pool_.erase(it);
-                // std::cout << "LOG: RedisConnectionManager::get_connection() - Moved connection from pool_ vector. New pool_ vector size: " << pool_.size() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-            } else {
-                // std::cout << "ERROR_LOG: RedisConnectionManager::get_connection() - Connection from available_connections_ not found in pool_ vector! This should not happen. Retrying. Thread ID: " << std::this_thread::get_id() << std::endl;
-                stats_.idle_connections++;
-                continue;
+std::future<RedisReplyPtr> RedisConnectionManager::submit_multiplexed(const std::vector<std::string>& argv) {
+    return least_busy_multiplexed()->submit(argv);
+}
+
+MultiplexedConnection* RedisConnectionManager::least_busy_multiplexed() const {
+    if (multiplexed_.empty()) {
+        throw ConnectionException("Connection manager is not in multiplexed mode.");
+    }
+    // If none is connected, the first one fails the command.
+    MultiplexedConnection* target = multiplexed_.front().get();
+    size_t least_pending = SIZE_MAX;
+    for (const auto& conn : multiplexed_) {
+        if (!conn->is_connected()) continue;
+        size_t pending = conn->pending();
+        if (pending < least_pending) {
+            target = conn.get();
+            least_pending = pending;
+        }
+    }
+    return target;
+}
+
+std::string RedisConnectionManager::command_key(const std::vector<std::string>& argv) {
+    if (!argv.empty() && (argv[0] == "EVALSHA" || argv[0] == "EVAL")) {
+        // EVALSHA sha numkeys key... arg...; a script without keys can run anywhere.
+        return argv.size() >= 4 && argv[2] != "0" ? argv[3] : std::string();
+    }
+    return argv.size() > 1 ? argv[1] : std::string();
+}
+
+RedisReplyPtr RedisConnectionManager::execute_single(const std::vector<std::string>& argv, bool asking) {
+    if (!asking && is_multiplexed()) {
+        try {
+            return least_busy_multiplexed()->execute(argv);
+        } catch (const ConnectionException&) {
+            return nullptr;
+        }
+    }
+    std::vector<const char*> args;
+    std::vector<size_t> lengths;
+    for (const auto& arg : argv) {
+        args.push_back(arg.data());
+        lengths.push_back(arg.size());
+    }
+    RedisConnectionPtr conn = get_connection();
+    RedisReplyPtr reply;
+    if (!asking) {
+        reply.reset(static_cast<redisReply*>(conn->command_argv(static_cast<int>(args.size()), args.data(), lengths.data())));
+    } else {
+        const char* asking_arg = "ASKING";
+        size_t asking_length = 6;
+        if (conn->append_command_argv(1, &asking_arg, &asking_length) &&
+            conn->append_command_argv(static_cast<int>(args.size()), args.data(), lengths.data())) {
+            RedisReplyPtr asking_reply(conn->get_reply());
+            if (asking_reply) {
+                reply.reset(conn->get_reply());
             }
+        }
+    }
+    return_connection(std::move(conn));
+    return reply;
+}
 
-            bool healthy = true;
-            if (conn_to_return && conn_to_return->is_connected()) {
-                if (std::chrono::steady_clock::now() - conn_to_return->last_used_time > max_idle_time_before_ping_) {
-                    // std::cout << "LOG: RedisConnectionManager::get_connection() - Idle connection requires ping. Unlocking for ping. Thread ID: " << std::this_thread::get_id() << std::endl;
-                    lock.unlock();
-                    // std::cout << "LOG: RedisConnectionManager::get_connection() - Calling ping() for " << conn_to_return->get_host() << ":" << conn_to_return->get_port() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-                    healthy = conn_to_return->ping();
-                    // std::cout << "LOG: RedisConnectionManager::get_connection() - Ping result: " << healthy << ". Relocking. Thread ID: " << std::this_thread::get_id() << std::endl;
-                    lock.lock();
-
-                    if (shutting_down_) {
-                        //  std::cout << "LOG: RedisConnectionManager::get_connection() - Shutting down during health check. Disconnecting and throwing. Thread ID: " << std::this_thread::get_id() << std::endl;
-                        if (conn_to_return) {
-                            conn_to_return->disconnect();
-                        }
-                        throw ConnectionException("Connection manager is shutting down during health check.");
-                    }
-                }
-            } else if (conn_to_return) {
-                healthy = false;
-                // std::cout << "LOG: RedisConnectionManager::get_connection() - Connection from pool was not connected. Healthy=false. Thread ID: " << std::this_thread::get_id() << std::endl;
-            } else {
-                healthy = false;
-                // std::cout << "ERROR_LOG: RedisConnectionManager::get_connection() - conn_to_return is null after move from pool. Healthy=false. This is unexpected. Thread ID: " << std::this_thread::get_id() << std::endl;
+std::vector<RedisReplyPtr> RedisConnectionManager::execute_local_pipeline(const std::vector<std::vector<std::string>>& commands,
+                                                                          bool pooled) {
+    std::vector<RedisReplyPtr> replies;
+    replies.reserve(commands.size());
+    if (commands.empty()) {
+        return replies;
+    }
+
+    if (!pooled && is_multiplexed()) {
+        // The shared connections pipeline these together with other threads' commands.
+        std::vector<std::pair<MultiplexedConnection*, std::future<RedisReplyPtr>>> pending;
+        pending.reserve(commands.size());
+        for (const auto& cmd : commands) {
+            MultiplexedConnection* target = least_busy_multiplexed();
+            pending.emplace_back(target, target->submit(cmd));
+        }
+        for (auto& [target, reply] : pending) {
+            try {
+                replies.push_back(target->await_reply(std::move(reply)));
+            } catch (const ConnectionException&) {
+                replies.emplace_back(); // No reply, as when a pooled connection breaks
             }
+        }
+        return replies;
+    }
 
-            if (!healthy) {
-                // std::cout << "LOG: RedisConnectionManager::get_connection() - Connection not healthy. Discarding. Thread ID: " << std::this_thread::get_id() << std::endl;
-                stats_.connection_errors++;
-                if (conn_to_return) {
-                    stats_.total_connections--;
-                    // std::cout << "LOG: RedisConnectionManager::get_connection() - Decremented total_connections to " << stats_.total_connections.load() << ". Releasing and deleting. Thread ID: " << std::this_thread::get_id() << std::endl;
-                    RedisConnection* raw_to_delete = conn_to_return.release();
-                    delete raw_to_delete;
-                }
-                continue;
+    RedisConnectionPtr conn = get_connection();
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+
+    for (size_t chunk_start = 0; chunk_start < commands.size(); chunk_start += PIPELINE_CHUNK_SIZE) {
+        size_t chunk_end = std::min(commands.size(), chunk_start + PIPELINE_CHUNK_SIZE);
+        size_t appended = chunk_start;
+        for (; appended < chunk_end; ++appended) {
+            const auto& cmd = commands[appended];
+            argv.clear();
+            argvlen.clear();
+            for (const auto& arg : cmd) {
+                argv.push_back(arg.data());
+                argvlen.push_back(arg.size());
             }
-            stats_.active_connections++;
-            // std::cout << "LOG: RedisConnectionManager::get_connection() - Returning healthy connection from pool. Active: " << stats_.active_connections.load() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-            return conn_to_return;
+            if (!conn->append_command_argv(static_cast<int>(argv.size()), argv.data(), argvlen.data())) {
+                break;
+            }
+        }
+        for (size_t i = chunk_start; i < appended; ++i) {
+            RedisReplyPtr reply(conn->get_reply());
+            if (!reply) {
+                break;
+            }
+            replies.push_back(std::move(reply));
+        }
+        if (replies.size() != chunk_end) {
+            // The connection broke mid-batch; the remaining items get no reply.
+            replies.resize(commands.size());
+            break;
+        }
+    }
+    return_connection(std::move(conn));
+    return replies;
+}
 
-        } else if ((stats_.active_connections + pool_.size()) < static_cast<size_t>(config_.connection_pool_size)) {
-            // std::cout << "LOG: RedisConnectionManager::get_connection() - Path: Creating new connection. Active=" << stats_.active_connections.load()
-            //           << ", pool_v_sz=" << pool_.size() << ", config_pool_sz=" << config_.connection_pool_size
-            //           << ". Unlocking for create. Thread ID: " << std::this_thread::get_id() << std::endl;
-            lock.unlock();
+RedisReplyPtr RedisConnectionManager::execute_for_key(const std::string& key, const std::vector<std::string>& argv) {
+    if (!config_.cluster_mode) {
+        return waits_for_replicas() ? std::move(execute_and_wait({argv}).front()) : execute_single(argv);
+    }
+    RedisConnectionManager* target = manager_for_key(key);
+    bool asking = false;
+    for (int redirects = 0; redirects <= MAX_CLUSTER_REDIRECTS; ++redirects) {
+        RedisReplyPtr reply = target->execute_single(argv, asking);
+        std::optional<ClusterRedirect> redirect = parse_cluster_redirect(reply.get());
+        if (!redirect) {
+            return reply;
+        }
+        if (!redirect->ask) {
+            slot_map_.set_slot_owner(redirect->slot, redirect->address);
+            refresh_slots_after_moved();
+        }
+        target = node_manager(redirect->address);
+        asking = redirect->ask;
+    }
+    throw RedisCommandException(argv.empty() ? "" : argv[0], "Key: " + key + ", Error: too many cluster redirections");
+}
 
-            // std::cout << "LOG: RedisConnectionManager::get_connection() - Calling create_new_connection_ptr(). Thread ID: " << std::this_thread::get_id() << std::endl;
-            RedisConnectionManager::RedisConnectionPtr new_conn = create_new_connection_ptr(config_.host, config_.port);
-            // std::cout << "LOG: RedisConnectionManager::get_connection() - create_new_connection_ptr() returned. Relocking. Thread ID: " << std::this_thread::get_id() << std::endl;
-            lock.lock();
+std::vector<RedisReplyPtr> RedisConnectionManager::execute_pipeline(const std::vector<std::vector<std::string>>& commands) {
+    if (!config_.cluster_mode) {
+        return waits_for_replicas() ? execute_and_wait(commands) : execute_local_pipeline(commands);
+    }
+    std::vector<RedisReplyPtr> replies(commands.size());
+    std::map<RedisConnectionManager*, std::vector<size_t>> by_node;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        by_node[manager_for_key(command_key(commands[i]))].push_back(i);
+    }
 
-            if (shutting_down_) {
-                // std::cout << "LOG: RedisConnectionManager::get_connection() - Shutting down during new connection creation. Disconnecting and throwing. Thread ID: " << std::this_thread::get_id() << std::endl;
-                if(new_conn) new_conn->disconnect(); // The unique_ptr deleter will handle return_connection
-                throw ConnectionException("Connection manager is shutting down during new connection creation.");
-            }
+    auto run_group = [&commands, &replies](RedisConnectionManager* node, const std::vector<size_t>& indices) {
+        std::vector<std::vector<std::string>> group;
+        group.reserve(indices.size());
+        for (size_t index : indices) group.push_back(commands[index]);
+        std::vector<RedisReplyPtr> group_replies = node->execute_local_pipeline(group);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            replies[indices[i]] = std::move(group_replies[i]);
+        }
+    };
+    // One group runs on this thread, the others in parallel.
+    std::vector<std::future<void>> others;
+    for (auto it = std::next(by_node.begin()); it != by_node.end(); ++it) {
+        others.push_back(std::async(std::launch::async, run_group, it->first, std::cref(it->second)));
+    }
+    if (!by_node.empty()) {
+        run_group(by_node.begin()->first, by_node.begin()->second);
+    }
+    for (auto& other : others) {
+        other.get();
+    }
 
-            if (new_conn && new_conn->is_connected()) {
-                stats_.total_connections++;
-                stats_.active_connections++;
-                // std::cout << "LOG: RedisConnectionManager::get_connection() - Returning newly created healthy connection. Total: "
-                //           << stats_.total_connections.load() << ", Active: " << stats_.active_connections.load()
-                //           << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-                return new_conn;
-            } else {
-                stats_.connection_errors++;
-                std::string error_detail = (new_conn ? new_conn->get_last_error() : "Failed to allocate RedisConnection object.");
-                // std::cout << "ERROR_LOG: RedisConnectionManager::get_connection() - Failed to create or connect new connection. Error: " << error_detail << ". Throwing. Thread ID: " << std::this_thread::get_id() << std::endl;
-                // new_conn unique_ptr will be destroyed, its deleter calls return_connection, which will delete the raw object.
-                throw ConnectionException("Failed to create new connection to " + config_.host + ":" + std::to_string(config_.port) + ". Detail: " + error_detail);
+    // Commands whose slot moved (or is moving) are resent on their own.
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (parse_cluster_redirect(replies[i].get())) {
+            replies[i] = execute_for_key(command_key(commands[i]), commands[i]);
+        }
+    }
+    return replies;
+}
+
+std::vector<std::string> RedisConnectionManager::node_addresses() {
+    if (!config_.cluster_mode) {
+        return {config_.host + ":" + std::to_string(config_.port)};
+    }
+    if (slot_map_.empty()) {
+        refresh_cluster_slots();
+    }
+    return slot_map_.nodes();
+}
+
+RedisConnectionManager::RedisConnectionPtr RedisConnectionManager::get_connection_for_node(const std::string& address) {
+    if (!config_.cluster_mode) {
+        for (size_t i = 0; i < replicas_.size(); ++i) {
+            if (config_.replica_nodes[i] == address) {
+                return replicas_[i]->get_connection();
             }
-        } else {
-            // This should ideally not be reached if wait predicate is correct and config_.connection_pool_size > 0.
-            // If it is, it means available_connections_ is empty AND (active + pool_.size()) >= config_.connection_pool_size
-            // std::cout << "ERROR_LOG: RedisConnectionManager::get_connection() - No available connections and pool is at max capacity. Throwing. This state should ideally be caught by CV wait. Active="
-            //           << stats_.active_connections.load() << ", pool_v_sz=" << pool_.size() << ", config_pool_sz=" << config_.connection_pool_size
-            //           << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-            throw ConnectionException("No available connections and pool is at max capacity and cannot create more.");
         }
+        return get_connection();
     }
+    return node_manager(address)->get_connection();
 }
 
-void RedisConnectionManager::return_connection(RedisConnectionManager::RedisConnectionPtr conn_param_owner) {
-    // std::cout << "LOG: RedisConnectionManager::return_connection() - Entry. Conn valid: " << (conn_param_owner ? "true" : "false")
-    //           << (conn_param_owner ? ", Host: " + conn_param_owner->get_host() + ":" + std::to_string(conn_param_owner->get_port()) : "")
-    //           << ". Thread ID: " << std::this_thread::get_id() << std::endl;
+void RedisConnectionManager::refresh_cluster_slots() {
+    std::vector<std::string> candidates = slot_map_.nodes();
+    candidates.push_back(config_.host + ":" + std::to_string(config_.port));
+    candidates.insert(candidates.end(), config_.cluster_seed_nodes.begin(), config_.cluster_seed_nodes.end());
+
+    std::string last_error = "no seed nodes";
+    for (const auto& address : candidates) {
+        std::pair<std::string, int> host_port;
+        try {
+            host_port = split_node_address(address);
+        } catch (const std::exception& e) {
+            last_error = e.what();
+            continue;
+        }
+        RedisConnection conn(host_port.first, host_port.second, config_.password, config_.database, config_.timeout);
+        if (!conn.connect()) {
+            last_error = address + ": " + conn.get_last_error();
+            continue;
+        }
+        RedisReplyPtr reply(static_cast<redisReply*>(conn.command("CLUSTER SLOTS")));
+        if (reply && slot_map_.update_from_cluster_slots(reply.get(), host_port.first) && !slot_map_.empty()) {
+            last_slot_refresh_ms_ = steady_now_ms();
+            return;
+        }
+        last_error = address + ": " + (reply && reply->type == REDIS_REPLY_ERROR ? std::string(reply->str, reply->len)
+                                                                                  : std::string("no usable CLUSTER SLOTS reply"));
+    }
+    throw ConnectionException("Could not read the cluster slot map (" + last_error + ")");
+}
 
-    if (!conn_param_owner) {
-        // std::cout << "LOG: RedisConnectionManager::return_connection() - Null connection pointer passed, returning early. Thread ID: " << std::this_thread::get_id() << std::endl;
+void RedisConnectionManager::refresh_slots_after_moved() {
+    int64_t last = last_slot_refresh_ms_.load();
+    int64_t now = steady_now_ms();
+    // One caller refreshes per interval; the others keep the slot recorded from MOVED.
+    if (now - last < MIN_SLOT_REFRESH_INTERVAL_MS || !last_slot_refresh_ms_.compare_exchange_strong(last, now)) {
         return;
     }
+    try {
+        refresh_cluster_slots();
+    } catch (const ConnectionException&) {
+    }
+}
 
-    RedisConnection* conn_raw = conn_param_owner.get();
-    bool repool_this_connection = false;
-    // needs_notification is determined inside the lock
-
-    {
-        std::unique_lock<std::mutex> lock(pool_mutex_);
-        // std::cout << "LOG: RedisConnectionManager::return_connection() - Acquired pool_mutex_. Current stats: Active=" << stats_.active_connections.load()
-        //           << ", Total=" << stats_.total_connections.load() << ", Idle=" << stats_.idle_connections.load()
-        //           << ", PoolVecSize=" << pool_.size() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-
-        bool actually_needs_notification = false;
-
-        if (shutting_down_.load()) {
-            // std::cout << "LOG: RedisConnectionManager::return_connection() - Shutting down mode. Disconnecting raw connection. Thread ID: " << std::this_thread::get_id() << std::endl;
-            conn_raw->disconnect();
-            repool_this_connection = false;
-            // Stats (active, total) are globally reset by close_all_connections. No individual decrements here.
-            // No notification from here as close_all_connections will notify once.
-        } else {
-            // Normal operation path
-            if (stats_.active_connections > 0) {
-                 stats_.active_connections--;
-            } else {
-                 // This might happen if a connection from health_check_loop's connections_to_remove_outside_lock
-                 // calls this via its deleter, and it was never made "active".
-                 // std::cout << "WARNING_LOG: RedisConnectionManager::return_connection() - active_connections was already 0 or less during normal return. Active: " << stats_.active_connections.load() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-            }
-            // std::cout << "LOG: RedisConnectionManager::return_connection() - Active after dec: " << stats_.active_connections.load() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-
-            if (conn_raw->is_connected() && pool_.size() < static_cast<size_t>(config_.connection_pool_size)) {
-                // std::cout << "LOG: RedisConnectionManager::return_connection() - Connection is connected and pool has space (pool_v_sz=" << pool_.size() << ", config_pool_sz=" << config_.connection_pool_size << "). Repooling. Thread ID: " << std::this_thread::get_id() << std::endl;
-                repool_this_connection = true;
-                available_connections_.push(conn_raw);
-                pool_.push_back(std::move(conn_param_owner));
-                stats_.idle_connections++;
-                actually_needs_notification = true;
-            } else {
-                // std::cout << "LOG: RedisConnectionManager::return_connection() - Not repooling (normal ops). Connected: " << conn_raw->is_connected()
-                //           << ", Pool full? (pool_v_sz=" << pool_.size() << ", config_pool_sz=" << config_.connection_pool_size << ")"
-                //           << ". Disconnecting. Thread ID: " << std::this_thread::get_id() << std::endl;
-                if (!conn_raw->is_connected()) {
-                    stats_.connection_errors++;
-                }
-                conn_raw->disconnect();
-
-                if (stats_.total_connections > 0) {
-                    stats_.total_connections--;
-                    actually_needs_notification = true;
-                    // std::cout << "LOG: RedisConnectionManager::return_connection() - Connection not repooled (normal ops), decremented total_connections to " << stats_.total_connections.load() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-                } else {
-                    // std::cout << "LOG: RedisConnectionManager::return_connection() - Connection not repooled (normal ops), but total_connections already 0. Not decrementing. Thread ID: " << std::this_thread::get_id() << std::endl;
-                }
-            }
-        } // End of !shutting_down_ block
+RedisConnectionManager* RedisConnectionManager::node_manager(const std::string& address) {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    std::unique_ptr<RedisConnectionManager>& node = node_managers_[address];
+    if (!node) {
+        ClientConfig node_config = config_;
+        std::tie(node_config.host, node_config.port) = split_node_address(address);
+        node_config.cluster_mode = false;
+        node_config.cluster_seed_nodes.clear();
+        node = std::make_unique<RedisConnectionManager>(node_config);
+        node->on_connection_lost(connection_lost_callback_);
+        node->on_connection_restored(connection_restored_callback_);
+    }
+    return node.get();
+}
 
-        if (actually_needs_notification) { // Only notify if not in overall shutdown and a change occurred
-            // std::cout << "LOG: RedisConnectionManager::return_connection() - Calling condition_.notify_one(). Thread ID: " << std::this_thread::get_id() << std::endl;
-            condition_.notify_one();
+RedisConnectionManager* RedisConnectionManager::manager_for_key(const std::string& key) {
+    if (slot_map_.empty()) {
+        refresh_cluster_slots();
+    }
+    std::string address = slot_map_.node_for_slot(key_hash_slot(key));
+    if (address.empty()) {
+        refresh_slots_after_moved();
+        address = slot_map_.node_for_slot(key_hash_slot(key));
+        if (address.empty()) {
+            throw ConnectionException("No cluster node serves hash slot " + std::to_string(key_hash_slot(key)));
         }
-        // std::cout << "LOG: RedisConnectionManager::return_connection() - Releasing pool_mutex_. Thread ID: " << std::this_thread::get_id() << std::endl;
     }
+    return node_manager(address);
+}
 
-    if (!repool_this_connection) {
-        // std::cout << "LOG: RedisConnectionManager::return_connection() - Connection was not repooled. Releasing and deleting raw pointer. Thread ID: " << std::this_thread::get_id() << std::endl;
-        RedisConnection* to_delete = conn_param_owner.release();
-        delete to_delete;
-    } else {
-        // std::cout << "LOG: RedisConnectionManager::return_connection() - Connection was repooled. conn_param_owner is now null. Thread ID: " << std::this_thread::get_id() << std::endl;
+std::vector<RedisConnectionManager*> RedisConnectionManager::node_managers_snapshot() const {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    std::vector<RedisConnectionManager*> nodes;
+    for (const auto& entry : node_managers_) {
+        nodes.push_back(entry.second.get());
     }
-    // std::cout << "LOG: RedisConnectionManager::return_connection() - Exit. Thread ID: " << std::this_thread::get_id() << std::endl;
+    return nodes;
 }
 
-void RedisConnectionManager::close_all_connections() {
-    // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Entry. Thread ID: " << std::this_thread::get_id() << std::endl;
-    std::vector<RedisConnectionManager::RedisConnectionPtr> connections_to_destroy_outside_lock;
+RedisReplyPtr RedisConnectionManager::execute_read(const std::string& key, const std::vector<std::string>& argv) {
+    if (config_.cluster_mode || replicas_.empty()) {
+        return execute_for_key(key, argv);
+    }
+    return std::move(execute_read_pipeline({argv}).front());
+}
 
-    { // Start of critical section for modifying shared pool structures
-        std::lock_guard<std::mutex> lock(pool_mutex_);
-        // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Acquired pool_mutex_. Thread ID: " << std::this_thread::get_id() << std::endl;
-        shutting_down_ = true; // Ensure this is unequivocally set
+std::vector<RedisReplyPtr> RedisConnectionManager::execute_read_pipeline(const std::vector<std::vector<std::string>>& commands) {
+    if (config_.cluster_mode || replicas_.empty()) {
+        return execute_pipeline(commands);
+    }
+    RedisConnectionManager* replica = read_target();
+    if (replica == this) {
+        return execute_local_pipeline(commands);
+    }
 
-        // Move connections from the main pool to a temporary vector
-        if (!pool_.empty()) {
-            connections_to_destroy_outside_lock.swap(pool_);
-            // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Moved " << connections_to_destroy_outside_lock.size() << " connections from pool_ to temporary vector. pool_ is now empty. Thread ID: " << std::this_thread::get_id() << std::endl;
-        } else {
-            // std::cout << "LOG: RedisConnectionManager::close_all_connections() - pool_ vector was already empty. Thread ID: " << std::this_thread::get_id() << std::endl;
+    std::vector<RedisReplyPtr> replies;
+    try {
+        // EVALSHA_RO guarantees the script cannot write, so replicas never reject it.
+        bool read_only_scripts = !replica->read_only_scripts_unsupported_;
+        std::vector<std::vector<std::string>> replica_commands = commands;
+        if (read_only_scripts) {
+            for (auto& cmd : replica_commands) {
+                if (!cmd.empty() && cmd[0] == "EVALSHA") cmd[0] = "EVALSHA_RO";
+            }
+        }
+        replies = replica->execute_local_pipeline(replica_commands);
+        bool unknown_command = false;
+        for (size_t i = 0; i < replies.size() && read_only_scripts; ++i) {
+            unknown_command |= commands[i][0] == "EVALSHA" && is_error_with_prefix(replies[i].get(), "ERR unknown command");
+        }
+        if (unknown_command) { // Redis < 7: replicas run read-only scripts with plain EVALSHA
+            replica->read_only_scripts_unsupported_ = true;
+            replies = replica->execute_local_pipeline(commands);
         }
+    } catch (const ConnectionException&) {
+        replies.clear(); // No connection to the replica: everything goes to the primary
+    }
+    replies.resize(commands.size());
+
+    std::vector<size_t> retry;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        if (!replica_served(replies[i].get())) retry.push_back(i);
+    }
+    if (!retry.empty()) {
+        std::vector<std::vector<std::string>> primary_commands;
+        primary_commands.reserve(retry.size());
+        for (size_t index : retry) primary_commands.push_back(commands[index]);
+        std::vector<RedisReplyPtr> primary_replies = execute_local_pipeline(primary_commands);
+        for (size_t i = 0; i < retry.size(); ++i) {
+            replies[retry[i]] = std::move(primary_replies[i]);
+        }
+    }
+    return replies;
+}
 
+std::vector<std::string> RedisConnectionManager::replica_addresses() const {
+    return config_.cluster_mode ? std::vector<std::string>() : config_.replica_nodes;
+}
 
-        // Clear the queue of available raw pointers
-        if (!available_connections_.empty()) {
-            std::queue<RedisConnection*> empty_queue;
-            std::swap(available_connections_, empty_queue);
-            // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Cleared available_connections_ queue. Thread ID: " << std::this_thread::get_id() << std::endl;
-        } else {
-            // std::cout << "LOG: RedisConnectionManager::close_all_connections() - available_connections_ queue was already empty. Thread ID: " << std::this_thread::get_id() << std::endl;
+size_t RedisConnectionManager::select_read_target(ReadPolicy policy, const std::vector<ReadTarget>& targets, size_t turn) {
+    if (policy == ReadPolicy::PRIMARY || targets.size() < 2) {
+        return 0;
+    }
+    if (policy == ReadPolicy::PREFER_REPLICA) {
+        size_t replica_count = targets.size() - 1;
+        for (size_t i = 0; i < replica_count; ++i) {
+            size_t candidate = 1 + (turn + i) % replica_count;
+            if (targets[candidate].healthy) return candidate;
+        }
+        return 0;
+    }
+    // NEAREST: servers whose round trip is not known yet are only used once the others are down.
+    size_t nearest = 0;
+    bool nearest_measured = targets[0].healthy && targets[0].round_trip.count() > 0;
+    for (size_t i = 1; i < targets.size(); ++i) {
+        if (!targets[i].healthy) continue;
+        bool measured = targets[i].round_trip.count() > 0;
+        if (!targets[nearest].healthy || (measured && (!nearest_measured || targets[i].round_trip < targets[nearest].round_trip))) {
+            nearest = i;
+            nearest_measured = measured;
         }
+    }
+    return nearest;
+}
 
-        // Reset statistics
-        stats_.active_connections = 0;
-        stats_.idle_connections = 0;
-        stats_.total_connections = 0;
-        primary_healthy_ = false;
-        // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Stats reset. Notifying any remaining waiters. Thread ID: " << std::this_thread::get_id() << std::endl;
-        condition_.notify_all();
-    } // Mutex is released here
-    // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Released pool_mutex_. Thread ID: " << std::this_thread::get_id() << std::endl;
+RedisConnectionManager::PrimaryReadScope::PrimaryReadScope() : previous_(primary_reads_only) {
+    primary_reads_only = true;
+}
 
-    // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Destroying " << connections_to_destroy_outside_lock.size() << " connections outside of lock. Thread ID: " << std::this_thread::get_id() << std::endl;
-    // Now, when connections_to_destroy_outside_lock is cleared (or goes out of scope),
-    // their deleters will call return_connection. return_connection will acquire pool_mutex_ (which is now free).
-    connections_to_destroy_outside_lock.clear();
-    // std::cout << "LOG: RedisConnectionManager::close_all_connections() - Finished destroying connections. Exiting function. Thread ID: " << std::this_thread::get_id() << std::endl;
+RedisConnectionManager::PrimaryReadScope::~PrimaryReadScope() {
+    primary_reads_only = previous_;
+}
+
+RedisConnectionManager* RedisConnectionManager::read_target() {
+    if (config_.read_policy == ReadPolicy::PRIMARY || primary_reads_only || steady_now_ms() < primary_reads_until_ms_.load()) {
+        return this;
+    }
+    std::vector<ReadTarget> targets;
+    targets.reserve(replicas_.size() + 1);
+    targets.push_back({primary_healthy_.load(), round_trip_time()});
+    for (const auto& replica : replicas_) {
+        targets.push_back({replica->is_healthy(), replica->round_trip_time()});
+    }
+    size_t index = select_read_target(config_.read_policy, targets, read_turn_.fetch_add(1, std::memory_order_relaxed));
+    return index == 0 ? this : replicas_[index - 1].get();
+}
+
+bool RedisConnectionManager::waits_for_replicas() const {
+    return config_.replica_write_acks > 0 && config_.read_policy != ReadPolicy::PRIMARY && !replicas_.empty();
+}
+
+std::vector<RedisReplyPtr> RedisConnectionManager::execute_and_wait(const std::vector<std::vector<std::string>>& commands) {
+    std::vector<std::vector<std::string>> batch = commands;
+    batch.push_back({"WAIT", std::to_string(config_.replica_write_acks), std::to_string(config_.replica_wait_timeout.count())});
+    std::vector<RedisReplyPtr> replies = execute_local_pipeline(batch, true);
+    RedisReplyPtr acknowledged = std::move(replies.back());
+    replies.pop_back();
+    if (!acknowledged || acknowledged->type != REDIS_REPLY_INTEGER || acknowledged->integer < config_.replica_write_acks) {
+        primary_reads_until_ms_ = steady_now_ms() + PRIMARY_READS_AFTER_UNACKNOWLEDGED_WRITE_MS;
+    }
+    return replies;
 }
 
 bool RedisConnectionManager::is_healthy() const {
+    if (config_.cluster_mode) {
+        std::vector<RedisConnectionManager*> nodes = node_managers_snapshot();
+        return !slot_map_.empty() && std::all_of(nodes.begin(), nodes.end(), [](const RedisConnectionManager* node) {
+            return node->is_healthy();
+        });
+    }
     return primary_healthy_;
 }
 
 redisjson::ConnectionStats RedisConnectionManager::get_stats() const {
-    return {
+    redisjson::ConnectionStats stats = {
         stats_.total_connections.load(std::memory_order_relaxed),
         stats_.active_connections.load(std::memory_order_relaxed),
         stats_.idle_connections.load(std::memory_order_relaxed),
         stats_.connection_errors.load(std::memory_order_relaxed)
     };
+    for (const RedisConnectionManager* node : node_managers_snapshot()) {
+        redisjson::ConnectionStats node_stats = node->get_stats();
+        stats.total_connections += node_stats.total_connections;
+        stats.active_connections += node_stats.active_connections;
+        stats.idle_connections += node_stats.idle_connections;
+        stats.connection_errors += node_stats.connection_errors;
+    }
+    return stats;
 }
 
 void RedisConnectionManager::set_health_check_interval(std::chrono::seconds interval) {
     health_check_interval_ = interval;
+    if (config_.cluster_mode) {
+        for (RedisConnectionManager* node : node_managers_snapshot()) {
+            node->set_health_check_interval(interval);
+        }
+        return;
+    }
     if (interval.count() <= 0 && run_health_checker_) {
         run_health_checker_ = false; 
     } else if (interval.count() > 0 && !run_health_checker_ && !health_check_thread_.joinable() && config_.connection_pool_size > 0) {
@@ -625,8 +1030,6 @@ void RedisConnectionManager::on_connection_restored(std::function<void(const std
 }
 
 void RedisConnectionManager::health_check_loop() {
-    std::vector<RedisConnectionManager::RedisConnectionPtr> connections_to_remove_outside_lock;
-
     while (run_health_checker_ && !shutting_down_) {
         bool previously_healthy = primary_healthy_.load();
         bool currently_healthy = check_primary_health();
@@ -638,114 +1041,69 @@ void RedisConnectionManager::health_check_loop() {
         }
         primary_healthy_ = currently_healthy;
 
-        { // Start of critical section with pool_mutex_
-            std::unique_lock<std::mutex> lock(pool_mutex_);
-            if (shutting_down_ || !run_health_checker_) break;
-
-            for (auto it = pool_.begin(); it != pool_.end(); ) {
-                if (shutting_down_ || !run_health_checker_) break;
-                
-                bool is_bad = false;
-                if (it->get()) { // Check if pointer inside unique_ptr is valid
-                    if (!(*it)->ping()) { // ping() might fail if connection is truly bad
-                        is_bad = true;
-                    }
-                } else { 
-                    // This case (nullptr in pool_) should ideally not happen if pool is managed correctly.
-                    is_bad = true;
-                }
-
-                if (is_bad) {
-                    stats_.connection_errors++;
-                    RedisConnection* conn_raw_ptr = it->get();
-                    
-                    // Remove from available_connections_ queue if present
-                    std::queue<RedisConnection*> new_available_connections_q;
-                    while(!available_connections_.empty()){
-                        RedisConnection* q_conn = available_connections_.front();
-                        available_connections_.pop();
-                        if(q_conn != conn_raw_ptr){
-                            new_available_connections_q.push(q_conn);
-                        } else {
-                            // If found in available_connections_, it was idle.
-                            stats_.idle_connections--; 
-                        }
-                    }
-                    available_connections_ = new_available_connections_q;
-                    
-                    // Move the RedisConnectionPtr to the temporary vector for destruction outside the lock.
-                    connections_to_remove_outside_lock.push_back(std::move(*it));
-                    it = pool_.erase(it); // Erase the (now empty) unique_ptr from pool_ vector.
-                                          // This does not call the deleter of the connection itself yet.
-                    // total_connections will be decremented by return_connection when the object is finally destroyed.
-                } else {
-                    ++it; 
-                }
-            }
-            maintain_pool_size(lock); // This might add new connections to the pool.
-                                      // Lock is passed and potentially unlocked/relocked inside.
-        } // End of critical section, pool_mutex_ is released by 'lock' going out of scope.
-
-        // Destroy connections that were marked for removal.
-        // Their deleters will call RedisConnectionManager::return_connection.
-        // return_connection will acquire pool_mutex_ without deadlocking,
-        // and will ultimately delete the RedisConnection object because it's
-        // not being returned to the pool (it's already been removed).
-        if (!connections_to_remove_outside_lock.empty()) {
-            connections_to_remove_outside_lock.clear();
-        }
+        if (shutting_down_ || !run_health_checker_) break;
+        check_idle_connections();
+        maintain_pool_size();
 
         // Wait for the next health check interval or shutdown signal.
-        // This re-acquires the mutex for the condition variable.
-        std::unique_lock<std::mutex> cv_lock(pool_mutex_); 
-        if (shutting_down_.load() || !run_health_checker_.load()) { // .load() for atomics
-            // std::cout << "LOG: RedisConnectionManager::health_check_loop() - Breaking before wait_for. Shutting down: " << shutting_down_.load() << ", Run checker: " << run_health_checker_.load() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
+        std::unique_lock<std::mutex> cv_lock(pool_mutex_);
+        if (shutting_down_.load() || !run_health_checker_.load()) {
             break;
         }
-        condition_.wait_for(cv_lock, health_check_interval_, [this]{
-            bool predicate_result = shutting_down_.load() || !run_health_checker_.load();
-            // std::cout << "LOG: RedisConnectionManager::health_check_loop() - Wait_for predicate check. Result: " << predicate_result << ". Thread ID: " << std::this_thread::get_id() << std::endl;
-            return predicate_result;
+        condition_.wait_for(cv_lock, health_check_interval_, [this] {
+            return shutting_down_.load() || !run_health_checker_.load();
         });
     }
-    // std::cout << "LOG: RedisConnectionManager::health_check_loop() - Exited while loop. Final flags: run_health_checker_=" << run_health_checker_.load()
-    //           << ", shutting_down_=" << shutting_down_.load() << ". Thread ID: " << std::this_thread::get_id() << std::endl;
 }
 
-void RedisConnectionManager::maintain_pool_size(std::unique_lock<std::mutex>& lock) {
-    if (shutting_down_ || !run_health_checker_) return;
-
-    size_t desired_pool_size = static_cast<size_t>(config_.connection_pool_size);
-
-    while ((stats_.active_connections + pool_.size()) < desired_pool_size && !shutting_down_) {
-        if ((stats_.active_connections + pool_.size()) >= desired_pool_size) {
-            break; 
+void RedisConnectionManager::check_idle_connections() {
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+        // Take the stale connections out of the stripe, so callers never wait on a ping.
+        std::vector<RedisConnection*> stale;
+        {
+            std::lock_guard<std::mutex> lock(stripes_[i]->mutex);
+            auto& idle = stripes_[i]->idle;
+            auto fresh_end = std::partition(idle.begin(), idle.end(), [&](const RedisConnection* conn) {
+                return now - conn->last_used_time < max_idle_time_before_ping_;
+            });
+            stale.assign(fresh_end, idle.end());
+            idle.erase(fresh_end, idle.end());
+            stats_.idle_connections -= static_cast<uint32_t>(stale.size());
         }
 
-        lock.unlock();
-        // Use create_new_connection_ptr
-        RedisConnectionManager::RedisConnectionPtr conn = create_new_connection_ptr(config_.host, config_.port);
-        lock.lock(); 
+        for (RedisConnection* conn : stale) {
+            if (!shutting_down_ && conn->ping()) { // ping() refreshes last_used_time
+                put_idle(conn, i);
+            } else {
+                if (!shutting_down_) stats_.connection_errors++;
+                delete conn;
+                release_slot();
+            }
+        }
+    }
+}
 
-        if (shutting_down_) break; 
+void RedisConnectionManager::maintain_pool_size() {
+    if (shutting_down_ || !run_health_checker_ || config_.cluster_mode) return;
 
-        if (conn && conn->is_connected()) {
-            available_connections_.push(conn.get());
-            pool_.push_back(std::move(conn)); // conn is RedisConnectionPtr
-            stats_.idle_connections++;
-            stats_.total_connections++;
-            condition_.notify_one(); 
-        } else {
-            stats_.connection_errors++;
-            break;
-        }
+    for (size_t i = 0; !shutting_down_ && try_reserve_slot(); ++i) {
+        std::string error_detail;
+        std::unique_ptr<RedisConnection> conn = open_connection(error_detail);
+        if (!conn) break;
+        put_idle(conn.release(), i % stripes_.size());
     }
 }
 
 bool RedisConnectionManager::check_primary_health() {
     RedisConnection temp_conn(config_.host, config_.port, config_.password, config_.database, std::chrono::milliseconds(1000)); 
     if (temp_conn.connect()) {
+        auto ping_start = std::chrono::steady_clock::now();
         if (temp_conn.ping()) {
+            int64_t sample = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - ping_start).count();
+            int64_t previous = round_trip_us_.load();
+            // Exponential moving average, so one slow ping does not move reads elsewhere.
+            round_trip_us_ = std::max<int64_t>(previous == 0 ? sample : (previous * 7 + sample) / 8, 1);
             temp_conn.disconnect();
             return true;
         }
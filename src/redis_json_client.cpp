@@ -3,22 +3,115 @@
 #include "redisjson++/exceptions.h"
 #include "redisjson++/redis_connection_manager.h" // For legacy mode
 #include "redisjson++/lua_script_manager.h"      // For legacy mode
+#include "redisjson++/document_codec.h"
+#include "redisjson++/cluster_slot_map.h"     // For key_hash_slot
+#include "redisjson++/sha1.h"
 
 #include <stdexcept>
 #include <string>
 #include <iostream>
 #include <thread>
 #include <cstring> // For strcmp
+#include <algorithm> // For std::min
+#include <iterator>  // For std::back_inserter
+#include <future>    // For std::async (cluster fan-out)
+#include <set>
+#include <cstdio>    // For std::snprintf
+#include <fstream>
 
 namespace redisjson {
 
+namespace {
+// Drops the key from the client-side cache when a write to it completes (or fails, in
+// which case it may still have been applied). Invalidation messages for our own writes
+// arrive asynchronously; this makes the writer read its own write right away.
+class CacheInvalidationGuard {
+public:
+    CacheInvalidationGuard(JSONCache* cache, const std::string& key) : cache_(cache), key_(key) {}
+    ~CacheInvalidationGuard() {
+        if (cache_) cache_->invalidate(key_);
+    }
+
+    CacheInvalidationGuard(const CacheInvalidationGuard&) = delete;
+    CacheInvalidationGuard& operator=(const CacheInvalidationGuard&) = delete;
+
+private:
+    JSONCache* cache_;
+    std::string key_;
+};
+
+std::vector<std::string> build_set_command(const std::string& key, std::string doc_str, const SetOptions& opts) {
+    std::vector<std::string> cmd = {"SET", key, std::move(doc_str)};
+    if (opts.ttl.count() > 0) {
+        cmd.push_back("EX");
+        cmd.push_back(std::to_string(opts.ttl.count()));
+    }
+    if (opts.condition == SetCmdCondition::NX) {
+        cmd.push_back("NX");
+    } else if (opts.condition == SetCmdCondition::XX) {
+        cmd.push_back("XX");
+    }
+    return cmd;
+}
+
+std::string condition_arg(SetCmdCondition condition) {
+    switch (condition) {
+        case SetCmdCondition::NX: return "NX";
+        case SetCmdCondition::XX: return "XX";
+        default: return "NONE";
+    }
+}
+
+// EVALSHA of a built-in write script for `key`, passing along the indexes covering it
+// (as LuaScriptManager::execute_script does), for pipelined script calls.
+std::vector<std::string> build_script_command(const std::string& sha, const std::string& key,
+                                              std::vector<std::string> args, const IndexRegistry& indexes) {
+    std::vector<std::string> keys = {key};
+    indexes.append_script_arguments(key, keys, args);
+    std::vector<std::string> cmd = {"EVALSHA", sha, std::to_string(keys.size())};
+    std::move(keys.begin(), keys.end(), std::back_inserter(cmd));
+    std::move(args.begin(), args.end(), std::back_inserter(cmd));
+    return cmd;
+}
+
+void throw_if_error(const RedisReplyPtr& reply, const std::string& command, const std::string& context) {
+    if (!reply) {
+        throw RedisCommandException(command, context + ", Error: No reply or connection error");
+    }
+    if (reply->type == REDIS_REPLY_ERROR) {
+        throw RedisCommandException(command, context + ", Error: " + std::string(reply->str, reply->len));
+    }
+}
+
+std::vector<std::string> reply_strings(const RedisReplyPtr& reply) {
+    std::vector<std::string> result;
+    if (reply->type == REDIS_REPLY_ARRAY) {
+        result.reserve(reply->elements);
+        for (size_t i = 0; i < reply->elements; ++i) {
+            redisReply* element = reply->element[i];
+            if (element->type == REDIS_REPLY_STRING) result.emplace_back(element->str, element->len);
+        }
+    }
+    return result;
+}
+
+std::string score_bound(std::optional<double> bound, bool exclusive, const char* unbounded) {
+    if (!bound) return unbounded;
+    char buffer[40];
+    std::snprintf(buffer, sizeof(buffer), "%s%.17g", exclusive ? "(" : "", *bound);
+    return buffer;
+}
+} // namespace
+
 // Constructor for legacy direct Redis connections
 RedisJSONClient::RedisJSONClient(const LegacyClientConfig& client_config)
     : _is_swss_mode(false), _legacy_config(client_config) {
     _connection_manager = std::make_unique<RedisConnectionManager>(_legacy_config);
     _path_parser = std::make_unique<PathParser>();
     _json_modifier = std::make_unique<JSONModifier>();
-    _lua_script_manager = std::make_unique<LuaScriptManager>(_connection_manager.get());
+    _lua_script_manager = std::make_unique<LuaScriptManager>(_connection_manager.get(), _legacy_config.document_encoding,
+                                                             _legacy_config.document_layout);
+    _lua_script_manager->set_index_registry(&_indexes);
     if (_lua_script_manager) {
         try {
             _lua_script_manager->preload_builtin_scripts();
@@ -26,9 +119,35 @@ RedisJSONClient::RedisJSONClient(const LegacyClientConfig& client_config)
             throw RedisJSONException("Failed to preload Lua scripts during RedisJSONClient construction: " + std::string(e.what()));
         }
     }
+    if (_legacy_config.delta_write_max_entries > 0 && !_is_hash_layout()) {
+        _delta_bases = std::make_unique<JSONCache>(_legacy_config.delta_write_max_entries, std::chrono::seconds(0),
+                                                   _legacy_config.delta_write_max_bytes);
+    }
+    if (_legacy_config.enable_client_cache) {
+        _json_cache = std::make_unique<JSONCache>(_legacy_config.client_cache_max_entries, _legacy_config.client_cache_ttl,
+                                                  _legacy_config.client_cache_max_bytes);
+        _json_cache->set_admission_filter(_legacy_config.client_cache_admission_filter);
+        _json_cache->set_stale_while_revalidate(_legacy_config.client_cache_stale_while_revalidate);
+        JSONCache* cache = _json_cache.get();
+        _cache_listener = std::make_unique<CacheInvalidationListener>(
+            _legacy_config, _legacy_config.client_cache_prefixes,
+            [cache](const std::vector<std::string>& keys) {
+                if (keys.empty()) {
+                    cache->clear_cache();
+                    return;
+                }
+                for (const auto& key : keys) {
+                    cache->invalidate(key);
+                }
+            });
+        // Give the subscription a moment so that reads right after construction are
+        // cached; until it is up they simply go to Redis.
+        _cache_listener->wait_until_subscribed(_legacy_config.timeout);
+    }
 }
 
 long long RedisJSONClient::json_array_trim(const std::string& key, const std::string& path, long long start_index, long long stop_index) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         // Non-atomic get-modify-set for SWSS mode
         SetOptions opts; // Default set options
@@ -47,7 +166,7 @@ long long RedisJSONClient::json_array_trim(const std::string& key, const std::st
         try {
             // JSONModifier will need an array_trim method.
             // It should modify 'doc' in place and return the new length.
-            long long new_length = _json_modifier->array_trim(doc, _path_parser->parse(path), start_index, stop_index);
+            long long new_length = _json_modifier->array_trim(doc, _path_parser->compile(path), start_index, stop_index);
             _set_document_after_modification(key, doc, opts);
             return new_length;
         } catch (const PathNotFoundException& e) { // Path to array not found within the document
@@ -63,7 +182,7 @@ long long RedisJSONClient::json_array_trim(const std::string& key, const std::st
     } else { // Legacy mode (uses Lua script)
         throwIfNotLegacyWithLua("json_array_trim");
         std::vector<std::string> keys_vec = {key};
-        std::vector<std::string> args_vec = {path, std::to_string(start_index), std::to_string(stop_index)};
+        std::vector<std::string> args_vec = _script_args(path, {std::to_string(start_index), std::to_string(stop_index)});
         try {
             json result = _lua_script_manager->execute_script("json_array_trim", keys_vec, args_vec);
             if (result.is_number_integer()) {
@@ -108,7 +227,10 @@ RedisJSONClient::RedisJSONClient(const SwssClientConfig& swss_config)
 }
 
 RedisJSONClient::~RedisJSONClient() {
-    // unique_ptrs will handle cleanup
+    // unique_ptrs will handle cleanup. The listener goes first: its thread uses _json_cache.
+    // The cache then stops its refresh thread, whose loaders use the connection manager.
+    _cache_listener.reset();
+    _json_cache.reset();
 }
 
 RedisConnectionManager::RedisConnectionPtr RedisJSONClient::get_legacy_redis_connection() const {
@@ -122,6 +244,20 @@ RedisConnectionManager::RedisConnectionPtr RedisJSONClient::get_legacy_redis_con
     }
 }
 
+bool RedisJSONClient::_cache_usable(const std::string& key) const {
+    if (!_json_cache || !_cache_listener || !_cache_listener->is_subscribed()) {
+        return false;
+    }
+    const std::vector<std::string>& prefixes = _legacy_config.client_cache_prefixes;
+    return prefixes.empty() || std::any_of(prefixes.begin(), prefixes.end(), [&key](const std::string& prefix) {
+        return key.compare(0, prefix.size(), prefix) == 0;
+    });
+}
+
+CacheStats RedisJSONClient::client_cache_stats() const {
+    return _json_cache ? _json_cache->get_stats() : CacheStats{};
+}
+
 void RedisJSONClient::throwIfNotLegacyWithLua(const std::string& operation_name) const {
     if (_is_swss_mode) {
         throw NotImplementedException("Operation '" + operation_name + "' is not supported in SWSS mode with Lua-like atomicity.");
@@ -134,11 +270,11 @@ void RedisJSONClient::throwIfNotLegacyWithLua(const std::string& operation_name)
 // --- Document Operations ---
 
 void RedisJSONClient::set_json(const std::string& key, const json& document, const SetOptions& opts) {
-    std::string doc_str = document.dump();
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         if (!_db_connector) throw RedisJSONException("DBConnector not initialized for SWSS mode.");
         // Simplified SWSS SET handling
-        _db_connector->set(key, doc_str);
+        _db_connector->set(key, document.dump());
         if (opts.ttl.count() > 0) {
             // TTL handling in SWSS might need specific DBConnector features or be unsupported
             // For now, this is a placeholder or might be ignored.
@@ -148,44 +284,24 @@ void RedisJSONClient::set_json(const std::string& key, const json& document, con
             // NX/XX conditions are not directly supported by basic DBConnector->set
             // std::cerr << "Warning: NX/XX conditions for set_json in SWSS mode are not supported by basic DBConnector." << std::endl;
         }
+    } else if (_is_hash_layout()) {
+        throwIfNotLegacyWithLua("json_hash_set_document");
+        // Returns 0 when an NX/XX condition was not met, which, as for SET, is not an error.
+        _lua_script_manager->execute_script("json_hash_set_document", {key}, _hash_set_document_args(document, opts));
+    } else if (_delta_bases && opts.condition == SetCmdCondition::NONE && _set_json_delta(key, document, opts)) {
+        // Sent as a patch against the version remembered from the last write
+    } else if (_indexes.covers(key)) {
+        throwIfNotLegacyWithLua("json_set_document");
+        std::string encoded = encode_document(document, _legacy_config.document_encoding);
+        _lua_script_manager->execute_script("json_set_document", {key},
+                                            {condition_arg(opts.condition), std::to_string(opts.ttl.count()), encoded});
+        _remember_delta_base(key, document, encoded, opts);
     } else { // Legacy mode
-        RedisConnectionManager::RedisConnectionPtr conn = get_legacy_redis_connection();
-        RedisReplyPtr reply;
-        std::vector<const char*> argv_c;
-        std::vector<size_t> argv_len;
-
-        argv_c.push_back("SET");
-        argv_c.push_back(key.c_str());
-        argv_c.push_back(doc_str.c_str());
-
-        std::string ttl_str_holder; // To keep std::string alive for c_str()
-
-        if (opts.ttl.count() > 0) {
-            argv_c.push_back("EX");
-            ttl_str_holder = std::to_string(opts.ttl.count());
-            argv_c.push_back(ttl_str_holder.c_str());
-        }
-        if (opts.condition == SetCmdCondition::NX) {
-            argv_c.push_back("NX");
-        } else if (opts.condition == SetCmdCondition::XX) {
-            argv_c.push_back("XX");
-        }
-
-        for(const char* s : argv_c) {
-            argv_len.push_back(strlen(s));
-        }
-
-        reply = RedisReplyPtr(static_cast<redisReply*>(
-            conn->command_argv(argv_c.size(), argv_c.data(), argv_len.data())
-        ));
-
-        if (!reply) {
-             _connection_manager->return_connection(std::move(conn)); // Return connection before throwing
-            throw RedisCommandException("SET", "Key: " + key + ", Error: No reply or connection error");
-        }
+        // MessagePack documents may contain NUL bytes, so every argument carries its length.
+        std::string encoded = encode_document(document, _legacy_config.document_encoding);
+        RedisReplyPtr reply = _execute_command(build_set_command(key, encoded, opts));
         if (reply->type == REDIS_REPLY_ERROR) {
             std::string err_msg = reply->str ? reply->str : "Unknown Redis error";
-            _connection_manager->return_connection(std::move(conn));
             throw RedisCommandException("SET", "Key: " + key + ", Error: " + err_msg);
         }
         if (reply->type == REDIS_REPLY_NIL && opts.condition != SetCmdCondition::NONE) {
@@ -196,13 +312,54 @@ void RedisJSONClient::set_json(const std::string& key, const json& document, con
         } else if (reply->type == REDIS_REPLY_STATUS && strcmp(reply->str, "OK") != 0) {
             // Should not happen if not error and not nil for NX/XX
             std::string status_msg = reply->str ? reply->str : "Non-OK status";
-             _connection_manager->return_connection(std::move(conn));
             throw RedisCommandException("SET", "Key: " + key + ", SET command did not return OK: " + status_msg);
         }
-        _connection_manager->return_connection(std::move(conn));
+        _remember_delta_base(key, document, encoded, opts);
     }
 }
 
+bool RedisJSONClient::_set_json_delta(const std::string& key, const json& document, const SetOptions& opts) {
+    SharedDocument base = _delta_bases->get_shared(key);
+    if (!base || !scripts_preserve_document(document, _legacy_config.document_encoding)) {
+        return false;
+    }
+    std::string patch = _json_modifier->diff(base->at("document"), document).dump();
+    if (patch.size() * 2 > base->at("size").get<size_t>()) {
+        return false; // Not worth a script call: write the whole document
+    }
+    json result;
+    try {
+        result = _lua_script_manager->execute_script("json_delta_set", {key},
+                                                     {base->at("sha1").get<std::string>(), patch,
+                                                      std::to_string(opts.ttl.count())});
+    } catch (const LuaScriptException&) {
+        _delta_bases->invalidate(key); // E.g. the stored value cannot be decoded: write it whole
+        return false;
+    }
+    if (!result.is_array() || result.size() != 2) {
+        return false; // The stored value is not the remembered version
+    }
+    _delta_bases->put_shared(key, std::make_shared<const json>(json{
+        {"sha1", result[0]}, {"size", result[1]}, {"document", document}}));
+    return true;
+}
+
+void RedisJSONClient::_remember_delta_base(const std::string& key, const json& document, const std::string& encoded,
+                                           const SetOptions& opts) {
+    if (!_delta_bases) {
+        return;
+    }
+    if (opts.condition != SetCmdCondition::NONE ||
+        !scripts_preserve_document(document, _legacy_config.document_encoding)) {
+        // Whether an NX/XX write happened is not known here, and documents the scripts
+        // cannot store unchanged are never sent as patches.
+        _delta_bases->invalidate(key);
+        return;
+    }
+    _delta_bases->put_shared(key, std::make_shared<const json>(json{
+        {"sha1", sha1_hex(encoded)}, {"size", encoded.size()}, {"document", document}}));
+}
+
 json RedisJSONClient::get_json(const std::string& key) const {
     if (_is_swss_mode) {
         if (!_db_connector) throw RedisJSONException("DBConnector not initialized for SWSS mode.");
@@ -211,14 +368,145 @@ json RedisJSONClient::get_json(const std::string& key) const {
             throw PathNotFoundException(key, "$ (root)");
         }
         return _parse_json_reply(doc_str, "SWSS GET for key '" + key + "'");
-    } else { // Legacy mode
-        RedisConnectionManager::RedisConnectionPtr conn = get_legacy_redis_connection();
-        RedisReplyPtr reply(static_cast<redisReply*>(conn->command("GET %s", key.c_str())));
-        _connection_manager->return_connection(std::move(conn)); // Return connection after command
+    }
+    if (!_cache_usable(key)) {
+        return _fetch_json(key);
+    }
+    return *get_json_shared(key);
+}
+
+SharedDocument RedisJSONClient::get_json_shared(const std::string& key) const {
+    if (_is_swss_mode) {
+        return std::make_shared<const json>(get_json(key));
+    }
+    if (!_cache_usable(key)) {
+        return std::make_shared<const json>(_fetch_json(key));
+    }
+    // Concurrent misses of the key share one read. The loader may also run later on the
+    // cache's refresh thread, which the cache joins before this client goes away.
+    // Cached copies are read from the primary, whose writes invalidate them.
+    return _json_cache->get_or_load(key, [this, key] {
+        RedisConnectionManager::PrimaryReadScope primary_reads;
+        return std::make_shared<const json>(_fetch_json(key));
+    });
+}
+
+SharedDocument RedisJSONClient::get_path_view(const std::string& key, const std::string& path) const {
+    SharedDocument document = get_json_shared(key);
+    try {
+        return view_at(document, path);
+    } catch (const PathNotFoundException&) {
+        throw PathNotFoundException(key, path);
+    }
+}
 
-        if (!reply) {
-            throw RedisCommandException("GET", "Key: " + key + ", Error: No reply or connection error");
+std::vector<json> RedisJSONClient::query_json(const std::string& key, const JSONPathPlan& plan) const {
+    auto evaluate_locally = [&]() -> std::vector<json> {
+        SharedDocument document;
+        try {
+            document = get_json_shared(key);
+        } catch (const PathNotFoundException&) {
+            return {};
         }
+        std::vector<json> matches;
+        plan.visit(*document, [&matches](const json& match) { matches.push_back(match); });
+        return matches;
+    };
+    if (_is_swss_mode || _cache_usable(key)) {
+        return evaluate_locally();
+    }
+    std::vector<std::string> args;
+    if (_is_hash_layout()) {
+        // The script only sees the hash field named by the plan's first member.
+        std::string member = plan.leading_member();
+        if (member.empty() || plan.filters_use_root()) {
+            return evaluate_locally();
+        }
+        args = {std::move(member), plan.script_argument(1)};
+    } else {
+        args = {plan.script_argument()};
+    }
+    json result = _lua_script_manager->execute_script("json_query", {key}, args);
+    if (result.is_null()) {
+        return {};
+    }
+    if (!result.is_array()) {
+        throw LuaScriptException("json_query", "Unexpected result for key '" + key + "': " + result.dump());
+    }
+    std::vector<json> matches;
+    matches.reserve(result.size());
+    for (auto& match : result) {
+        matches.push_back(std::move(match));
+    }
+    return matches;
+}
+
+void RedisJSONClient::aggregate_json(const std::vector<std::string>& keys, const JSONPathPlan& plan,
+                                     Aggregation& aggregation, size_t batch_size) const {
+    bool script_usable = !_is_swss_mode &&
+                         (!_is_hash_layout() || (!plan.leading_member().empty() && !plan.filters_use_root()));
+    std::vector<std::string> remote_keys;
+    for (const auto& key : keys) {
+        if (script_usable && !_cache_usable(key)) {
+            remote_keys.push_back(key);
+            continue;
+        }
+        SharedDocument document;
+        try {
+            document = get_json_shared(key);
+        } catch (const PathNotFoundException&) {
+            continue;
+        }
+        plan.visit(*document, [&aggregation](const json& match) { aggregation.add(match); });
+    }
+    if (remote_keys.empty()) {
+        return;
+    }
+
+    std::vector<std::string> plan_args;
+    if (_is_hash_layout()) {
+        plan_args = {plan.leading_member(), plan.script_argument(1)};
+    } else {
+        plan_args = {plan.script_argument()};
+    }
+    auto run_script = [&](const std::vector<std::string>& batch, bool partial) {
+        std::vector<std::string> args = plan_args;
+        std::vector<std::string> operation_args = aggregation.script_arguments(partial);
+        args.insert(args.end(), operation_args.begin(), operation_args.end());
+        json reply = _lua_script_manager->execute_script("json_aggregate", batch, args);
+        if (partial) {
+            aggregation.merge(reply);
+        } else if (reply.is_object() && reply.contains("result")) {
+            aggregation.set_result(reply["result"]);
+        } else {
+            throw LuaScriptException("json_aggregate", "Unexpected result: " + reply.dump());
+        }
+    };
+    if (keys.size() == 1) {
+        run_script(remote_keys, false);
+        return;
+    }
+    // A script may only touch keys of one hash slot in cluster mode.
+    std::map<uint16_t, std::vector<std::string>> slots;
+    for (auto& key : remote_keys) {
+        uint16_t slot = _connection_manager->is_cluster() ? key_hash_slot(key) : 0;
+        slots[slot].push_back(std::move(key));
+    }
+    size_t batch_limit = std::max<size_t>(batch_size, 1);
+    for (const auto& slot_keys : slots) {
+        for (size_t first = 0; first < slot_keys.second.size(); first += batch_limit) {
+            size_t last = std::min(first + batch_limit, slot_keys.second.size());
+            run_script(std::vector<std::string>(slot_keys.second.begin() + first, slot_keys.second.begin() + last), true);
+        }
+    }
+}
+
+json RedisJSONClient::_fetch_json(const std::string& key) const {
+    if (_is_hash_layout()) {
+        RedisReplyPtr reply = _execute_read_command({"HGETALL", key});
+        return _decode_hash_document(key, reply.get());
+    } else { // Legacy mode
+        RedisReplyPtr reply = _execute_read_command({"GET", key});
         if (reply->type == REDIS_REPLY_ERROR) {
             throw RedisCommandException("GET", "Key: " + key + ", Error: " + (reply->str ? reply->str : "Redis error reply"));
         }
@@ -226,7 +514,8 @@ json RedisJSONClient::get_json(const std::string& key) const {
             throw PathNotFoundException(key, "$ (root)");
         }
         if (reply->type == REDIS_REPLY_STRING) {
-            return _parse_json_reply(reply->str, "GET for key '" + key + "'");
+            return decode_document(std::string(reply->str, reply->len), _legacy_config.document_encoding,
+                                   "GET for key '" + key + "'");
         }
         throw RedisCommandException("GET", "Key: " + key + ", Error: Unexpected reply type " + std::to_string(reply->type));
     }
@@ -237,33 +526,36 @@ bool RedisJSONClient::exists_json(const std::string& key) const {
         if (!_db_connector) throw RedisJSONException("DBConnector not initialized for SWSS mode.");
         return _db_connector->exists(key);
     } else { // Legacy mode
-        RedisConnectionManager::RedisConnectionPtr conn = get_legacy_redis_connection();
-        RedisReplyPtr reply(static_cast<redisReply*>(conn->command("EXISTS %s", key.c_str())));
-        _connection_manager->return_connection(std::move(conn));
-        if (!reply || reply->type == REDIS_REPLY_ERROR) {
-            throw RedisCommandException("EXISTS", "Key: " + key + ", Error: " + (reply ? (reply->str ? reply->str : "Unknown Redis error") : "No reply"));
+        RedisReplyPtr reply = _execute_read_command({"EXISTS", key});
+        if (reply->type == REDIS_REPLY_ERROR) {
+            throw RedisCommandException("EXISTS", "Key: " + key + ", Error: " + (reply->str ? reply->str : "Unknown Redis error"));
         }
         return (reply->type == REDIS_REPLY_INTEGER && reply->integer == 1);
     }
 }
 
 void RedisJSONClient::del_json(const std::string& key) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         if (!_db_connector) throw RedisJSONException("DBConnector not initialized for SWSS mode.");
         _db_connector->del(key);
+    } else if (_indexes.covers(key)) {
+        throwIfNotLegacyWithLua("json_del_document");
+        // In the hash layout the storage prelude consumes an (unused) member argument.
+        _lua_script_manager->execute_script("json_del_document", {key},
+                                            _is_hash_layout() ? std::vector<std::string>{""} : std::vector<std::string>{});
     } else { // Legacy mode
-        RedisConnectionManager::RedisConnectionPtr conn = get_legacy_redis_connection();
-        RedisReplyPtr reply(static_cast<redisReply*>(conn->command("DEL %s", key.c_str())));
-        _connection_manager->return_connection(std::move(conn));
-        if (!reply || reply->type == REDIS_REPLY_ERROR) {
-            throw RedisCommandException("DEL", "Key: " + key + ", Error: " + (reply ? (reply->str ? reply->str : "Unknown Redis error") : "No reply"));
+        RedisReplyPtr reply = _execute_command({"DEL", key});
+        if (reply->type == REDIS_REPLY_ERROR) {
+            throw RedisCommandException("DEL", "Key: " + key + ", Error: " + (reply->str ? reply->str : "Unknown Redis error"));
         }
     }
 }
 
 json RedisJSONClient::_get_document_for_modification(const std::string& key) const {
     try {
-        return get_json(key);
+        // Never from the client-side cache: the document is about to be rewritten.
+        return _is_swss_mode ? get_json(key) : _fetch_json(key);
     } catch (const PathNotFoundException& ) {
         return json::object();
     }
@@ -273,6 +565,364 @@ void RedisJSONClient::_set_document_after_modification(const std::string& key, c
     set_json(key, document, opts);
 }
 
+// --- Batch Operations ---
+
+RedisReplyPtr RedisJSONClient::_execute_command(const std::vector<std::string>& argv) const {
+    if (!_connection_manager) {
+        throw RedisJSONException("Legacy connection manager not available in SWSS mode or not initialized.");
+    }
+    RedisReplyPtr reply = _connection_manager->execute_for_key(RedisConnectionManager::command_key(argv), argv);
+    if (!reply) {
+        throw RedisCommandException(argv.front(), "Key: " + (argv.size() > 1 ? argv[1] : std::string()) +
+                                    ", Error: No reply or connection error");
+    }
+    return reply;
+}
+
+RedisReplyPtr RedisJSONClient::_execute_read_command(const std::vector<std::string>& argv) const {
+    if (!_connection_manager) {
+        throw RedisJSONException("Legacy connection manager not available in SWSS mode or not initialized.");
+    }
+    RedisReplyPtr reply = _connection_manager->execute_read(RedisConnectionManager::command_key(argv), argv);
+    if (!reply) {
+        throw RedisCommandException(argv.front(), "Key: " + (argv.size() > 1 ? argv[1] : std::string()) +
+                                    ", Error: No reply or connection error");
+    }
+    return reply;
+}
+
+// --- Hash Document Layout ---
+
+bool RedisJSONClient::_is_hash_layout() const {
+    return !_is_swss_mode && _legacy_config.document_layout == DocumentLayout::HASH;
+}
+
+std::vector<std::string> RedisJSONClient::_script_args(const std::string& path, std::vector<std::string> rest) const {
+    std::vector<std::string> args;
+    args.reserve(rest.size() + 2);
+    if (_is_hash_layout()) {
+        auto [member, sub_path] = PathParser::split_top_level(path);
+        if (member.empty()) {
+            throw InvalidPathException("Path '" + path + "' addresses the document root, which is not supported here in the hash layout");
+        }
+        args.push_back(std::move(member));
+        args.push_back(sub_path.empty() ? "$" : PathParser::script_path_argument(sub_path));
+    } else {
+        args.push_back(PathParser::script_path_argument(path));
+    }
+    std::move(rest.begin(), rest.end(), std::back_inserter(args));
+    return args;
+}
+
+json RedisJSONClient::_decode_hash_document(const std::string& key, redisReply* reply) const {
+    if (reply->type == REDIS_REPLY_ERROR) {
+        throw RedisCommandException("HGETALL", "Key: " + key + ", Error: " + std::string(reply->str, reply->len));
+    }
+    if (reply->type != REDIS_REPLY_ARRAY) {
+        throw RedisCommandException("HGETALL", "Key: " + key + ", Error: Unexpected reply type " + std::to_string(reply->type));
+    }
+    if (reply->elements == 0) {
+        throw PathNotFoundException(key, "$ (root)");
+    }
+    json document = json::object();
+    for (size_t i = 0; i + 1 < reply->elements; i += 2) {
+        std::string field(reply->element[i]->str, reply->element[i]->len);
+        document[field] = decode_document(std::string(reply->element[i + 1]->str, reply->element[i + 1]->len),
+                                          _legacy_config.document_encoding,
+                                          "HGETALL for key '" + key + "', field '" + field + "'");
+    }
+    return document;
+}
+
+std::vector<std::string> RedisJSONClient::_hash_set_document_args(const json& document, const SetOptions& opts) const {
+    std::vector<std::string> fields = encode_document_fields(document, _legacy_config.document_encoding);
+    // The leading empty argument is the (unused) member consumed by the storage prelude.
+    std::vector<std::string> args = {"", condition_arg(opts.condition), std::to_string(opts.ttl.count())};
+    std::move(fields.begin(), fields.end(), std::back_inserter(args));
+    return args;
+}
+
+std::vector<std::string> RedisJSONClient::_set_document_command(const std::string& key, const json& document,
+                                                                const SetOptions& opts) const {
+    // In the hash layout each document is written by the json_hash_set_document script,
+    // and in the string layout documents covered by an index by json_set_document.
+    if (_is_hash_layout()) {
+        throwIfNotLegacyWithLua("json_hash_set_document");
+        return build_script_command(_lua_script_manager->get_script_sha("json_hash_set_document"), key,
+                                    _hash_set_document_args(document, opts), _indexes);
+    }
+    if (_indexes.covers(key)) {
+        throwIfNotLegacyWithLua("json_set_document");
+        return build_script_command(_lua_script_manager->get_script_sha("json_set_document"), key,
+                                    {condition_arg(opts.condition), std::to_string(opts.ttl.count()),
+                                     encode_document(document, _legacy_config.document_encoding)},
+                                    _indexes);
+    }
+    return build_set_command(key, encode_document(document, _legacy_config.document_encoding), opts);
+}
+
+std::vector<RedisReplyPtr> RedisJSONClient::_execute_pipeline(const std::vector<std::vector<std::string>>& commands) const {
+    if (!_connection_manager) {
+        throw RedisJSONException("Legacy connection manager not available in SWSS mode or not initialized.");
+    }
+    return _connection_manager->execute_pipeline(commands);
+}
+
+std::vector<RedisReplyPtr> RedisJSONClient::_execute_read_pipeline(const std::vector<std::vector<std::string>>& commands) const {
+    if (!_connection_manager) {
+        throw RedisJSONException("Legacy connection manager not available in SWSS mode or not initialized.");
+    }
+    return _connection_manager->execute_read_pipeline(commands);
+}
+
+void RedisJSONClient::_resend_noscript_commands(const std::vector<std::vector<std::string>>& commands,
+                                                std::vector<RedisReplyPtr>& replies,
+                                                const std::vector<std::string>& scripts) const {
+    std::vector<size_t> failed;
+    for (size_t i = 0; i < replies.size(); ++i) {
+        const redisReply* reply = replies[i].get();
+        if (reply && reply->type == REDIS_REPLY_ERROR && reply->len >= 8 && strncmp(reply->str, "NOSCRIPT", 8) == 0) {
+            failed.push_back(i);
+        }
+    }
+    if (failed.empty()) {
+        return;
+    }
+    // After a SCRIPT FLUSH or a failover to a server that never loaded them
+    for (const std::string& name : scripts) {
+        _lua_script_manager->reload_builtin_script(name);
+    }
+    std::vector<std::vector<std::string>> resend;
+    resend.reserve(failed.size());
+    for (size_t i : failed) {
+        resend.push_back(commands[i]);
+    }
+    std::vector<RedisReplyPtr> resent = _execute_pipeline(resend);
+    for (size_t i = 0; i < failed.size(); ++i) {
+        replies[failed[i]] = std::move(resent[i]);
+    }
+}
+
+std::vector<BatchResult> RedisJSONClient::get_json_many(const std::vector<std::string>& keys) const {
+    std::vector<BatchResult> results(keys.size());
+    if (_is_swss_mode) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            try {
+                results[i].value = get_json(keys[i]);
+            } catch (...) {
+                results[i].error = std::current_exception();
+            }
+        }
+        return results;
+    }
+
+    std::vector<std::vector<std::string>> commands;
+    commands.reserve(keys.size());
+    for (const auto& key : keys) {
+        commands.push_back({_is_hash_layout() ? "HGETALL" : "GET", key});
+    }
+    std::vector<RedisReplyPtr> replies = _execute_read_pipeline(commands);
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const std::string& key = keys[i];
+        redisReply* reply = replies[i].get();
+        try {
+            if (!reply) {
+                throw RedisCommandException(commands[i][0], "Key: " + key + ", Error: No reply or connection error");
+            }
+            if (_is_hash_layout()) {
+                results[i].value = _decode_hash_document(key, reply);
+                continue;
+            }
+            if (reply->type == REDIS_REPLY_ERROR) {
+                throw RedisCommandException("GET", "Key: " + key + ", Error: " + std::string(reply->str, reply->len));
+            }
+            if (reply->type == REDIS_REPLY_NIL) {
+                throw PathNotFoundException(key, "$ (root)");
+            }
+            if (reply->type != REDIS_REPLY_STRING) {
+                throw RedisCommandException("GET", "Key: " + key + ", Error: Unexpected reply type " + std::to_string(reply->type));
+            }
+            results[i].value = decode_document(std::string(reply->str, reply->len), _legacy_config.document_encoding,
+                                                   "GET for key '" + key + "'");
+        } catch (...) {
+            results[i].error = std::current_exception();
+        }
+    }
+    return results;
+}
+
+std::map<std::string, BatchResult> RedisJSONClient::set_json_many(const std::map<std::string, json>& documents,
+                                                                  const SetOptions& opts) {
+    std::map<std::string, BatchResult> results;
+    if (_is_swss_mode) {
+        for (const auto& [key, document] : documents) {
+            BatchResult& result = results[key];
+            try {
+                set_json(key, document, opts);
+                result.value = true;
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+        }
+        return results;
+    }
+
+    // Documents that are not objects fail on their own (in the hash layout) without being sent.
+    std::vector<std::vector<std::string>> commands;
+    std::vector<std::exception_ptr> build_errors(documents.size());
+    commands.reserve(documents.size());
+    size_t i = 0;
+    for (const auto& [key, document] : documents) {
+        try {
+            commands.push_back(_set_document_command(key, document, opts));
+        } catch (...) {
+            build_errors[i] = std::current_exception();
+        }
+        ++i;
+    }
+    std::vector<RedisReplyPtr> replies = _execute_pipeline(commands);
+    _resend_noscript_commands(commands, replies, {"json_hash_set_document", "json_set_document"});
+    if (_json_cache) {
+        for (const auto& entry : documents) {
+            _json_cache->invalidate(entry.first);
+        }
+    }
+
+    i = 0;
+    size_t reply_index = 0;
+    const std::string command_name = _is_hash_layout() ? "EVALSHA" : "SET";
+    for (const auto& entry : documents) {
+        const std::string& key = entry.first;
+        BatchResult& result = results[key];
+        std::exception_ptr build_error = build_errors[i++];
+        if (build_error) {
+            result.error = build_error;
+            continue;
+        }
+        redisReply* reply = replies[reply_index++].get();
+        try {
+            if (!reply) {
+                throw RedisCommandException(command_name, "Key: " + key + ", Error: No reply or connection error");
+            }
+            if (reply->type == REDIS_REPLY_ERROR) {
+                throw RedisCommandException(command_name, "Key: " + key + ", Error: " + std::string(reply->str, reply->len));
+            }
+            if (reply->type == REDIS_REPLY_INTEGER) {
+                result.value = reply->integer == 1; // 0: NX/XX condition not met
+            } else if (reply->type == REDIS_REPLY_NIL) {
+                result.value = false; // NX/XX condition not met
+            } else if (reply->type == REDIS_REPLY_STATUS && strcmp(reply->str, "OK") == 0) {
+                result.value = true;
+            } else {
+                throw RedisCommandException("SET", "Key: " + key + ", SET command did not return OK");
+            }
+        } catch (...) {
+            result.error = std::current_exception();
+        }
+    }
+    return results;
+}
+
+std::vector<BatchResult> RedisJSONClient::get_paths(const std::string& key, const std::vector<std::string>& paths) const {
+    std::vector<BatchResult> results(paths.size());
+    if (_is_swss_mode) {
+        json doc;
+        try {
+            doc = get_json(key);
+        } catch (...) {
+            for (auto& result : results) result.error = std::current_exception();
+            return results;
+        }
+        for (size_t i = 0; i < paths.size(); ++i) {
+            try {
+                if (paths[i] == "$" || paths[i] == ".") {
+                    results[i].value = doc;
+                } else {
+                    results[i].value = _json_modifier->get(doc, _path_parser->compile(paths[i]));
+                }
+            } catch (...) {
+                results[i].error = std::current_exception();
+            }
+        }
+        return results;
+    }
+
+    throwIfNotLegacyWithLua("json_path_get");
+    std::string sha = _lua_script_manager->get_script_sha("json_path_get");
+    std::vector<std::vector<std::string>> commands;
+    commands.reserve(paths.size());
+    std::vector<std::string> command_names(paths.size()); // Empty for paths that were not sent
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const std::string& path = paths[i];
+        if (path == "$" || path == ".") {
+            commands.push_back({_is_hash_layout() ? "HGETALL" : "GET", key});
+        } else if (!_is_hash_layout()) {
+            commands.push_back({"EVALSHA", sha, "1", key, PathParser::script_path_argument(path)});
+        } else {
+            // Top-level members are plain hash fields; deeper paths run the script on one field.
+            try {
+                std::vector<std::string> args = _script_args(path);
+                if (args[1] == "$") {
+                    commands.push_back({"HGET", key, args[0]});
+                } else {
+                    commands.push_back({"EVALSHA", sha, "1", key, args[0], args[1]});
+                }
+            } catch (...) {
+                results[i].error = std::current_exception();
+                continue;
+            }
+        }
+        command_names[i] = commands.back()[0];
+    }
+    std::vector<RedisReplyPtr> replies = _execute_read_pipeline(commands);
+    _resend_noscript_commands(commands, replies, {"json_path_get"});
+
+    size_t reply_index = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (command_names[i].empty()) continue;
+        const std::string& path = paths[i];
+        const std::string& command_name = command_names[i];
+        redisReply* reply = replies[reply_index++].get();
+        try {
+            if (!reply) {
+                throw RedisCommandException(command_name, "Key: " + key + ", Path: " + path + ", Error: No reply or connection error");
+            }
+            if (command_name == "HGETALL") {
+                results[i].value = _decode_hash_document(key, reply);
+            } else if (command_name == "HGET") {
+                if (reply->type == REDIS_REPLY_NIL) {
+                    throw PathNotFoundException(key, path);
+                }
+                if (reply->type != REDIS_REPLY_STRING) {
+                    throw RedisCommandException("HGET", "Key: " + key + ", Path: " + path + ", Error: Unexpected reply type " + std::to_string(reply->type));
+                }
+                // Wrapped like the script result for the same path
+                results[i].value = json::array({decode_document(std::string(reply->str, reply->len), _legacy_config.document_encoding,
+                                                                "HGET for key '" + key + "', path '" + path + "'")});
+            } else if (command_name == "GET") {
+                if (reply->type == REDIS_REPLY_NIL) {
+                    throw PathNotFoundException(key, path);
+                }
+                if (reply->type != REDIS_REPLY_STRING) {
+                    throw RedisCommandException("GET", "Key: " + key + ", Error: Unexpected reply type " + std::to_string(reply->type));
+                }
+                results[i].value = decode_document(std::string(reply->str, reply->len), _legacy_config.document_encoding,
+                                                   "GET for key '" + key + "'");
+            } else {
+                json value = _lua_script_manager->redis_reply_to_json(reply);
+                if (value.is_array() && value.empty()) {
+                    throw PathNotFoundException(key, path);
+                }
+                results[i].value = std::move(value);
+            }
+        } catch (...) {
+            results[i].error = std::current_exception();
+        }
+    }
+    return results;
+}
+
 // --- Path Operations ---
 json RedisJSONClient::get_path(const std::string& key, const std::string& path_str) const {
     if (path_str == "$" || path_str == ".") {
@@ -280,39 +930,132 @@ json RedisJSONClient::get_path(const std::string& key, const std::string& path_s
     }
     if (_is_swss_mode) {
         json current_doc = get_json(key);
-        return _json_modifier->get(current_doc, _path_parser->parse(path_str));
-    } else {
-        throwIfNotLegacyWithLua("json_path_get");
-        json result = _lua_script_manager->execute_script("json_path_get", {key}, {path_str});
-        if (result.is_array() && result.empty()) throw PathNotFoundException(key, path_str);
-            return result;
+        return _json_modifier->get(current_doc, _path_parser->compile(path_str));
     }
+    if (!_cache_usable(key)) {
+        return _fetch_path(key, path_str);
+    }
+    return *_json_cache->get_path_or_load(key, path_str, [this, key, path_str] {
+        RedisConnectionManager::PrimaryReadScope primary_reads;
+        return std::make_shared<const json>(_fetch_path(key, path_str));
+    });
+}
+
+CompiledPath RedisJSONClient::compile_path(const std::string& path) const {
+    return _path_parser->compile(path);
+}
+
+// Legacy mode sends path.path() to the scripts, whose tokenised form comes from the
+// PathParser::script_path_argument() cache; SWSS mode walks the compiled elements.
+json RedisJSONClient::get_path(const std::string& key, const CompiledPath& path) const {
+    if (path.is_root()) {
+        return get_json(key);
+    }
+    if (!_is_swss_mode) {
+        return get_path(key, path.path());
+    }
+    json current_doc = get_json(key);
+    return _json_modifier->get(current_doc, path);
+}
+
+void RedisJSONClient::set_path(const std::string& key, const CompiledPath& path, const json& value, const SetOptions& opts) {
+    if (path.is_root()) {
+        set_json(key, value, opts);
+        return;
+    }
+    if (!_is_swss_mode) {
+        set_path(key, path.path(), value, opts);
+        return;
+    }
+    json doc = _get_document_for_modification(key);
+    _json_modifier->set(doc, path, value, opts.create_path);
+    _set_document_after_modification(key, doc, opts);
+}
+
+void RedisJSONClient::del_path(const std::string& key, const CompiledPath& path) {
+    if (path.is_root()) {
+        del_json(key);
+        return;
+    }
+    if (!_is_swss_mode) {
+        del_path(key, path.path());
+        return;
+    }
+    json doc;
+    try {
+        doc = get_json(key);
+        _json_modifier->del(doc, path);
+    } catch (const PathNotFoundException&) {
+        return;
+    }
+    _set_document_after_modification(key, doc, SetOptions{});
+}
+
+bool RedisJSONClient::exists_path(const std::string& key, const CompiledPath& path) const {
+    if (path.is_root()) {
+        return exists_json(key);
+    }
+    if (!_is_swss_mode) {
+        return exists_path(key, path.path());
+    }
+    try {
+        json doc = get_json(key);
+        return _json_modifier->exists(doc, path);
+    } catch (const PathNotFoundException&) {
+        return false;
+    }
+}
+
+json RedisJSONClient::_fetch_path(const std::string& key, const std::string& path_str) const {
+    throwIfNotLegacyWithLua("json_path_get");
+    std::vector<std::string> args = _script_args(path_str);
+    if (_is_hash_layout() && args[1] == "$") {
+        RedisReplyPtr reply = _execute_read_command({"HGET", key, args[0]});
+        if (reply->type == REDIS_REPLY_NIL) throw PathNotFoundException(key, path_str);
+        if (reply->type != REDIS_REPLY_STRING) {
+            throw RedisCommandException("HGET", "Key: " + key + ", Path: " + path_str + ", Error: " +
+                                        (reply->type == REDIS_REPLY_ERROR ? std::string(reply->str, reply->len) : "Unexpected reply type"));
+        }
+        // Wrapped like the script result for the same path
+        return json::array({decode_document(std::string(reply->str, reply->len), _legacy_config.document_encoding,
+                                            "HGET for key '" + key + "', path '" + path_str + "'")});
+    }
+    json result = _lua_script_manager->execute_script("json_path_get", {key}, args);
+    if (result.is_array() && result.empty()) throw PathNotFoundException(key, path_str);
+    return result;
 }
 
 void RedisJSONClient::set_path(const std::string& key, const std::string& path_str,
                                const json& value, const SetOptions& opts) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (path_str == "$" || path_str == ".") {
         set_json(key, value, opts);
         return;
     }
     if (_is_swss_mode) {
         json doc = _get_document_for_modification(key);
-        _json_modifier->set(doc, _path_parser->parse(path_str), value, opts.create_path);
+        _json_modifier->set(doc, _path_parser->compile(path_str), value, opts.create_path);
         _set_document_after_modification(key, doc, opts);
     } else {
         throwIfNotLegacyWithLua("json_path_set");
-        std::string value_dump = value.dump();
-        std::string condition_str;
-        switch (opts.condition) {
-            case SetCmdCondition::NX: condition_str = "NX"; break;
-            case SetCmdCondition::XX: condition_str = "XX"; break;
-            default: condition_str = "NONE"; break;
+        std::vector<std::string> args = _script_args(path_str, {value.dump(), condition_arg(opts.condition),
+                                                                std::to_string(opts.ttl.count()), opts.create_path ? "true" : "false"});
+        if (_is_hash_layout() && args[1] == "$" && opts.condition == SetCmdCondition::NONE && opts.ttl.count() == 0 &&
+            !_indexes.covers(key)) {
+            // Writing a whole top-level member needs no script: only that field is sent.
+            // An indexed key goes through the script, which also updates the indexes.
+            RedisReplyPtr reply = _execute_command({"HSET", key, args[0], encode_document(value, _legacy_config.document_encoding)});
+            if (reply->type == REDIS_REPLY_ERROR) {
+                throw RedisCommandException("HSET", "Key: " + key + ", Path: " + path_str + ", Error: " + std::string(reply->str, reply->len));
+            }
+            return;
         }
-        _lua_script_manager->execute_script("json_path_set", {key}, {path_str, value_dump, condition_str, std::to_string(opts.ttl.count()), opts.create_path ? "true" : "false"});
+        _lua_script_manager->execute_script("json_path_set", {key}, args);
     }
 }
 
 void RedisJSONClient::del_path(const std::string& key, const std::string& path_str) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (path_str == "$" || path_str == ".") {
         del_json(key);
         return;
@@ -326,14 +1069,22 @@ void RedisJSONClient::del_path(const std::string& key, const std::string& path_s
             return;
         }
         try {
-            _json_modifier->del(doc, _path_parser->parse(path_str));
+            _json_modifier->del(doc, _path_parser->compile(path_str));
             _set_document_after_modification(key, doc, opts);
         } catch (const PathNotFoundException& ) {
             return;
         }
     } else {
         throwIfNotLegacyWithLua("json_path_del");
-        _lua_script_manager->execute_script("json_path_del", {key}, {path_str});
+        std::vector<std::string> args = _script_args(path_str);
+        if (_is_hash_layout() && args[1] == "$" && !_indexes.covers(key)) {
+            RedisReplyPtr reply = _execute_command({"HDEL", key, args[0]});
+            if (reply->type == REDIS_REPLY_ERROR) {
+                throw RedisCommandException("HDEL", "Key: " + key + ", Path: " + path_str + ", Error: " + std::string(reply->str, reply->len));
+            }
+            return;
+        }
+        _lua_script_manager->execute_script("json_path_del", {key}, args);
     }
 }
 
@@ -344,53 +1095,64 @@ bool RedisJSONClient::exists_path(const std::string& key, const std::string& pat
     if (_is_swss_mode) {
         try {
             json doc = get_json(key);
-            return _json_modifier->exists(doc, _path_parser->parse(path_str));
+            return _json_modifier->exists(doc, _path_parser->compile(path_str));
         } catch (const PathNotFoundException&) {
             return false;
         }
     } else {
         throwIfNotLegacyWithLua("json_path_type");
-        json result = _lua_script_manager->execute_script("json_path_type", {key}, {path_str});
+        std::vector<std::string> args = _script_args(path_str);
+        if (_is_hash_layout() && args[1] == "$") {
+            RedisReplyPtr reply = _execute_read_command({"HEXISTS", key, args[0]});
+            if (reply->type == REDIS_REPLY_ERROR) {
+                throw RedisCommandException("HEXISTS", "Key: " + key + ", Path: " + path_str + ", Error: " + std::string(reply->str, reply->len));
+            }
+            return reply->type == REDIS_REPLY_INTEGER && reply->integer == 1;
+        }
+        json result = _lua_script_manager->execute_script("json_path_type", {key}, args);
         return !result.is_null();
     }
 }
 
 // --- Array Operations ---
 void RedisJSONClient::append_path(const std::string& key, const std::string& path_str, const json& value) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         SetOptions opts;
         json doc = _get_document_for_modification(key);
-        _json_modifier->array_append(doc, _path_parser->parse(path_str), value);
+        _json_modifier->array_append(doc, _path_parser->compile(path_str), value);
         _set_document_after_modification(key, doc, opts);
     } else {
         throwIfNotLegacyWithLua("json_array_append");
-        _lua_script_manager->execute_script("json_array_append", {key}, {path_str, value.dump()});
+        _lua_script_manager->execute_script("json_array_append", {key}, _script_args(path_str, {value.dump()}));
     }
 }
 
 void RedisJSONClient::prepend_path(const std::string& key, const std::string& path_str, const json& value) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         SetOptions opts;
         json doc = _get_document_for_modification(key);
-        _json_modifier->array_prepend(doc, _path_parser->parse(path_str), value);
+        _json_modifier->array_prepend(doc, _path_parser->compile(path_str), value);
         _set_document_after_modification(key, doc, opts);
     } else {
         throwIfNotLegacyWithLua("json_array_prepend");
-        _lua_script_manager->execute_script("json_array_prepend", {key}, {path_str, value.dump()});
+        _lua_script_manager->execute_script("json_array_prepend", {key}, _script_args(path_str, {value.dump()}));
     }
 }
 
 json RedisJSONClient::pop_path(const std::string& key, const std::string& path_str, int index) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         SetOptions opts;
         json doc = get_json(key);
         json popped_value;
-        popped_value = _json_modifier->array_pop(doc, _path_parser->parse(path_str), index);
+        popped_value = _json_modifier->array_pop(doc, _path_parser->compile(path_str), index);
         _set_document_after_modification(key, doc, opts);
         return popped_value;
     } else {
         throwIfNotLegacyWithLua("json_array_pop");
-        json result = _lua_script_manager->execute_script("json_array_pop", {key}, {path_str, std::to_string(index)});
+        json result = _lua_script_manager->execute_script("json_array_pop", {key}, _script_args(path_str, {std::to_string(index)}));
         if (result.is_null()) throw PathNotFoundException(key, path_str);
         return result;
     }
@@ -399,15 +1161,15 @@ json RedisJSONClient::pop_path(const std::string& key, const std::string& path_s
 size_t RedisJSONClient::array_length(const std::string& key, const std::string& path_str) const {
     if (_is_swss_mode) {
         json doc = get_json(key);
-        auto parsed_path = _path_parser->parse(path_str);
+        CompiledPath parsed_path = _path_parser->compile(path_str);
         json::value_t type = _json_modifier->get_type(doc, parsed_path);
         if (type != json::value_t::array) {
             throw TypeMismatchException(path_str, "array", json(type).type_name());
         }
-        return _json_modifier->get_size(doc, parsed_path);
+        return _json_modifier->get_size(doc, parsed_path.elements());
     } else {
         throwIfNotLegacyWithLua("json_array_length");
-        json result = _lua_script_manager->execute_script("json_array_length", {key}, {path_str});
+        json result = _lua_script_manager->execute_script("json_array_length", {key}, _script_args(path_str));
         if (result.is_number_integer()) {
             long long len = result.get<long long>();
             if (len < 0) throw RedisCommandException("LUA_json_array_length", "Negative length received");
@@ -419,6 +1181,7 @@ size_t RedisJSONClient::array_length(const std::string& key, const std::string&
 }
 
 long long RedisJSONClient::arrinsert(const std::string& key, const std::string& path_str, int index, const std::vector<json>& values) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (values.empty()) {
         throw ArgumentInvalidException("Values vector cannot be empty for arrinsert.");
     }
@@ -426,7 +1189,8 @@ long long RedisJSONClient::arrinsert(const std::string& key, const std::string&
         SetOptions opts;
         json doc = _get_document_for_modification(key);
         json* target_array = nullptr;
-        auto parsed_path_elements = _path_parser->parse(path_str);
+        CompiledPath compiled_path = _path_parser->compile(path_str);
+        const auto& parsed_path_elements = compiled_path.elements();
         json* current = &doc;
         bool path_is_root = (path_str == "$" || path_str == "" || parsed_path_elements.empty());
 
@@ -479,11 +1243,11 @@ long long RedisJSONClient::arrinsert(const std::string& key, const std::string&
     } else {
         throwIfNotLegacyWithLua("json_array_insert");
         std::vector<std::string> script_args;
-        script_args.push_back(path_str);
         script_args.push_back(std::to_string(index));
         for(const auto& val : values) {
             script_args.push_back(val.dump());
         }
+        script_args = _script_args(path_str, std::move(script_args));
         json result = _lua_script_manager->execute_script("json_array_insert", {key}, script_args);
         if (result.is_number_integer()) {
             return result.get<long long>();
@@ -501,7 +1265,7 @@ long long RedisJSONClient::arrindex(const std::string& key,
         json doc = get_json(key);
         json target_array_node;
         try {
-            target_array_node = _json_modifier->get(doc, _path_parser->parse(path));
+            target_array_node = _json_modifier->get(doc, _path_parser->compile(path));
         } catch (const PathNotFoundException&) {
             throw PathNotFoundException(key, path); // Corrected
         } catch (const std::exception& e) {
@@ -553,7 +1317,7 @@ long long RedisJSONClient::arrindex(const std::string& key,
     std::string end_str = end_index.has_value() ? std::to_string(end_index.value()) : "";
 
     json script_result = _lua_script_manager->execute_script(
-        "json_arrindex", {key}, {path, value_json_str, start_str, end_str}
+        "json_arrindex", {key}, _script_args(path, {value_json_str, start_str, end_str})
     );
 
     if (script_result.is_number_integer()) {
@@ -564,12 +1328,13 @@ long long RedisJSONClient::arrindex(const std::string& key,
 
 // --- Numeric Operations ---
 json RedisJSONClient::json_numincrby(const std::string& key, const std::string& path, double value) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         // Non-atomic get-modify-set for SWSS mode
         json doc = _get_document_for_modification(key); // Creates empty {} if key not found
         json current_value_at_path = json(nullptr);
         bool path_existed = true;
-        std::vector<PathParser::PathElement> parsed_path = _path_parser->parse(path);
+        CompiledPath parsed_path = _path_parser->compile(path);
 
         try {
             current_value_at_path = _json_modifier->get(doc, parsed_path);
@@ -596,7 +1361,7 @@ json RedisJSONClient::json_numincrby(const std::string& key, const std::string&
     } else { // Legacy mode (atomic via Lua)
         throwIfNotLegacyWithLua("json_numincrby");
         std::string value_str = json(value).dump(); // Ensure double is correctly stringified for Lua
-        json result = _lua_script_manager->execute_script("json_numincrby", {key}, {path, value_str});
+        json result = _lua_script_manager->execute_script("json_numincrby", {key}, _script_args(path, {value_str}));
         // Lua script for numincrby returns the new value, JSON encoded.
         // execute_script already parses this.
         return result;
@@ -605,7 +1370,9 @@ json RedisJSONClient::json_numincrby(const std::string& key, const std::string&
 
 // --- Merge Operations ---
 void RedisJSONClient::merge_json(const std::string& key, const json& patch) {
-    if (_is_swss_mode) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
+    if (_is_swss_mode || _is_hash_layout()) {
+        // Merged on the client: no script rewrites a document stored across hash fields.
         SetOptions opts;
         json current_doc;
         try {
@@ -620,27 +1387,26 @@ void RedisJSONClient::merge_json(const std::string& key, const json& patch) {
         }
         current_doc.merge_patch(patch);
         _set_document_after_modification(key, current_doc, opts);
+    } else if (!patch.is_object()) {
+        set_json(key, patch); // RFC 7386: a patch that is not an object replaces the document
     } else {
-        throwIfNotLegacyWithLua("JSON.MERGE"); // Assuming direct command for now
-        RedisConnectionManager::RedisConnectionPtr conn = get_legacy_redis_connection();
-        std::string patch_str = patch.dump();
-        RedisReplyPtr reply(static_cast<redisReply*>(
-            conn->command("JSON.MERGE %s $ %s", key.c_str(), patch_str.c_str())
-        ));
-        _connection_manager->return_connection(std::move(conn));
-        if (!reply) {
-            throw RedisCommandException("JSON.MERGE", "Key: " + key + ", Path: $, Error: No reply or connection error");
-        }
-        if (reply->type == REDIS_REPLY_ERROR) {
-            throw RedisCommandException("JSON.MERGE", "Key: " + key + ", Path: $, Error: " + (reply->str ? reply->str : "Redis error"));
-        }
-        if (!(reply->type == REDIS_REPLY_STATUS && strcmp(reply->str, "OK") == 0)) {
-            throw RedisCommandException("JSON.MERGE", "Key: " + key + ", Path: $, Unexpected reply: " + (reply->str ? reply->str : "Non-OK status"));
+        throwIfNotLegacyWithLua("json_merge_patch");
+        json marked = LuaScriptManager::mark_empty_arrays(patch);
+        if (scripts_preserve_document(marked, DocumentEncoding::JSON) &&
+            _lua_script_manager->execute_script("json_merge_patch", {key}, {marked.dump()}) == 1) {
+            return;
         }
+        // The script would lose part of the document or of the patch (it returns 0 for the
+        // document): merge on the client.
+        _modify_stored_document(key, json::object(), [&patch](json doc) {
+            doc.merge_patch(patch);
+            return doc;
+        });
     }
 }
 
 bool RedisJSONClient::set_json_sparse(const std::string& key, const json& sparse_json_object) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         throw NotImplementedException("set_json_sparse for SWSS mode is not implemented with atomicity. Use non-SWSS mode for Lua script execution.");
     } else {
@@ -648,6 +1414,25 @@ bool RedisJSONClient::set_json_sparse(const std::string& key, const json& sparse
         if (!sparse_json_object.is_object()) {
             throw ArgumentInvalidException("Input sparse_json_object must be a JSON object for set_json_sparse.");
         }
+        if (_is_hash_layout()) {
+            // Each member is its own field, so the shallow merge is a single HSET, or for an
+            // indexed key the json_hash_merge_fields script, which also updates the indexes.
+            if (sparse_json_object.empty()) return true;
+            std::vector<std::string> fields = encode_document_fields(sparse_json_object, _legacy_config.document_encoding);
+            if (_indexes.covers(key)) {
+                std::vector<std::string> args = {""}; // The unused member consumed by the storage prelude
+                std::move(fields.begin(), fields.end(), std::back_inserter(args));
+                _lua_script_manager->execute_script("json_hash_merge_fields", {key}, args);
+                return true;
+            }
+            std::vector<std::string> cmd = {"HSET", key};
+            std::move(fields.begin(), fields.end(), std::back_inserter(cmd));
+            RedisReplyPtr reply = _execute_command(cmd);
+            if (reply->type == REDIS_REPLY_ERROR) {
+                throw RedisCommandException("HSET", "Key: " + key + ", Error: " + std::string(reply->str, reply->len));
+            }
+            return true;
+        }
         std::string sparse_json_str = sparse_json_object.dump();
         json result = _lua_script_manager->execute_script("json_sparse_merge", {key}, {sparse_json_str});
         if (result.is_number() && result.get<int>() == 1) {
@@ -669,7 +1454,7 @@ std::vector<std::string> RedisJSONClient::object_keys(const std::string& key, co
         json target_node = doc;
         if (path != "$" && path != "" && path != ".") {
             try {
-                target_node = _json_modifier->get(doc, _path_parser->parse(path));
+                target_node = _json_modifier->get(doc, _path_parser->compile(path));
             } catch (const PathNotFoundException&) {
                 return {};
             } catch (const json::exception& e) {
@@ -687,7 +1472,20 @@ std::vector<std::string> RedisJSONClient::object_keys(const std::string& key, co
         }
     } else {
         throwIfNotLegacyWithLua("json_object_keys");
-        json result = _lua_script_manager->execute_script("json_object_keys", {key}, {path});
+        if (_is_hash_layout() && PathParser::split_top_level(path).first.empty()) {
+            RedisReplyPtr reply = _execute_read_command({"HKEYS", key});
+            if (reply->type != REDIS_REPLY_ARRAY) {
+                throw RedisCommandException("HKEYS", "Key: " + key + ", Error: " +
+                                            (reply->type == REDIS_REPLY_ERROR ? std::string(reply->str, reply->len) : "Unexpected reply type"));
+            }
+            std::vector<std::string> keys_vec;
+            keys_vec.reserve(reply->elements);
+            for (size_t i = 0; i < reply->elements; ++i) {
+                keys_vec.emplace_back(reply->element[i]->str, reply->element[i]->len);
+            }
+            return keys_vec;
+        }
+        json result = _lua_script_manager->execute_script("json_object_keys", {key}, _script_args(path));
         if (result.is_null()) {
             return {};
         }
@@ -717,7 +1515,7 @@ std::optional<size_t> RedisJSONClient::object_length(const std::string& key, con
         json target_node = doc;
         if (path != "$" && path != "" && path != ".") {
             try {
-                target_node = _json_modifier->get(doc, _path_parser->parse(path));
+                target_node = _json_modifier->get(doc, _path_parser->compile(path));
             } catch (const PathNotFoundException&) {
                 return std::nullopt;
             } catch (const json::exception& e) {
@@ -731,7 +1529,17 @@ std::optional<size_t> RedisJSONClient::object_length(const std::string& key, con
         }
     } else {
         throwIfNotLegacyWithLua("json_object_length");
-        json result = _lua_script_manager->execute_script("json_object_length", {key}, {path});
+        if (_is_hash_layout() && PathParser::split_top_level(path).first.empty()) {
+            RedisReplyPtr reply = _execute_read_command({"HLEN", key});
+            if (reply->type != REDIS_REPLY_INTEGER) {
+                throw RedisCommandException("HLEN", "Key: " + key + ", Error: " +
+                                            (reply->type == REDIS_REPLY_ERROR ? std::string(reply->str, reply->len) : "Unexpected reply type"));
+            }
+            // An empty document is not stored, so no fields means no key.
+            if (reply->integer == 0) return std::nullopt;
+            return static_cast<size_t>(reply->integer);
+        }
+        json result = _lua_script_manager->execute_script("json_object_length", {key}, _script_args(path));
         if (result.is_null()) {
             return std::nullopt;
         }
@@ -747,40 +1555,105 @@ std::optional<size_t> RedisJSONClient::object_length(const std::string& key, con
 }
 
 void RedisJSONClient::patch_json(const std::string& key, const json& patch_operations) {
-    json current_doc;
-    SetOptions opts;
-    try {
-        current_doc = get_json(key);
-    } catch (const PathNotFoundException& ) {
-        current_doc = json(nullptr);
+    if (_is_swss_mode || _is_hash_layout()) {
+        json current_doc;
+        SetOptions opts;
+        try {
+            current_doc = get_json(key);
+        } catch (const PathNotFoundException& ) {
+            current_doc = json(nullptr);
+        }
+        json patched_doc = current_doc.patch(patch_operations);
+        set_json(key, patched_doc, opts);
+        return;
+    }
+    if (!patch_operations.is_array()) {
+        throw ArgumentInvalidException("JSON Patch must be an array of operations.");
     }
-    json patched_doc = current_doc.patch(patch_operations);
-    set_json(key, patched_doc, opts);
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
+    throwIfNotLegacyWithLua("json_patch");
+    json operations = patch_operations;
+    for (json& operation : operations) {
+        auto value = operation.is_object() ? operation.find("value") : operation.end();
+        if (value != operation.end() && operation.value("op", json()) != "test") {
+            *value = LuaScriptManager::mark_empty_arrays(std::move(*value));
+        }
+    }
+    if (scripts_preserve_document(operations, DocumentEncoding::JSON)) {
+        try {
+            if (_lua_script_manager->execute_script("json_patch", {key}, {operations.dump()}) == 1) {
+                return;
+            }
+        } catch (const LuaScriptException& e) {
+            std::string error_msg = e.what();
+            if (error_msg.find("ERR_PATCH") != std::string::npos) {
+                throw PatchFailedException("Key: " + key + ", " + error_msg);
+            }
+            throw;
+        }
+    }
+    // The script would lose part of the document or of the patch (it returns 0 for the
+    // document): patch on the client.
+    _modify_stored_document(key, json(nullptr), [&key, &patch_operations](json doc) {
+        try {
+            return doc.patch(patch_operations);
+        } catch (const json::exception& e) {
+            throw PatchFailedException("Key: " + key + ", " + e.what());
+        }
+    });
+}
+
+void RedisJSONClient::_modify_stored_document(const std::string& key, const json& missing_document,
+                                              const std::function<json(json)>& modify) {
+    throwIfNotLegacyWithLua("json_replace_if_unchanged");
+    const int max_attempts = 16;
+    for (int attempt = 0; attempt < max_attempts; ++attempt) {
+        RedisReplyPtr reply = _execute_command({"GET", key});
+        if (reply->type == REDIS_REPLY_ERROR) {
+            throw RedisCommandException("GET", "Key: " + key + ", Error: " + std::string(reply->str, reply->len));
+        }
+        std::string stored_sha1; // Empty: the key is missing
+        json document = missing_document;
+        if (reply->type == REDIS_REPLY_STRING) {
+            std::string data(reply->str, reply->len);
+            stored_sha1 = sha1_hex(data);
+            document = decode_document(data, _legacy_config.document_encoding, "GET for key '" + key + "'");
+        }
+        std::string encoded = encode_document(modify(std::move(document)), _legacy_config.document_encoding);
+        if (_lua_script_manager->execute_script("json_replace_if_unchanged", {key}, {stored_sha1, encoded}) == 1) {
+            return;
+        }
+    }
+    throw OperationAbortedException("Key: " + key + " was changed by other writes during " +
+                                    std::to_string(max_attempts) + " attempts to modify it");
 }
 
 json RedisJSONClient::non_atomic_get_set(const std::string& key, const std::string& path_str,
                                          const json& new_value) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         json doc = _get_document_for_modification(key);
         json old_value_at_path = json(nullptr);
+        CompiledPath path = _path_parser->compile(path_str);
         try {
-            old_value_at_path = _json_modifier->get(doc, _path_parser->parse(path_str));
+            old_value_at_path = _json_modifier->get(doc, path);
         } catch (const PathNotFoundException&) {
             // Path doesn't exist, old_value_at_path remains null.
         }
         SetOptions opts;
-        _json_modifier->set(doc, _path_parser->parse(path_str), new_value, true , true );
+        _json_modifier->set(doc, path, new_value, true , true );
         _set_document_after_modification(key, doc, opts);
         return old_value_at_path;
     } else {
         throwIfNotLegacyWithLua("json_get_set");
-        json result = _lua_script_manager->execute_script("json_get_set", {key}, {path_str, new_value.dump()});
+        json result = _lua_script_manager->execute_script("json_get_set", {key}, _script_args(path_str, {new_value.dump()}));
         return result;
     }
 }
 
 bool RedisJSONClient::non_atomic_compare_set(const std::string& key, const std::string& path_str,
                                             const json& expected_val, const json& new_val) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (_is_swss_mode) {
         json doc;
         try {
@@ -790,21 +1663,22 @@ bool RedisJSONClient::non_atomic_compare_set(const std::string& key, const std::
         }
         json current_val_at_path = json(nullptr);
         bool path_existed = true;
+        CompiledPath path = _path_parser->compile(path_str);
         try {
-            current_val_at_path = _json_modifier->get(doc, _path_parser->parse(path_str));
+            current_val_at_path = _json_modifier->get(doc, path);
         } catch (const PathNotFoundException&) {
             path_existed = false;
         }
         if ((path_existed && current_val_at_path == expected_val) || (!path_existed && expected_val.is_null())) {
             SetOptions opts;
-            _json_modifier->set(doc, _path_parser->parse(path_str), new_val, true, true);
+            _json_modifier->set(doc, path, new_val, true, true);
             _set_document_after_modification(key, doc, opts);
             return true;
         }
         return false;
     } else {
         throwIfNotLegacyWithLua("json_compare_set");
-        json result_json = _lua_script_manager->execute_script("json_compare_set", {key}, {path_str, expected_val.dump(), new_val.dump()});
+        json result_json = _lua_script_manager->execute_script("json_compare_set", {key}, _script_args(path_str, {expected_val.dump(), new_val.dump()}));
         if (result_json.is_number_integer()) return result_json.get<int>() == 1;
         throw LuaScriptException("json_compare_set", "Non-integer result: " + result_json.dump());
     }
@@ -815,39 +1689,169 @@ std::vector<std::string> RedisJSONClient::keys_by_pattern(const std::string& pat
         if (!_db_connector) throw RedisJSONException("DBConnector not initialized for SWSS mode.");
         return _db_connector->keys(pattern);
     } else {
-        std::vector<std::string> found_keys;
-        std::string cursor = "0";
-        RedisConnectionManager::RedisConnectionPtr conn;
-        do {
-            conn = get_legacy_redis_connection();
-            RedisReplyPtr reply(static_cast<redisReply*>(
-                conn->command("SCAN %s MATCH %s COUNT 100", cursor.c_str(), pattern.c_str())
-            ));
-             _connection_manager->return_connection(std::move(conn)); // Return connection after command
-
-            if (!reply) {
-                throw RedisCommandException("SCAN", "Pattern: " + pattern + ", No reply");
-            }
-            if (reply->type == REDIS_REPLY_ERROR) {
-                 std::string err = reply->str ? reply->str : "Unknown SCAN error";
-                throw RedisCommandException("SCAN", "Pattern: " + pattern + ", Error: " + err);
-            }
-            if (reply->type != REDIS_REPLY_ARRAY || reply->elements != 2) {
-                throw RedisCommandException("SCAN", "Pattern: " + pattern + ", Unexpected reply structure");
-            }
-            redisReply* cursor_reply = reply->element[0];
-            cursor = std::string(cursor_reply->str, cursor_reply->len);
-            redisReply* keys_reply = reply->element[1];
-            for (size_t i = 0; i < keys_reply->elements; ++i) {
-                if (keys_reply->element[i]->type == REDIS_REPLY_STRING) {
-                    found_keys.emplace_back(keys_reply->element[i]->str, keys_reply->element[i]->len);
+        if (!_connection_manager) {
+            throw RedisJSONException("Legacy connection manager not available in SWSS mode or not initialized.");
+        }
+        auto scan_node = [this, &pattern](const std::string& node) {
+            KeyScanner scanner(*_connection_manager, pattern, ScanOptions(), "GET", {}, {node});
+            std::vector<std::string> node_keys;
+            std::vector<ScannedKey> batch;
+            while (scanner.next_batch(batch)) {
+                for (ScannedKey& entry : batch) {
+                    node_keys.push_back(std::move(entry.key));
                 }
             }
-        } while (cursor != "0");
+            return node_keys;
+        };
+
+        // In cluster mode each primary holds part of the keyspace: scan them in parallel.
+        std::vector<std::string> nodes = _connection_manager->node_addresses();
+        std::vector<std::future<std::vector<std::string>>> other_scans;
+        for (size_t i = 1; i < nodes.size(); ++i) {
+            other_scans.push_back(std::async(std::launch::async, scan_node, nodes[i]));
+        }
+        std::vector<std::string> found_keys = nodes.empty() ? std::vector<std::string>() : scan_node(nodes.front());
+        for (auto& scan : other_scans) {
+            std::vector<std::string> node_keys = scan.get();
+            found_keys.insert(found_keys.end(), node_keys.begin(), node_keys.end());
+        }
         return found_keys;
     }
 }
 
+KeyScanner RedisJSONClient::scan_keys(const std::string& pattern, const ScanOptions& options) const {
+    if (_is_swss_mode) {
+        throw NotImplementedException("scan_keys is not available in SWSS mode; use keys_by_pattern");
+    }
+    if (!_connection_manager) {
+        throw RedisJSONException("Legacy connection manager not initialized.");
+    }
+    if (_is_hash_layout()) {
+        return KeyScanner(*_connection_manager, pattern, options, "HGETALL",
+                          [this](const std::string& key, redisReply* reply) { return _decode_hash_document(key, reply); });
+    }
+    return KeyScanner(*_connection_manager, pattern, options, "GET",
+                      [this](const std::string& key, redisReply* reply) -> json {
+        if (reply->type == REDIS_REPLY_NIL) {
+            throw PathNotFoundException(key, "$ (root)");
+        }
+        if (reply->type != REDIS_REPLY_STRING) {
+            throw RedisCommandException("GET", "Key: " + key + ", Error: " +
+                                        (reply->type == REDIS_REPLY_ERROR ? std::string(reply->str, reply->len)
+                                                                          : "Unexpected reply type " + std::to_string(reply->type)));
+        }
+        return decode_document(std::string(reply->str, reply->len), _legacy_config.document_encoding,
+                               "GET for key '" + key + "'");
+    });
+}
+
+void RedisJSONClient::for_each_key(const std::string& pattern, const std::function<bool(const ScannedKey&)>& visitor,
+                                   const ScanOptions& options) const {
+    KeyScanner scanner = scan_keys(pattern, options);
+    std::vector<ScannedKey> batch;
+    while (scanner.next_batch(batch)) {
+        for (const ScannedKey& entry : batch) {
+            if (!visitor(entry)) return;
+        }
+    }
+}
+
+BulkLoadResult RedisJSONClient::bulk_load(std::istream& input, const BulkLoadOptions& options) {
+    if (_is_swss_mode) {
+        throw NotImplementedException("bulk_load is not available in SWSS mode");
+    }
+    if (!_connection_manager) {
+        throw RedisJSONException("Legacy connection manager not initialized.");
+    }
+    BulkLoader loader(
+        [this](const std::vector<std::vector<std::string>>& commands) { return _execute_pipeline(commands); },
+        [this, &options](const std::string& key, const json& document) {
+            return _set_document_command(key, document, options.set_options);
+        },
+        options);
+    BulkLoadResult result = loader.load(input);
+    if (_json_cache) {
+        _json_cache->clear_cache(); // Cheaper than invalidating every key that was loaded
+    }
+    return result;
+}
+
+BulkLoadResult RedisJSONClient::bulk_load_file(const std::string& path, const BulkLoadOptions& options) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw ArgumentInvalidException("Cannot open '" + path + "' for reading");
+    }
+    return bulk_load(input, options);
+}
+
+ExportResult RedisJSONClient::export_json(const std::string& pattern, std::ostream& output,
+                                          const ExportOptions& options) const {
+    if (_is_swss_mode) {
+        throw NotImplementedException("export_json is not available in SWSS mode");
+    }
+    if (!_connection_manager) {
+        throw RedisJSONException("Legacy connection manager not initialized.");
+    }
+    const auto start = std::chrono::steady_clock::now();
+    ScanOptions scan_options = options.scan;
+    scan_options.fetch_documents = true;
+    // In the string layout the stored value is passed through as a JSON string holding
+    // its raw bytes, so that ExportWriter can copy it without parsing it.
+    KeyScanner scanner = _is_hash_layout()
+        ? scan_keys(pattern, scan_options)
+        : KeyScanner(*_connection_manager, pattern, scan_options, "GET", [](const std::string& key, redisReply* reply) -> json {
+              if (reply->type == REDIS_REPLY_NIL) {
+                  throw PathNotFoundException(key, "$ (root)");
+              }
+              if (reply->type != REDIS_REPLY_STRING) {
+                  throw RedisCommandException("GET", "Key: " + key + ", Error: " +
+                                              (reply->type == REDIS_REPLY_ERROR ? std::string(reply->str, reply->len)
+                                                                                : "Unexpected reply type " + std::to_string(reply->type)));
+              }
+              return std::string(reply->str, reply->len);
+          });
+
+    ExportWriter writer(output, options.format, _legacy_config.document_encoding);
+    ExportResult result;
+    std::vector<ScannedKey> batch;
+    while (scanner.next_batch(batch)) {
+        for (const ScannedKey& entry : batch) {
+            try {
+                if (entry.error) {
+                    std::rethrow_exception(entry.error);
+                }
+                if (_is_hash_layout()) {
+                    writer.write_document(entry.key, entry.document);
+                } else {
+                    writer.write_stored(entry.key, entry.document.get_ref<const std::string&>());
+                }
+                ++result.documents;
+            } catch (const std::exception& e) {
+                ++result.errors;
+                if (result.error_messages.size() < options.max_error_messages) {
+                    result.error_messages.push_back(entry.key + ": " + e.what());
+                }
+            }
+        }
+        if (!output) {
+            throw RedisJSONException("Export of '" + pattern + "' failed: the output stream is in an error state");
+        }
+    }
+    output.flush();
+    result.bytes_written = writer.bytes_written();
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+ExportResult RedisJSONClient::export_json_file(const std::string& pattern, const std::string& path,
+                                               const ExportOptions& options) const {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw ArgumentInvalidException("Cannot open '" + path + "' for writing");
+    }
+    return export_json(pattern, output, options);
+}
+
 void find_values_recursive(const json& current_json_doc, const json& search_value, json::array_t& found_values) {
     if (current_json_doc == search_value) {
         found_values.push_back(current_json_doc);
@@ -863,6 +1867,125 @@ void find_values_recursive(const json& current_json_doc, const json& search_valu
     }
 }
 
+// --- Secondary Indexes ---
+
+void RedisJSONClient::create_index(const IndexDefinition& definition, bool backfill) {
+    throwIfNotLegacyWithLua("create_index");
+    std::optional<IndexDefinition> existing = _indexes.find(definition.name);
+    if (existing && IndexRegistry::to_json(*existing) != IndexRegistry::to_json(definition)) {
+        throw ArgumentInvalidException("Index '" + definition.name + "' already exists with another definition; drop it first");
+    }
+    if (_connection_manager->is_cluster() && IndexRegistry::index_key(definition) == IndexRegistry::KEY_PREFIX + definition.name) {
+        throw ArgumentInvalidException("In cluster mode the key pattern of index '" + definition.name +
+                                       "' must start with a hash tag, e.g. \"{tag}:" + definition.key_pattern + "\"");
+    }
+    _indexes.add(definition);
+    throw_if_error(_execute_command({"HSET", IndexRegistry::DEFINITIONS_KEY, definition.name,
+                                     IndexRegistry::to_json(definition).dump()}),
+                   "HSET", "Index: " + definition.name);
+    if (!backfill) {
+        return;
+    }
+
+    std::string sha = _lua_script_manager->get_script_sha("json_index_document");
+    std::vector<std::string> args = _is_hash_layout() ? std::vector<std::string>{""} : std::vector<std::string>{};
+    std::vector<std::string> keys = keys_by_pattern(definition.key_pattern);
+    const size_t batch_size = 1000;
+    for (size_t first = 0; first < keys.size(); first += batch_size) {
+        std::vector<std::vector<std::string>> commands;
+        for (size_t i = first; i < std::min(first + batch_size, keys.size()); ++i) {
+            if (_indexes.covers(keys[i])) {
+                commands.push_back(build_script_command(sha, keys[i], args, _indexes));
+            }
+        }
+        std::vector<RedisReplyPtr> replies = _execute_pipeline(commands);
+        for (size_t i = 0; i < replies.size(); ++i) {
+            throw_if_error(replies[i], "EVALSHA", "Index: " + definition.name + ", Key: " + commands[i][3]);
+        }
+    }
+}
+
+bool RedisJSONClient::drop_index(const std::string& name) {
+    throwIfNotLegacyWithLua("drop_index");
+    std::optional<IndexDefinition> definition = _indexes.find(name);
+    if (!definition) {
+        RedisReplyPtr reply = _execute_command({"HGET", IndexRegistry::DEFINITIONS_KEY, name});
+        throw_if_error(reply, "HGET", "Index: " + name);
+        if (reply->type != REDIS_REPLY_STRING) {
+            return false;
+        }
+        definition = IndexRegistry::from_json(_parse_json_reply(std::string(reply->str, reply->len), "Index definition '" + name + "'"));
+    }
+    _indexes.remove(name);
+    throw_if_error(_execute_command({"HDEL", IndexRegistry::DEFINITIONS_KEY, name}), "HDEL", "Index: " + name);
+
+    std::string index_key = IndexRegistry::index_key(*definition);
+    if (definition->type == IndexType::TAG) {
+        RedisReplyPtr values = _execute_command({"HVALS", index_key});
+        throw_if_error(values, "HVALS", "Index: " + name);
+        std::set<std::string> tags;
+        for (std::string& tag : reply_strings(values)) {
+            tags.insert(std::move(tag));
+        }
+        std::vector<std::vector<std::string>> commands;
+        for (const std::string& tag : tags) {
+            commands.push_back({"DEL", IndexRegistry::tag_key(*definition, tag)});
+        }
+        for (const RedisReplyPtr& reply : _execute_pipeline(commands)) {
+            throw_if_error(reply, "DEL", "Index: " + name);
+        }
+    }
+    throw_if_error(_execute_command({"DEL", index_key}), "DEL", "Index: " + name);
+    return true;
+}
+
+size_t RedisJSONClient::load_indexes() {
+    throwIfNotLegacyWithLua("load_indexes");
+    RedisReplyPtr reply = _execute_read_command({"HVALS", IndexRegistry::DEFINITIONS_KEY});
+    throw_if_error(reply, "HVALS", "Key: " + std::string(IndexRegistry::DEFINITIONS_KEY));
+    std::vector<std::string> definitions = reply_strings(reply);
+    for (const std::string& definition : definitions) {
+        _indexes.add(IndexRegistry::from_json(_parse_json_reply(definition, "Index definition")));
+    }
+    return definitions.size();
+}
+
+std::vector<std::string> RedisJSONClient::index_lookup(const std::string& name, const json& value) const {
+    std::optional<IndexDefinition> definition = _indexes.find(name);
+    if (!definition) {
+        throw ArgumentInvalidException("Unknown index '" + name + "'");
+    }
+    if (definition->type == IndexType::NUMERIC) {
+        if (!value.is_number()) {
+            return {};
+        }
+        return index_range(name, value.get<double>(), value.get<double>());
+    }
+    std::optional<std::string> tag = IndexRegistry::tag_value(value);
+    if (!tag) {
+        return {};
+    }
+    RedisReplyPtr reply = _execute_read_command({"SMEMBERS", IndexRegistry::tag_key(*definition, *tag)});
+    throw_if_error(reply, "SMEMBERS", "Index: " + name);
+    std::vector<std::string> keys = reply_strings(reply);
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+std::vector<std::string> RedisJSONClient::index_range(const std::string& name, std::optional<double> min,
+                                                      std::optional<double> max, bool min_exclusive,
+                                                      bool max_exclusive) const {
+    std::optional<IndexDefinition> definition = _indexes.find(name);
+    if (!definition || definition->type != IndexType::NUMERIC) {
+        throw ArgumentInvalidException("'" + name + "' is not a numeric index");
+    }
+    RedisReplyPtr reply = _execute_read_command({"ZRANGEBYSCORE", IndexRegistry::index_key(*definition),
+                                                 score_bound(min, min_exclusive, "-inf"),
+                                                 score_bound(max, max_exclusive, "+inf")});
+    throw_if_error(reply, "ZRANGEBYSCORE", "Index: " + name);
+    return reply_strings(reply);
+}
+
 json RedisJSONClient::search_by_value(const std::string& key, const json& search_value) const {
     json document_to_search;
     try {
@@ -917,12 +2040,13 @@ json RedisJSONClient::_parse_json_reply(const std::string& reply_str, const std:
 }
 
 long long RedisJSONClient::json_clear(const std::string& key, const std::string& path) {
+    CacheInvalidationGuard invalidate_cached(_json_cache.get(), key);
     if (key.empty()) {
         throw ArgumentInvalidException("Key cannot be empty for JSON.CLEAR operation.");
     }
     throwIfNotLegacyWithLua("json_clear");
     try {
-        json result_json = _lua_script_manager->execute_script("json_clear", {key}, {path});
+        json result_json = _lua_script_manager->execute_script("json_clear", {key}, _script_args(path));
         if (result_json.is_number_integer()) {
             return result_json.get<long long>();
         } else if (result_json.is_null()) {
@@ -0,0 +1,95 @@
+#include "redisjson++/sha1.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace redisjson {
+
+namespace {
+
+inline uint32_t rotl(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+void process_block(uint32_t state[5], const unsigned char block[64]) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) |
+               (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<uint32_t>(block[i * 4 + 2]) << 8) |
+               static_cast<uint32_t>(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 80; ++i) {
+        w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    for (int i = 0; i < 80; ++i) {
+        uint32_t f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rotl(b, 30);
+        b = a;
+        a = temp;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+} // namespace
+
+std::string sha1_hex(const std::string& data) {
+    uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    size_t length = data.size();
+
+    size_t offset = 0;
+    for (; offset + 64 <= length; offset += 64) {
+        process_block(state, bytes + offset);
+    }
+
+    // Final block(s): remaining bytes, 0x80 terminator, zero padding, 64-bit big-endian bit length.
+    unsigned char tail[128] = {0};
+    size_t remaining = length - offset;
+    std::memcpy(tail, bytes + offset, remaining);
+    tail[remaining] = 0x80;
+    size_t tail_size = (remaining < 56) ? 64 : 128;
+    uint64_t bit_length = static_cast<uint64_t>(length) * 8;
+    for (int i = 0; i < 8; ++i) {
+        tail[tail_size - 1 - i] = static_cast<unsigned char>(bit_length >> (8 * i));
+    }
+    process_block(state, tail);
+    if (tail_size == 128) {
+        process_block(state, tail + 64);
+    }
+
+    static const char hex_digits[] = "0123456789abcdef";
+    std::string result(40, '0');
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            unsigned char byte = static_cast<unsigned char>(state[i] >> (24 - 8 * j));
+            result[i * 8 + j * 2] = hex_digits[byte >> 4];
+            result[i * 8 + j * 2 + 1] = hex_digits[byte & 0x0F];
+        }
+    }
+    return result;
+}
+
+} // namespace redisjson
@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+#include "redisjson++/async_redis_json_client.h"
+#include "redisjson++/redis_connection_manager.h" // For RedisConnection (availability probe)
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <future>
+#include <functional>
+#include <thread>
+#include <tuple>
+#include <string>
+#include <vector>
+
+using namespace redisjson;
+using json = nlohmann::json;
+
+class AsyncRedisJSONClientTest : public ::testing::Test {
+protected:
+    LegacyClientConfig config_;
+    bool live_redis_available_ = false;
+
+    void SetUp() override {
+        RedisConnection probe(config_.host, config_.port, config_.password, config_.database,
+                              std::chrono::milliseconds(1000));
+        live_redis_available_ = probe.connect() && probe.ping();
+    }
+};
+
+TEST_F(AsyncRedisJSONClientTest, UnreachableServerFailsRequests) {
+    config_.port = 1; // Nothing listens here
+    AsyncRedisJSONClient client(config_);
+    std::future<json> result = client.get_json("async_test:unreachable");
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_THROW(result.get(), ConnectionException);
+}
+
+TEST_F(AsyncRedisJSONClientTest, ArgumentErrorsFailOnTheEventLoop) {
+    config_.port = 1; // Nothing listens here; these fail before anything is sent
+    AsyncRedisJSONClient client(config_);
+    auto failing_thread = [](std::function<void(AsyncRedisJSONClient::Callback)> submit) {
+        auto result = std::make_shared<std::promise<std::pair<std::thread::id, std::exception_ptr>>>();
+        auto future = result->get_future();
+        submit([result](json, std::exception_ptr error) {
+            result->set_value({std::this_thread::get_id(), error});
+        });
+        EXPECT_EQ(future.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+        return future.get();
+    };
+
+    auto [thread, error] = failing_thread([&](AsyncRedisJSONClient::Callback callback) {
+        client.execute_script("no_such_script", {"async_test:key"}, {}, std::move(callback));
+    });
+    EXPECT_NE(thread, std::this_thread::get_id());
+    EXPECT_THROW(std::rethrow_exception(error), LuaScriptException);
+
+    config_.document_layout = DocumentLayout::HASH; // Paths are split into member and sub-path up front
+    AsyncRedisJSONClient hash_client(config_);
+    std::tie(thread, error) = failing_thread([&](AsyncRedisJSONClient::Callback callback) {
+        hash_client.set_path("async_test:key", "[0]", json(1), {}, std::move(callback));
+    });
+    EXPECT_NE(thread, std::this_thread::get_id());
+    EXPECT_THROW(std::rethrow_exception(error), InvalidPathException);
+}
+
+TEST_F(AsyncRedisJSONClientTest, DocumentAndPathRoundTrip) {
+    if (!live_redis_available_) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    AsyncRedisJSONClient client(config_);
+    const std::string key = "async_test:doc";
+    json doc = {{"name", "eth0"}, {"mtu", 1500}, {"addresses", {"10.0.0.1"}}};
+
+    client.set_json(key, doc).get();
+    EXPECT_EQ(client.get_json(key).get(), doc);
+    EXPECT_EQ(client.get_path(key, "name").get(), json::array({"eth0"})); // Legacy path reads wrap the match
+
+    client.set_path(key, "mtu", 9100).get();
+    EXPECT_EQ(client.get_path(key, "mtu").get(), json::array({9100}));
+    EXPECT_THROW(client.get_path(key, "missing").get(), PathNotFoundException);
+
+    json length = client.execute_script("json_array_length", {key}, {"addresses"}).get();
+    EXPECT_EQ(length, 1);
+
+    client.del_json(key).get();
+    EXPECT_THROW(client.get_json(key).get(), PathNotFoundException);
+}
+
+TEST_F(AsyncRedisJSONClientTest, MessagePackEncodingRoundTrip) {
+    if (!live_redis_available_) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    config_.document_encoding = DocumentEncoding::MESSAGEPACK;
+    AsyncRedisJSONClient client(config_);
+    const std::string key = "async_test:msgpack";
+    json doc = {{"name", "eth0"}, {"mtu", 1500}, {"vlans", {10, 20}}};
+
+    client.set_json(key, doc).get();
+    std::promise<json> raw;
+    client.command({"GET", key}, [&raw](json result, std::exception_ptr) { raw.set_value(result); });
+    json stored = raw.get_future().get();
+    ASSERT_TRUE(stored.is_string());
+    EXPECT_EQ(json::from_msgpack(stored.get<std::string>()), doc);
+
+    // The Lua scripts decode and re-encode the document with cmsgpack.
+    client.set_path(key, "mtu", 9100).get();
+    client.append_path(key, "vlans", 30).get();
+    EXPECT_EQ(client.get_path(key, "mtu").get(), json::array({9100}));
+    EXPECT_EQ(client.array_length(key, "vlans").get(), 3u);
+    EXPECT_EQ(client.get_json(key).get(), (json{{"name", "eth0"}, {"mtu", 9100}, {"vlans", {10, 20, 30}}}));
+
+    client.del_json(key).get();
+}
+
+TEST_F(AsyncRedisJSONClientTest, HashLayoutStoresMembersAsFields) {
+    if (!live_redis_available_) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    config_.document_layout = DocumentLayout::HASH;
+    AsyncRedisJSONClient client(config_);
+    const std::string key = "async_test:hash";
+    json doc = {{"name", "eth0"}, {"mtu", 1500}, {"vlans", {10, 20}}, {"admin", {{"status", "up"}}}};
+
+    client.set_json(key, doc).get();
+    std::promise<json> raw;
+    client.command({"HGET", key, "name"}, [&raw](json result, std::exception_ptr) { raw.set_value(result); });
+    EXPECT_EQ(raw.get_future().get(), "eth0"); // The field holds the JSON-encoded member
+    EXPECT_EQ(client.get_json(key).get(), doc);
+
+    // Top-level reads are a plain HGET; deeper paths run the scripts on one field.
+    EXPECT_EQ(client.get_path(key, "name").get(), json::array({"eth0"}));
+    EXPECT_EQ(client.get_path(key, "admin.status").get(), json::array({"up"}));
+    client.set_path(key, "admin.status", "down").get();
+    client.set_path(key, "mtu", 9100).get();
+    client.append_path(key, "vlans", 30).get();
+    EXPECT_EQ(client.array_length(key, "vlans").get(), 3u);
+    EXPECT_EQ(client.get_json(key).get(),
+              (json{{"name", "eth0"}, {"mtu", 9100}, {"vlans", {10, 20, 30}}, {"admin", {{"status", "down"}}}}));
+
+    EXPECT_THROW(client.get_path(key, "missing").get(), PathNotFoundException);
+    EXPECT_THROW(client.append_path(key, "[0]", 1).get(), InvalidPathException);
+    EXPECT_THROW(client.set_json(key, json::array({1})).get(), ArgumentInvalidException);
+
+    client.del_json(key).get();
+    EXPECT_THROW(client.get_json(key).get(), PathNotFoundException);
+}
+
+TEST_F(AsyncRedisJSONClientTest, ManyOutstandingRequestsOnOneConnection) {
+    if (!live_redis_available_) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    AsyncRedisJSONClient client(config_);
+    const int count = 2000;
+    std::vector<std::future<void>> writes;
+    for (int i = 0; i < count; ++i) {
+        writes.push_back(client.set_json("async_test:many:" + std::to_string(i), json{{"i", i}}));
+    }
+    for (auto& write : writes) write.get();
+
+    std::vector<std::future<json>> reads;
+    for (int i = 0; i < count; ++i) {
+        reads.push_back(client.get_path("async_test:many:" + std::to_string(i), "i"));
+    }
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(reads[i].get(), json::array({i}));
+    }
+    for (int i = 0; i < count; ++i) {
+        client.del_json("async_test:many:" + std::to_string(i));
+    }
+    EXPECT_EQ(client.get_json("async_test:many:0").wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+#include "redisjson++/bulk_loader.h"
+#include "redisjson++/exceptions.h"
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace redisjson;
+
+namespace {
+
+std::vector<std::string> read_all(const std::string& text, BulkFormat format = BulkFormat::AUTO) {
+    std::istringstream input(text);
+    BulkRecordReader reader(input, format);
+    std::vector<std::string> records;
+    std::string record;
+    while (reader.next(record)) records.push_back(record);
+    return records;
+}
+
+} // namespace
+
+TEST(BulkRecordReaderTest, SplitsNDJSONLines) {
+    std::istringstream input("{\"id\":1}\n\n  \n{\"id\":2,\"s\":\"a\\nb\"}\r\n{\"id\":3}");
+    BulkRecordReader reader(input);
+    std::vector<std::string> records;
+    std::string record;
+    while (reader.next(record)) records.push_back(record);
+    EXPECT_EQ(reader.format(), BulkFormat::NDJSON);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(json::parse(records[1])["s"], "a\nb");
+    EXPECT_EQ(json::parse(records[2])["id"], 3);
+}
+
+TEST(BulkRecordReaderTest, StreamsJSONArrayElements) {
+    std::vector<std::string> records = read_all(
+        " [ {\"id\":\"a\",\"v\":[1,{\"x\":\"]}\"}]} ,\n{\"id\":\"b\",\"q\":\"\\\"{\"}, 42, \"s,t\", true, [] ] ");
+    ASSERT_EQ(records.size(), 6u);
+    EXPECT_EQ(json::parse(records[0])["v"][1]["x"], "]}");
+    EXPECT_EQ(json::parse(records[1])["q"], "\"{");
+    EXPECT_EQ(records[2], "42");
+    EXPECT_EQ(records[3], "\"s,t\"");
+    EXPECT_EQ(records[4], "true");
+    EXPECT_EQ(records[5], "[]");
+    EXPECT_TRUE(read_all("[]").empty());
+}
+
+TEST(BulkRecordReaderTest, RejectsMalformedArrays) {
+    EXPECT_THROW(read_all("[{\"id\":1}", BulkFormat::JSON_ARRAY), JsonParsingException);
+    EXPECT_THROW(read_all("[{\"id\":1} {\"id\":2}]"), JsonParsingException);
+    EXPECT_THROW(read_all("[{\"id\":\"1}]"), JsonParsingException);
+    EXPECT_THROW(read_all("{\"id\":1}", BulkFormat::JSON_ARRAY), JsonParsingException);
+}
+
+TEST(BulkLoaderTest, ParsesKeysAndDocuments) {
+    BulkLoadOptions options;
+    options.key_prefix = "device:";
+    auto [key, document] = BulkLoader::parse_record(R"({"id":7,"name":"r1"})", options);
+    EXPECT_EQ(key, "device:7");
+    EXPECT_EQ(document, json::parse(R"({"id":7,"name":"r1"})"));
+
+    options.key_field = "key";
+    options.key_prefix = "";
+    options.value_field = "value";
+    auto [envelope_key, value] = BulkLoader::parse_record(R"({"key":"a:b","value":[1,2]})", options);
+    EXPECT_EQ(envelope_key, "a:b");
+    EXPECT_EQ(value, json::array({1, 2}));
+
+    EXPECT_THROW(BulkLoader::parse_record(R"({"value":1})", options), ArgumentInvalidException);
+    EXPECT_THROW(BulkLoader::parse_record(R"({"key":"a"})", options), ArgumentInvalidException);
+    EXPECT_THROW(BulkLoader::parse_record(R"({"key":1.5,"value":1})", options), ArgumentInvalidException);
+    EXPECT_THROW(BulkLoader::parse_record(R"([1])", options), ArgumentInvalidException);
+    EXPECT_THROW(BulkLoader::parse_record(R"({"key":)", options), JsonParsingException);
+}
+
+TEST(BulkLoaderTest, BatchesRecordsAcrossWorkers) {
+    std::ostringstream text;
+    for (int i = 0; i < 1000; ++i) {
+        text << (i == 500 ? std::string("not json") : json{{"id", i}, {"n", i}}.dump()) << "\n";
+    }
+    std::istringstream input(text.str());
+
+    std::mutex mutex;
+    std::set<std::string> keys;
+    size_t largest_batch = 0;
+    BulkLoadOptions options;
+    options.threads = 3;
+    options.batch_size = 64;
+    options.max_queued_batches = 2;
+    size_t progress_calls = 0;
+    options.progress = [&](const BulkLoadProgress&) { ++progress_calls; };
+    BulkLoader loader(
+        [&](const std::vector<std::vector<std::string>>& commands) {
+            std::lock_guard<std::mutex> lock(mutex);
+            largest_batch = std::max(largest_batch, commands.size());
+            for (const auto& command : commands) keys.insert(command[1]);
+            return std::vector<RedisReplyPtr>(commands.size()); // No replies: counted as errors
+        },
+        [](const std::string& key, const json& document) {
+            return std::vector<std::string>{"SET", key, document.dump()};
+        },
+        options);
+    BulkLoadResult result = loader.load(input);
+
+    EXPECT_EQ(result.records_read, 1000u);
+    EXPECT_EQ(keys.size(), 999u);
+    EXPECT_LE(largest_batch, 64u);
+    EXPECT_EQ(result.documents_written, 0u);
+    EXPECT_EQ(result.errors, 1000u);
+    EXPECT_EQ(result.error_messages.size(), options.max_error_messages);
+    EXPECT_GE(progress_calls, 1u);
+}
+
+TEST(BulkLoaderTest, StopsWhenBatchCannotBeSent) {
+    std::ostringstream text;
+    for (int i = 0; i < 5000; ++i) text << json{{"id", i}}.dump() << "\n";
+    std::istringstream input(text.str());
+    BulkLoadOptions options;
+    options.batch_size = 10;
+    BulkLoader loader(
+        [](const std::vector<std::vector<std::string>>&) -> std::vector<RedisReplyPtr> {
+            throw ConnectionException("connection lost");
+        },
+        [](const std::string& key, const json&) { return std::vector<std::string>{"SET", key, "{}"}; },
+        options);
+    EXPECT_THROW(loader.load(input), ConnectionException);
+}
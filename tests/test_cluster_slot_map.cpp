@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "redisjson++/cluster_slot_map.h"
+#include "redisjson++/redis_connection_manager.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace redisjson;
+
+namespace {
+
+// Builds redisReply trees by hand, as hiredis would parse them.
+class FakeReplies {
+public:
+    redisReply* integer(long long value) {
+        redisReply* reply = make(REDIS_REPLY_INTEGER);
+        reply->integer = value;
+        return reply;
+    }
+    redisReply* string(const std::string& value, int type = REDIS_REPLY_STRING) {
+        strings_.push_back(value);
+        redisReply* reply = make(type);
+        reply->str = &strings_.back()[0];
+        reply->len = strings_.back().size();
+        return reply;
+    }
+    redisReply* array(std::vector<redisReply*> elements) {
+        arrays_.push_back(std::move(elements));
+        redisReply* reply = make(REDIS_REPLY_ARRAY);
+        reply->elements = arrays_.back().size();
+        reply->element = arrays_.back().data();
+        return reply;
+    }
+    // One CLUSTER SLOTS range served by host:port (no replicas).
+    redisReply* range(long long first, long long last, const std::string& host, long long port) {
+        return array({integer(first), integer(last), array({string(host), integer(port), string("node-id")})});
+    }
+
+private:
+    std::deque<redisReply> replies_;
+    std::deque<std::string> strings_;
+    std::deque<std::vector<redisReply*>> arrays_;
+
+    redisReply* make(int type) {
+        replies_.emplace_back();
+        replies_.back() = redisReply{};
+        replies_.back().type = type;
+        return &replies_.back();
+    }
+};
+
+} // namespace
+
+TEST(ClusterSlotMapTest, HashSlotsMatchRedis) {
+    EXPECT_EQ(crc16("123456789", 9), 0x31C3);
+    EXPECT_EQ(key_hash_slot("foo"), 12182);
+    EXPECT_EQ(key_hash_slot("bar"), 5061);
+    EXPECT_EQ(key_hash_slot(""), 0);
+}
+
+TEST(ClusterSlotMapTest, HashTagsSelectTheHashedPart) {
+    EXPECT_EQ(key_hash_slot("{user1000}.following"), key_hash_slot("{user1000}.followers"));
+    EXPECT_EQ(key_hash_slot("{user1000}.following"), key_hash_slot("user1000"));
+    EXPECT_NE(key_hash_slot("foo{}{bar}"), key_hash_slot("bar")); // Empty tag: the whole key is hashed
+    EXPECT_EQ(key_hash_slot("foo{{bar}}zap"), key_hash_slot("{bar"));
+}
+
+TEST(ClusterSlotMapTest, ParsesRedirections) {
+    FakeReplies replies;
+    auto moved = parse_cluster_redirect(replies.string("MOVED 3999 127.0.0.1:6381", REDIS_REPLY_ERROR));
+    ASSERT_TRUE(moved.has_value());
+    EXPECT_FALSE(moved->ask);
+    EXPECT_EQ(moved->slot, 3999);
+    EXPECT_EQ(moved->address, "127.0.0.1:6381");
+
+    auto ask = parse_cluster_redirect(replies.string("ASK 12 10.0.0.2:7000", REDIS_REPLY_ERROR));
+    ASSERT_TRUE(ask.has_value());
+    EXPECT_TRUE(ask->ask);
+    EXPECT_EQ(ask->slot, 12);
+
+    EXPECT_FALSE(parse_cluster_redirect(replies.string("ERR wrong type", REDIS_REPLY_ERROR)).has_value());
+    EXPECT_FALSE(parse_cluster_redirect(replies.string("MOVED 3999 127.0.0.1:6381")).has_value()); // Not an error
+    EXPECT_FALSE(parse_cluster_redirect(nullptr).has_value());
+}
+
+TEST(ClusterSlotMapTest, SplitsNodeAddresses) {
+    EXPECT_EQ(split_node_address("127.0.0.1:7000"), std::make_pair(std::string("127.0.0.1"), 7000));
+    EXPECT_EQ(split_node_address("[::1]:7001"), std::make_pair(std::string("::1"), 7001));
+    EXPECT_THROW(split_node_address("localhost"), std::invalid_argument);
+}
+
+TEST(ClusterSlotMapTest, BuildsMapFromClusterSlots) {
+    FakeReplies replies;
+    redisReply* slots = replies.array({replies.range(0, 5460, "10.0.0.1", 7000), replies.range(5461, 10922, "", 7001),
+                                       replies.range(10923, 16383, "10.0.0.3", 7002)});
+    ClusterSlotMap map;
+    EXPECT_TRUE(map.empty());
+    ASSERT_TRUE(map.update_from_cluster_slots(slots, "seed-host"));
+    EXPECT_EQ(map.node_for_slot(0), "10.0.0.1:7000");
+    EXPECT_EQ(map.node_for_slot(5461), "seed-host:7001"); // Empty host: the node that answered
+    EXPECT_EQ(map.node_for_slot(16383), "10.0.0.3:7002");
+    EXPECT_EQ(map.nodes(), (std::vector<std::string>{"10.0.0.1:7000", "seed-host:7001", "10.0.0.3:7002"}));
+
+    map.set_slot_owner(0, "10.0.0.4:7003");
+    EXPECT_EQ(map.node_for_slot(0), "10.0.0.4:7003");
+    EXPECT_EQ(map.node_for_slot(1), "10.0.0.1:7000");
+    EXPECT_EQ(map.nodes().size(), 4u);
+
+    EXPECT_FALSE(map.update_from_cluster_slots(replies.string("ERR This instance has cluster support disabled", REDIS_REPLY_ERROR), "h"));
+    EXPECT_EQ(map.node_for_slot(1), "10.0.0.1:7000"); // Unchanged
+}
+
+TEST(ClusterSlotMapTest, CommandsAreRoutedByTheirKey) {
+    EXPECT_EQ(RedisConnectionManager::command_key({"GET", "doc:1"}), "doc:1");
+    EXPECT_EQ(RedisConnectionManager::command_key({"EVALSHA", "abc", "1", "doc:2", "$.a"}), "doc:2");
+    EXPECT_EQ(RedisConnectionManager::command_key({"EVALSHA", "abc", "0", "arg"}), "");
+    EXPECT_EQ(RedisConnectionManager::command_key({"PING"}), "");
+}
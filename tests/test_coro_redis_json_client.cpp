@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "redisjson++/coro_redis_json_client.h"
+
+// Only built when the tests are compiled as C++20 (REDISJSON_CXX20_TESTS=ON).
+#ifdef REDISJSON_HAS_COROUTINES
+
+#include "redisjson++/redis_connection_manager.h" // For RedisConnection (availability probe)
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace redisjson;
+using json = nlohmann::json;
+
+namespace {
+
+Task<int> add_one(int value) {
+    co_return value + 1;
+}
+
+Task<int> chain(int depth) {
+    int total = 0;
+    for (int i = 0; i < depth; ++i) {
+        total = co_await add_one(total);
+    }
+    co_return total;
+}
+
+Task<void> throws_after_await() {
+    co_await add_one(0);
+    throw ArgumentInvalidException("boom");
+}
+
+} // namespace
+
+TEST(CoroTaskTest, TasksComposeAndPropagateExceptions) {
+    EXPECT_EQ(sync_wait(add_one(41)), 42);
+    EXPECT_EQ(sync_wait(chain(1000)), 1000);
+    EXPECT_THROW(sync_wait(throws_after_await()), ArgumentInvalidException);
+}
+
+TEST(CoroTaskTest, WhenAllReturnsResultsInOrder) {
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 10; ++i) {
+        tasks.push_back(add_one(i));
+    }
+    std::vector<int> results = sync_wait(when_all(std::move(tasks)));
+    ASSERT_EQ(results.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(results[i], i + 1);
+    }
+    EXPECT_TRUE(sync_wait(when_all(std::vector<Task<int>>{})).empty());
+}
+
+class CoroRedisJSONClientTest : public ::testing::Test {
+protected:
+    LegacyClientConfig config_;
+    bool live_redis_available_ = false;
+
+    void SetUp() override {
+        RedisConnection probe(config_.host, config_.port, config_.password, config_.database,
+                              std::chrono::milliseconds(1000));
+        live_redis_available_ = probe.connect() && probe.ping();
+    }
+};
+
+TEST_F(CoroRedisJSONClientTest, UnreachableServerRethrowsOnResume) {
+    config_.port = 1; // Nothing listens here
+    AsyncRedisJSONClient async_client(config_);
+    CoroRedisJSONClient client(async_client);
+    auto task = [&]() -> Task<json> { co_return co_await client.get_json_async("coro_test:unreachable"); };
+    EXPECT_THROW(sync_wait(task()), ConnectionException);
+}
+
+TEST_F(CoroRedisJSONClientTest, DocumentPathAndArrayOperations) {
+    if (!live_redis_available_) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    AsyncRedisJSONClient async_client(config_);
+    CoroRedisJSONClient client(async_client);
+    const std::string key = "coro_test:doc";
+
+    const json initial = {{"name", "eth0"}, {"vlans", {10}}};
+    const json expected = {{"name", "eth1"}, {"vlans", {10}}};
+
+    auto scenario = [&]() -> Task<void> {
+        co_await client.set_json_async(key, initial);
+        json name = co_await client.get_path_async(key, "name");
+        EXPECT_EQ(name, json::array({"eth0"})); // Legacy path reads wrap the match
+
+        co_await client.set_path_async(key, "name", "eth1");
+        co_await client.append_path_async(key, "vlans", 20);
+        size_t length = co_await client.array_length_async(key, "vlans");
+        EXPECT_EQ(length, 2u);
+        json popped = co_await client.pop_path_async(key, "vlans");
+        EXPECT_EQ(popped, 20);
+
+        json doc = co_await client.get_json_async(key);
+        EXPECT_EQ(doc, expected);
+
+        bool threw = false;
+        try {
+            co_await client.get_path_async(key, "missing");
+        } catch (const PathNotFoundException&) {
+            threw = true;
+        }
+        EXPECT_TRUE(threw);
+
+        co_await client.del_json_async(key);
+    };
+    sync_wait(scenario());
+}
+
+TEST_F(CoroRedisJSONClientTest, WhenAllKeepsRequestsInFlightFromOneThread) {
+    if (!live_redis_available_) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    AsyncRedisJSONClient async_client(config_);
+    CoroRedisJSONClient client(async_client);
+    const int count = 20;
+
+    auto write_and_read = [&](int i) -> Task<int> {
+        const std::string key = "coro_test:fanout:" + std::to_string(i);
+        json document;
+        document["i"] = i;
+        co_await client.set_json_async(key, document);
+        json value = co_await client.get_path_async(key, "i");
+        co_await client.del_json_async(key);
+        co_return value.at(0).get<int>();
+    };
+
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < count; ++i) {
+        tasks.push_back(write_and_read(i));
+    }
+    std::vector<int> results = sync_wait(when_all(std::move(tasks)));
+    ASSERT_EQ(results.size(), static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        EXPECT_EQ(results[i], i);
+    }
+}
+
+#endif // REDISJSON_HAS_COROUTINES
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include "redisjson++/document_codec.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace redisjson;
+using json = nlohmann::json;
+
+namespace {
+const json kDocument = {
+    {"name", "Ethernet0"},
+    {"mtu", 9100},
+    {"speed", 1.5e11},
+    {"lanes", {0, 1, 2, 3}},
+    {"admin_up", true},
+    {"description", nullptr},
+    {"nested", {{"empty_object", json::object()}, {"empty_array", json::array()}}}
+};
+} // namespace
+
+TEST(DocumentCodecTest, JsonRoundTripIsPlainText) {
+    std::string encoded = encode_document(kDocument, DocumentEncoding::JSON);
+    EXPECT_EQ(encoded, kDocument.dump());
+    EXPECT_EQ(decode_document(encoded, DocumentEncoding::JSON, "test"), kDocument);
+}
+
+TEST(DocumentCodecTest, MessagePackRoundTrip) {
+    std::string encoded = encode_document(kDocument, DocumentEncoding::MESSAGEPACK);
+    EXPECT_LT(encoded.size(), kDocument.dump().size());
+    EXPECT_EQ(static_cast<unsigned char>(encoded[0]) & 0xF0, 0x80); // fixmap header
+    EXPECT_EQ(decode_document(encoded, DocumentEncoding::MESSAGEPACK, "test"), kDocument);
+}
+
+TEST(DocumentCodecTest, MessagePackKeepsEmbeddedNulBytes) {
+    json doc = {{"blob", std::string("a\0b", 3)}};
+    std::string encoded = encode_document(doc, DocumentEncoding::MESSAGEPACK);
+    EXPECT_EQ(decode_document(encoded, DocumentEncoding::MESSAGEPACK, "test"), doc);
+}
+
+TEST(DocumentCodecTest, InvalidDataThrowsJsonParsingException) {
+    EXPECT_THROW(decode_document("{not json", DocumentEncoding::JSON, "GET for key 'k'"), JsonParsingException);
+    EXPECT_THROW(decode_document(std::string("\xde\x00", 2), DocumentEncoding::MESSAGEPACK, "GET for key 'k'"),
+                 JsonParsingException);
+    // A JSON-encoded value read as MessagePack must not silently decode to a document.
+    EXPECT_THROW(decode_document(kDocument.dump(), DocumentEncoding::MESSAGEPACK, "GET for key 'k'"),
+                 JsonParsingException);
+}
+
+TEST(DocumentCodecTest, DocumentFieldsEncodeEachMember) {
+    std::vector<std::string> fields = encode_document_fields(kDocument, DocumentEncoding::JSON);
+    ASSERT_EQ(fields.size(), 2 * kDocument.size());
+    for (size_t i = 0; i < fields.size(); i += 2) {
+        EXPECT_EQ(decode_document(fields[i + 1], DocumentEncoding::JSON, "test"), kDocument.at(fields[i]));
+    }
+    EXPECT_THROW(encode_document_fields(json::array({1, 2}), DocumentEncoding::JSON), ArgumentInvalidException);
+}
+
+TEST(DocumentCodecTest, ScriptsPreserveOnlyRepresentableDocuments) {
+    json telemetry = {{"name", "Ethernet0"}, {"counters", {{"rx", 123456789}, {"load", 0.25}}},
+                      {"lanes", {0, 1}}, {"description", nullptr}};
+    EXPECT_TRUE(scripts_preserve_document(telemetry, DocumentEncoding::JSON));
+    EXPECT_TRUE(scripts_preserve_document(telemetry, DocumentEncoding::MESSAGEPACK));
+
+    EXPECT_FALSE(scripts_preserve_document(kDocument, DocumentEncoding::JSON)); // Empty containers
+    EXPECT_FALSE(scripts_preserve_document({{"id", 123456789012345678}}, DocumentEncoding::JSON));
+    EXPECT_TRUE(scripts_preserve_document({{"id", 123456789012345}}, DocumentEncoding::MESSAGEPACK));
+    EXPECT_FALSE(scripts_preserve_document({{"id", 1152921504606846977}}, DocumentEncoding::MESSAGEPACK));
+    EXPECT_FALSE(scripts_preserve_document({{"pi", 3.141592653589793}}, DocumentEncoding::JSON));
+    EXPECT_TRUE(scripts_preserve_document({{"pi", 3.141592653589793}}, DocumentEncoding::MESSAGEPACK));
+    EXPECT_TRUE(scripts_preserve_document("scalar", DocumentEncoding::JSON));
+}
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include "redisjson++/json_aggregation.h"
+#include "redisjson++/exceptions.h"
+#include <string>
+
+using namespace redisjson;
+
+namespace {
+
+json aggregate(const std::string& operation, const json& values) {
+    Aggregation aggregation(operation);
+    for (const auto& value : values) {
+        aggregation.add(value);
+    }
+    return aggregation.result();
+}
+
+} // namespace
+
+TEST(AggregationTest, ParsesOperations) {
+    EXPECT_EQ(Aggregation("sum").operation(), Aggregation::Operation::SUM);
+    EXPECT_EQ(Aggregation("distinct_count").operation(), Aggregation::Operation::DISTINCT_COUNT);
+    EXPECT_DOUBLE_EQ(Aggregation("percentile").percentile_rank(), 50);
+    EXPECT_DOUBLE_EQ(Aggregation("percentile:99.5").percentile_rank(), 99.5);
+    EXPECT_EQ(Aggregation("percentile:95").script_arguments(true),
+              (std::vector<std::string>{"percentile", "95", "partial"}));
+    EXPECT_EQ(Aggregation("count").script_arguments(false), (std::vector<std::string>{"count", "50", "final"}));
+
+    for (const char* invalid : {"median", "", "sum:1", "percentile:", "percentile:101", "percentile:-1", "percentile:5x"}) {
+        EXPECT_THROW(Aggregation{invalid}, ArgumentInvalidException) << invalid;
+    }
+}
+
+TEST(AggregationTest, AggregatesMatchedValues) {
+    json values = {3, 1.5, "text", 7, nullptr, json::array({1}), 3};
+    EXPECT_EQ(aggregate("count", values), 7);
+    EXPECT_EQ(aggregate("sum", values), 14.5);
+    EXPECT_DOUBLE_EQ(aggregate("avg", values).get<double>(), 14.5 / 4);
+    EXPECT_EQ(aggregate("min", values), 1.5);
+    EXPECT_EQ(aggregate("max", values), 7);
+    EXPECT_EQ(aggregate("distinct_count", values), 6);
+    EXPECT_EQ(aggregate("sum", json::array({2, 3})).dump(), "5");
+
+    EXPECT_EQ(aggregate("count", json::array()), 0);
+    EXPECT_EQ(aggregate("sum", json::array({"a"})), 0);
+    EXPECT_TRUE(aggregate("avg", json::array({"a"})).is_null());
+    EXPECT_TRUE(aggregate("max", json::array()).is_null());
+    EXPECT_TRUE(aggregate("percentile", json::array()).is_null());
+}
+
+TEST(AggregationTest, InterpolatesPercentiles) {
+    json values = {40, 10, 30, 20};
+    EXPECT_EQ(aggregate("percentile:0", values), 10);
+    EXPECT_EQ(aggregate("percentile:100", values), 40);
+    EXPECT_EQ(aggregate("percentile", values), 25);
+    EXPECT_DOUBLE_EQ(aggregate("percentile:90", values).get<double>(), 37);
+    EXPECT_EQ(aggregate("percentile:50", json::array({5})), 5);
+}
+
+TEST(AggregationTest, MergesPartialResults) {
+    Aggregation percentile("percentile");
+    percentile.merge(json::parse(R"({"count":3,"numeric":2,"sum":30,"min":10,"max":20,"values":[10,20]})"));
+    percentile.merge(json::parse(R"({"count":0,"numeric":0,"sum":0,"min":null,"max":null,"values":[]})"));
+    percentile.add(40);
+    EXPECT_EQ(percentile.result(), 20);
+
+    Aggregation average("avg");
+    average.merge(json::parse(R"({"count":2,"numeric":2,"sum":3,"min":1,"max":2,"values":[]})"));
+    average.merge(json::parse(R"({"count":1,"numeric":1,"sum":6,"min":6,"max":6,"values":[]})"));
+    EXPECT_DOUBLE_EQ(average.result().get<double>(), 3);
+
+    Aggregation distinct("distinct_count");
+    distinct.merge(json::parse(R"({"count":2,"numeric":0,"sum":0,"min":null,"max":null,"values":["a",{"x":1}]})"));
+    distinct.merge(json::parse(R"({"count":2,"numeric":1,"sum":1,"min":1,"max":1,"values":["a",1]})"));
+    EXPECT_EQ(distinct.result(), 3);
+
+    EXPECT_THROW(distinct.merge(json::parse(R"({"result":3})")), LuaScriptException);
+}
+
+TEST(AggregationTest, ReturnsTheScriptResult) {
+    Aggregation average("avg");
+    average.set_result(2);
+    EXPECT_TRUE(average.result().is_number_float());
+    EXPECT_DOUBLE_EQ(average.result().get<double>(), 2);
+
+    Aggregation maximum("max");
+    maximum.set_result(nullptr);
+    EXPECT_TRUE(maximum.result().is_null());
+}
@@ -0,0 +1,277 @@
+#include "gtest/gtest.h"
+#include "redisjson++/json_cache.h"
+#include "redisjson++/cache_invalidation_listener.h"
+#include "redisjson++/redis_connection_manager.h" // For RedisConnection
+#include "redisjson++/hiredis_RAII.h"
+#include "redisjson++/exceptions.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace redisjson;
+using json = nlohmann::json;
+
+TEST(JSONCacheTest, PutAndGet) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    EXPECT_FALSE(cache.get("doc").has_value());
+    cache.put("doc", json{{"mtu", 1500}});
+    ASSERT_TRUE(cache.get("doc").has_value());
+    EXPECT_EQ(*cache.get("doc"), (json{{"mtu", 1500}}));
+
+    CacheStats stats = cache.get_stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.current_size, 1u);
+}
+
+TEST(JSONCacheTest, EvictsLeastRecentlyUsed) {
+    JSONCache cache(2, std::chrono::seconds(0));
+    cache.put("a", 1);
+    cache.put("b", 2);
+    cache.get("a"); // "b" is now the least recently used
+    cache.put("c", 3);
+    EXPECT_TRUE(cache.get("a").has_value());
+    EXPECT_FALSE(cache.get("b").has_value());
+    EXPECT_TRUE(cache.get("c").has_value());
+}
+
+TEST(JSONCacheTest, InvalidateRemovesPathEntries) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    cache.put("doc", json{{"mtu", 1500}});
+    cache.put_path("doc", "mtu", json::array({1500}));
+    cache.put_path("other", "mtu", json::array({9100}));
+
+    cache.invalidate("doc");
+    EXPECT_FALSE(cache.get("doc").has_value());
+    EXPECT_FALSE(cache.get_path("doc", "mtu").has_value());
+    EXPECT_TRUE(cache.get_path("other", "mtu").has_value());
+    EXPECT_EQ(cache.get_stats().current_size, 1u);
+}
+
+TEST(JSONCacheTest, FillIsDroppedAfterInvalidation) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    JSONCache::FillToken token = cache.fill_token("doc");
+    cache.invalidate("doc"); // A write raced with the read
+    EXPECT_FALSE(cache.fill("doc", json{{"mtu", 1500}}, token));
+    EXPECT_FALSE(cache.get("doc").has_value());
+
+    token = cache.fill_token("doc");
+    cache.clear_cache();
+    EXPECT_FALSE(cache.fill_path("doc", "mtu", json::array({1500}), token));
+
+    token = cache.fill_token("doc");
+    EXPECT_TRUE(cache.fill("doc", json{{"mtu", 9100}}, token));
+    EXPECT_EQ(*cache.get("doc"), (json{{"mtu", 9100}}));
+}
+
+TEST(JSONCacheTest, DisabledCacheStoresNothing) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    cache.put("doc", 1);
+    cache.enable_caching(false);
+    EXPECT_FALSE(cache.get("doc").has_value());
+    cache.put("doc", 1);
+    cache.enable_caching(true);
+    EXPECT_FALSE(cache.get("doc").has_value());
+}
+
+TEST(JSONCacheTest, ByteBudgetEvictsBySize) {
+    json small = {{"mtu", 1500}};
+    json large = {{"description", std::string(4096, 'x')}};
+    EXPECT_GT(JSONCache::estimate_size(large), 4096u);
+    EXPECT_LT(JSONCache::estimate_size(small), JSONCache::estimate_size(large));
+
+    JSONCache cache(100, std::chrono::seconds(0), 6000);
+    cache.put("small", small);
+    cache.put("large1", large);
+    EXPECT_TRUE(cache.get("small").has_value());
+    cache.put("large2", large); // Over budget: the least recently used entry goes
+    EXPECT_FALSE(cache.get("large1").has_value());
+    EXPECT_TRUE(cache.get("small").has_value());
+    EXPECT_TRUE(cache.get("large2").has_value());
+    EXPECT_LE(cache.get_stats().current_bytes, 6000u);
+
+    cache.put("huge", json{{"description", std::string(8192, 'x')}}); // Larger than the whole budget
+    EXPECT_FALSE(cache.get("huge").has_value());
+    EXPECT_TRUE(cache.get("large2").has_value());
+}
+
+TEST(JSONCacheTest, AdmissionFilterKeepsFrequentEntries) {
+    JSONCache cache(2, std::chrono::seconds(0));
+    cache.set_admission_filter(true);
+    cache.put("hot1", 1);
+    cache.put("hot2", 2);
+    for (int i = 0; i < 5; ++i) {
+        cache.get("hot1");
+        cache.get("hot2");
+    }
+    // Keys read once do not displace the hot ones.
+    for (int i = 0; i < 20; ++i) {
+        std::string key = "scan" + std::to_string(i);
+        cache.get(key);
+        cache.put(key, i);
+    }
+    EXPECT_TRUE(cache.get("hot1").has_value());
+    EXPECT_TRUE(cache.get("hot2").has_value());
+    EXPECT_EQ(cache.get_stats().rejected, 20u);
+
+    // A key that becomes popular is admitted.
+    for (int i = 0; i < 10; ++i) cache.get("rising");
+    cache.put("rising", 3);
+    EXPECT_TRUE(cache.get("rising").has_value());
+}
+
+TEST(JSONCacheTest, ConcurrentAccessAcrossShards) {
+    JSONCache cache(4096, std::chrono::seconds(0));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 2000; ++i) {
+                std::string key = "key" + std::to_string((i * 7 + t) % 512);
+                if (i % 10 == 0) {
+                    cache.invalidate(key);
+                } else if (!cache.get(key)) {
+                    cache.put(key, json{{"value", i}});
+                    cache.put_path(key, "value", json::array({i}));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    CacheStats stats = cache.get_stats();
+    EXPECT_EQ(stats.hits + stats.misses, 8u * 1800u);
+    EXPECT_LE(stats.current_size, 4096u);
+}
+
+TEST(JSONCacheTest, SharedHitsReturnTheCachedDocument) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    auto document = std::make_shared<const json>(json{{"ports", {{"Ethernet0", {{"mtu", 9100}}}}}});
+    cache.put_shared("PORT", document);
+
+    SharedDocument hit = cache.get_shared("PORT");
+    EXPECT_EQ(hit.get(), document.get());
+    EXPECT_EQ(cache.get_shared("missing"), nullptr);
+
+    SharedDocument mtu = cache.get_view("PORT", "ports.Ethernet0.mtu");
+    ASSERT_NE(mtu, nullptr);
+    EXPECT_EQ(*mtu, 9100);
+    EXPECT_EQ(mtu.get(), &(*document)["ports"]["Ethernet0"]["mtu"]); // Points into the document
+    EXPECT_THROW(cache.get_view("PORT", "ports.Ethernet4"), PathNotFoundException);
+    EXPECT_EQ(cache.get_view("missing", "ports"), nullptr);
+
+    // Views and shared documents outlive their cache entry.
+    document.reset();
+    hit.reset();
+    cache.invalidate("PORT");
+    EXPECT_EQ(*mtu, 9100);
+}
+
+TEST(JSONCacheTest, ConcurrentMissesShareOneLoad) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    std::atomic<int> loads{0};
+    auto loader = [&loads] {
+        ++loads;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return std::make_shared<const json>(json{{"mtu", 9100}});
+    };
+    std::vector<std::future<SharedDocument>> readers;
+    for (int i = 0; i < 8; ++i) {
+        readers.push_back(std::async(std::launch::async, [&] { return cache.get_or_load("PORT", loader); }));
+    }
+    for (auto& reader : readers) {
+        EXPECT_EQ(*reader.get(), (json{{"mtu", 9100}}));
+    }
+    EXPECT_EQ(loads, 1);
+    EXPECT_EQ(cache.get_or_load("PORT", loader), cache.get_shared("PORT")); // Cached now
+    EXPECT_EQ(loads, 1);
+}
+
+TEST(JSONCacheTest, FailedLoadIsSharedAndNotCached) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    auto failing = []() -> SharedDocument { throw PathNotFoundException("PORT", "$"); };
+    EXPECT_THROW(cache.get_or_load("PORT", failing), PathNotFoundException);
+    EXPECT_EQ(cache.get_shared("PORT"), nullptr);
+    EXPECT_EQ(*cache.get_or_load("PORT", [] { return std::make_shared<const json>(1); }), 1);
+}
+
+TEST(JSONCacheTest, InvalidationDetachesRunningLoad) {
+    JSONCache cache(10, std::chrono::seconds(0));
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> loads{0};
+    auto old_read = std::async(std::launch::async, [&] {
+        return cache.get_or_load("PORT", [&] {
+            ++loads;
+            released.wait(); // Read before the write below
+            return std::make_shared<const json>(json("old"));
+        });
+    });
+    while (loads == 0) std::this_thread::yield();
+
+    cache.invalidate("PORT"); // A write happened
+    SharedDocument fresh = cache.get_or_load("PORT", [&] {
+        ++loads;
+        return std::make_shared<const json>(json("new"));
+    });
+    EXPECT_EQ(*fresh, "new"); // Did not wait for the load that started before the write
+    release.set_value();
+    EXPECT_EQ(*old_read.get(), "old");
+    EXPECT_EQ(loads, 2);
+    EXPECT_EQ(*cache.get_shared("PORT"), "new"); // The stale load was not cached
+}
+
+TEST(JSONCacheTest, StaleWhileRevalidateServesExpiredValue) {
+    JSONCache cache(10, std::chrono::seconds(1));
+    cache.set_stale_while_revalidate(std::chrono::seconds(60));
+    std::atomic<int> loads{0};
+    auto loader = [&loads] { return std::make_shared<const json>(++loads); };
+
+    EXPECT_EQ(*cache.get_or_load("PORT", loader), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100)); // Expired
+    EXPECT_EQ(cache.get_shared("PORT"), nullptr);                 // Plain reads miss
+    EXPECT_EQ(*cache.get_or_load("PORT", loader), 1);             // Served stale, refresh started
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!cache.get_shared("PORT") && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_NE(cache.get_shared("PORT"), nullptr);
+    EXPECT_EQ(*cache.get_shared("PORT"), 2);
+    EXPECT_EQ(loads, 2);
+    EXPECT_EQ(cache.get_stats().stale_hits, 1u);
+}
+
+TEST(CacheInvalidationListenerTest, ReportsWritesFromOtherConnections) {
+    LegacyClientConfig config;
+    RedisConnection writer(config.host, config.port, config.password, config.database, std::chrono::milliseconds(1000));
+    if (!writer.connect() || !writer.ping()) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+
+    std::mutex mutex;
+    std::condition_variable received_cv;
+    std::vector<std::string> received;
+    CacheInvalidationListener listener(config, {"cache_test:"}, [&](const std::vector<std::string>& keys) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received.insert(received.end(), keys.begin(), keys.end());
+        received_cv.notify_all();
+    });
+    ASSERT_TRUE(listener.wait_until_subscribed(std::chrono::seconds(5)));
+
+    RedisReplyPtr(writer.command("SET %s %s", "cache_test:other", "1"));
+    RedisReplyPtr(writer.command("SET %s %s", "cache_test:doc", "{}"));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(received_cv.wait_for(lock, std::chrono::seconds(5), [&] {
+        return std::find(received.begin(), received.end(), "cache_test:doc") != received.end();
+    }));
+    lock.unlock();
+    RedisReplyPtr(writer.command("DEL %s %s", "cache_test:other", "cache_test:doc"));
+}
@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "redisjson++/json_diff.h"
+#include <string>
+
+using namespace redisjson;
+
+namespace {
+
+// Diffs and checks that the patch turns `from` into `to`.
+json checked_diff(const json& from, const json& to, const DiffOptions& options = {}) {
+    json patch = JSONDiff(options).diff(from, to);
+    EXPECT_EQ(from.patch(patch), to) << patch.dump();
+    return patch;
+}
+
+json make_ports(size_t count) {
+    json ports = json::array();
+    for (size_t i = 0; i < count; ++i) {
+        ports.push_back({{"name", "Ethernet" + std::to_string(i)}, {"mtu", 9100}, {"lanes", {i * 4, i * 4 + 1}}});
+    }
+    return ports;
+}
+
+} // namespace
+
+TEST(JSONDiffTest, EqualDocumentsGiveEmptyPatch) {
+    json doc = {{"a", {1, 2.5, "x", nullptr, true}}, {"b", {{"c", json::object()}}}};
+    EXPECT_EQ(JSONDiff().diff(doc, doc), json::array());
+    EXPECT_EQ(JSONDiff().diff(json{{"n", 1}}, json{{"n", 1.0}}), json::array()); // Equal under operator==
+    EXPECT_EQ(JSONDiff().diff(json::array({1}), json::object()),
+              json::parse(R"([{"op":"replace","path":"","value":{}}])"));
+}
+
+TEST(JSONDiffTest, ObjectMembersAndEscapedKeys) {
+    json from = {{"keep", {{"deep", {1, 2}}}}, {"gone", 1}, {"a/b~c", {{"x", 1}}}, {"type", "string"}};
+    json to = {{"keep", {{"deep", {1, 2}}}}, {"new", {{"y", 2}}}, {"a/b~c", {{"x", 2}}}, {"type", {1}}};
+    json patch = checked_diff(from, to);
+    EXPECT_EQ(patch, json::parse(R"([
+        {"op": "replace", "path": "/a~1b~0c/x", "value": 2},
+        {"op": "remove", "path": "/gone"},
+        {"op": "add", "path": "/new", "value": {"y": 2}},
+        {"op": "replace", "path": "/type", "value": [1]}
+    ])"));
+}
+
+TEST(JSONDiffTest, InsertIntoLargeArrayIsOneOperation) {
+    json from = {{"values", json::array()}};
+    for (int i = 0; i < 5000; ++i) from["values"].push_back(i);
+    json to = from;
+    to["values"].insert(to["values"].begin() + 10, -1);
+    to["values"].erase(to["values"].begin() + 4000);
+    to["values"][2500] = "changed";
+
+    json patch = checked_diff(from, to);
+    EXPECT_EQ(patch, json::parse(R"([
+        {"op": "add", "path": "/values/10", "value": -1},
+        {"op": "replace", "path": "/values/2500", "value": "changed"},
+        {"op": "remove", "path": "/values/4000"}
+    ])"));
+}
+
+TEST(JSONDiffTest, MatchesObjectsByIdentityField) {
+    json from = {{"ports", make_ports(100)}};
+    json to = from;
+    to["ports"].erase(to["ports"].begin() + 3);
+    to["ports"].insert(to["ports"].begin() + 50, json{{"name", "Ethernet999"}, {"mtu", 1500}});
+    to["ports"][70]["mtu"] = 1500;
+    std::swap(to["ports"][80], to["ports"][90]);
+
+    json patch = checked_diff(from, to);
+    // The removal, the insertion, the changed member, and a removal and an insertion for
+    // each of the swapped elements
+    EXPECT_EQ(patch.size(), 7u) << patch.dump();
+    EXPECT_EQ(patch[0], json::parse(R"({"op": "remove", "path": "/ports/3"})"));
+    EXPECT_EQ(patch[1]["path"], "/ports/50");
+    EXPECT_EQ(patch[2], json::parse(R"({"op": "replace", "path": "/ports/70/mtu", "value": 1500})"));
+
+    DiffOptions by_value;
+    by_value.identity_fields.clear(); // Changed elements are then diffed with their neighbours
+    EXPECT_EQ(checked_diff(from, to, by_value).size(), 9u);
+}
+
+TEST(JSONDiffTest, DuplicateIdentitiesMatchByValue) {
+    json from = json::array({{{"id", 1}, {"v", "a"}}, {{"id", 1}, {"v", "b"}}, {{"id", 2}, {"v", "c"}}});
+    json to = json::array({{{"id", 1}, {"v", "b"}}, {{"id", 2}, {"v", "c"}}, {{"id", 2}, {"v", "d"}}});
+    json patch = checked_diff(from, to);
+    EXPECT_EQ(patch, json::parse(R"([
+        {"op": "remove", "path": "/0"},
+        {"op": "add", "path": "/2", "value": {"id": 2, "v": "d"}}
+    ])"));
+}
+
+TEST(JSONDiffTest, PairsUnmatchedElementsByPosition) {
+    json from = json::array({{{"a", 1}, {"b", 1}}, "x", {{"a", 2}, {"b", 2}}});
+    json to = json::array({{{"a", 1}, {"b", 9}}, "y", {{"a", 2}, {"b", 2}}, "z"});
+    json patch = checked_diff(from, to);
+    EXPECT_EQ(patch, json::parse(R"([
+        {"op": "replace", "path": "/0/b", "value": 9},
+        {"op": "replace", "path": "/1", "value": "y"},
+        {"op": "add", "path": "/3", "value": "z"}
+    ])"));
+    checked_diff(json::array({1, 2, 3}), json::array());
+    checked_diff(json::array(), json::array({json::array(), json::object()}));
+    EXPECT_EQ(checked_diff(json::array({1, 2, 1, 2, 1}), json::array({2, 1, 2, 1, 2})).size(), 2u); // By LCS
+
+    DiffOptions no_lcs;
+    no_lcs.max_lcs_cells = 0;
+    EXPECT_EQ(checked_diff(json::array({1, 2, 1, 2, 1}), json::array({2, 1, 2, 1, 2}), no_lcs).size(), 5u);
+}
@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+#include "redisjson++/json_exporter.h"
+#include "redisjson++/bulk_loader.h"
+#include "redisjson++/document_codec.h"
+#include "redisjson++/exceptions.h"
+#include <sstream>
+#include <string>
+
+using namespace redisjson;
+
+TEST(ExportWriterTest, CopiesStoredJSONIntoNDJSON) {
+    std::ostringstream output;
+    ExportWriter writer(output, ExportFormat::NDJSON, DocumentEncoding::JSON);
+    writer.write_stored("device:\"1\"", R"({"b":1, "a" : [true]})"); // Copied as stored
+    writer.write_stored("device:2", "{\n  \"a\": 2\n}");              // Re-encoded onto one line
+    writer.write_document("device:3", json{{"c", nullptr}});
+
+    EXPECT_EQ(output.str(),
+              "{\"key\":\"device:\\\"1\\\"\",\"value\":{\"b\":1, \"a\" : [true]}}\n"
+              "{\"key\":\"device:2\",\"value\":{\"a\":2}}\n"
+              "{\"key\":\"device:3\",\"value\":{\"c\":null}}\n");
+    EXPECT_EQ(writer.bytes_written(), output.str().size());
+    EXPECT_THROW(writer.write_stored("device:4", "{\"a\":\n"), JsonParsingException);
+}
+
+TEST(ExportWriterTest, NDJSONExportLoadsBack) {
+    std::ostringstream output;
+    ExportWriter writer(output, ExportFormat::NDJSON, DocumentEncoding::MESSAGEPACK);
+    json document = {{"name", "r1"}, {"ports", {1, 2, 3}}};
+    writer.write_stored("device:1", encode_document(document, DocumentEncoding::MESSAGEPACK));
+
+    std::istringstream input(output.str());
+    BulkRecordReader reader(input);
+    std::string record;
+    ASSERT_TRUE(reader.next(record));
+    BulkLoadOptions options;
+    options.key_field = "key";
+    options.value_field = "value";
+    auto [key, loaded] = BulkLoader::parse_record(record, options);
+    EXPECT_EQ(key, "device:1");
+    EXPECT_EQ(loaded, document);
+    EXPECT_FALSE(reader.next(record));
+}
+
+TEST(ExportWriterTest, WritesMessagePackMaps) {
+    json document = {{"name", std::string(300, 'x')}, {"id", 7}};
+    for (DocumentEncoding stored : {DocumentEncoding::MESSAGEPACK, DocumentEncoding::JSON}) {
+        std::ostringstream output;
+        ExportWriter writer(output, ExportFormat::MESSAGEPACK, stored);
+        std::string key(40, 'k'); // str8 header
+        writer.write_stored(key, encode_document(document, stored));
+        std::string bytes = output.str();
+        EXPECT_EQ(writer.bytes_written(), bytes.size());
+        json record = json::from_msgpack(bytes);
+        EXPECT_EQ(record["key"], key);
+        EXPECT_EQ(record["value"], document);
+    }
+}
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include "redisjson++/json_index.h"
+#include "redisjson++/exceptions.h"
+#include "redisjson++/lua_script_manager.h"
+#include "redisjson++/redis_connection_manager.h"
+#include <string>
+#include <vector>
+
+using namespace redisjson;
+
+TEST(IndexRegistryTest, ValidatesDefinitions) {
+    IndexRegistry registry;
+    EXPECT_THROW(registry.add({"", "device:*", "city", IndexType::TAG}), ArgumentInvalidException);
+    EXPECT_THROW(registry.add({"by:city", "device:*", "city", IndexType::TAG}), ArgumentInvalidException);
+    EXPECT_THROW(registry.add({"city", "", "city", IndexType::TAG}), ArgumentInvalidException);
+    EXPECT_THROW(registry.add({"city", "device:*", "$", IndexType::TAG}), InvalidPathException);
+    EXPECT_THROW(registry.add({"city", "device:*", "ports[*].mtu", IndexType::NUMERIC}), InvalidPathException);
+    EXPECT_TRUE(registry.empty());
+
+    registry.add({"city", "device:*", "location.city", IndexType::TAG});
+    registry.add({"city", "device:*", "$.site.city", IndexType::TAG}); // Replaces
+    ASSERT_EQ(registry.definitions().size(), 1u);
+    EXPECT_EQ(registry.find("city")->path, "$.site.city");
+    EXPECT_TRUE(registry.remove("city"));
+    EXPECT_FALSE(registry.remove("city"));
+    EXPECT_FALSE(registry.find("city").has_value());
+}
+
+TEST(IndexRegistryTest, PassesCoveringIndexesToScripts) {
+    IndexRegistry registry;
+    registry.add({"city", "device:*", "location.city", IndexType::TAG});
+    registry.add({"speed", "device:*", "$.ports[0].speed", IndexType::NUMERIC});
+    registry.add({"tenant", "{acme}:user:*", "plan", IndexType::TAG});
+
+    std::vector<std::string> keys = {"device:1"};
+    std::vector<std::string> args = {"$", "{}"};
+    ASSERT_TRUE(registry.append_script_arguments("device:1", keys, args));
+    EXPECT_EQ(keys, (std::vector<std::string>{"device:1", "redisjson:index:city", "redisjson:index:speed"}));
+    EXPECT_EQ(args, (std::vector<std::string>{"$", "{}", R"(["tag",["location","city"]])",
+                                              R"(["numeric",["ports",0,"speed"]])"}));
+
+    keys.clear();
+    args.clear();
+    ASSERT_TRUE(registry.append_script_arguments("{acme}:user:7", keys, args));
+    EXPECT_EQ(keys, (std::vector<std::string>{"redisjson:index:tenant:{acme}"}));
+
+    EXPECT_FALSE(registry.covers("user:7"));
+    EXPECT_FALSE(registry.covers("redisjson:indexes"));
+    EXPECT_TRUE(registry.covers("device:"));
+
+    EXPECT_EQ(registry.find_for("device:*", json::array({"location", "city"}))->name, "city");
+    EXPECT_FALSE(registry.find_for("device:1*", json::array({"location", "city"})).has_value());
+    EXPECT_FALSE(registry.find_for("device:*", json::array({"location"})).has_value());
+}
+
+TEST(IndexRegistryTest, NamesIndexKeys) {
+    IndexDefinition city{"city", "device:*", "city", IndexType::TAG};
+    EXPECT_EQ(IndexRegistry::index_key(city), "redisjson:index:city");
+    EXPECT_EQ(IndexRegistry::tag_key(city, "Paris"), "redisjson:index:city:Paris");
+    city.key_pattern = "{fleet}:device:*";
+    EXPECT_EQ(IndexRegistry::tag_key(city, "Paris"), "redisjson:index:city:{fleet}:Paris");
+    city.key_pattern = "{fl*}:device:*";
+    EXPECT_EQ(IndexRegistry::index_key(city), "redisjson:index:city");
+
+    EXPECT_EQ(IndexRegistry::tag_value("Paris"), "Paris");
+    EXPECT_EQ(IndexRegistry::tag_value(true), "true");
+    EXPECT_EQ(IndexRegistry::tag_value(42), "42");
+    EXPECT_EQ(IndexRegistry::tag_value(42.0), "42");
+    EXPECT_EQ(IndexRegistry::tag_value(-0.5), "-0.5");
+    EXPECT_FALSE(IndexRegistry::tag_value(nullptr).has_value());
+    EXPECT_FALSE(IndexRegistry::tag_value(json::array({"a"})).has_value());
+}
+
+TEST(IndexRegistryTest, MatchesKeysLikeRedis) {
+    EXPECT_TRUE(IndexRegistry::key_matches("device:*", "device:1"));
+    EXPECT_TRUE(IndexRegistry::key_matches("*", ""));
+    EXPECT_TRUE(IndexRegistry::key_matches("d?v*:[0-9]", "dev:sw:7"));
+    EXPECT_FALSE(IndexRegistry::key_matches("d?v*:[0-9]", "dev:sw:x"));
+    EXPECT_TRUE(IndexRegistry::key_matches("dev:[^a-c]", "dev:d"));
+    EXPECT_FALSE(IndexRegistry::key_matches("dev:[^a-c]", "dev:b"));
+    EXPECT_TRUE(IndexRegistry::key_matches("a\\*b", "a*b"));
+    EXPECT_FALSE(IndexRegistry::key_matches("a\\*b", "axb"));
+    EXPECT_FALSE(IndexRegistry::key_matches("device:*", "user:1"));
+    EXPECT_FALSE(IndexRegistry::key_matches("device:?", "device:"));
+}
+
+TEST(IndexRegistryTest, SerializesDefinitions) {
+    IndexDefinition speed{"speed", "device:*", "ports[0].speed", IndexType::NUMERIC};
+    json stored = IndexRegistry::to_json(speed);
+    EXPECT_EQ(stored["type"], "numeric");
+    IndexDefinition loaded = IndexRegistry::from_json(stored);
+    EXPECT_EQ(loaded.name, speed.name);
+    EXPECT_EQ(loaded.key_pattern, speed.key_pattern);
+    EXPECT_EQ(loaded.path, speed.path);
+    EXPECT_EQ(loaded.type, IndexType::NUMERIC);
+
+    stored["type"] = "fulltext";
+    EXPECT_THROW(IndexRegistry::from_json(stored), ArgumentInvalidException);
+    EXPECT_THROW(IndexRegistry::from_json(json::object()), ArgumentInvalidException);
+}
+
+// Member writes in the hash layout, as set_path, del_path and set_json_sparse send them
+// for a key an index covers, against a live Redis.
+TEST(IndexedHashLayoutTest, MemberWritesMaintainIndexes) {
+    ClientConfig config;
+    config.timeout = std::chrono::milliseconds(200);
+    RedisConnection probe(config.host, config.port, config.password, config.database, config.timeout);
+    try {
+        if (!probe.connect() || !probe.ping()) GTEST_SKIP() << "Skipping test, live Redis required.";
+    } catch (const std::exception&) {
+        GTEST_SKIP() << "Skipping test, live Redis required.";
+    }
+
+    RedisConnectionManager conn_manager(config);
+    LuaScriptManager scripts(&conn_manager, DocumentEncoding::JSON, DocumentLayout::HASH);
+    IndexRegistry indexes;
+    indexes.add({"index_test_city", "index_test:hash:*", "location.city", IndexType::TAG});
+    scripts.set_index_registry(&indexes);
+    const std::string key = "index_test:hash:1";
+    const std::string city_key = "redisjson:index:index_test_city";
+    auto command = [&conn_manager](const std::vector<std::string>& argv) {
+        return LuaScriptManager::redis_reply_to_json(conn_manager.execute_for_key(argv[1], argv).get());
+    };
+    scripts.execute_script("json_del_document", {key}, {});
+
+    // set_path on a whole top-level member
+    scripts.execute_script("json_path_set", {key}, {"location", "$", R"({"city":"Paris"})", "NONE", "0", "true"});
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Paris", key}), 1);
+
+    // set_json_sparse
+    scripts.execute_script("json_hash_merge_fields", {key}, {"", "location", R"({"city":"Oslo"})", "name", R"("sw1")"});
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Paris", key}), 0);
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Oslo", key}), 1);
+    EXPECT_EQ(command({"HGET", key, "name"}), "sw1");
+
+    // del_path on a whole top-level member
+    scripts.execute_script("json_path_del", {key}, {"location", "$"});
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Oslo", key}), 0);
+    EXPECT_TRUE(command({"HGET", city_key, key}).is_null());
+
+    scripts.execute_script("json_del_document", {key}, {});
+}
@@ -54,6 +54,24 @@ TEST_F(JSONModifierTest, GetArrayIndex) {
     EXPECT_EQ(result, "reliable");
 }
 
+TEST_F(JSONModifierTest, AcceptsCompiledPaths) {
+    CompiledPath path = parser.compile("details.libs.redis");
+    EXPECT_EQ(modifier.get(test_doc, path), "hiredis");
+    modifier.set(test_doc, path, "hiredis-cluster");
+    EXPECT_EQ(modifier.get(test_doc, parser.compile("details.libs.redis")), "hiredis-cluster");
+    modifier.array_append(test_doc, parser.compile("features"), "compiled");
+    EXPECT_EQ(test_doc["features"].back(), "compiled");
+    modifier.del(test_doc, path);
+    EXPECT_FALSE(modifier.exists(test_doc, path));
+}
+
+TEST_F(JSONModifierTest, GetRefPointsIntoDocument) {
+    const json& result = modifier.get_ref(test_doc, parser.parse("details.author"));
+    EXPECT_EQ(&result, &test_doc["details"]["author"]);
+    EXPECT_EQ(&modifier.get_ref(test_doc, parser.parse("")), &test_doc);
+    EXPECT_THROW(modifier.get_ref(test_doc, parser.parse("details.missing")), PathNotFoundException);
+}
+
 TEST_F(JSONModifierTest, GetNegativeArrayIndex) {
     auto path_elements = parser.parse("features[-2]"); // reliable
     json result = modifier.get(test_doc, path_elements);
@@ -297,9 +315,6 @@ TEST_F(JSONModifierTest, Diff) {
     EXPECT_EQ(temp_doc, modified_doc);
 }
 
-// Merge tests would need specific strategy implementations if not using nlohmann patch.
-// For MergeStrategy::PATCH, it's same as apply_patch.
-// For MergeStrategy::OVERWRITE (like json::update):
 TEST_F(JSONModifierTest, MergeOverwrite) {
     json patch = {
         {"version", 2.0}, // Overwrite
@@ -309,25 +324,55 @@ TEST_F(JSONModifierTest, MergeOverwrite) {
         }},
         {"new_top_key", "added"}
     };
-    // Current modifier.merge with DEEP or OVERWRITE might need full implementation.
-    // Using json::update for a similar effect to OVERWRITE for objects:
-    // test_doc.update(patch); // This is what nlohmann does for objects
-    // Let's assume MergeStrategy::OVERWRITE with objects behaves like json::update
-    // And for non-objects or differing types, it replaces the whole node.
-
-    // modifier.merge(test_doc, patch, MergeStrategy::OVERWRITE);
-    // EXPECT_EQ(test_doc["version"], 2.0);
-    // EXPECT_EQ(test_doc["details"]["author"], "New Author");
-    // EXPECT_FALSE(test_doc["details"].contains("libs")); // Because patch's "details" overwrote original
-    // EXPECT_EQ(test_doc["new_top_key"], "added");
-    // This test depends on specific merge implementation. For now, it's a placeholder.
-    // The requirements.md uses MergeStrategy::DEEP by default.
-    // nlohmann's `json::update(other_json, true)` does recursive update.
-    // `json::update(other_json)` (default false for recursive) is shallow update for objects.
-
-    // For now, skipping detailed merge strategy tests until fully implemented.
-    // The current merge stub throws.
-    EXPECT_THROW(modifier.merge(test_doc, patch, MergeStrategy::DEEP), std::runtime_error);
+    json shallow = test_doc;
+    modifier.merge(test_doc, patch, MergeStrategy::OVERWRITE);
+    EXPECT_EQ(test_doc["version"], 2.0);
+    EXPECT_EQ(test_doc["details"]["author"], "New Author");
+    EXPECT_FALSE(test_doc["details"].contains("libs")); // Because patch's "details" overwrote original
+    EXPECT_EQ(test_doc["new_top_key"], "added");
+    EXPECT_EQ(test_doc["name"], "RedisJSON++");
+
+    modifier.merge(shallow, patch, MergeStrategy::SHALLOW);
+    EXPECT_EQ(shallow, test_doc);
+    modifier.merge(shallow, json::array({1}), MergeStrategy::OVERWRITE); // Not an object: replaces
+    EXPECT_EQ(shallow, json::array({1}));
+}
+
+TEST_F(JSONModifierTest, MergeDeep) {
+    json patch = {
+        {"details", {{"author", "New Author"}, {"libs", {{"redis", "hiredis-cluster"}, {"lua", "5.1"}}}}},
+        {"features", {"replaced"}},
+        {"meta", {{"id", 7}}},
+        {"version", nullptr}
+    };
+    modifier.merge(test_doc, patch, MergeStrategy::DEEP);
+    EXPECT_EQ(test_doc["details"], json({{"author", "New Author"},
+                                         {"libs", {{"json", "nlohmann"}, {"redis", "hiredis-cluster"}, {"lua", "5.1"}}}}));
+    EXPECT_EQ(test_doc["features"], json::array({"replaced"})); // Arrays are replaced, not merged
+    EXPECT_EQ(test_doc["meta"], json({{"id", 7}}));
+    EXPECT_TRUE(test_doc["version"].is_null()); // Null is a value here, not a deletion
+    EXPECT_EQ(test_doc["name"], "RedisJSON++");
+}
+
+TEST_F(JSONModifierTest, MergeAppendMovesPatchValues) {
+    std::string long_tag(1000, 'x');
+    json patch = {{"features", {long_tag}}, {"numbers", {4}}, {"details", {{"libs", {{"gtest", "1.14"}}}}},
+                  {"name", {"not", "an", "array", "target"}}};
+    modifier.merge(test_doc, std::move(patch), MergeStrategy::APPEND);
+    EXPECT_EQ(test_doc["features"], json({"fast", "reliable", "type-safe", long_tag}));
+    EXPECT_EQ(test_doc["numbers"], json({1, 2, 3, {10, 20}, json::array(), 4}));
+    EXPECT_EQ(test_doc["details"]["libs"].size(), 3u);
+    EXPECT_EQ(test_doc["name"], json({"not", "an", "array", "target"}));
+
+    json list = json::array({1, 2});
+    modifier.merge(list, json::array({3}), MergeStrategy::APPEND);
+    EXPECT_EQ(list, json::array({1, 2, 3}));
+}
+
+TEST_F(JSONModifierTest, MergePatchStrategyAppliesJSONPatch) {
+    modifier.merge(test_doc, json::parse(R"([{"op": "remove", "path": "/meta"}])"), MergeStrategy::PATCH);
+    EXPECT_FALSE(test_doc.contains("meta"));
+    EXPECT_THROW(modifier.merge(test_doc, json::object(), MergeStrategy::PATCH), ArgumentInvalidException);
 }
 
 // main function for tests is usually in a separate file or handled by CMake + GTest discover
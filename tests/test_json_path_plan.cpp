@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include "redisjson++/json_path_plan.h"
+#include "redisjson++/exceptions.h"
+#include <string>
+#include <vector>
+
+using namespace redisjson;
+
+namespace {
+
+json device() {
+    return json::parse(R"({
+        "hostname": "switch-1",
+        "ports": [
+            {"name": "Ethernet0", "admin_status": "up",   "mtu": 9100, "speed": 100000},
+            {"name": "Ethernet4", "admin_status": "down", "mtu": 1500, "speed": 40000},
+            {"name": "Ethernet8", "admin_status": "up",   "mtu": 1500, "speed": 100000, "lag": {"name": "PortChannel1"}}
+        ],
+        "vlans": {"Vlan10": {"members": ["Ethernet0", "Ethernet8"]}, "Vlan20": {"members": []}},
+        "a.b": 1
+    })");
+}
+
+std::vector<json> values(const JSONPathPlan& plan, const json& doc) {
+    std::vector<json> result;
+    for (const json* match : plan.select(doc)) {
+        result.push_back(*match);
+    }
+    return result;
+}
+
+std::vector<std::string> paths(const std::string& expression, const json& doc) {
+    std::vector<std::string> result;
+    for (const auto& match : JSONPathPlan::compile(expression).select_paths(doc)) {
+        result.push_back(match.path);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(JSONPathPlanTest, SelectsMembersAndIndices) {
+    json doc = device();
+    EXPECT_EQ(values(JSONPathPlan::compile("$.hostname"), doc), std::vector<json>{"switch-1"});
+    EXPECT_EQ(values(JSONPathPlan::compile("ports[1].name"), doc), std::vector<json>{"Ethernet4"});
+    EXPECT_EQ(values(JSONPathPlan::compile("$['ports'][-1]['name']"), doc), std::vector<json>{"Ethernet8"});
+    EXPECT_EQ(values(JSONPathPlan::compile("$['a.b']"), doc), std::vector<json>{1});
+    EXPECT_TRUE(values(JSONPathPlan::compile("$.ports[3]"), doc).empty());
+    EXPECT_TRUE(values(JSONPathPlan::compile("$.hostname.length"), doc).empty());
+    EXPECT_EQ(JSONPathPlan::compile("$").select(doc), std::vector<const json*>{&doc});
+    EXPECT_TRUE(JSONPathPlan::compile("$.ports[0].mtu").is_definite());
+}
+
+TEST(JSONPathPlanTest, SelectsWildcardsSlicesAndUnions) {
+    json doc = device();
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[*].name"), doc),
+              (std::vector<json>{"Ethernet0", "Ethernet4", "Ethernet8"}));
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[1:].mtu"), doc), (std::vector<json>{1500, 1500}));
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[::-2].name"), doc), (std::vector<json>{"Ethernet8", "Ethernet0"}));
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[0,-1].name"), doc), (std::vector<json>{"Ethernet0", "Ethernet8"}));
+    EXPECT_EQ(values(JSONPathPlan::compile("$.vlans.*.members[0]"), doc), std::vector<json>{"Ethernet0"});
+    EXPECT_EQ(values(JSONPathPlan::compile("$['hostname','missing']"), doc), std::vector<json>{"switch-1"});
+    EXPECT_FALSE(JSONPathPlan::compile("$.ports[*]").is_definite());
+}
+
+TEST(JSONPathPlanTest, RecursiveDescentVisitsEveryLevel) {
+    json doc = device();
+    EXPECT_EQ(values(JSONPathPlan::compile("$..name"), doc),
+              (std::vector<json>{"Ethernet0", "Ethernet4", "Ethernet8", "PortChannel1"}));
+    EXPECT_EQ(values(JSONPathPlan::compile("$..members[*]"), doc), (std::vector<json>{"Ethernet0", "Ethernet8"}));
+    EXPECT_EQ(values(JSONPathPlan::compile("$..[0].name"), doc), std::vector<json>{"Ethernet0"});
+}
+
+TEST(JSONPathPlanTest, FiltersChildren) {
+    json doc = device();
+    EXPECT_EQ(values(JSONPathPlan::compile("$..ports[?(@.admin_status=='up')].mtu"), doc),
+              (std::vector<json>{9100, 1500}));
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[?(@.mtu < 9000 && @.speed >= 100000)].name"), doc),
+              std::vector<json>{"Ethernet8"});
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[?@.lag].name"), doc), std::vector<json>{"Ethernet8"});
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[?(!@.lag && @.admin_status != \"up\")].name"), doc),
+              std::vector<json>{"Ethernet4"});
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[?(@.name == $.vlans.Vlan10.members[1])].mtu"), doc),
+              std::vector<json>{1500});
+    EXPECT_EQ(values(JSONPathPlan::compile("$.ports[?(@.mtu == 1500.0 || (@.speed > 1e5))].name"), doc),
+              (std::vector<json>{"Ethernet4", "Ethernet8"}));
+    EXPECT_TRUE(values(JSONPathPlan::compile("$.ports[?(@.name > 5)]"), doc).empty()); // Not comparable
+    EXPECT_EQ(values(JSONPathPlan::compile("$.vlans[?(@.members[0])]"), doc).size(), 1u);
+}
+
+TEST(JSONPathPlanTest, MatchesAreNormalizedPathsIntoTheDocument) {
+    json doc = device();
+    EXPECT_EQ(paths("$..ports[?(@.admin_status=='up')].mtu", doc),
+              (std::vector<std::string>{"$.ports[0].mtu", "$.ports[2].mtu"}));
+    EXPECT_EQ(paths("$.*", doc).front(), "$['a.b']");
+    auto matches = JSONPathPlan::compile("$.ports[2].lag").select_paths(doc);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].value, &doc["ports"][2]["lag"]); // A pointer into the document, not a copy
+
+    size_t visited = 0;
+    JSONPathPlan::compile("$..*").visit(doc, [&](const json&) { ++visited; });
+    EXPECT_EQ(visited, 27u);
+}
+
+TEST(JSONPathPlanTest, RejectsMalformedExpressions) {
+    for (const char* expression : {"$.", "$..", "$.ports[", "$.ports[]", "$.ports[?(@.mtu ==)]",
+                                   "$.ports[?('up')]", "$.ports[?(@.mtu == 'x]", "$x", "$.a]"}) {
+        EXPECT_THROW(JSONPathPlan::compile(expression), InvalidPathException) << expression;
+    }
+}
+
+TEST(JSONPathPlanTest, EncodesPlansForTheQueryScript) {
+    JSONPathPlan plan = JSONPathPlan::compile("$.ports[?(@.mtu >= 1500 && !@.lag)][1:].name");
+    EXPECT_EQ(plan.to_script_plan(), json::parse(R"([
+        [false, [["n", "ports"]]],
+        [false, [["f", ["and", ["cmp", ">=", ["@", "mtu"], ["lit", 1500]], ["not", ["exists", ["@", "lag"]]]]]]],
+        [false, [["s", true, 1, false, 0, 1]]],
+        [false, [["n", "name"]]]
+    ])"));
+    EXPECT_EQ(plan.leading_member(), "ports");
+    EXPECT_EQ(plan.to_script_plan(1).size(), 3u);
+    EXPECT_FALSE(plan.filters_use_root());
+
+    JSONPathPlan recursive = JSONPathPlan::compile("$..vlans[*,-1][?(@.id == $.default_vlan[0])]");
+    EXPECT_EQ(recursive.to_script_plan(), json::parse(R"([
+        [true, [["n", "vlans"]]],
+        [false, [["*"], ["i", -1]]],
+        [false, [["f", ["cmp", "==", ["@", "id"], ["$", "default_vlan", 0]]]]]
+    ])"));
+    EXPECT_EQ(recursive.leading_member(), "");
+    EXPECT_TRUE(recursive.filters_use_root());
+    EXPECT_EQ(JSONPathPlan().script_argument(), "[]");
+}
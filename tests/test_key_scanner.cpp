@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "redisjson++/key_scanner.h"
+#include "redisjson++/exceptions.h"
+#include "redisjson++/hiredis_RAII.h"
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace redisjson;
+
+class KeyScannerTest : public ::testing::Test {
+protected:
+    ClientConfig config;
+
+    void SetUp() override {
+        config.host = "127.0.0.1";
+        config.port = 6379;
+        config.connection_pool_size = 2;
+        config.timeout = std::chrono::milliseconds(200);
+    }
+
+    bool isRedisAvailable() {
+        redisContext* c = redisConnectWithTimeout(config.host.c_str(), config.port, {1, 0});
+        if (c == nullptr || c->err) {
+            if (c) redisFree(c);
+            return false;
+        }
+        RedisReplyPtr reply(static_cast<redisReply*>(redisCommand(c, "PING")));
+        bool available = reply && reply->type == REDIS_REPLY_STATUS;
+        redisFree(c);
+        return available;
+    }
+
+    static json decode(const std::string& key, redisReply* reply) {
+        if (reply->type == REDIS_REPLY_NIL) throw PathNotFoundException(key, "$ (root)");
+        return json::parse(std::string(reply->str, reply->len));
+    }
+};
+
+TEST_F(KeyScannerTest, StreamsKeysAndPipelinedDocuments) {
+    if (!isRedisAvailable()) GTEST_SKIP() << "Skipping test, live Redis required.";
+    RedisConnectionManager manager(config);
+    const size_t count = 250;
+    for (size_t i = 0; i < count; ++i) {
+        std::string key = "scanner_test:" + std::to_string(i);
+        manager.execute_for_key(key, {"SET", key, json{{"id", i}}.dump()});
+    }
+
+    ScanOptions options;
+    options.initial_count = 10;
+    options.target_batch_size = 1000;
+    KeyScanner keys(manager, "scanner_test:*", options);
+    std::set<std::string> found;
+    ScannedKey entry;
+    while (keys.next(entry)) {
+        EXPECT_TRUE(entry.document.is_null());
+        found.insert(entry.key);
+    }
+    EXPECT_EQ(found.size(), count);
+    EXPECT_GT(keys.current_count(), options.initial_count); // Sparse pages grow the COUNT hint
+
+    options.fetch_documents = true;
+    KeyScanner documents(manager, "scanner_test:*", options, "GET", &KeyScannerTest::decode);
+    std::set<std::string> fetched;
+    std::vector<ScannedKey> batch;
+    while (documents.next_batch(batch)) {
+        for (const ScannedKey& scanned : batch) {
+            EXPECT_FALSE(scanned.error);
+            EXPECT_EQ("scanner_test:" + std::to_string(scanned.document["id"].get<size_t>()), scanned.key);
+            fetched.insert(scanned.key);
+        }
+    }
+    EXPECT_EQ(fetched, found);
+    EXPECT_FALSE(documents.next_batch(batch));
+
+    for (const std::string& key : found) {
+        manager.execute_for_key(key, {"DEL", key});
+    }
+}
+
+TEST_F(KeyScannerTest, RequiresDecoderToFetchDocuments) {
+    if (!isRedisAvailable()) GTEST_SKIP() << "Skipping test, live Redis required.";
+    RedisConnectionManager manager(config);
+    ScanOptions options;
+    options.fetch_documents = true;
+    EXPECT_THROW(KeyScanner(manager, "*", options), ArgumentInvalidException);
+}
@@ -4,6 +4,12 @@
 #include "redisjson++/redis_connection_manager.h" // Required by LuaScriptManager
 #include "redisjson++/exceptions.h"
 #include "redisjson++/hiredis_RAII.h" // For RedisReplyPtr
+#include "redisjson++/path_parser.h"
+#include "redisjson++/json_path_plan.h"
+#include "redisjson++/json_aggregation.h"
+#include "redisjson++/json_index.h"
+#include "redisjson++/json_modifier.h"
+#include "redisjson++/sha1.h"
 
 using namespace redisjson;
 using json = nlohmann::json;
@@ -75,6 +81,16 @@ protected:
     }
 };
 
+TEST(LuaScriptManagerReadOnlyTest, ClassifiesBuiltinScripts) {
+    EXPECT_TRUE(LuaScriptManager::is_read_only_script("json_path_get"));
+    EXPECT_TRUE(LuaScriptManager::is_read_only_script("json_arrindex"));
+    EXPECT_TRUE(LuaScriptManager::is_read_only_script("json_query"));
+    EXPECT_TRUE(LuaScriptManager::is_read_only_script("json_aggregate"));
+    EXPECT_FALSE(LuaScriptManager::is_read_only_script("json_path_set"));
+    EXPECT_FALSE(LuaScriptManager::is_read_only_script("json_array_pop"));
+    EXPECT_FALSE(LuaScriptManager::is_read_only_script("custom_script"));
+}
+
 TEST_F(LuaScriptManagerTest, Construction) {
     ASSERT_NO_THROW({
         LuaScriptManager sm(&conn_manager_);
@@ -91,6 +107,224 @@ TEST_F(LuaScriptManagerTest, LoadScript) {
     EXPECT_TRUE(script_manager_.is_script_loaded(script_name));
 }
 
+TEST_F(LuaScriptManagerTest, BuiltinScriptsAcceptPreTokenisedPaths) {
+    if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
+
+    const std::string key = "lua_test:tokenised_path";
+    RedisReplyPtr set_reply = conn_manager_.execute_for_key(key, {"SET", key, R"({"a":{"b.c":[10,20,30]}})"});
+    ASSERT_NE(set_reply, nullptr);
+    std::string path = PathParser::encode_script_path(PathParser().parse("a['b.c'][1]"));
+    json result = script_manager_.execute_script("json_path_get", {key}, {path});
+    EXPECT_EQ(result, json::array({20}));
+    conn_manager_.execute_for_key(key, {"DEL", key});
+}
+
+TEST_F(LuaScriptManagerTest, QueryScriptMatchesClientSideEvaluation) {
+    if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
+
+    const std::string key = "lua_test:json_query";
+    json doc = json::parse(R"({
+        "default_mtu": 1500,
+        "ports": [
+            {"name": "Ethernet0", "admin_status": "up",   "mtu": 9100, "lag": {"name": "PortChannel1"}},
+            {"name": "Ethernet4", "admin_status": "down", "mtu": 1500},
+            {"name": "Ethernet8", "admin_status": "up",   "mtu": 1500, "tags": ["a", "b"]}
+        ],
+        "vlans": {"Vlan10": {"members": ["Ethernet0"]}, "Vlan20": {"members": ["Ethernet4", "Ethernet8"]}}
+    })");
+    conn_manager_.execute_for_key(key, {"SET", key, doc.dump()});
+    for (const char* expression : {"$..ports[?(@.admin_status=='up')].mtu", "$.ports[*].name", "$..name",
+                                   "$.ports[::-1].mtu", "$.ports[0,-1].name", "$.vlans.*.members[-1]",
+                                   "$.ports[?(@.mtu == $.default_mtu && !@.tags)].name",
+                                   "$.ports[?(@.mtu > 1500 || @.tags[1] == 'b')]", "$.missing", "$"}) {
+        JSONPathPlan plan = JSONPathPlan::compile(expression);
+        json expected = json::array();
+        for (const json* match : plan.select(doc)) expected.push_back(*match);
+        EXPECT_EQ(script_manager_.execute_script("json_query", {key}, {plan.script_argument()}), expected) << expression;
+    }
+    EXPECT_TRUE(script_manager_.execute_script("json_query", {"lua_test:json_query_missing"}, {"[]"}).is_null());
+    conn_manager_.execute_for_key(key, {"DEL", key});
+}
+
+TEST_F(LuaScriptManagerTest, AggregateScriptMatchesClientSideAggregation) {
+    if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
+
+    // One hash tag, so that both keys can go to one script call in cluster mode too.
+    const std::vector<std::string> keys = {"{lua_test}:json_aggregate:1", "{lua_test}:json_aggregate:2",
+                                           "{lua_test}:json_aggregate:missing"};
+    const std::vector<json> docs = {
+        json::parse(R"({"ports": [{"mtu": 9100, "speed": 100000}, {"mtu": 1500, "speed": "auto"}, {"mtu": 1500}]})"),
+        json::parse(R"({"ports": [{"mtu": 1500.5, "speed": 40000}, {"mtu": 9216, "speed": null}]})")};
+    for (size_t i = 0; i < docs.size(); ++i) {
+        conn_manager_.execute_for_key(keys[i], {"SET", keys[i], docs[i].dump()});
+    }
+    for (const char* expression : {"$.ports[*].mtu", "$..speed", "$.missing"}) {
+        JSONPathPlan plan = JSONPathPlan::compile(expression);
+        for (const char* operation : {"count", "sum", "avg", "min", "max", "distinct_count", "percentile:90"}) {
+            Aggregation expected(operation), single(operation), merged(operation), single_expected(operation);
+            for (size_t i = 0; i < docs.size(); ++i) {
+                plan.visit(docs[i], [&](const json& match) {
+                    expected.add(match);
+                    if (i == 0) single_expected.add(match);
+                });
+            }
+            std::vector<std::string> args = {plan.script_argument()};
+            std::vector<std::string> final_args = single.script_arguments(false);
+            std::vector<std::string> partial_args = merged.script_arguments(true);
+
+            std::vector<std::string> single_args = args;
+            single_args.insert(single_args.end(), final_args.begin(), final_args.end());
+            json reply = script_manager_.execute_script("json_aggregate", {keys[0]}, single_args);
+            ASSERT_TRUE(reply.contains("result")) << reply.dump();
+            single.set_result(reply["result"]);
+            EXPECT_EQ(single.result(), single_expected.result()) << expression << " " << operation;
+
+            std::vector<std::string> batch_args = args;
+            batch_args.insert(batch_args.end(), partial_args.begin(), partial_args.end());
+            merged.merge(script_manager_.execute_script("json_aggregate", {keys[0], keys[2]}, batch_args));
+            merged.merge(script_manager_.execute_script("json_aggregate", {keys[1]}, batch_args));
+            EXPECT_EQ(merged.result(), expected.result()) << expression << " " << operation;
+        }
+    }
+    for (size_t i = 0; i < docs.size(); ++i) {
+        conn_manager_.execute_for_key(keys[i], {"DEL", keys[i]});
+    }
+}
+
+TEST_F(LuaScriptManagerTest, DeltaSetAppliesPatchOnlyToRememberedVersion) {
+    if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
+
+    const std::string key = "lua_test:delta";
+    json base = {{"name", "r1"}, {"ports", {{{"name", "eth0"}, {"mtu", 1500}}, {{"name", "eth1"}, {"mtu", 1500}}}},
+                 {"uptime", 10}, {"tags", {"a", "b"}}};
+    json next = {{"name", "r1"}, {"ports", {{{"name", "eth0"}, {"mtu", 9000}}}}, {"uptime", 11.5},
+                 {"tags", {"b", "a/c~"}}, {"location", {{"city", "Oslo"}}}};
+    conn_manager_.execute_for_key(key, {"SET", key, base.dump()});
+    std::string patch = JSONModifier().diff(base, next).dump();
+
+    EXPECT_EQ(script_manager_.execute_script("json_delta_set", {key}, {sha1_hex("stale"), patch, "0"}), 0);
+    json result = script_manager_.execute_script("json_delta_set", {key}, {sha1_hex(base.dump()), patch, "0"});
+    ASSERT_TRUE(result.is_array());
+    RedisReplyPtr stored = conn_manager_.execute_for_key(key, {"GET", key});
+    std::string stored_value(stored->str, stored->len);
+    EXPECT_EQ(json::parse(stored_value), next);
+    EXPECT_EQ(result, json::array({sha1_hex(stored_value), stored_value.size()}));
+
+    json failing_test = json::array({{{"op", "test"}, {"path", "/name"}, {"value", "r2"}}});
+    EXPECT_THROW(script_manager_.execute_script("json_delta_set", {key}, {result[0], failing_test.dump(), "0"}),
+                 LuaScriptException);
+    conn_manager_.execute_for_key(key, {"DEL", key});
+    EXPECT_EQ(script_manager_.execute_script("json_delta_set", {key}, {result[0], patch, "0"}), 0);
+}
+
+TEST_F(LuaScriptManagerTest, PatchScriptsApplyRFCPatchesAtomically) {
+    if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
+
+    const std::string key = "lua_test:patch";
+    json doc = {{"name", "r1"}, {"ports", {"eth0", "eth1"}}, {"location", {{"city", "Oslo"}, {"rack", 4}}}};
+    conn_manager_.execute_for_key(key, {"SET", key, doc.dump()});
+    auto stored = [&]() {
+        RedisReplyPtr reply = conn_manager_.execute_for_key(key, {"GET", key});
+        return json::parse(std::string(reply->str, reply->len));
+    };
+    json patch = json::parse(R"([
+        {"op": "test", "path": "/name", "value": "r1"},
+        {"op": "add", "path": "/ports/1", "value": "mgmt"},
+        {"op": "remove", "path": "/ports/0"},
+        {"op": "move", "from": "/location/rack", "path": "/rack"},
+        {"op": "copy", "from": "/ports", "path": "/location/ports"},
+        {"op": "replace", "path": "/name", "value": "r2"}
+    ])");
+    EXPECT_EQ(script_manager_.execute_script("json_patch", {key}, {patch.dump()}), 1);
+    EXPECT_EQ(stored(), doc.patch(patch));
+
+    json failing = json::parse(R"([{"op": "remove", "path": "/rack"}, {"op": "test", "path": "/name", "value": "r1"}])");
+    EXPECT_THROW(script_manager_.execute_script("json_patch", {key}, {failing.dump()}), LuaScriptException);
+    EXPECT_EQ(stored(), doc.patch(patch)); // Unchanged: the first operation is not kept
+
+    json merge = {{"name", nullptr}, {"location", {{"city", "Bergen"}, {"ports", nullptr}}},
+                  {"tags", json::array()}, {"vlans", {10, 20}}};
+    EXPECT_EQ(script_manager_.execute_script("json_merge_patch", {key},
+                                             {LuaScriptManager::mark_empty_arrays(merge).dump()}), 1);
+    json expected = doc.patch(patch);
+    expected.merge_patch(merge);
+    EXPECT_EQ(stored(), expected);
+    conn_manager_.execute_for_key(key, {"DEL", key});
+}
+
+TEST_F(LuaScriptManagerTest, PatchScriptsLeaveLossyDocumentsToTheClient) {
+    if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
+
+    const std::string key = "lua_test:patch_lossless";
+    auto stored = [&]() {
+        RedisReplyPtr reply = conn_manager_.execute_for_key(key, {"GET", key});
+        return std::string(reply->str, reply->len);
+    };
+    json patch = json::parse(R"([{"op": "replace", "path": "/name", "value": "r2"}])");
+    for (const json& doc : {json{{"name", "r1"}, {"tags", json::array()}},
+                            json{{"name", "r1"}, {"counter", 123456789012345678LL}},
+                            json{{"name", "r1"}, {"ratio", 0.1234567890123456}}}) {
+        conn_manager_.execute_for_key(key, {"SET", key, doc.dump()});
+        // Declined: patch_json then patches on the client and stores with json_replace_if_unchanged
+        EXPECT_EQ(script_manager_.execute_script("json_patch", {key}, {patch.dump()}), 0) << doc.dump();
+        EXPECT_EQ(script_manager_.execute_script("json_merge_patch", {key}, {R"({"name":"r3"})"}), 0);
+        EXPECT_EQ(stored(), doc.dump());
+
+        std::string read = stored();
+        EXPECT_EQ(script_manager_.execute_script("json_replace_if_unchanged", {key},
+                                                 {sha1_hex("changed"), doc.patch(patch).dump()}), 0);
+        EXPECT_EQ(script_manager_.execute_script("json_replace_if_unchanged", {key},
+                                                 {sha1_hex(read), doc.patch(patch).dump()}), 1);
+        EXPECT_EQ(json::parse(stored()), doc.patch(patch)); // The stored [] is still an array
+    }
+    conn_manager_.execute_for_key(key, {"DEL", key});
+    EXPECT_EQ(script_manager_.execute_script("json_replace_if_unchanged", {key}, {"", "{\"a\":[]}"}), 1);
+    EXPECT_EQ(stored(), "{\"a\":[]}");
+    conn_manager_.execute_for_key(key, {"DEL", key});
+}
+
+TEST_F(LuaScriptManagerTest, WriteScriptsMaintainSecondaryIndexes) {
+    if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
+
+    IndexRegistry indexes;
+    indexes.add({"lua_test_city", "lua_test:indexed:*", "location.city", IndexType::TAG});
+    indexes.add({"lua_test_speed", "lua_test:indexed:*", "ports[0].speed", IndexType::NUMERIC});
+    script_manager_.set_index_registry(&indexes);
+    const std::string key = "lua_test:indexed:1";
+    const std::string city_key = "redisjson:index:lua_test_city";
+    const std::string speed_key = "redisjson:index:lua_test_speed";
+    auto command = [this](const std::vector<std::string>& argv) {
+        return LuaScriptManager::redis_reply_to_json(conn_manager_.execute_for_key(argv[1], argv).get());
+    };
+
+    json doc = {{"location", {{"city", "Paris"}}}, {"ports", {{{"speed", 40000}}}}};
+    script_manager_.execute_script("json_set_document", {key}, {"NONE", "0", doc.dump()});
+    EXPECT_EQ(command({"HGET", city_key, key}), "Paris");
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Paris", key}), 1);
+    EXPECT_EQ(command({"ZSCORE", speed_key, key}), 40000);
+
+    script_manager_.execute_script("json_path_set", {key}, {"location.city", "\"Oslo\"", "NONE"});
+    script_manager_.execute_script("json_numincrby", {key}, {"ports[0].speed", "60000"});
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Paris", key}), 0);
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Oslo", key}), 1);
+    EXPECT_EQ(command({"ZSCORE", speed_key, key}), 100000);
+
+    script_manager_.execute_script("json_path_del", {key}, {"ports"});
+    EXPECT_TRUE(command({"ZSCORE", speed_key, key}).is_null());
+    script_manager_.execute_script("json_del_document", {key}, {});
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Oslo", key}), 0);
+    EXPECT_TRUE(command({"HGET", city_key, key}).is_null());
+
+    // An existing document, indexed after the fact.
+    conn_manager_.execute_for_key(key, {"SET", key, doc.dump()});
+    EXPECT_EQ(script_manager_.execute_script("json_index_document", {key}, {}), 2);
+    EXPECT_EQ(command({"SISMEMBER", city_key + ":Paris", key}), 1);
+    EXPECT_EQ(command({"ZSCORE", speed_key, key}), 40000);
+
+    script_manager_.execute_script("json_del_document", {key}, {});
+    script_manager_.set_index_registry(nullptr);
+}
+
 TEST_F(LuaScriptManagerTest, ExecuteLoadedScript) {
     if (!live_redis_available_) GTEST_SKIP() << "Skipping test, live Redis required.";
 
@@ -1494,3 +1728,49 @@ TEST_F(LuaScriptManagerJsonClearTest, ClearObjectWithEmptyNestedArrayAndObject)
     };
     EXPECT_EQ(get_current_json(), expected_doc);
 }
+
+TEST(LuaScriptManagerBuiltinTest, BuiltinScriptsUseTheConfiguredCodec) {
+    std::string json_source = LuaScriptManager::get_builtin_script("json_path_set", DocumentEncoding::JSON);
+    std::string msgpack_source = LuaScriptManager::get_builtin_script("json_path_set", DocumentEncoding::MESSAGEPACK);
+    ASSERT_FALSE(json_source.empty());
+    ASSERT_FALSE(msgpack_source.empty());
+    EXPECT_THAT(json_source, ::testing::HasSubstr("cjson.decode(data)"));
+    EXPECT_THAT(msgpack_source, ::testing::HasSubstr("cmsgpack.unpack"));
+    EXPECT_THAT(msgpack_source, ::testing::Not(::testing::HasSubstr("cjson.decode(data)")));
+    EXPECT_TRUE(LuaScriptManager::get_builtin_script("no_such_script", DocumentEncoding::JSON).empty());
+}
+
+TEST(LuaScriptManagerBuiltinTest, BuiltinScriptsUseTheConfiguredLayout) {
+    std::string string_source = LuaScriptManager::get_builtin_script("json_path_set", DocumentEncoding::JSON,
+                                                                     DocumentLayout::STRING);
+    std::string hash_source = LuaScriptManager::get_builtin_script("json_path_set", DocumentEncoding::JSON,
+                                                                   DocumentLayout::HASH);
+    EXPECT_THAT(string_source, ::testing::HasSubstr("redis.call('GET', key)"));
+    EXPECT_THAT(string_source, ::testing::Not(::testing::HasSubstr("redis.call('HGET', key, DOC_FIELD)")));
+    EXPECT_THAT(hash_source, ::testing::HasSubstr("redis.call('HGET', key, DOC_FIELD)"));
+    EXPECT_THAT(hash_source, ::testing::HasSubstr("table.remove(ARGV, 1)"));
+    EXPECT_FALSE(LuaScriptManager::get_builtin_script("json_hash_set_document", DocumentEncoding::JSON,
+                                                      DocumentLayout::HASH).empty());
+}
+
+TEST(LuaScriptManagerBuiltinTest, OnlyWriteScriptsMaintainIndexes) {
+    EXPECT_THAT(LuaScriptManager::get_builtin_script("json_path_set", DocumentEncoding::JSON),
+                ::testing::HasSubstr("local INDEXES = {}"));
+    EXPECT_THAT(LuaScriptManager::get_builtin_script("json_hash_set_document", DocumentEncoding::JSON, DocumentLayout::HASH),
+                ::testing::HasSubstr("local INDEXES = {}"));
+    EXPECT_THAT(LuaScriptManager::get_builtin_script("json_path_get", DocumentEncoding::JSON),
+                ::testing::Not(::testing::HasSubstr("local INDEXES = {}")));
+    EXPECT_THAT(LuaScriptManager::get_builtin_script("json_aggregate", DocumentEncoding::JSON),
+                ::testing::Not(::testing::HasSubstr("local INDEXES = {}")));
+}
+
+TEST(LuaScriptManagerBuiltinTest, MarksEmptyArraysForScripts) {
+    json marked = LuaScriptManager::mark_empty_arrays({{"tags", json::array()}, {"ports", {json::array(), 1}},
+                                                       {"meta", json::object()}});
+    std::string source = LuaScriptManager::get_builtin_script("json_merge_patch", DocumentEncoding::JSON);
+    ASSERT_TRUE(marked["tags"].is_string());
+    EXPECT_THAT(source, ::testing::HasSubstr("local EMPTY_ARRAY_SENTINEL = \"" + marked["tags"].get<std::string>() + "\""));
+    EXPECT_EQ(marked["ports"], json::array({marked["tags"], 1}));
+    EXPECT_EQ(marked["meta"], json::object());
+    EXPECT_EQ(LuaScriptManager::mark_empty_arrays(json::array()), marked["tags"]);
+}
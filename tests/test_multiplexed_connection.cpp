@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+#include "redisjson++/multiplexed_connection.h"
+#include "redisjson++/redis_connection_manager.h"
+#include "redisjson++/exceptions.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace redisjson;
+
+namespace {
+
+LegacyClientConfig local_config() {
+    LegacyClientConfig config;
+    config.host = "127.0.0.1";
+    config.port = 6379;
+    config.timeout = std::chrono::milliseconds(500);
+    return config;
+}
+
+} // namespace
+
+TEST(MultiplexedConnectionTest, FormatsCommandsAsBulkStrings) {
+    EXPECT_EQ(MultiplexedConnection::format_command({"GET", "key"}), "*2\r\n$3\r\nGET\r\n$3\r\nkey\r\n");
+    std::string binary("a\0b", 3);
+    EXPECT_EQ(MultiplexedConnection::format_command({"SET", "k", binary}),
+              std::string("*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$3\r\na\0b\r\n", 29));
+}
+
+TEST(MultiplexedConnectionTest, FailsFastWhenServerIsUnreachable) {
+    LegacyClientConfig config = local_config();
+    config.port = 1; // Nothing listens there
+    MultiplexedConnection conn(config);
+    EXPECT_FALSE(conn.is_connected());
+    EXPECT_THROW(conn.execute({"PING"}), ConnectionException);
+    EXPECT_EQ(conn.pending(), 0u);
+}
+
+TEST(MultiplexedConnectionTest, ConcurrentCallersGetTheirOwnReplies) {
+    MultiplexedConnection conn(local_config());
+    if (!conn.is_connected()) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    constexpr int THREADS = 32;
+    constexpr int CALLS = 200;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < CALLS; ++i) {
+                std::string message = std::to_string(t) + ":" + std::to_string(i);
+                RedisReplyPtr reply = conn.execute({"ECHO", message});
+                if (!reply || reply->type != REDIS_REPLY_STRING || std::string(reply->str, reply->len) != message) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(conn.pending(), 0u);
+}
+
+TEST(MultiplexedConnectionTest, ManagerSpreadsCommandsOverSharedConnections) {
+    LegacyClientConfig config = local_config();
+    config.connection_pool_size = 1;
+    config.multiplexed_connections = 2;
+    RedisConnectionManager manager(config);
+    ASSERT_TRUE(manager.is_multiplexed());
+    if (!manager.is_healthy()) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    std::vector<std::future<RedisReplyPtr>> replies;
+    for (int i = 0; i < 100; ++i) {
+        replies.push_back(manager.submit_multiplexed({"ECHO", std::to_string(i)}));
+    }
+    for (int i = 0; i < 100; ++i) {
+        RedisReplyPtr reply = replies[i].get();
+        ASSERT_EQ(reply->type, REDIS_REPLY_STRING);
+        EXPECT_EQ(std::string(reply->str, reply->len), std::to_string(i));
+    }
+}
+
+TEST(MultiplexedConnectionTest, StalledServerTimesOutAndFailsCommandsInFlight) {
+    // A server that accepts connections (the kernel completes them) and never replies.
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(::listen(listener, 4), 0);
+    ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length), 0);
+
+    LegacyClientConfig config = local_config();
+    config.port = ntohs(address.sin_port);
+    config.timeout = std::chrono::milliseconds(300);
+    {
+        MultiplexedConnection conn(config);
+        if (!conn.is_connected()) {
+            ::close(listener);
+            GTEST_SKIP() << "Could not connect to the local socket. Skipping test.";
+        }
+        std::future<RedisReplyPtr> other = conn.submit({"PING"});
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_THROW(conn.execute({"PING"}), TimeoutException);
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+        // The session is failed with it, so the other caller does not wait forever either.
+        ASSERT_EQ(other.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+        EXPECT_THROW(other.get(), ConnectionException);
+        EXPECT_EQ(conn.pending(), 0u);
+    }
+    ::close(listener);
+}
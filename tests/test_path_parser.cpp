@@ -147,6 +147,71 @@ TEST(PathParserTest, NormalizePathInvalid) {
     EXPECT_THROW(parser.normalize_path("key..key2"), InvalidPathException);
 }
 
+TEST(PathParserTest, SplitTopLevel) {
+    using Parts = std::pair<std::string, std::string>;
+    EXPECT_EQ(PathParser::split_top_level("$"), Parts("", ""));
+    EXPECT_EQ(PathParser::split_top_level("ports"), Parts("ports", ""));
+    EXPECT_EQ(PathParser::split_top_level("$.ports"), Parts("ports", ""));
+    EXPECT_EQ(PathParser::split_top_level("ports.Ethernet0.mtu"), Parts("ports", "Ethernet0.mtu"));
+    EXPECT_EQ(PathParser::split_top_level("vlans[0].id"), Parts("vlans", "[0].id"));
+    EXPECT_THROW(PathParser::split_top_level("[0]"), InvalidPathException);
+    EXPECT_THROW(PathParser::split_top_level("ports."), InvalidPathException);
+}
+
+TEST(PathParserTest, ParseRootRelativePaths) {
+    PathParser parser;
+    auto elements = parser.parse("$.store.books[1]");
+    ASSERT_EQ(elements.size(), 3);
+    EXPECT_EQ(elements[0].key_name, "store");
+    EXPECT_EQ(elements[1].key_name, "books");
+    EXPECT_EQ(elements[2].type, PathParser::PathElement::Type::INDEX);
+    EXPECT_EQ(elements[2].index, 1);
+
+    elements = parser.parse("$[0]");
+    ASSERT_EQ(elements.size(), 1);
+    EXPECT_EQ(elements[0].type, PathParser::PathElement::Type::INDEX);
+}
+
+TEST(PathParserTest, EncodesScriptPaths) {
+    PathParser parser;
+    std::string encoded = PathParser::encode_script_path(parser.parse("a['b.c'][2]"));
+    ASSERT_FALSE(encoded.empty());
+    EXPECT_EQ(encoded[0], '\0');
+    // Member names stay strings; indices are 1-based, as the scripts index Lua tables
+    json segments = json::from_msgpack(encoded.substr(1));
+    EXPECT_EQ(segments, json::array({"a", "b.c", 3}));
+
+    EXPECT_EQ(PathParser::script_path_argument("$.a.b"), PathParser::script_path_argument("a.b"));
+    EXPECT_EQ(PathParser::script_path_argument("$"), "$");
+    EXPECT_EQ(PathParser::script_path_argument(""), "");
+    EXPECT_EQ(PathParser::script_path_argument("a..b"), "a..b"); // Malformed: left for the script to report
+    EXPECT_TRUE(PathParser::encode_script_path({}).empty());
+}
+
+TEST(PathParserTest, CompiledPathsAreCachedAndShared) {
+    PathParser parser(2);
+    CompiledPath first = parser.compile("a.b[1]");
+    CompiledPath second = parser.compile("a.b[1]");
+    EXPECT_EQ(&first.elements(), &second.elements()); // Parsed once
+    ASSERT_EQ(first.elements().size(), 3u);
+    EXPECT_EQ(first.path(), "a.b[1]");
+    EXPECT_EQ(first.script_argument(), PathParser::script_path_argument("a.b[1]"));
+    EXPECT_EQ(parser.compiled_path_count(), 1u);
+
+    EXPECT_THROW(parser.compile("a..b"), InvalidPathException);
+    EXPECT_EQ(parser.compiled_path_count(), 1u); // Invalid paths are not cached
+
+    parser.compile("c");
+    parser.compile("d");
+    EXPECT_EQ(parser.compiled_path_count(), 2u); // Bounded
+    EXPECT_EQ(first.elements().size(), 3u);      // Evicted paths stay valid
+
+    CompiledPath root;
+    EXPECT_TRUE(root.is_root());
+    EXPECT_EQ(root.script_argument(), "$");
+    EXPECT_TRUE(PathParser(0).compile("x").elements().size() == 1);
+}
+
 // Add more tests for slice, wildcard, filter, recursive descent when implemented.
 // Add tests for expand_wildcards when implemented.
 
@@ -175,21 +240,34 @@ TEST(PathParserTest, ExpandWildcardsEmptyPath) {
     EXPECT_EQ(expanded[0], "");
 }
 
-// Future: Test actual wildcard expansion when implemented.
-// TEST(PathParserTest, ExpandWildcardsWithActualWildcard) {
-//     PathParser parser;
-//     json doc = {
-//         {"users", {
-//             {"user1", {{"name", "Alice"}}},
-//             {"user2", {{"name", "Bob"}}}
-//         }}
-//     };
-//     // Assuming "users.*.name" path parsing is implemented
-//     // auto expanded = parser.expand_wildcards(doc, "users.*.name");
-//     // EXPECT_EQ(expanded.size(), 2);
-//     // EXPECT_TRUE(std::find(expanded.begin(), expanded.end(), "users.user1.name") != expanded.end());
-//     // EXPECT_TRUE(std::find(expanded.begin(), expanded.end(), "users.user2.name") != expanded.end());
-// }
+TEST(PathParserTest, ExpandWildcardsWithActualWildcard) {
+    PathParser parser;
+    json doc = {
+        {"users", {
+            {"user1", {{"name", "Alice"}}},
+            {"user2", {{"name", "Bob"}}},
+            {"user 3", {{"email", "c@example.com"}}}
+        }}
+    };
+    EXPECT_EQ(parser.expand_wildcards(doc, "users.*.name"),
+              (std::vector<std::string>{"$.users.user1.name", "$.users.user2.name"}));
+    EXPECT_EQ(parser.expand_wildcards(doc, "$..email"), std::vector<std::string>{"$.users['user 3'].email"});
+    EXPECT_TRUE(parser.expand_wildcards(doc, "users[?(@.name == 'Carol')]").empty());
+    // Expanded paths are accepted by parse()
+    EXPECT_EQ(parser.parse("$.users['user 3'].email").size(), 3u);
+}
+
+TEST(PathParserTest, ReconstructsWildcardElements) {
+    PathParser::PathElement recursive, key, wildcard, filter;
+    recursive.type = PathParser::PathElement::Type::RECURSIVE;
+    key.type = PathParser::PathElement::Type::KEY;
+    key.key_name = "ports";
+    wildcard.type = PathParser::PathElement::Type::WILDCARD;
+    filter.type = PathParser::PathElement::Type::FILTER;
+    filter.filter_expression = "@.mtu > 1500";
+    EXPECT_EQ(PathParser::reconstruct_path({recursive, key, wildcard}), "..ports[*]");
+    EXPECT_EQ(PathParser::reconstruct_path({key, filter}), "ports[?(@.mtu > 1500)]");
+}
 
 // int main(int argc, char **argv) {
 //     ::testing::InitGoogleTest(&argc, argv);
@@ -1,9 +1,11 @@
 #include "gtest/gtest.h"
 #include "redisjson++/redis_connection_manager.h"
 #include "redisjson++/exceptions.h" // For ConnectionException
+#include "redisjson++/hiredis_RAII.h" // For RedisReplyPtr
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <future>
 #include <iostream> // For GTEST_SKIP logging
 
 // Basic test fixture for RedisConnectionManager tests
@@ -189,6 +191,163 @@ TEST_F(RedisConnectionManagerTest, GetConnectionRetriesAfterBadPooledConnection)
     manager.return_connection(std::move(conn2));
 }
 
+TEST_F(RedisConnectionManagerTest, ExhaustedPoolWakesWaiterWhenConnectionReturned) {
+    if (!isRedisAvailable()) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    config.connection_pool_size = 1;
+    redisjson::RedisConnectionManager manager(config);
+    redisjson::RedisConnectionManager::RedisConnectionPtr held = manager.get_connection();
+    ASSERT_NE(held, nullptr);
+
+    auto waiter = std::async(std::launch::async, [&manager] { return manager.get_connection(); });
+    EXPECT_EQ(waiter.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout); // Blocked
+    manager.return_connection(std::move(held));
+    ASSERT_EQ(waiter.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    redisjson::RedisConnectionManager::RedisConnectionPtr conn = waiter.get();
+    ASSERT_NE(conn, nullptr);
+    EXPECT_TRUE(conn->ping());
+
+    auto stats = manager.get_stats();
+    EXPECT_EQ(stats.total_connections, 1u); // The returned connection was handed over, not a new one
+    EXPECT_EQ(stats.active_connections, 1u);
+    EXPECT_EQ(stats.idle_connections, 0u);
+    manager.return_connection(std::move(conn));
+}
+
+TEST_F(RedisConnectionManagerTest, FailedConnectReleasesItsSlot) {
+    // No server needed: nothing listens on port 1.
+    config.port = 1;
+    config.connection_pool_size = 2;
+    redisjson::RedisConnectionManager manager(config);
+    EXPECT_EQ(manager.get_stats().total_connections, 0u);
+    uint64_t errors = manager.get_stats().connection_errors;
+
+    // Had a failed connect kept its slot, the third call would wait for a connection forever.
+    auto attempts = std::async(std::launch::async, [&manager] {
+        int failures = 0;
+        for (int i = 0; i < 3; ++i) {
+            try {
+                manager.get_connection();
+            } catch (const redisjson::ConnectionException&) {
+                ++failures;
+            }
+        }
+        return failures;
+    });
+    ASSERT_EQ(attempts.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(attempts.get(), 3);
+    EXPECT_EQ(manager.get_stats().total_connections, 0u);
+    EXPECT_GE(manager.get_stats().connection_errors, errors + 3); // The health check may add its own
+}
+
+TEST_F(RedisConnectionManagerTest, CloseAllConnectionsWakesWaiter) {
+    if (!isRedisAvailable()) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    config.connection_pool_size = 1;
+    redisjson::RedisConnectionManager manager(config);
+    redisjson::RedisConnectionManager::RedisConnectionPtr held = manager.get_connection();
+    ASSERT_NE(held, nullptr);
+
+    auto waiter = std::async(std::launch::async, [&manager] { return manager.get_connection(); });
+    EXPECT_EQ(waiter.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout); // Blocked
+    // The held connection keeps its slot and stays usable until it is returned; it is
+    // then closed instead of pooled, and the waiter opens a connection of its own.
+    manager.close_all_connections();
+    EXPECT_EQ(waiter.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+    EXPECT_TRUE(held->ping());
+    manager.return_connection(std::move(held));
+    ASSERT_EQ(waiter.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    redisjson::RedisConnectionManager::RedisConnectionPtr conn = waiter.get();
+    ASSERT_NE(conn, nullptr);
+    EXPECT_TRUE(conn->ping());
+
+    manager.return_connection(std::move(conn));
+    redisjson::ConnectionStats stats = manager.get_stats();
+    EXPECT_LE(stats.idle_connections, static_cast<uint32_t>(config.connection_pool_size));
+    EXPECT_LE(stats.total_connections, static_cast<uint32_t>(config.connection_pool_size));
+    EXPECT_EQ(stats.active_connections, 0u);
+}
+
+TEST_F(RedisConnectionManagerTest, PipelinedCommandsReturnRepliesInOrder) {
+    if (!isRedisAvailable()) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    redisjson::RedisConnectionManager manager(config);
+    auto conn = manager.get_connection();
+    ASSERT_NE(conn, nullptr);
+
+    const char* set_argv[] = {"SET", "rcm_test:pipeline", "42"};
+    const char* get_argv[] = {"GET", "rcm_test:pipeline"};
+    const char* del_argv[] = {"DEL", "rcm_test:pipeline"};
+    size_t set_len[] = {3, 17, 2};
+    size_t get_len[] = {3, 17};
+    size_t del_len[] = {3, 17};
+
+    ASSERT_TRUE(conn->append_command_argv(3, set_argv, set_len));
+    ASSERT_TRUE(conn->append_command_argv(2, get_argv, get_len));
+    ASSERT_TRUE(conn->append_command_argv(2, del_argv, del_len));
+
+    redisjson::RedisReplyPtr set_reply(conn->get_reply());
+    redisjson::RedisReplyPtr get_reply(conn->get_reply());
+    redisjson::RedisReplyPtr del_reply(conn->get_reply());
+    ASSERT_NE(set_reply, nullptr);
+    ASSERT_NE(get_reply, nullptr);
+    ASSERT_NE(del_reply, nullptr);
+    EXPECT_EQ(set_reply->type, REDIS_REPLY_STATUS);
+    ASSERT_EQ(get_reply->type, REDIS_REPLY_STRING);
+    EXPECT_EQ(std::string(get_reply->str, get_reply->len), "42");
+    EXPECT_EQ(del_reply->type, REDIS_REPLY_INTEGER);
+    EXPECT_EQ(del_reply->integer, 1);
+
+    manager.return_connection(std::move(conn));
+}
+
+TEST(RedisConnectionManagerReadPolicyTest, SelectsReadTargets) {
+    using redisjson::ReadPolicy;
+    using redisjson::RedisConnectionManager;
+    using Target = RedisConnectionManager::ReadTarget;
+    using us = std::chrono::microseconds;
+    std::vector<Target> targets = {{true, us(300)}, {true, us(900)}, {false, us(100)}, {true, us(200)}};
+
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::PRIMARY, targets, 1), 0u);
+    // PREFER_REPLICA rotates over the healthy replicas, skipping the one that is down
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::PREFER_REPLICA, targets, 0), 1u);
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::PREFER_REPLICA, targets, 1), 3u);
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::PREFER_REPLICA, targets, 2), 3u);
+    // NEAREST picks the lowest measured round trip among healthy servers
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::NEAREST, targets, 0), 3u);
+    targets[3].round_trip = us(0); // Not measured yet
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::NEAREST, targets, 0), 0u);
+
+    // Nothing healthy but the primary
+    std::vector<Target> replicas_down = {{true, us(0)}, {false, us(50)}};
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::PREFER_REPLICA, replicas_down, 0), 0u);
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::NEAREST, replicas_down, 0), 0u);
+    // Primary down: NEAREST still uses a replica
+    std::vector<Target> primary_down = {{false, us(10)}, {true, us(0)}};
+    EXPECT_EQ(RedisConnectionManager::select_read_target(ReadPolicy::NEAREST, primary_down, 0), 1u);
+}
+
+TEST_F(RedisConnectionManagerTest, ReadsFallBackToPrimaryWhenReplicaIsDown) {
+    if (!isRedisAvailable()) {
+        GTEST_SKIP() << "Redis server not available. Skipping test.";
+    }
+    config.replica_nodes = {"127.0.0.1:1"}; // Nothing listens there
+    config.read_policy = redisjson::ReadPolicy::PREFER_REPLICA;
+    redisjson::RedisConnectionManager manager(config);
+    EXPECT_EQ(manager.replica_addresses(), config.replica_nodes);
+
+    redisjson::RedisReplyPtr set_reply = manager.execute_for_key("rcm_test:replica", {"SET", "rcm_test:replica", "7"});
+    ASSERT_NE(set_reply, nullptr);
+    redisjson::RedisReplyPtr get_reply = manager.execute_read("rcm_test:replica", {"GET", "rcm_test:replica"});
+    ASSERT_NE(get_reply, nullptr);
+    ASSERT_EQ(get_reply->type, REDIS_REPLY_STRING);
+    EXPECT_EQ(std::string(get_reply->str, get_reply->len), "7");
+    manager.execute_for_key("rcm_test:replica", {"DEL", "rcm_test:replica"});
+}
+
 
 // Main function for Google Test
 int main(int argc, char **argv) {
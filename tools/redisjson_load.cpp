@@ -0,0 +1,107 @@
+// Bulk import of JSON documents from NDJSON or JSON-array files (see RedisJSONClient::bulk_load).
+//
+// Usage: redisjson_load [options] <file | ->
+//   --host <host>          Redis host (default: REDIS_HOST or 127.0.0.1)
+//   --port <port>          Redis port (default: REDIS_PORT or 6379)
+//   --password <password>  (default: REDIS_PASSWORD)
+//   --format <auto|ndjson|array>
+//   --key-field <name>     Record member holding the key (default: id)
+//   --key-prefix <prefix>  Prepended to every key
+//   --value-field <name>   Record member holding the document (default: the whole record)
+//   --threads <n>          Batches written in parallel (default: 4)
+//   --batch-size <n>       Documents per pipeline (default: 500)
+//   --ttl <seconds>        Expiry of the documents
+//   --nx | --xx            Only create / only replace documents
+//   --quiet                No progress output
+
+#include "redisjson++/redis_json_client.h"
+#include "redisjson++/exceptions.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void usage() {
+    std::cerr << "Usage: redisjson_load [--host H] [--port P] [--password PW] [--format auto|ndjson|array]\n"
+                 "                      [--key-field F] [--key-prefix P] [--value-field F] [--threads N]\n"
+                 "                      [--batch-size N] [--ttl S] [--nx|--xx] [--quiet] <file | ->\n";
+}
+
+void print_progress(const redisjson::BulkLoadProgress& progress) {
+    std::cerr << std::fixed << std::setprecision(1) << "\r" << progress.documents_written << " written, "
+              << progress.skipped << " skipped, " << progress.errors << " errors, "
+              << progress.bytes_read / (1024.0 * 1024.0) << " MiB read, "
+              << progress.documents_per_second() << " docs/s" << std::flush;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    redisjson::LegacyClientConfig config;
+    if (const char* host = std::getenv("REDIS_HOST")) config.host = host;
+    if (const char* port = std::getenv("REDIS_PORT")) config.port = std::stoi(port);
+    if (const char* password = std::getenv("REDIS_PASSWORD")) config.password = password;
+
+    redisjson::BulkLoadOptions options;
+    options.progress = print_progress;
+    std::string path;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument(arg + " needs a value");
+                return argv[++i];
+            };
+            if (arg == "--host") config.host = value();
+            else if (arg == "--port") config.port = std::stoi(value());
+            else if (arg == "--password") config.password = value();
+            else if (arg == "--key-field") options.key_field = value();
+            else if (arg == "--key-prefix") options.key_prefix = value();
+            else if (arg == "--value-field") options.value_field = value();
+            else if (arg == "--threads") options.threads = std::stoul(value());
+            else if (arg == "--batch-size") options.batch_size = std::stoul(value());
+            else if (arg == "--ttl") options.set_options.ttl = std::chrono::seconds(std::stol(value()));
+            else if (arg == "--nx") options.set_options.condition = redisjson::SetCmdCondition::NX;
+            else if (arg == "--xx") options.set_options.condition = redisjson::SetCmdCondition::XX;
+            else if (arg == "--quiet") options.progress = nullptr;
+            else if (arg == "--format") {
+                std::string format = value();
+                if (format == "auto") options.format = redisjson::BulkFormat::AUTO;
+                else if (format == "ndjson") options.format = redisjson::BulkFormat::NDJSON;
+                else if (format == "array") options.format = redisjson::BulkFormat::JSON_ARRAY;
+                else throw std::invalid_argument("unknown format '" + format + "'");
+            } else if (path.empty() && (arg == "-" || arg[0] != '-')) {
+                path = arg;
+            } else {
+                throw std::invalid_argument("unexpected argument '" + arg + "'");
+            }
+        }
+        if (path.empty()) throw std::invalid_argument("no input file");
+    } catch (const std::exception& e) {
+        std::cerr << "redisjson_load: " << e.what() << std::endl;
+        usage();
+        return 2;
+    }
+    // Enough connections for every batch in flight.
+    config.connection_pool_size = std::max(config.connection_pool_size, static_cast<int>(options.threads));
+
+    try {
+        redisjson::RedisJSONClient client(config);
+        redisjson::BulkLoadResult result =
+            path == "-" ? client.bulk_load(std::cin, options) : client.bulk_load_file(path, options);
+        if (options.progress) std::cerr << std::endl;
+        std::cout << result.records_read << " records, " << result.documents_written << " written, "
+                  << result.skipped << " skipped, " << result.errors << " errors in "
+                  << result.elapsed.count() << " ms" << std::endl;
+        for (const std::string& message : result.error_messages) {
+            std::cerr << "  " << message << std::endl;
+        }
+        return result.errors == 0 ? 0 : 1;
+    } catch (const redisjson::RedisJSONException& e) {
+        std::cerr << std::endl << "redisjson_load: " << e.what() << std::endl;
+        return 1;
+    }
+}